@@ -24,6 +24,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
@@ -44,6 +45,37 @@
  * Private Data
  ****************************************************************************/
 
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+static bool g_host_segv_installed;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+
+/****************************************************************************
+ * Name: host_segv
+ *
+ * Description:
+ *   Report faults on the guarded allocator pool, then restore the default
+ *   action so that returning faults again and terminates the simulation.
+ *
+ ****************************************************************************/
+
+static void host_segv(int signo, siginfo_t *info, void *context)
+{
+  struct sigaction act;
+
+  heapguard_fault(info->si_addr);
+
+  memset(&act, 0, sizeof(act));
+  act.sa_handler = SIG_DFL;
+  sigaction(SIGSEGV, &act, NULL);
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -184,3 +216,36 @@ void *host_realloc(void *oldmem, size_t size)
   mem = host_uninterruptible(realloc, oldmem, size);
   return mem;
 }
+
+/****************************************************************************
+ * Name: up_heapguard_protect
+ *
+ * Description:
+ *   Make a page aligned range of the guarded allocator pool inaccessible,
+ *   or accessible again.  Faults on it are reported by heapguard_fault().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+int up_heapguard_protect(void *addr, size_t size, bool access)
+{
+  struct sigaction act;
+
+  if (!g_host_segv_installed)
+    {
+      memset(&act, 0, sizeof(act));
+      act.sa_sigaction = host_segv;
+      act.sa_flags     = SA_SIGINFO;
+      sigaction(SIGSEGV, &act, NULL);
+      g_host_segv_installed = true;
+    }
+
+  if (host_uninterruptible(mprotect, addr, size,
+                           access ? PROT_READ | PROT_WRITE : PROT_NONE) < 0)
+    {
+      return -errno;
+    }
+
+  return 0;
+}
+#endif
@@ -235,6 +235,10 @@ void host_free(void *mem);
 void *host_realloc(void *oldmem, size_t size);
 int host_unlinkshmem(const char *name);
 
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+void heapguard_fault(void *addr);
+#endif
+
 /* sim_hosttime.c ***********************************************************/
 
 uint64_t host_gettime(bool rtc);
@@ -24,6 +24,10 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+
 #include <nuttx/clk/clk_provider.h>
 #include <nuttx/crypto/crypto.h>
 #include <nuttx/drivers/drivers.h>
@@ -32,6 +36,7 @@
 #include <nuttx/fs/loop.h>
 #include <nuttx/fs/smart.h>
 #include <nuttx/fs/loopmtd.h>
+#include <nuttx/init.h>
 #include <nuttx/input/uinput.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/net/loopback.h>
@@ -63,6 +68,9 @@
 #ifdef CONFIG_DRIVERS_BINDER
 #  include <nuttx/android/binder.h>
 #endif
+#ifdef CONFIG_DRIVERS_INITCALL
+#  include <nuttx/drivers/initcall.h>
+#endif
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -79,6 +87,98 @@
 #  error More than one console driver selected. Check your configuration !
 #endif
 
+/* The bus and subsystem probes at the end of drivers_initialize() go
+ * through initcall_run() when it is available.
+ */
+
+#if defined(CONFIG_DRIVERS_INITCALL) && \
+    ((defined(CONFIG_PCI) && !defined(CONFIG_PCI_LATE_DRIVERS_REGISTER)) || \
+     defined(CONFIG_DRIVERS_VIRTIO) || defined(CONFIG_DRIVERS_VHOST) || \
+     !defined(CONFIG_DEV_OPTEE_NONE) || defined(CONFIG_THERMAL))
+#  define DRIVERS_HAVE_INITCALLS 1
+#endif
+
+#ifdef DRIVERS_HAVE_INITCALLS
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_DRIVERS_VIRTIO
+static int drivers_virtio_init(void);
+#endif
+#ifdef CONFIG_DRIVERS_VHOST
+static int drivers_vhost_init(void);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The virtio and vhost transports may sit on PCI, let the PCI drivers
+ * register first when they are registered here.
+ */
+
+#if defined(CONFIG_PCI) && !defined(CONFIG_PCI_LATE_DRIVERS_REGISTER)
+static FAR const char * const g_drivers_pcideps[] =
+{
+  "pci_register_drivers", NULL
+};
+
+#  define DRIVERS_PCIDEPS g_drivers_pcideps
+#else
+#  define DRIVERS_PCIDEPS NULL
+#endif
+
+static const struct initcall_s g_drivers_initcalls[] =
+{
+#if defined(CONFIG_PCI) && !defined(CONFIG_PCI_LATE_DRIVERS_REGISTER)
+  { "pci_register_drivers", pci_register_drivers, NULL, 0 },
+#endif
+#ifdef CONFIG_DRIVERS_VIRTIO
+  { "drivers_virtio_init", drivers_virtio_init, DRIVERS_PCIDEPS, 0 },
+#endif
+#ifdef CONFIG_DRIVERS_VHOST
+  { "drivers_vhost_init", drivers_vhost_init, DRIVERS_PCIDEPS, 0 },
+#endif
+#ifndef CONFIG_DEV_OPTEE_NONE
+  { "optee_register", optee_register, NULL, 0 },
+#endif
+#ifdef CONFIG_THERMAL
+  { "thermal_init", thermal_init, NULL, 0 },
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_DRIVERS_VIRTIO
+/****************************************************************************
+ * Name: drivers_virtio_init
+ ****************************************************************************/
+
+static int drivers_virtio_init(void)
+{
+  virtio_register_drivers();
+  return OK;
+}
+#endif
+
+#ifdef CONFIG_DRIVERS_VHOST
+/****************************************************************************
+ * Name: drivers_vhost_init
+ ****************************************************************************/
+
+static int drivers_vhost_init(void)
+{
+  vhost_register_drivers();
+  return OK;
+}
+#endif
+
+#endif /* DRIVERS_HAVE_INITCALLS */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -119,6 +219,7 @@ void drivers_early_initialize(void)
 void drivers_initialize(void)
 {
   drivers_trace_begin();
+  nx_boot_begin("drivers_initialize");
 
   /* Register devices */
 
@@ -288,25 +389,30 @@ void drivers_initialize(void)
   binder_initialize();
 #endif
 
-#if defined(CONFIG_PCI) && !defined(CONFIG_PCI_LATE_DRIVERS_REGISTER)
+#ifdef DRIVERS_HAVE_INITCALLS
+  initcall_run(g_drivers_initcalls, nitems(g_drivers_initcalls));
+#else
+#  if defined(CONFIG_PCI) && !defined(CONFIG_PCI_LATE_DRIVERS_REGISTER)
   pci_register_drivers();
-#endif
+#  endif
 
-#ifdef CONFIG_DRIVERS_VIRTIO
+#  ifdef CONFIG_DRIVERS_VIRTIO
   virtio_register_drivers();
-#endif
+#  endif
 
-#ifdef CONFIG_DRIVERS_VHOST
+#  ifdef CONFIG_DRIVERS_VHOST
   vhost_register_drivers();
-#endif
+#  endif
 
-#ifndef CONFIG_DEV_OPTEE_NONE
+#  ifndef CONFIG_DEV_OPTEE_NONE
   optee_register();
-#endif
+#  endif
 
-#ifdef CONFIG_THERMAL
+#  ifdef CONFIG_THERMAL
   thermal_init();
+#  endif
 #endif
 
+  nx_boot_end("drivers_initialize");
   drivers_trace_end();
 }
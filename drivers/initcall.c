@@ -0,0 +1,525 @@
+/****************************************************************************
+ * drivers/initcall.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/param.h>
+
+#include <errno.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/init.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/kthread.h>
+#include <nuttx/mutex.h>
+#include <nuttx/sched.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/drivers/initcall.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define INITCALL_WAITING   0  /* Not started yet */
+#define INITCALL_RUNNING   1  /* Running in some worker */
+#define INITCALL_DONE      2  /* Returned OK */
+#define INITCALL_FAILED    3  /* Returned an error or was skipped */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct initcall_state_s
+{
+  FAR const struct initcall_s *calls;  /* The table being run */
+  size_t          ncalls;              /* Number of entries in the table */
+  FAR uint8_t    *status;              /* INITCALL_* of each entry */
+  mutex_t         lock;                /* Protects the fields below */
+  sem_t           wake;                /* Posted when an initcall finishes */
+  sem_t           exit;                /* Posted when a helper exits */
+  int             nwaiters;            /* Number of workers waiting on wake */
+  size_t          pending;             /* Unfinished entries of the level */
+  int             nfailed;             /* Failed or skipped entries */
+  uint8_t         level;               /* The level being run */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: initcall_find
+ ****************************************************************************/
+
+static int initcall_find(FAR const struct initcall_s *calls, size_t ncalls,
+                         FAR const char *name)
+{
+  size_t i;
+
+  for (i = 0; i < ncalls; i++)
+    {
+      if (strcmp(calls[i].name, name) == 0)
+        {
+          return i;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: initcall_check
+ *
+ * Description:
+ *   Validate the table before anything runs: a dependency may not point to
+ *   a later level and the dependencies may not form a cycle.  The status
+ *   array is used as scratch and left cleared.
+ *
+ ****************************************************************************/
+
+static int initcall_check(FAR const struct initcall_s *calls, size_t ncalls,
+                          FAR uint8_t *status)
+{
+  FAR const char * const *dep;
+  size_t nresolved = 0;
+  bool progress = true;
+  size_t i;
+  int j;
+
+  for (i = 0; i < ncalls; i++)
+    {
+      for (dep = calls[i].depends; dep != NULL && *dep != NULL; dep++)
+        {
+          j = initcall_find(calls, ncalls, *dep);
+          if (j < 0)
+            {
+              swarn("WARNING: %s depends on unknown %s\n",
+                    calls[i].name, *dep);
+            }
+          else if (calls[j].level > calls[i].level)
+            {
+              serr("ERROR: %s depends on %s of a later level\n",
+                   calls[i].name, *dep);
+              return -EINVAL;
+            }
+        }
+    }
+
+  /* Resolve the entries whose dependencies are all resolved until nothing
+   * changes, whatever is left is part of a cycle.
+   */
+
+  while (progress && nresolved < ncalls)
+    {
+      progress = false;
+      for (i = 0; i < ncalls; i++)
+        {
+          if (status[i])
+            {
+              continue;
+            }
+
+          for (dep = calls[i].depends; dep != NULL && *dep != NULL; dep++)
+            {
+              j = initcall_find(calls, ncalls, *dep);
+              if (j >= 0 && !status[j])
+                {
+                  break;
+                }
+            }
+
+          if (dep == NULL || *dep == NULL)
+            {
+              status[i] = 1;
+              nresolved++;
+              progress  = true;
+            }
+        }
+    }
+
+  for (i = 0; i < ncalls; i++)
+    {
+      if (nresolved < ncalls && !status[i])
+        {
+          serr("ERROR: %s is part of a dependency cycle\n", calls[i].name);
+        }
+
+      status[i] = INITCALL_WAITING;
+    }
+
+  return nresolved < ncalls ? -EINVAL : OK;
+}
+
+/****************************************************************************
+ * Name: initcall_wakeup
+ *
+ * Description:
+ *   Wake up all the workers waiting for an initcall to finish.  Called
+ *   with the lock held.
+ *
+ ****************************************************************************/
+
+static void initcall_wakeup(FAR struct initcall_state_s *state)
+{
+  while (state->nwaiters > 0)
+    {
+      state->nwaiters--;
+      nxsem_post(&state->wake);
+    }
+}
+
+/****************************************************************************
+ * Name: initcall_pick
+ *
+ * Description:
+ *   Find an entry of the current level which can start now.  Entries that
+ *   depend on a failed entry are marked as failed on the way.  Called with
+ *   the lock held.
+ *
+ ****************************************************************************/
+
+static int initcall_pick(FAR struct initcall_state_s *state)
+{
+  FAR const struct initcall_s *calls = state->calls;
+  FAR const char * const *dep;
+  bool rescan = true;
+  bool failed;
+  size_t i;
+  int j;
+
+  while (rescan)
+    {
+      rescan = false;
+      for (i = 0; i < state->ncalls; i++)
+        {
+          if (calls[i].level != state->level ||
+              state->status[i] != INITCALL_WAITING)
+            {
+              continue;
+            }
+
+          failed = false;
+          for (dep = calls[i].depends; dep != NULL && *dep != NULL; dep++)
+            {
+              j = initcall_find(calls, state->ncalls, *dep);
+              if (j < 0)
+                {
+                  continue;
+                }
+              else if (state->status[j] == INITCALL_FAILED)
+                {
+                  failed = true;
+                }
+              else if (state->status[j] != INITCALL_DONE)
+                {
+                  break;
+                }
+            }
+
+          if (dep != NULL && *dep != NULL)
+            {
+              continue;
+            }
+
+          if (!failed)
+            {
+              state->status[i] = INITCALL_RUNNING;
+              return i;
+            }
+
+          swarn("WARNING: Skip %s, a dependency failed\n", calls[i].name);
+          state->status[i] = INITCALL_FAILED;
+          state->nfailed++;
+          state->pending--;
+
+          initcall_wakeup(state);
+
+          /* Skipping may unblock entries seen earlier in this pass */
+
+          rescan = true;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: initcall_call
+ ****************************************************************************/
+
+static int initcall_call(FAR const struct initcall_s *call)
+{
+#ifdef CONFIG_DRIVERS_INITCALL_REPORT
+  struct timespec ts;
+  clock_t start;
+  int ret;
+
+  start = perf_gettime();
+  ret = call->func();
+  perf_convert(perf_gettime() - start, &ts);
+
+  syslog(LOG_INFO, "initcall: %-24s level %u ret %4d %6lu.%06lu ms\n",
+         call->name, call->level, ret, (unsigned long)(ts.tv_sec * 1000 +
+         ts.tv_nsec / 1000000), (unsigned long)(ts.tv_nsec % 1000000));
+  return ret;
+#else
+  return call->func();
+#endif
+}
+
+/****************************************************************************
+ * Name: initcall_worker
+ *
+ * Description:
+ *   Run the entries of the current level until all of them are finished.
+ *   Executed by the caller of initcall_run() and by the helper threads.
+ *
+ ****************************************************************************/
+
+static void initcall_worker(FAR struct initcall_state_s *state)
+{
+  int ret;
+  int i;
+
+  nxmutex_lock(&state->lock);
+  while (state->pending > 0)
+    {
+      i = initcall_pick(state);
+      if (i < 0)
+        {
+          /* Wait for the running entries to unblock the rest */
+
+          state->nwaiters++;
+          nxmutex_unlock(&state->lock);
+          nxsem_wait_uninterruptible(&state->wake);
+          nxmutex_lock(&state->lock);
+          continue;
+        }
+
+      nxmutex_unlock(&state->lock);
+      ret = initcall_call(&state->calls[i]);
+      nxmutex_lock(&state->lock);
+
+      if (ret < 0)
+        {
+          serr("ERROR: %s failed: %d\n", state->calls[i].name, ret);
+          state->status[i] = INITCALL_FAILED;
+          state->nfailed++;
+        }
+      else
+        {
+          state->status[i] = INITCALL_DONE;
+        }
+
+      state->pending--;
+      initcall_wakeup(state);
+    }
+
+  nxmutex_unlock(&state->lock);
+}
+
+#if CONFIG_DRIVERS_INITCALL_NTHREADS > 1
+/****************************************************************************
+ * Name: initcall_thread
+ ****************************************************************************/
+
+static int initcall_thread(int argc, FAR char *argv[])
+{
+  FAR struct initcall_state_s *state =
+    (FAR struct initcall_state_s *)((uintptr_t)strtoul(argv[1], NULL, 0));
+
+  initcall_worker(state);
+
+  /* The state lives on the stack of initcall_run(), don't touch it after
+   * this post.
+   */
+
+  nxsem_post(&state->exit);
+  return 0;
+}
+
+/****************************************************************************
+ * Name: initcall_spawn
+ *
+ * Description:
+ *   Start the helper threads for the current level, the caller itself is
+ *   the last worker.
+ *
+ * Returned Value:
+ *   The number of helper threads started.
+ *
+ ****************************************************************************/
+
+static int initcall_spawn(FAR struct initcall_state_s *state)
+{
+  struct sched_param param;
+  FAR char *argv[2];
+  char arg[32];
+  int nthreads;
+  int ret;
+  int i;
+
+  /* The idle thread may not wait for the helpers */
+
+  if (!OSINIT_OS_READY() || sched_idletask())
+    {
+      return 0;
+    }
+
+  /* The helpers run at the priority of the caller */
+
+  nxsched_get_param(0, &param);
+  nthreads = MIN(state->pending, CONFIG_DRIVERS_INITCALL_NTHREADS) - 1;
+
+  snprintf(arg, sizeof(arg), "%p", state);
+  argv[0] = arg;
+  argv[1] = NULL;
+
+  for (i = 0; i < nthreads; i++)
+    {
+      ret = kthread_create("initcall", param.sched_priority,
+                           CONFIG_DRIVERS_INITCALL_STACKSIZE,
+                           initcall_thread, argv);
+      if (ret < 0)
+        {
+          swarn("WARNING: Failed to start an initcall thread: %d\n", ret);
+          break;
+        }
+    }
+
+  return i;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: initcall_run
+ *
+ * Description:
+ *   Run a table of initcalls, level by level, honoring the dependencies.
+ *   Once the OS is ready, up to CONFIG_DRIVERS_INITCALL_NTHREADS
+ *   initcalls run concurrently; before that they run one by one in the
+ *   calling thread.  The dependents of a failed initcall are skipped.
+ *
+ * Input Parameters:
+ *   calls  - The table of initcalls
+ *   ncalls - Number of entries in the table
+ *
+ * Returned Value:
+ *   The number of initcalls that failed or were skipped, or a negated
+ *   errno if the table is not valid.
+ *
+ ****************************************************************************/
+
+int initcall_run(FAR const struct initcall_s *calls, size_t ncalls)
+{
+  struct initcall_state_s state;
+  int next = 0;
+  int ret;
+  size_t i;
+
+  if (ncalls == 0)
+    {
+      return 0;
+    }
+
+  memset(&state, 0, sizeof(state));
+  state.calls  = calls;
+  state.ncalls = ncalls;
+  state.status = kmm_zalloc(ncalls);
+  if (state.status == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ret = initcall_check(calls, ncalls, state.status);
+  if (ret < 0)
+    {
+      goto out;
+    }
+
+  nxmutex_init(&state.lock);
+  nxsem_init(&state.wake, 0, 0);
+  nxsem_init(&state.exit, 0, 0);
+
+  /* Run the levels in ascending order, next is the lowest level not run
+   * yet.
+   */
+
+  while (next >= 0)
+    {
+      state.level   = next;
+      state.pending = 0;
+      next          = -1;
+
+      for (i = 0; i < ncalls; i++)
+        {
+          if (calls[i].level == state.level)
+            {
+              state.pending++;
+            }
+          else if (calls[i].level > state.level &&
+                   (next < 0 || calls[i].level < next))
+            {
+              next = calls[i].level;
+            }
+        }
+
+      if (state.pending > 0)
+        {
+#if CONFIG_DRIVERS_INITCALL_NTHREADS > 1
+          int nthreads = initcall_spawn(&state);
+
+          initcall_worker(&state);
+          while (nthreads-- > 0)
+            {
+              nxsem_wait_uninterruptible(&state.exit);
+            }
+#else
+          initcall_worker(&state);
+#endif
+        }
+    }
+
+  nxsem_destroy(&state.exit);
+  nxsem_destroy(&state.wake);
+  nxmutex_destroy(&state.lock);
+  ret = state.nfailed;
+
+out:
+  kmm_free(state.status);
+  return ret;
+}
@@ -41,6 +41,8 @@
 #include <nuttx/mtd/smart.h>
 #include <nuttx/mutex.h>
 #include <nuttx/mmcsd.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/queue.h>
 #include <nuttx/rpmsg/rpmsg.h>
 
 #include "rpmsgblk.h"
@@ -62,6 +64,10 @@ struct rpmsgblk_s
   mutex_t                 lock;        /* Lock for thread-safe */
   struct geometry         geo;         /* block geomerty */
   int                     refs;        /* refence count */
+  uint32_t                features;    /* Features agreed with the server */
+  mutex_t                 xfer_lock;   /* Lock for xfers and gone */
+  dq_queue_t              xfers;       /* Read/write transfers in progress */
+  bool                    gone;        /* The endpoint is torn down */
 };
 
 /* Rpmsg device cookie used to handle the response from the remote cpu */
@@ -73,6 +79,20 @@ struct rpmsgblk_cookie_s
   FAR void *data;    /* The return data buffer of the remote call */
 };
 
+/* Cookie shared by all chunks of one block read or write, every completed
+ * chunk posts the semaphore once.
+ */
+
+struct rpmsgblk_xfer_s
+{
+  struct rpmsgblk_cookie_s cookie;
+  dq_entry_t               node;       /* Entry in rpmsgblk_s::xfers */
+  blkcnt_t                 start;      /* First sector of the transfer */
+  uint32_t                 sectorsize; /* Sector size of the transfer */
+  size_t                   nsectors;   /* Sectors completed so far */
+  bool                     cancelled;  /* No more chunk will complete */
+};
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -104,15 +124,29 @@ static int     rpmsgblk_send_recv(FAR struct rpmsgblk_s *priv,
                                   int len, FAR void *data);
 static FAR void *rpmsgblk_get_tx_payload_buffer(FAR struct rpmsgblk_s *priv,
                                                 FAR uint32_t *len);
+static int     rpmsgblk_xfer_begin(FAR struct rpmsgblk_s *priv,
+                                   FAR struct rpmsgblk_xfer_s *xfer);
+static void    rpmsgblk_xfer_end(FAR struct rpmsgblk_s *priv,
+                                 FAR struct rpmsgblk_xfer_s *xfer);
+static int     rpmsgblk_xfer_wait(FAR struct rpmsgblk_s *priv,
+                                  FAR struct rpmsgblk_xfer_s *xfer,
+                                  FAR unsigned int *inflight,
+                                  unsigned int depth);
 
 /* Functions handle the responses from the remote cpu */
 
 static int     rpmsgblk_default_handler(FAR struct rpmsg_endpoint *ept,
                                         FAR void *data, size_t len,
                                         uint32_t src, FAR void *priv);
+static int     rpmsgblk_open_handler(FAR struct rpmsg_endpoint *ept,
+                                     FAR void *data, size_t len,
+                                     uint32_t src, FAR void *priv);
 static int     rpmsgblk_read_handler(FAR struct rpmsg_endpoint *ept,
                                      FAR void *data, size_t len,
                                      uint32_t src, FAR void *priv);
+static int     rpmsgblk_write_handler(FAR struct rpmsg_endpoint *ept,
+                                      FAR void *data, size_t len,
+                                      uint32_t src, FAR void *priv);
 static int     rpmsgblk_geometry_handler(FAR struct rpmsg_endpoint *ept,
                                          FAR void *data, size_t len,
                                          uint32_t src, FAR void *priv);
@@ -130,6 +164,8 @@ static int     rpmsgblk_ept_cb(FAR struct rpmsg_endpoint *ept,
                                FAR void *data, size_t len, uint32_t src,
                                FAR void *priv);
 static void    rpmsgblk_ns_bound(struct rpmsg_endpoint *ept);
+static void    rpmsgblk_ept_release(FAR struct rpmsg_endpoint *ept);
+static void    rpmsgblk_teardown(FAR struct rpmsgblk_s *priv);
 
 /****************************************************************************
  * Private Data
@@ -139,10 +175,10 @@ static void    rpmsgblk_ns_bound(struct rpmsg_endpoint *ept);
 
 static const rpmsg_ept_cb g_rpmsgblk_handler[] =
 {
-  [RPMSGBLK_OPEN]     = rpmsgblk_default_handler,
+  [RPMSGBLK_OPEN]     = rpmsgblk_open_handler,
   [RPMSGBLK_CLOSE]    = rpmsgblk_default_handler,
   [RPMSGBLK_READ]     = rpmsgblk_read_handler,
-  [RPMSGBLK_WRITE]    = rpmsgblk_default_handler,
+  [RPMSGBLK_WRITE]    = rpmsgblk_write_handler,
   [RPMSGBLK_GEOMETRY] = rpmsgblk_geometry_handler,
   [RPMSGBLK_IOCTL]    = rpmsgblk_ioctl_handler,
 };
@@ -186,8 +222,11 @@ static int rpmsgblk_open(FAR struct inode *inode)
 
   if (priv->refs++ == 0)
     {
-      /* Try to open the block device in the remote cpu */
+      /* Try to open the block device in the remote cpu, and agree on the
+       * features both sides understand.
+       */
 
+      msg.features = RPMSGBLK_FEATURES;
       ret = rpmsgblk_send_recv(priv, RPMSGBLK_OPEN, true, &msg.header,
                                sizeof(msg), NULL);
       if (ret < 0)
@@ -269,7 +308,10 @@ static ssize_t rpmsgblk_read(FAR struct inode *inode,
 {
   FAR struct rpmsgblk_s *priv = inode->i_private;
   struct rpmsgblk_read_s msg;
-  struct iovec iov;
+  struct rpmsgblk_xfer_s xfer;
+  unsigned int inflight = 0;
+  size_t requested = 0;
+  size_t chunk;
   int ret;
 
   if (buffer == NULL)
@@ -288,19 +330,77 @@ static ssize_t rpmsgblk_read(FAR struct inode *inode,
       return ret;
     }
 
-  /* In block read, iov_len represent the received block number */
+  memset(&xfer, 0, sizeof(xfer));
+  nxsem_init(&xfer.cookie.sem, 0, 0);
+  xfer.cookie.data = buffer;
+  xfer.start       = start_sector;
+  xfer.sectorsize  = priv->geo.geo_sectorsize;
+
+  ret = rpmsgblk_xfer_begin(priv, &xfer);
+  if (ret < 0)
+    {
+      nxsem_destroy(&xfer.cookie.sem);
+      return ret;
+    }
+
+  /* Split the read into chunks that fit in one response buffer, and keep
+   * up to CONFIG_BLK_RPMSG_QUEUE_DEPTH of them outstanding.  A legacy
+   * server gets the whole read as one request.
+   */
+
+  if (priv->features & RPMSGBLK_FEATURE_XFER)
+    {
+      chunk = (rpmsg_get_tx_buffer_size(&priv->ept) - sizeof(msg) + 1) /
+              xfer.sectorsize;
+      if (chunk == 0)
+        {
+          chunk = 1;
+        }
+    }
+  else
+    {
+      chunk = nsectors;
+    }
+
+  while (requested < nsectors)
+    {
+      ret = rpmsgblk_xfer_wait(priv, &xfer, &inflight,
+                               CONFIG_BLK_RPMSG_QUEUE_DEPTH - 1);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      msg.header.command = RPMSGBLK_READ;
+      msg.header.result  = -ENXIO;
+      msg.header.cookie  = (uintptr_t)&xfer;
+      msg.startsector    = start_sector + requested;
+      msg.nsectors       = MIN(chunk, nsectors - requested);
+      msg.sectorsize     = xfer.sectorsize;
+      msg.last           = 0;
 
-  iov.iov_base = buffer;
-  iov.iov_len  = 0;
+      ret = rpmsg_send(&priv->ept, &msg, sizeof(msg) - 1);
+      if (ret < 0)
+        {
+          break;
+        }
+
+      requested += msg.nsectors;
+      inflight++;
+    }
 
-  msg.startsector = start_sector;
-  msg.nsectors    = nsectors;
-  msg.sectorsize  = priv->geo.geo_sectorsize;
+  /* Wait for all the outstanding chunks, the cookie lives on our stack */
 
-  ret = rpmsgblk_send_recv(priv, RPMSGBLK_READ, true, &msg.header,
-                           sizeof(msg) - 1, &iov);
+  rpmsgblk_xfer_wait(priv, &xfer, &inflight, 0);
+  rpmsgblk_xfer_end(priv, &xfer);
+  nxsem_destroy(&xfer.cookie.sem);
 
-  return ret < 0 ? ret : iov.iov_len;
+  if (ret >= 0)
+    {
+      ret = xfer.cookie.result;
+    }
+
+  return ret < 0 ? ret : xfer.nsectors;
 }
 
 /****************************************************************************
@@ -329,7 +429,8 @@ static ssize_t rpmsgblk_write(FAR struct inode *inode,
 {
   FAR struct rpmsgblk_s *priv = inode->i_private;
   FAR struct rpmsgblk_write_s *msg;
-  struct rpmsgblk_cookie_s cookie;
+  struct rpmsgblk_xfer_s xfer;
+  unsigned int inflight = 0;
   uint32_t sectorsize;
   uint32_t space;
   size_t written = 0;
@@ -351,42 +452,59 @@ static ssize_t rpmsgblk_write(FAR struct inode *inode,
       return ret;
     }
 
-  /* Perform the rpmsg write */
+  /* Perform the rpmsg write, every chunk is acked so that a failure in
+   * any of them is reported, up to CONFIG_BLK_RPMSG_QUEUE_DEPTH chunks
+   * are outstanding at the same time.  A legacy server acks only the
+   * chunk that carries the cookie, so it goes on the final chunk only.
+   */
 
-  memset(&cookie, 0, sizeof(cookie));
-  nxsem_init(&cookie.sem, 0, 0);
+  memset(&xfer, 0, sizeof(xfer));
+  nxsem_init(&xfer.cookie.sem, 0, 0);
+
+  ret = rpmsgblk_xfer_begin(priv, &xfer);
+  if (ret < 0)
+    {
+      nxsem_destroy(&xfer.cookie.sem);
+      return ret;
+    }
 
   sectorsize = priv->geo.geo_sectorsize;
   while (written < nsectors)
     {
+      ret = rpmsgblk_xfer_wait(priv, &xfer, &inflight,
+                               CONFIG_BLK_RPMSG_QUEUE_DEPTH - 1);
+      if (ret < 0)
+        {
+          break;
+        }
+
       msg = rpmsgblk_get_tx_payload_buffer(priv, &space);
       if (msg == NULL)
         {
           ret = -ENOMEM;
-          goto out;
+          break;
         }
 
       DEBUGASSERT(sizeof(*msg) - 1 + sectorsize <= space);
 
       msg->nsectors = (space - sizeof(*msg) + 1) / sectorsize;
-      if (msg->nsectors >= nsectors - written)
+      if (msg->nsectors > nsectors - written)
         {
-          /* Send complete, set cookie is valid, need ack */
-
           msg->nsectors = nsectors - written;
-          msg->header.cookie = (uintptr_t)&cookie;
-        }
-      else
-        {
-          /* Not send complete, set cookie invalid, do not need ack */
-
-          msg->header.cookie = 0;
         }
 
       msg->header.command = RPMSGBLK_WRITE;
       msg->header.result  = -ENXIO;
+      msg->header.cookie  = 0;
+      if ((priv->features & RPMSGBLK_FEATURE_XFER) ||
+          msg->nsectors == nsectors - written)
+        {
+          msg->header.cookie = (uintptr_t)&xfer;
+        }
+
       msg->startsector    = start_sector;
       msg->sectorsize     = sectorsize;
+      msg->last           = 0;
       memcpy(msg->buf, buffer, msg->nsectors * sectorsize);
 
       buffer       += msg->nsectors * sectorsize;
@@ -398,21 +516,30 @@ static ssize_t rpmsgblk_write(FAR struct inode *inode,
       if (ret < 0)
         {
           rpmsg_release_tx_buffer(&priv->ept, msg);
-          goto out;
+          break;
+        }
+
+      if (msg->header.cookie != 0)
+        {
+          inflight++;
         }
     }
 
-  ret = rpmsg_wait(&priv->ept, &cookie.sem);
-  if (ret < 0)
+  rpmsgblk_xfer_wait(priv, &xfer, &inflight, 0);
+  rpmsgblk_xfer_end(priv, &xfer);
+  nxsem_destroy(&xfer.cookie.sem);
+
+  if (ret >= 0)
     {
-      goto out;
+      ret = xfer.cookie.result;
     }
 
-  ret = cookie.result;
+  if (ret < 0)
+    {
+      return ret;
+    }
 
-out:
-  nxsem_destroy(&cookie.sem);
-  return ret < 0 ? ret : nsectors;
+  return (priv->features & RPMSGBLK_FEATURE_XFER) ? xfer.nsectors : nsectors;
 }
 
 /****************************************************************************
@@ -803,6 +930,125 @@ static FAR void *rpmsgblk_get_tx_payload_buffer(FAR struct rpmsgblk_s *priv,
   return rpmsg_get_tx_payload_buffer(&priv->ept, len, true);
 }
 
+/****************************************************************************
+ * Name: rpmsgblk_xfer_begin
+ *
+ * Description:
+ *   Make a read or write transfer known to the endpoint teardown, which
+ *   cancels the transfer if the chunks still outstanding will never
+ *   complete.
+ *
+ * Parameters:
+ *   priv - The rpmsg-blk handle
+ *   xfer - The transfer cookie
+ *
+ * Returned Values:
+ *   OK on success; -ENOTCONN if the endpoint is already torn down.
+ *
+ ****************************************************************************/
+
+static int rpmsgblk_xfer_begin(FAR struct rpmsgblk_s *priv,
+                               FAR struct rpmsgblk_xfer_s *xfer)
+{
+  int ret = -ENOTCONN;
+
+  nxmutex_lock(&priv->xfer_lock);
+  if (!priv->gone)
+    {
+      dq_addlast(&xfer->node, &priv->xfers);
+      ret = OK;
+    }
+
+  nxmutex_unlock(&priv->xfer_lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: rpmsgblk_xfer_end
+ *
+ * Description:
+ *   Forget a transfer registered by rpmsgblk_xfer_begin(), no chunk of it
+ *   may be outstanding any more.
+ *
+ * Parameters:
+ *   priv - The rpmsg-blk handle
+ *   xfer - The transfer cookie
+ *
+ ****************************************************************************/
+
+static void rpmsgblk_xfer_end(FAR struct rpmsgblk_s *priv,
+                              FAR struct rpmsgblk_xfer_s *xfer)
+{
+  nxmutex_lock(&priv->xfer_lock);
+  dq_rem(&xfer->node, &priv->xfers);
+  nxmutex_unlock(&priv->xfer_lock);
+}
+
+/****************************************************************************
+ * Name: rpmsgblk_xfer_wait
+ *
+ * Description:
+ *   Wait until no more than depth chunks of a read or write transfer are
+ *   outstanding at the remote side.
+ *
+ * Parameters:
+ *   priv     - The rpmsg-blk handle
+ *   xfer     - The transfer cookie
+ *   inflight - The number of outstanding chunks, updated on return
+ *   depth    - The number of outstanding chunks allowed on return
+ *
+ * Returned Values:
+ *   OK if the transfer may continue; the first error reported by the
+ *   remote, the failed wait or -ENOTCONN if the endpoint was torn down
+ *   otherwise.
+ *
+ ****************************************************************************/
+
+static int rpmsgblk_xfer_wait(FAR struct rpmsgblk_s *priv,
+                              FAR struct rpmsgblk_xfer_s *xfer,
+                              FAR unsigned int *inflight,
+                              unsigned int depth)
+{
+  int ret;
+
+  while (*inflight > depth && !xfer->cancelled)
+    {
+      ret = rpmsg_wait(&priv->ept, &xfer->cookie.sem);
+      if (ret >= 0)
+        {
+          (*inflight)--;
+          continue;
+        }
+
+      /* A failed wait (e.g. -ECANCELED) fails again at once, but the
+       * remote may still complete the outstanding chunks into the cookie
+       * on our stack.  Take the endpoint down as if the remote was gone
+       * and sleep until the teardown has cancelled the transfer.
+       */
+
+      ferr("ERROR: wait failed, ret=%d\n", ret);
+      rpmsgblk_teardown(priv);
+
+      nxmutex_lock(&priv->xfer_lock);
+      while (!xfer->cancelled)
+        {
+          nxmutex_unlock(&priv->xfer_lock);
+          nxsem_wait_uninterruptible(&xfer->cookie.sem);
+          nxmutex_lock(&priv->xfer_lock);
+        }
+
+      xfer->cookie.result = ret;
+      nxmutex_unlock(&priv->xfer_lock);
+    }
+
+  if (xfer->cancelled)
+    {
+      *inflight = 0;
+    }
+
+  return xfer->cookie.result < 0 ? xfer->cookie.result : OK;
+}
+
 /****************************************************************************
  * Name: rpmsgblk_send_recv
  *
@@ -886,8 +1132,7 @@ fail:
  *
  * Description:
  *   Default rpmsg-blk response handler, this function will be called to
- *   process the return message of rpmsgblk_open(), rpmsgblk_close() and
- *   rpmsgblk_write().
+ *   process the return message of rpmsgblk_open() and rpmsgblk_close().
  *
  * Parameters:
  *   ept  - The rpmsg endpoint
@@ -918,6 +1163,42 @@ static int rpmsgblk_default_handler(FAR struct rpmsg_endpoint *ept,
   return rpmsg_post(ept, &cookie->sem);
 }
 
+/****************************************************************************
+ * Name: rpmsgblk_open_handler
+ *
+ * Description:
+ *   Rpmsg-blk open response handler, record the features the server
+ *   agreed to.  A legacy server echoes only the header and gets none.
+ *
+ * Parameters:
+ *   ept  - The rpmsg endpoint
+ *   data - The return message
+ *   len  - The return message length
+ *   src  - unknow
+ *   priv - unknow
+ *
+ * Returned Values:
+ *   Always OK
+ *
+ ****************************************************************************/
+
+static int rpmsgblk_open_handler(FAR struct rpmsg_endpoint *ept,
+                                 FAR void *data, size_t len,
+                                 uint32_t src, FAR void *priv)
+{
+  FAR struct rpmsgblk_s *rpmsgblk = ept->priv;
+  FAR struct rpmsgblk_open_s *rsp = data;
+
+  rpmsgblk->features = 0;
+  if (len >= sizeof(*rsp))
+    {
+      rpmsgblk->features = rsp->features & RPMSGBLK_FEATURES;
+    }
+
+  return rpmsgblk_default_handler(ept, data, MIN(len, sizeof(*rsp)),
+                                  src, priv);
+}
+
 /****************************************************************************
  * Name: rpmsgblk_read_handler
  *
@@ -941,30 +1222,86 @@ static int rpmsgblk_read_handler(FAR struct rpmsg_endpoint *ept,
                                  FAR void *data, size_t len,
                                  uint32_t src, FAR void *priv)
 {
+  FAR struct rpmsgblk_s *rpmsgblk = ept->priv;
   FAR struct rpmsgblk_header_s *header = data;
-  FAR struct rpmsgblk_cookie_s *cookie =
-      (FAR struct rpmsgblk_cookie_s *)(uintptr_t)header->cookie;
+  FAR struct rpmsgblk_xfer_s *xfer =
+      (FAR struct rpmsgblk_xfer_s *)(uintptr_t)header->cookie;
   FAR struct rpmsgblk_read_s *rsp = data;
-  FAR struct iovec *iov = cookie->data;
-  size_t read;
+  bool chunked = (rpmsgblk->features & RPMSGBLK_FEATURE_XFER) != 0;
+  size_t offset;
 
-  cookie->result = header->result;
-  if (cookie->result > 0)
+  if (header->result > 0)
+    {
+      /* Chunked responses may arrive in any order, place them by sector.
+       * A legacy server answers one request in order and the range in
+       * the response is not reliable.
+       */
+
+      offset = chunked ? rsp->startsector - xfer->start : xfer->nsectors;
+      memcpy((FAR char *)xfer->cookie.data + offset * xfer->sectorsize,
+             rsp->buf, header->result * rsp->sectorsize);
+      xfer->nsectors += header->result;
+    }
+  else if (header->result < 0 && xfer->cookie.result >= 0)
     {
-      read = cookie->result * rsp->sectorsize;
-      memcpy(iov->iov_base, rsp->buf, read);
-      iov->iov_base += read;
-      iov->iov_len  += cookie->result;
+      xfer->cookie.result = header->result;
     }
 
-  if (cookie->result <= 0 || iov->iov_len >= rsp->nsectors)
+  if (chunked ? rsp->last != 0 :
+      header->result <= 0 || xfer->nsectors >= rsp->nsectors)
     {
-      return rpmsg_post(ept, &cookie->sem);
+      return rpmsg_post(ept, &xfer->cookie.sem);
     }
 
   return 0;
 }
 
+/****************************************************************************
+ * Name: rpmsgblk_write_handler
+ *
+ * Description:
+ *   Rpmsg-blk block write response handler, this function will be called
+ *   once for each chunk sent by rpmsgblk_write().
+ *
+ * Parameters:
+ *   ept  - The rpmsg endpoint
+ *   data - The return message
+ *   len  - The return message length
+ *   src  - unknow
+ *   priv - unknow
+ *
+ * Returned Values:
+ *   Always OK
+ *
+ ****************************************************************************/
+
+static int rpmsgblk_write_handler(FAR struct rpmsg_endpoint *ept,
+                                  FAR void *data, size_t len,
+                                  uint32_t src, FAR void *priv)
+{
+  FAR struct rpmsgblk_header_s *header = data;
+  FAR struct rpmsgblk_xfer_s *xfer =
+      (FAR struct rpmsgblk_xfer_s *)(uintptr_t)header->cookie;
+
+  /* A server error on an unacked legacy chunk carries no cookie */
+
+  if (xfer == NULL)
+    {
+      return 0;
+    }
+
+  if (header->result > 0)
+    {
+      xfer->nsectors += header->result;
+    }
+  else if (header->result < 0 && xfer->cookie.result >= 0)
+    {
+      xfer->cookie.result = header->result;
+    }
+
+  return rpmsg_post(ept, &xfer->cookie.sem);
+}
+
 /****************************************************************************
  * Name: rpmsgblk_geometry_handler
  *
@@ -1124,6 +1461,77 @@ static void rpmsgblk_ns_bound(FAR struct rpmsg_endpoint *ept)
   rpmsg_post(&priv->ept, &priv->wait);
 }
 
+/****************************************************************************
+ * Name: rpmsgblk_ept_release
+ *
+ * Description:
+ *   Called once the endpoint is destroyed and no response handler runs
+ *   any more, cancel the read/write transfers that are still waiting for
+ *   the remote.
+ *
+ * Parameters:
+ *   ept - The rpmsg-blk end point
+ *
+ * Returned Values:
+ *   None
+ *
+ ****************************************************************************/
+
+static void rpmsgblk_ept_release(FAR struct rpmsg_endpoint *ept)
+{
+  FAR struct rpmsgblk_s *priv = ept->priv;
+  FAR struct rpmsgblk_xfer_s *xfer;
+  FAR dq_entry_t *node;
+
+  nxmutex_lock(&priv->xfer_lock);
+  priv->gone = true;
+  dq_for_every(&priv->xfers, node)
+    {
+      xfer = container_of(node, struct rpmsgblk_xfer_s, node);
+      if (!xfer->cancelled)
+        {
+          if (xfer->cookie.result >= 0)
+            {
+              xfer->cookie.result = -ENOTCONN;
+            }
+
+          xfer->cancelled = true;
+          nxsem_post(&xfer->cookie.sem);
+        }
+    }
+
+  nxmutex_unlock(&priv->xfer_lock);
+}
+
+/****************************************************************************
+ * Name: rpmsgblk_teardown
+ *
+ * Description:
+ *   Destroy the endpoint unless it is already torn down.
+ *
+ * Parameters:
+ *   priv - The rpmsg-blk handle
+ *
+ * Returned Values:
+ *   None
+ *
+ ****************************************************************************/
+
+static void rpmsgblk_teardown(FAR struct rpmsgblk_s *priv)
+{
+  bool gone;
+
+  nxmutex_lock(&priv->xfer_lock);
+  gone = priv->gone;
+  priv->gone = true;
+  nxmutex_unlock(&priv->xfer_lock);
+
+  if (!gone)
+    {
+      rpmsg_destroy_ept(&priv->ept);
+    }
+}
+
 /****************************************************************************
  * Name: rpmsgblk_device_created
  *
@@ -1148,8 +1556,13 @@ static void rpmsgblk_device_created(FAR struct rpmsg_device *rdev,
 
   if (strcmp(priv->remotecpu, rpmsg_get_cpuname(rdev)) == 0)
     {
+      nxmutex_lock(&priv->xfer_lock);
+      priv->gone = false;
+      nxmutex_unlock(&priv->xfer_lock);
+
       priv->ept.priv = priv;
       priv->ept.ns_bound_cb = rpmsgblk_ns_bound;
+      priv->ept.release_cb = rpmsgblk_ept_release;
       snprintf(buf, sizeof(buf), "%s%s", RPMSGBLK_NAME_PREFIX,
                priv->remotepath);
       rpmsg_create_ept(&priv->ept, rdev, buf,
@@ -1181,7 +1594,7 @@ static void rpmsgblk_device_destroy(FAR struct rpmsg_device *rdev,
 
   if (strcmp(priv->remotecpu, rpmsg_get_cpuname(rdev)) == 0)
     {
-      rpmsg_destroy_ept(&priv->ept);
+      rpmsgblk_teardown(priv);
     }
 }
 
@@ -1286,6 +1699,8 @@ int rpmsgblk_register(FAR const char *remotecpu, FAR const char *remotepath,
 
   nxsem_init(&dev->wait, 0, 0);
   nxmutex_init(&dev->lock);
+  nxmutex_init(&dev->xfer_lock);
+  dev->gone = true;
 
   /* Register the rpmsg callback */
 
@@ -1326,6 +1741,7 @@ fail_with_rpmsg:
 fail:
   nxsem_destroy(&dev->wait);
   nxmutex_destroy(&dev->lock);
+  nxmutex_destroy(&dev->xfer_lock);
   kmm_free(dev);
   return ret;
 }
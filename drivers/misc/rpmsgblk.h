@@ -46,6 +46,13 @@
 #define RPMSGBLK_GEOMETRY        5
 #define RPMSGBLK_IOCTL           6
 
+/* Features negotiated by RPMSGBLK_OPEN.  A peer that predates the feature
+ * word replies with the bare header and gets none of them.
+ */
+
+#define RPMSGBLK_FEATURE_XFER    (1 << 0) /* Chunked read/write framing */
+#define RPMSGBLK_FEATURES        RPMSGBLK_FEATURE_XFER
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -60,9 +67,13 @@ begin_packed_struct struct rpmsgblk_header_s
 begin_packed_struct struct rpmsgblk_open_s
 {
   struct rpmsgblk_header_s header;
+  uint32_t                 features;
 } end_packed_struct;
 
-#define rpmsgblk_close_s rpmsgblk_open_s
+begin_packed_struct struct rpmsgblk_close_s
+{
+  struct rpmsgblk_header_s header;
+} end_packed_struct;
 
 begin_packed_struct struct rpmsgblk_read_s
 {
@@ -70,7 +81,8 @@ begin_packed_struct struct rpmsgblk_read_s
   uint32_t                 startsector;
   uint32_t                 nsectors;
   int32_t                  sectorsize;
-  uint32_t                 count;
+  uint32_t                 last;    /* Non-zero in the final response,
+                                     * RPMSGBLK_FEATURE_XFER only */
   char                     buf[1];
 } end_packed_struct;
 
@@ -49,6 +49,7 @@ struct rpmsgblk_server_s
   struct rpmsg_endpoint              ept;
   FAR struct inode                  *blknode;
   FAR const struct block_operations *bops;
+  uint32_t                           features;
 };
 
 /****************************************************************************
@@ -117,13 +118,29 @@ static int rpmsgblk_open_handler(FAR struct rpmsg_endpoint *ept,
   FAR struct rpmsgblk_server_s *server = ept->priv;
   FAR struct rpmsgblk_open_s *msg = data;
 
+  /* A legacy client sends the bare header, answer it in the same size
+   * and keep to the framing it knows.
+   */
+
+  if (len >= sizeof(*msg))
+    {
+      server->features = msg->features & RPMSGBLK_FEATURES;
+      msg->features    = server->features;
+      len              = sizeof(*msg);
+    }
+  else
+    {
+      server->features = 0;
+      len              = sizeof(msg->header);
+    }
+
   /* To check if the block device has been removed by unlink operation. */
 
 #ifndef CONFIG_DISABLE_PSEUDOFS_OPERATIONS
   if (server->blknode->i_peer == NULL)
     {
       msg->header.result = -ENODEV;
-      return rpmsg_send(ept, msg, sizeof(*msg));
+      return rpmsg_send(ept, msg, len);
     }
 #endif
 
@@ -140,7 +157,7 @@ static int rpmsgblk_open_handler(FAR struct rpmsg_endpoint *ept,
       msg->header.result = 0;
     }
 
-  return rpmsg_send(ept, msg, sizeof(*msg));
+  return rpmsg_send(ept, msg, len);
 }
 
 /****************************************************************************
@@ -198,6 +215,7 @@ static int rpmsgblk_read_handler(FAR struct rpmsg_endpoint *ept,
   if (server->blknode->i_peer == NULL)
     {
       msg->header.result = -ENODEV;
+      msg->last = 1;
       return rpmsg_send(ept, msg, sizeof(*msg) - 1);
     }
 #endif
@@ -221,10 +239,23 @@ static int rpmsgblk_read_handler(FAR struct rpmsg_endpoint *ept,
           nsectors = msg->nsectors - read;
         }
 
+      rsp->startsector = msg->startsector + read;
       ret = server->bops->read(server->blknode,
                                (FAR unsigned char *)rsp->buf,
-                               msg->startsector, nsectors);
+                               rsp->startsector, nsectors);
       rsp->header.result = ret;
+
+      /* Each response carries its own sector range, so the client can
+       * place it even when several requests are outstanding.  A legacy
+       * client expects the total in nsectors and counts to it instead.
+       */
+
+      if (server->features & RPMSGBLK_FEATURE_XFER)
+        {
+          rsp->nsectors = ret < 0 ? 0 : ret;
+          rsp->last     = ret <= 0 || read + ret >= msg->nsectors;
+        }
+
       if (rpmsg_send_nocopy(ept, rsp, (ret < 0 ? 0 : ret * msg->sectorsize) +
                                       sizeof(*rsp) - 1) < 0)
         {
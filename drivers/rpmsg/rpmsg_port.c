@@ -24,10 +24,13 @@
  * Included Files
  ****************************************************************************/
 
+#include <debug.h>
+#include <inttypes.h>
 #include <stdio.h>
 
 #include <nuttx/irq.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/nuttx.h>
 
 #include <metal/mutex.h>
 #include <metal/sys.h>
@@ -43,6 +46,12 @@
 #define RPMSG_PORT_BUF_TO_NODE(q,b) ((q)->node + ((FAR void *)(b) - (q)->buf) / (q)->len)
 #define RPMSG_PORT_NODE_TO_BUF(q,n) ((q)->buf + (((n) - (q)->node)) * (q)->len)
 
+/* Packets packed into one frame start on this boundary, so the rpmsg
+ * header of each packet can be accessed in place by the receiver.
+ */
+
+#define RPMSG_PORT_PACK_ALIGN       8
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -712,6 +721,151 @@ rpmsg_port_queue_get_buffer(FAR struct rpmsg_port_queue_s *queue, bool wait)
     }
 }
 
+/****************************************************************************
+ * Name: rpmsg_port_queue_pack_buffer
+ ****************************************************************************/
+
+uint16_t
+rpmsg_port_queue_pack_buffer(FAR struct rpmsg_port_queue_s *queue,
+                             FAR struct rpmsg_port_header_s *hdr,
+                             uint16_t max)
+{
+  FAR struct rpmsg_port_header_s *next;
+  FAR struct list_node *node;
+  irqstate_t flags;
+  uint16_t npackets = 1;
+  uint16_t off;
+  uint16_t len;
+
+  while (npackets < max)
+    {
+      /* Only take the head packet when it fits, to keep the send order */
+
+      flags = spin_lock_irqsave(&queue->ready.lock);
+      node = list_peek_head(&queue->ready.head);
+      if (node == NULL)
+        {
+          spin_unlock_irqrestore(&queue->ready.lock, flags);
+          break;
+        }
+
+      next = RPMSG_PORT_NODE_TO_BUF(queue, node);
+      off = ALIGN_UP(hdr->len, RPMSG_PORT_PACK_ALIGN);
+      len = next->len - sizeof(*next);
+      if (off + len > queue->len)
+        {
+          spin_unlock_irqrestore(&queue->ready.lock, flags);
+          break;
+        }
+
+      list_delete(node);
+      queue->ready.num--;
+      spin_unlock_irqrestore(&queue->ready.lock, flags);
+
+      /* The rpmsg header of each packet carries its length */
+
+      memcpy((FAR uint8_t *)hdr + off, next->buf, len);
+      hdr->len = off + len;
+      npackets++;
+
+      rpmsg_port_queue_return_buffer(queue, next);
+    }
+
+  return npackets;
+}
+
+/****************************************************************************
+ * Name: rpmsg_port_frame_npackets
+ ****************************************************************************/
+
+uint16_t rpmsg_port_frame_npackets(FAR struct rpmsg_port_header_s *hdr,
+                                   uint16_t max)
+{
+  FAR struct rpmsg_hdr *rphdr;
+  uint16_t npackets = 0;
+  uint32_t off = sizeof(*hdr);
+  uint32_t len;
+
+  while (off < hdr->len && npackets < max)
+    {
+      rphdr = (FAR struct rpmsg_hdr *)((FAR uint8_t *)hdr + off);
+      len = sizeof(*rphdr) + rphdr->len;
+      if (off + len > hdr->len)
+        {
+          break;
+        }
+
+      off = ALIGN_UP(off + len, RPMSG_PORT_PACK_ALIGN);
+      npackets++;
+    }
+
+  return npackets;
+}
+
+/****************************************************************************
+ * Name: rpmsg_port_queue_unpack_buffer
+ ****************************************************************************/
+
+uint16_t
+rpmsg_port_queue_unpack_buffer(FAR struct rpmsg_port_queue_s *queue,
+                               FAR struct rpmsg_port_header_s *hdr,
+                               FAR struct rpmsg_port_header_s **hdrs,
+                               uint16_t max, uint16_t reserve)
+{
+  FAR struct rpmsg_hdr *rphdr = (FAR struct rpmsg_hdr *)hdr->buf;
+  uint16_t total = hdr->len;
+  uint16_t npackets = 1;
+  uint32_t off;
+  uint32_t len;
+
+  off = sizeof(*hdr) + sizeof(*rphdr) + rphdr->len;
+  if (off > total)
+    {
+      return 0;
+    }
+
+  hdrs[0]  = hdr;
+  hdr->len = off;
+  off      = ALIGN_UP(off, RPMSG_PORT_PACK_ALIGN);
+
+  while (off < total && npackets < max)
+    {
+      rphdr = (FAR struct rpmsg_hdr *)((FAR uint8_t *)hdr + off);
+      len = sizeof(*rphdr) + rphdr->len;
+      if (off + len > total)
+        {
+          rpmsgerr("malformed frame, %" PRIu32 " bytes dropped\n",
+                   total - off);
+          break;
+        }
+
+      /* Never take the buffers the driver keeps for its next frame */
+
+      hdrs[npackets] = NULL;
+      if (rpmsg_port_queue_navail(queue) > reserve)
+        {
+          hdrs[npackets] = rpmsg_port_queue_get_available_buffer(queue,
+                                                                 false);
+        }
+
+      if (hdrs[npackets] == NULL)
+        {
+          rpmsgerr("no rx buffer, %" PRIu32 " bytes dropped\n",
+                   total - off);
+          break;
+        }
+
+      memcpy(hdrs[npackets]->buf, rphdr, len);
+      hdrs[npackets]->cmd = hdr->cmd;
+      hdrs[npackets]->len = sizeof(*hdr) + len;
+
+      off = ALIGN_UP(off + len, RPMSG_PORT_PACK_ALIGN);
+      npackets++;
+    }
+
+  return npackets;
+}
+
 /****************************************************************************
  * Name: rpmsg_port_queue_add_buffer
  ****************************************************************************/
@@ -821,6 +975,24 @@ static void rpmsg_port_dump(FAR struct rpmsg_s *rpmsg)
 
   metal_log(METAL_LOG_EMERGENCY, "Remote: %s\n", port->cpuname);
 
+  if (port->stats.txframes != 0 || port->stats.rxframes != 0)
+    {
+      metal_log(METAL_LOG_EMERGENCY,
+                "link TX: frames %" PRIu32 " packets %" PRIu32
+                " bytes %" PRIu64 " util %" PRIu64 "%%\n",
+                port->stats.txframes, port->stats.txpackets,
+                port->stats.txbytes, port->stats.txframes ?
+                port->stats.txbytes * 100 /
+                ((uint64_t)port->stats.txframes * port->txq.len) : 0);
+      metal_log(METAL_LOG_EMERGENCY,
+                "link RX: frames %" PRIu32 " packets %" PRIu32
+                " bytes %" PRIu64 " util %" PRIu64 "%%\n",
+                port->stats.rxframes, port->stats.rxpackets,
+                port->stats.rxbytes, port->stats.rxframes ?
+                port->stats.rxbytes * 100 /
+                ((uint64_t)port->stats.rxframes * port->rxq.len) : 0);
+    }
+
   metal_list_for_each(&rdev->endpoints, node)
     {
       ept = metal_container_of(node, struct rpmsg_endpoint, node);
@@ -87,6 +87,18 @@ struct rpmsg_port_queue_s
   struct rpmsg_port_list_s ready;
 };
 
+/* Link statistics, updated by the physical layer driver */
+
+struct rpmsg_port_stats_s
+{
+  uint32_t txframes;              /* Frames sent on the link */
+  uint32_t txpackets;             /* Rpmsg packets carried by txframes */
+  uint64_t txbytes;               /* Bytes used by the sent packets */
+  uint32_t rxframes;              /* Frames received from the link */
+  uint32_t rxpackets;             /* Rpmsg packets carried by rxframes */
+  uint64_t rxbytes;               /* Bytes used by the received packets */
+};
+
 struct rpmsg_port_s;
 
 typedef void (*rpmsg_port_rx_cb_t)(FAR struct rpmsg_port_s *port,
@@ -126,6 +138,10 @@ struct rpmsg_port_s
   /* Ops need implemented by drivers under port layer */
 
   const FAR struct rpmsg_port_ops_s *ops;
+
+  /* Link statistics, reported by the rpmsg dump */
+
+  struct rpmsg_port_stats_s         stats;
 };
 
 #ifndef __ASSEMBLY__
@@ -220,6 +236,77 @@ rpmsg_port_queue_get_buffer(FAR struct rpmsg_port_queue_s *queue,
 void rpmsg_port_queue_add_buffer(FAR struct rpmsg_port_queue_s *queue,
                                  FAR struct rpmsg_port_header_s *hdr);
 
+/****************************************************************************
+ * Name: rpmsg_port_queue_pack_buffer
+ *
+ * Description:
+ *   Append the packets waiting in the ready list of the queue behind hdr,
+ *   as long as they fit in one buffer, so that the driver can send them in
+ *   one frame.  The appended buffers are returned to the free list.
+ *
+ * Input Parameters:
+ *   queue - The queue hdr was getten from.
+ *   hdr   - The first packet of the frame, removed from the ready list.
+ *   max   - The maximum number of packets in the frame.
+ *
+ * Returned Value:
+ *   Number of packets in the frame, hdr->len is updated to the frame
+ *   length.
+ *
+ ****************************************************************************/
+
+uint16_t
+rpmsg_port_queue_pack_buffer(FAR struct rpmsg_port_queue_s *queue,
+                             FAR struct rpmsg_port_header_s *hdr,
+                             uint16_t max);
+
+/****************************************************************************
+ * Name: rpmsg_port_frame_npackets
+ *
+ * Description:
+ *   Count the packets of a frame built by rpmsg_port_queue_pack_buffer()
+ *   without touching it, so that the receiver can reserve the buffers the
+ *   frame will be split into as soon as it arrives.
+ *
+ * Input Parameters:
+ *   hdr - The received frame.
+ *   max - The maximum number of packets to count.
+ *
+ * Returned Value:
+ *   Number of well formed packets, the same number
+ *   rpmsg_port_queue_unpack_buffer() splits when it gets enough buffers.
+ *
+ ****************************************************************************/
+
+uint16_t rpmsg_port_frame_npackets(FAR struct rpmsg_port_header_s *hdr,
+                                   uint16_t max);
+
+/****************************************************************************
+ * Name: rpmsg_port_queue_unpack_buffer
+ *
+ * Description:
+ *   Split a frame built by rpmsg_port_queue_pack_buffer() back into one
+ *   buffer per packet.  The first packet stays in hdr, the others are
+ *   copied to buffers getten from the free list of the queue.
+ *
+ * Input Parameters:
+ *   queue   - The queue hdr was getten from.
+ *   hdr     - The received frame.
+ *   hdrs    - Array to store the packet buffers in order.
+ *   max     - Size of the hdrs array.
+ *   reserve - Number of free buffers that must be left in the queue.
+ *
+ * Returned Value:
+ *   Number of buffers stored to hdrs.
+ *
+ ****************************************************************************/
+
+uint16_t
+rpmsg_port_queue_unpack_buffer(FAR struct rpmsg_port_queue_s *queue,
+                               FAR struct rpmsg_port_header_s *hdr,
+                               FAR struct rpmsg_port_header_s **hdrs,
+                               uint16_t max, uint16_t reserve);
+
 /****************************************************************************
  * Name: rpmsg_port_queue_navail
  *
@@ -27,6 +27,7 @@
 #include <debug.h>
 #include <errno.h>
 #include <stdio.h>
+#include <sys/param.h>
 
 #include <nuttx/nuttx.h>
 #include <nuttx/crc16.h>
@@ -59,8 +60,21 @@ enum rpmsg_port_spi_cmd_e
   RPMSG_PORT_SPI_CMD_CONNECT = 0x01,
   RPMSG_PORT_SPI_CMD_AVAIL,
   RPMSG_PORT_SPI_CMD_DATA,
+  RPMSG_PORT_SPI_CMD_DATA_AGGR,
 };
 
+/* Payload of the connect frame.  A peer built without aggregation leaves
+ * the fields behind the cpu name unset, so they are only trusted when the
+ * check matches.
+ */
+
+begin_packed_struct struct rpmsg_port_spi_connect_s
+{
+  char     cpuname[RPMSG_NAME_SIZE];
+  uint16_t aggregate;             /* Max packets per frame it can split */
+  uint16_t check;                 /* ~aggregate */
+} end_packed_struct;
+
 struct rpmsg_port_spi_s
 {
   struct rpmsg_port_s            port;
@@ -95,6 +109,14 @@ struct rpmsg_port_spi_s
   uint16_t                       rxavail;
   uint16_t                       rxthres;
 
+  /* Used for packet aggregation: the peer's limit, the packets of the
+   * frame in flight and the rx buffers owed to frames not split yet.
+   */
+
+  uint16_t                       txaggr;
+  uint16_t                       txnpackets;
+  atomic_int                     rxreserved;
+
   atomic_int                     transferring;
 };
 
@@ -122,6 +144,65 @@ static const struct rpmsg_port_ops_s g_rpmsg_port_spi_ops =
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: rpmsg_port_spi_frame_reserve
+ ****************************************************************************/
+
+static uint16_t
+rpmsg_port_spi_frame_reserve(FAR struct rpmsg_port_header_s *hdr)
+{
+  uint16_t npackets;
+
+  /* The first packet stays in the frame buffer, each of the others is
+   * copied to a buffer of its own when the frame is split.
+   */
+
+  if (hdr->cmd != RPMSG_PORT_SPI_CMD_DATA_AGGR)
+    {
+      return 0;
+    }
+
+  npackets = rpmsg_port_frame_npackets(hdr, CONFIG_RPMSG_PORT_SPI_AGGREGATE);
+  return npackets > 1 ? npackets - 1 : 0;
+}
+
+/****************************************************************************
+ * Name: rpmsg_port_spi_txavail
+ ****************************************************************************/
+
+static uint16_t rpmsg_port_spi_txavail(uint16_t avail, uint16_t npackets)
+{
+  /* The peer advertised avail before it received the frame sent in the
+   * same exchange.  That frame takes one rx buffer per packet, the first
+   * is covered by the buffer the peer keeps for its next frame.
+   */
+
+  if (npackets <= 1)
+    {
+      return avail;
+    }
+
+  return avail > npackets - 1 ? avail - (npackets - 1) : 0;
+}
+
+/****************************************************************************
+ * Name: rpmsg_port_spi_peer_aggregate
+ ****************************************************************************/
+
+static uint16_t
+rpmsg_port_spi_peer_aggregate(FAR struct rpmsg_port_header_s *hdr)
+{
+  FAR struct rpmsg_port_spi_connect_s *conn =
+    (FAR struct rpmsg_port_spi_connect_s *)(hdr + 1);
+
+  if (conn->aggregate == 0 || conn->check != (uint16_t)~conn->aggregate)
+    {
+      return 1;
+    }
+
+  return MIN(conn->aggregate, CONFIG_RPMSG_PORT_SPI_AGGREGATE);
+}
+
 /****************************************************************************
  * Name: rpmsg_port_spi_drop_packets
  ****************************************************************************/
@@ -137,6 +218,8 @@ static void rpmsg_port_spi_drop_packets(FAR struct rpmsg_port_spi_s *rpspi)
 
   while (!!(hdr = rpmsg_port_queue_get_buffer(&rpspi->port.rxq, false)))
     {
+      atomic_fetch_sub(&rpspi->rxreserved,
+                       rpmsg_port_spi_frame_reserve(hdr));
       rpmsg_port_queue_return_buffer(&rpspi->port.rxq, hdr);
     }
 }
@@ -195,6 +278,7 @@ static void rpmsg_port_spi_register_cb(FAR struct rpmsg_port_s *port,
 static void rpmsg_port_spi_exchange(FAR struct rpmsg_port_spi_s *rpspi)
 {
   FAR struct rpmsg_port_header_s *txhdr;
+  int avail;
 
   IOEXP_WRITEPIN(rpspi->ioe, rpspi->mreq, 0);
   if (atomic_fetch_add(&rpspi->transferring, 1))
@@ -204,18 +288,37 @@ static void rpmsg_port_spi_exchange(FAR struct rpmsg_port_spi_s *rpspi)
 
   if (!rpspi->connected)
     {
+      FAR struct rpmsg_port_spi_connect_s *conn;
+
       txhdr = rpspi->cmdhdr;
       txhdr->cmd = RPMSG_PORT_SPI_CMD_CONNECT;
-      strlcpy((FAR char *)(txhdr + 1), rpspi->port.cpuname, RPMSG_NAME_SIZE);
+      conn = (FAR struct rpmsg_port_spi_connect_s *)(txhdr + 1);
+      strlcpy(conn->cpuname, rpspi->port.cpuname, sizeof(conn->cpuname));
+      conn->aggregate = CONFIG_RPMSG_PORT_SPI_AGGREGATE;
+      conn->check     = (uint16_t)~CONFIG_RPMSG_PORT_SPI_AGGREGATE;
     }
   else if (rpspi->txavail > 0 &&
            rpmsg_port_queue_nused(&rpspi->port.txq) > 0)
     {
+      uint16_t npackets;
+
       txhdr = rpmsg_port_queue_get_buffer(&rpspi->port.txq, false);
       DEBUGASSERT(txhdr != NULL);
 
-      txhdr->cmd = RPMSG_PORT_SPI_CMD_DATA;
+      /* Each packet of the frame takes one rx buffer of the peer, and
+       * the peer may split no more than it announced at connect.
+       */
+
+      npackets = rpmsg_port_queue_pack_buffer(&rpspi->port.txq, txhdr,
+                   MIN(rpspi->txavail, rpspi->txaggr));
+      txhdr->cmd = npackets > 1 ? RPMSG_PORT_SPI_CMD_DATA_AGGR :
+                                  RPMSG_PORT_SPI_CMD_DATA;
       rpspi->txhdr = txhdr;
+      rpspi->txnpackets = npackets;
+
+      rpspi->port.stats.txframes++;
+      rpspi->port.stats.txpackets += npackets;
+      rpspi->port.stats.txbytes   += txhdr->len;
     }
   else
     {
@@ -223,8 +326,13 @@ static void rpmsg_port_spi_exchange(FAR struct rpmsg_port_spi_s *rpspi)
       txhdr->cmd = RPMSG_PORT_SPI_CMD_AVAIL;
     }
 
-  txhdr->avail = rpmsg_port_queue_navail(&rpspi->port.rxq);
-  txhdr->avail = txhdr->avail > 1 ? txhdr->avail - 1 : 0;
+  /* Keep one buffer for the next frame, and the ones owed to received
+   * frames that have not been split yet.
+   */
+
+  avail = rpmsg_port_queue_navail(&rpspi->port.rxq) -
+          atomic_load(&rpspi->rxreserved);
+  txhdr->avail = avail > 1 ? avail - 1 : 0;
   txhdr->crc = rpmsg_port_spi_crc16(txhdr);
 
   rpmsginfo("irq send cmd:%u avail:%u\n", txhdr->cmd, txhdr->avail);
@@ -243,6 +351,7 @@ static void rpmsg_port_spi_exchange(FAR struct rpmsg_port_spi_s *rpspi)
 static void rpmsg_port_spi_complete_handler(FAR void *arg)
 {
   FAR struct rpmsg_port_spi_s *rpspi = arg;
+  uint16_t npackets;
 
   SPI_SELECT(rpspi->spi, rpspi->devid, false);
 
@@ -255,6 +364,9 @@ static void rpmsg_port_spi_complete_handler(FAR void *arg)
       rpspi->txhdr = NULL;
     }
 
+  npackets = rpspi->txnpackets;
+  rpspi->txnpackets = 0;
+
   if (rpspi->rxhdr->crc != 0)
     {
       uint16_t crc = rpmsg_port_spi_crc16(rpspi->rxhdr);
@@ -263,6 +375,10 @@ static void rpmsg_port_spi_complete_handler(FAR void *arg)
         {
           rpmsgerr("crc check fail received: %u calculated: %u\n",
                    rpspi->rxhdr->crc, crc);
+
+          /* No fresh credit, charge the frame sent to the old one */
+
+          rpspi->txavail -= MIN(rpspi->txavail, npackets);
           goto out;
         }
     }
@@ -279,11 +395,13 @@ static void rpmsg_port_spi_complete_handler(FAR void *arg)
         }
 
       rpspi->txavail = rpspi->rxhdr->avail;
+      rpspi->txaggr = rpmsg_port_spi_peer_aggregate(rpspi->rxhdr);
       rpspi->connected = true;
     }
   else
     {
-      rpspi->txavail = rpspi->rxhdr->avail;
+      rpspi->txavail = rpmsg_port_spi_txavail(rpspi->rxhdr->avail,
+                                              npackets);
       if (rpspi->rxhdr->cmd == RPMSG_PORT_SPI_CMD_CONNECT)
         {
           rpspi->connected = false;
@@ -291,8 +409,21 @@ static void rpmsg_port_spi_complete_handler(FAR void *arg)
         }
     }
 
+  if (rpspi->rxhdr->cmd == RPMSG_PORT_SPI_CMD_DATA ||
+      rpspi->rxhdr->cmd == RPMSG_PORT_SPI_CMD_DATA_AGGR)
+    {
+      rpspi->port.stats.rxframes++;
+      rpspi->port.stats.rxbytes += rpspi->rxhdr->len;
+    }
+
   if (rpspi->rxhdr->cmd != RPMSG_PORT_SPI_CMD_AVAIL)
     {
+      /* Reserve the buffers the frame will be split into before it is
+       * queued, so that they are not advertised to the peer again.
+       */
+
+      atomic_fetch_add(&rpspi->rxreserved,
+                       rpmsg_port_spi_frame_reserve(rpspi->rxhdr));
       rpmsg_port_queue_add_buffer(&rpspi->port.rxq, rpspi->rxhdr);
       rpspi->rxhdr = rpmsg_port_queue_get_available_buffer(
         &rpspi->port.rxq, false);
@@ -352,6 +483,43 @@ static void rpmsg_port_spi_connect(FAR struct rpmsg_port_spi_s *rpspi)
     }
 }
 
+/****************************************************************************
+ * Name: rpmsg_port_spi_process_frame
+ ****************************************************************************/
+
+static void
+rpmsg_port_spi_process_frame(FAR struct rpmsg_port_spi_s *rpspi,
+                             FAR struct rpmsg_port_header_s *rxhdr)
+{
+  FAR struct rpmsg_port_header_s *hdrs[CONFIG_RPMSG_PORT_SPI_AGGREGATE];
+  uint16_t reserved;
+  uint16_t npackets;
+  uint16_t i;
+
+  /* Split the whole frame before delivering the first packet, the frame
+   * buffer may be reused once its first packet is released.  Leave the
+   * buffer of the next frame and the ones owed to later frames alone.
+   */
+
+  reserved = rpmsg_port_spi_frame_reserve(rxhdr);
+  npackets = rpmsg_port_queue_unpack_buffer(&rpspi->port.rxq, rxhdr, hdrs,
+               nitems(hdrs),
+               1 + atomic_load(&rpspi->rxreserved) - reserved);
+  atomic_fetch_sub(&rpspi->rxreserved, reserved);
+  if (npackets == 0)
+    {
+      rpmsgerr("received a malformed frame, dropped\n");
+      rpmsg_port_queue_return_buffer(&rpspi->port.rxq, rxhdr);
+      return;
+    }
+
+  rpspi->port.stats.rxpackets += npackets;
+  for (i = 0; i < npackets; i++)
+    {
+      rpspi->rxcb(&rpspi->port, hdrs[i]);
+    }
+}
+
 /****************************************************************************
  * Name: rpmsg_port_spi_process_packet
  ****************************************************************************/
@@ -382,9 +550,14 @@ rpmsg_port_spi_process_packet(FAR struct rpmsg_port_spi_s *rpspi,
         break;
 
       case RPMSG_PORT_SPI_CMD_DATA:
+        rpspi->port.stats.rxpackets++;
         rpspi->rxcb(&rpspi->port, rxhdr);
         break;
 
+      case RPMSG_PORT_SPI_CMD_DATA_AGGR:
+        rpmsg_port_spi_process_frame(rpspi, rxhdr);
+        break;
+
       default:
         rpmsgerr("received a unexpected frame, dropped\n");
         rpmsg_port_queue_return_buffer(&rpspi->port.rxq, rxhdr);
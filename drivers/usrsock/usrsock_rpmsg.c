@@ -54,6 +54,9 @@ static void usrsock_rpmsg_ns_unbind(FAR struct rpmsg_endpoint *ept);
 
 static int usrsock_rpmsg_dns_handler(FAR struct rpmsg_endpoint *ept,
                                   FAR struct usrsock_rpmsg_dns_event_s *dns);
+static int usrsock_rpmsg_event_batch_handler(FAR struct rpmsg_endpoint *ept,
+                              FAR struct usrsock_rpmsg_event_batch_s *batch,
+                              size_t len);
 
 static int usrsock_rpmsg_ept_cb(FAR struct rpmsg_endpoint *ept,
                                 FAR void *data, size_t len,
@@ -114,6 +117,16 @@ static int usrsock_rpmsg_send_dns_request(FAR void *arg,
 static void usrsock_rpmsg_ns_bound(FAR struct rpmsg_endpoint *ept)
 {
   FAR struct usrsock_rpmsg_s *priv = ept->priv;
+  struct usrsock_request_common_s batch;
+
+  /* Tell the server that batched socket events are understood here, an
+   * older server rejects the unknown request and keeps sending one event
+   * per message.
+   */
+
+  batch.reqid = USRSOCK_RPMSG_EVENT_BATCH;
+  batch.xid   = 0;
+  rpmsg_send(ept, &batch, sizeof(batch));
 
 #ifdef CONFIG_NETDB_DNSCLIENT
   dns_register_notify(usrsock_rpmsg_send_dns_request, priv);
@@ -140,6 +153,37 @@ static int usrsock_rpmsg_dns_handler(FAR struct rpmsg_endpoint *ept,
   return 0;
 }
 
+static int usrsock_rpmsg_event_batch_handler(FAR struct rpmsg_endpoint *ept,
+                              FAR struct usrsock_rpmsg_event_batch_s *batch,
+                              size_t len)
+{
+  FAR struct usrsock_rpmsg_event_entry_s *entry =
+    (FAR struct usrsock_rpmsg_event_entry_s *)(batch + 1);
+  struct usrsock_message_socket_event_s event;
+  uint16_t i;
+
+  if (len < sizeof(*batch) ||
+      len < sizeof(*batch) + batch->count * sizeof(*entry))
+    {
+      return -EINVAL;
+    }
+
+  /* Unpack the batch into the regular event message, one per socket */
+
+  event.head.msgid = USRSOCK_MESSAGE_SOCKET_EVENT;
+  event.head.flags = USRSOCK_MESSAGE_FLAG_EVENT;
+
+  for (i = 0; i < batch->count; i++)
+    {
+      event.head.events = entry[i].events;
+      event.usockid     = entry[i].usockid;
+
+      usrsock_response((FAR const char *)&event, sizeof(event), NULL);
+    }
+
+  return 0;
+}
+
 static int usrsock_rpmsg_ept_cb(FAR struct rpmsg_endpoint *ept,
                                 FAR void *data, size_t len,
                                 uint32_t src, FAR void *priv)
@@ -151,6 +195,11 @@ static int usrsock_rpmsg_ept_cb(FAR struct rpmsg_endpoint *ept,
       return usrsock_rpmsg_dns_handler(ept, data);
     }
 
+  if (common->msgid == USRSOCK_RPMSG_EVENT_BATCH)
+    {
+      return usrsock_rpmsg_event_batch_handler(ept, data, len);
+    }
+
   if (common->msgid == USRSOCK_RPMSG_FRAG_RESPONSE)
     {
       data = (FAR char *)data + sizeof(struct usrsock_message_frag_ack_s);
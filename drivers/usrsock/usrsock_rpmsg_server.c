@@ -41,6 +41,7 @@
 #include <nuttx/queue.h>
 #include <nuttx/rpmsg/rpmsg.h>
 #include <nuttx/usrsock/usrsock_rpmsg.h>
+#include <nuttx/wqueue.h>
 #ifdef CONFIG_NETDEV_WIRELESS_IOCTL
 #include <nuttx/wireless/wireless.h>
 #endif
@@ -82,6 +83,20 @@ struct usrsock_rpmsg_ept_s
   sq_queue_t                 req_free;
   sq_queue_t                 req_pending;
   struct usrsock_rpmsg_req_s reqs[CONFIG_NET_USRSOCK_RPMSG_SERVER_NIOVEC];
+
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+  /* Socket events waiting to be sent in one batch message, evt_pending and
+   * evt_npending are protected by priv->mutex.  evt_lock serializes the
+   * batch senders so that no ack overtakes an event queued before it.
+   */
+
+  mutex_t                    evt_lock;
+  struct work_s              evt_work;
+  bool                       evt_batch;
+  bool                       evt_closing;
+  uint16_t                   evt_npending;
+  uint16_t        evt_pending[CONFIG_NET_USRSOCK_RPMSG_SERVER_NSOCKS];
+#endif
 };
 
 /****************************************************************************
@@ -102,6 +117,13 @@ static int usrsock_rpmsg_send_data_ack(FAR struct rpmsg_endpoint *ept,
                               int32_t datalen);
 static int usrsock_rpmsg_send_event(FAR struct rpmsg_endpoint *ept,
                                     int16_t usockid, uint16_t events);
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+static void usrsock_rpmsg_ack_begin(FAR struct rpmsg_endpoint *ept);
+static void usrsock_rpmsg_ack_end(FAR struct rpmsg_endpoint *ept);
+#else
+#  define usrsock_rpmsg_ack_begin(ept)
+#  define usrsock_rpmsg_ack_end(ept)
+#endif
 
 static int usrsock_rpmsg_socket_handler(FAR struct rpmsg_endpoint *ept,
                                         FAR void *data, size_t len,
@@ -209,16 +231,32 @@ static int usrsock_rpmsg_send_ack(FAR struct rpmsg_endpoint *ept,
                                   uint16_t events,
                                   uint32_t xid, int32_t result)
 {
-  struct usrsock_message_req_ack_s ack;
+  FAR struct usrsock_message_req_ack_s *ack;
+  uint32_t len;
+  int ret;
+
+  ack = rpmsg_get_tx_payload_buffer(ept, &len, true);
+  if (ack == NULL)
+    {
+      return -ENOMEM;
+    }
 
-  ack.head.msgid  = USRSOCK_MESSAGE_RESPONSE_ACK;
-  ack.head.flags  = (result == -EINPROGRESS);
-  ack.head.events = events;
+  ack->head.msgid  = USRSOCK_MESSAGE_RESPONSE_ACK;
+  ack->head.flags  = (result == -EINPROGRESS);
+  ack->head.events = events;
 
-  ack.xid    = xid;
-  ack.result = result == -EINPROGRESS ? 0 : result;
+  ack->xid    = xid;
+  ack->result = result == -EINPROGRESS ? 0 : result;
+
+  usrsock_rpmsg_ack_begin(ept);
+  ret = rpmsg_send_nocopy(ept, ack, sizeof(*ack));
+  usrsock_rpmsg_ack_end(ept);
+  if (ret < 0)
+    {
+      rpmsg_release_tx_buffer(ept, ack);
+    }
 
-  return rpmsg_send(ept, &ack, sizeof(ack));
+  return ret;
 }
 
 static int usrsock_rpmsg_send_data_ack(FAR struct rpmsg_endpoint *ept,
@@ -252,7 +290,9 @@ static int usrsock_rpmsg_send_data_ack(FAR struct rpmsg_endpoint *ept,
   ack->valuelen          = valuelen;
   ack->valuelen_nontrunc = valuelen_nontrunc;
 
+  usrsock_rpmsg_ack_begin(ept);
   ret = rpmsg_send_nocopy(ept, ack, sizeof(*ack) + valuelen + datalen);
+  usrsock_rpmsg_ack_end(ept);
   if (ret < 0)
     {
       rpmsg_release_tx_buffer(ept, ack);
@@ -267,6 +307,8 @@ static int usrsock_rpmsg_send_frag_ack(FAR struct rpmsg_endpoint *ept,
                               uint32_t xid, int32_t result,
                               uint32_t datalen)
 {
+  int ret;
+
   ack->reqack.head.msgid  = USRSOCK_RPMSG_FRAG_RESPONSE;
   ack->reqack.head.flags  = 0;
   ack->reqack.head.events = events;
@@ -274,23 +316,222 @@ static int usrsock_rpmsg_send_frag_ack(FAR struct rpmsg_endpoint *ept,
   ack->reqack.result      = result;
   ack->datalen            = datalen;
 
-  return rpmsg_send_nocopy(ept, ack, sizeof(*ack) + datalen);
+  usrsock_rpmsg_ack_begin(ept);
+  ret = rpmsg_send_nocopy(ept, ack, sizeof(*ack) + datalen);
+  usrsock_rpmsg_ack_end(ept);
+
+  return ret;
 }
 
 static int usrsock_rpmsg_send_event(FAR struct rpmsg_endpoint *ept,
                                     int16_t usockid, uint16_t events)
 {
-  struct usrsock_message_socket_event_s event;
+  FAR struct usrsock_message_socket_event_s *event;
+  uint32_t len;
+  int ret;
+
+  event = rpmsg_get_tx_payload_buffer(ept, &len, true);
+  if (event == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  event->head.msgid  = USRSOCK_MESSAGE_SOCKET_EVENT;
+  event->head.flags  = USRSOCK_MESSAGE_FLAG_EVENT;
+  event->head.events = events;
+
+  event->usockid = usockid;
+
+  ret = rpmsg_send_nocopy(ept, event, sizeof(*event));
+  if (ret < 0)
+    {
+      rpmsg_release_tx_buffer(ept, event);
+    }
+
+  return ret;
+}
+
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+/* Called with uept->evt_lock held */
+
+static int usrsock_rpmsg_flush_events(FAR struct usrsock_rpmsg_ept_s *uept,
+                                      bool wait)
+{
+  FAR struct usrsock_rpmsg_s *priv = uept->ept.priv;
+  FAR struct usrsock_rpmsg_event_batch_s *batch;
+  FAR struct usrsock_rpmsg_event_entry_s *entry;
+  bool more;
+  uint32_t len;
+  int ret;
+  int i;
+
+  nxrmutex_lock(&priv->mutex);
+  more = uept->evt_npending > 0;
+  nxrmutex_unlock(&priv->mutex);
+
+  while (more)
+    {
+      /* Get the tx buffer before taking the mutex, the poll callback
+       * must not be blocked while the remote is slow to free buffers.
+       */
 
-  event.head.msgid  = USRSOCK_MESSAGE_SOCKET_EVENT;
-  event.head.flags  = USRSOCK_MESSAGE_FLAG_EVENT;
-  event.head.events = events;
+      batch = rpmsg_get_tx_payload_buffer(&uept->ept, &len, wait);
+      if (batch == NULL)
+        {
+          return -EAGAIN;
+        }
+
+      entry = (FAR struct usrsock_rpmsg_event_entry_s *)(batch + 1);
+      len   = (len - sizeof(*batch)) / sizeof(*entry);
+
+      batch->head.msgid  = USRSOCK_RPMSG_EVENT_BATCH;
+      batch->head.flags  = USRSOCK_MESSAGE_FLAG_EVENT;
+      batch->head.events = 0;
+      batch->count       = 0;
+
+      nxrmutex_lock(&priv->mutex);
+      for (i = 0; i < CONFIG_NET_USRSOCK_RPMSG_SERVER_NSOCKS &&
+                  batch->count < len; i++)
+        {
+          if (uept->evt_pending[i] != 0)
+            {
+              entry[batch->count].usockid = i;
+              entry[batch->count].events  = uept->evt_pending[i];
+              batch->count++;
 
-  event.usockid = usockid;
+              uept->evt_pending[i] = 0;
+              uept->evt_npending--;
+            }
+        }
 
-  return rpmsg_send(ept, &event, sizeof(event));
+      more = uept->evt_npending > 0;
+      nxrmutex_unlock(&priv->mutex);
+
+      if (batch->count == 0)
+        {
+          rpmsg_release_tx_buffer(&uept->ept, batch);
+          break;
+        }
+
+      len = sizeof(*batch) + batch->count * sizeof(*entry);
+      ret = rpmsg_send_nocopy(&uept->ept, batch, len);
+      if (ret < 0)
+        {
+          rpmsg_release_tx_buffer(&uept->ept, batch);
+          return ret;
+        }
+    }
+
+  return OK;
 }
 
+/* The worker never blocks: a flush that holds evt_lock or waits for a tx
+ * buffer would stall the work queue and make the work_cancel_sync() in
+ * usrsock_rpmsg_ept_release() wait forever.  Retry a tick later instead.
+ */
+
+static void usrsock_rpmsg_flush_work(FAR void *arg)
+{
+  FAR struct usrsock_rpmsg_ept_s *uept = arg;
+  FAR struct usrsock_rpmsg_s *priv = uept->ept.priv;
+
+  if (nxmutex_trylock(&uept->evt_lock) >= 0)
+    {
+      usrsock_rpmsg_flush_events(uept, false);
+      nxmutex_unlock(&uept->evt_lock);
+    }
+
+  nxrmutex_lock(&priv->mutex);
+  if (uept->evt_npending > 0 && !uept->evt_closing &&
+      work_available(&uept->evt_work))
+    {
+      work_queue(LPWORK, &uept->evt_work,
+                 usrsock_rpmsg_flush_work, uept, 1);
+    }
+
+  nxrmutex_unlock(&priv->mutex);
+}
+
+/* Send all the queued events before an ack leaves, otherwise the client
+ * could see an event (e.g. RECVFROM_AVAIL) after the ack that consumed it.
+ */
+
+static void usrsock_rpmsg_ack_begin(FAR struct rpmsg_endpoint *ept)
+{
+  FAR struct usrsock_rpmsg_ept_s *uept =
+    (FAR struct usrsock_rpmsg_ept_s *)ept;
+
+  nxmutex_lock(&uept->evt_lock);
+  usrsock_rpmsg_flush_events(uept, true);
+}
+
+static void usrsock_rpmsg_ack_end(FAR struct rpmsg_endpoint *ept)
+{
+  FAR struct usrsock_rpmsg_ept_s *uept =
+    (FAR struct usrsock_rpmsg_ept_s *)ept;
+
+  nxmutex_unlock(&uept->evt_lock);
+}
+
+/* Called with priv->mutex held */
+
+static void usrsock_rpmsg_queue_event(FAR struct rpmsg_endpoint *ept,
+                                      int16_t usockid, uint16_t events)
+{
+  FAR struct usrsock_rpmsg_ept_s *uept =
+    (FAR struct usrsock_rpmsg_ept_s *)ept;
+
+  if (uept->evt_pending[usockid] == 0)
+    {
+      uept->evt_npending++;
+    }
+
+  uept->evt_pending[usockid] |= events;
+  if (work_available(&uept->evt_work))
+    {
+      work_queue(LPWORK, &uept->evt_work,
+                 usrsock_rpmsg_flush_work, uept, 0);
+    }
+}
+
+/* Called with priv->mutex held */
+
+static void usrsock_rpmsg_post_event(FAR struct rpmsg_endpoint *ept,
+                                     int16_t usockid, uint16_t events)
+{
+  FAR struct usrsock_rpmsg_ept_s *uept =
+    (FAR struct usrsock_rpmsg_ept_s *)ept;
+
+  /* Only a client that announced USRSOCK_RPMSG_EVENT_BATCH can unpack the
+   * batch message, an older one still gets one message per event.
+   */
+
+  if (uept->evt_batch)
+    {
+      usrsock_rpmsg_queue_event(ept, usockid, events);
+    }
+  else
+    {
+      usrsock_rpmsg_send_event(ept, usockid, events);
+    }
+}
+
+/* Called with priv->mutex held */
+
+static void usrsock_rpmsg_drop_event(FAR struct rpmsg_endpoint *ept,
+                                     int16_t usockid)
+{
+  FAR struct usrsock_rpmsg_ept_s *uept =
+    (FAR struct usrsock_rpmsg_ept_s *)ept;
+
+  if (uept->evt_pending[usockid] != 0)
+    {
+      uept->evt_pending[usockid] = 0;
+      uept->evt_npending--;
+    }
+}
+#endif
+
 static int usrsock_rpmsg_socket_handler(FAR struct rpmsg_endpoint *ept,
                                         FAR void *data, size_t len,
                                         uint32_t src, FAR void *priv_)
@@ -360,6 +601,9 @@ static int usrsock_rpmsg_close_handler(FAR struct rpmsg_endpoint *ept,
 
       ret = psock_close(&priv->socks[req->usockid]);
       nxrmutex_lock(&priv->mutex);
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+      usrsock_rpmsg_drop_event(ept, req->usockid);
+#endif
       priv->epts[req->usockid] = NULL;
       nxrmutex_unlock(&priv->mutex);
     }
@@ -1023,6 +1267,10 @@ static bool usrsock_rpmsg_ns_match(FAR struct rpmsg_device *rdev,
 static void usrsock_rpmsg_ept_release(FAR struct rpmsg_endpoint *ept)
 {
   FAR struct usrsock_rpmsg_s *priv = ept->priv;
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+  FAR struct usrsock_rpmsg_ept_s *uept =
+    (FAR struct usrsock_rpmsg_ept_s *)ept;
+#endif
   int i;
 
 #ifdef CONFIG_NETDB_DNSCLIENT
@@ -1046,6 +1294,20 @@ static void usrsock_rpmsg_ept_release(FAR struct rpmsg_endpoint *ept)
         }
     }
 
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+  /* Stop the worker from rescheduling itself, then cancel a queued retry
+   * and wait for a running flush until the work is idle.
+   */
+
+  nxrmutex_lock(&priv->mutex);
+  uept->evt_closing = true;
+  nxrmutex_unlock(&priv->mutex);
+
+  while (work_cancel_sync(LPWORK, &uept->evt_work) >= 0);
+
+  nxmutex_destroy(&uept->evt_lock);
+#endif
+
   kmm_free(ept);
 }
 
@@ -1066,6 +1328,9 @@ static void usrsock_rpmsg_ns_bind(FAR struct rpmsg_device *rdev,
 
   uept->ept.priv = priv;
   uept->ept.release_cb = usrsock_rpmsg_ept_release;
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+  nxmutex_init(&uept->evt_lock);
+#endif
   for (i = 0; i < CONFIG_NET_USRSOCK_RPMSG_SERVER_NIOVEC; i++)
     {
       sq_addlast(&uept->reqs[i].flink, &uept->req_free);
@@ -1076,6 +1341,9 @@ static void usrsock_rpmsg_ns_bind(FAR struct rpmsg_device *rdev,
                          usrsock_rpmsg_ept_cb, rpmsg_destroy_ept);
   if (ret < 0)
     {
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+      nxmutex_destroy(&uept->evt_lock);
+#endif
       kmm_free(uept);
       return;
     }
@@ -1095,6 +1363,17 @@ static int usrsock_rpmsg_ept_do_cb(FAR struct usrsock_rpmsg_ept_s *uept,
     {
       return usrsock_rpmsg_sendto_handler(&uept->ept, data, len, src, priv);
     }
+  else if (common->reqid == USRSOCK_RPMSG_EVENT_BATCH)
+    {
+      /* The client understands batched events */
+
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+      nxrmutex_lock(&priv->mutex);
+      uept->evt_batch = true;
+      nxrmutex_unlock(&priv->mutex);
+#endif
+      return OK;
+    }
   else if (common->reqid >= 0 && common->reqid <= USRSOCK_REQUEST__MAX)
     {
       return g_usrsock_rpmsg_handler[common->reqid](&uept->ept, data, len,
@@ -1273,7 +1552,11 @@ static void usrsock_rpmsg_poll_cb(FAR struct pollfd *pfds)
 
   if (events != 0)
     {
+#ifdef CONFIG_NET_USRSOCK_RPMSG_SERVER_BATCH
+      usrsock_rpmsg_post_event(priv->epts[pfds->fd], pfds->fd, events);
+#else
       usrsock_rpmsg_send_event(priv->epts[pfds->fd], pfds->fd, events);
+#endif
     }
 
   nxrmutex_unlock(&priv->mutex);
@@ -0,0 +1,641 @@
+/****************************************************************************
+ * fs/mount/fs_lazymount.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/wqueue.h>
+
+#include "inode/inode.h"
+#include "mount/mount.h"
+#include "fs_heap.h"
+
+#ifdef CONFIG_FS_LAZYMOUNT
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The state of a mountpoint whose file system is not bound yet.  It is
+ * the i_private of the mountpoint inode until the bind succeeds, then the
+ * inode is switched to the real operations and handle.
+ */
+
+struct lazymount_s
+{
+  FAR const struct mountpt_operations *mops; /* The real file system */
+  FAR struct inode *drvr;                    /* Block or MTD driver */
+  FAR char         *data;                    /* Copy of the mount options */
+  FAR struct inode *mountpt;                 /* The mountpoint inode */
+  bool              binding;                 /* The bind is in progress */
+#ifdef CONFIG_FS_LAZYMOUNT_BACKGROUND
+  struct work_s     work;                    /* Background activation */
+#endif
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int lazymount_open(FAR struct file *filep, FAR const char *relpath,
+                          int oflags, mode_t mode);
+static int lazymount_opendir(FAR struct inode *mountpt,
+                             FAR const char *relpath,
+                             FAR struct fs_dirent_s **dir);
+static int lazymount_unbind(FAR void *handle, FAR struct inode **blkdriver,
+                            unsigned int flags);
+static int lazymount_statfs(FAR struct inode *mountpt,
+                            FAR struct statfs *buf);
+static int lazymount_unlink(FAR struct inode *mountpt,
+                            FAR const char *relpath);
+static int lazymount_mkdir(FAR struct inode *mountpt,
+                           FAR const char *relpath, mode_t mode);
+static int lazymount_rmdir(FAR struct inode *mountpt,
+                           FAR const char *relpath);
+static int lazymount_rename(FAR struct inode *mountpt,
+                            FAR const char *oldrelpath,
+                            FAR const char *newrelpath);
+static int lazymount_stat(FAR struct inode *mountpt,
+                          FAR const char *relpath, FAR struct stat *buf);
+static int lazymount_chstat(FAR struct inode *mountpt,
+                            FAR const char *relpath,
+                            FAR const struct stat *buf, int flags);
+static int lazymount_syncfs(FAR struct inode *mountpt);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* Only the entry points reachable through an unbound mountpoint are
+ * needed: no file can be open on it yet.
+ */
+
+const struct mountpt_operations g_lazymount_operations =
+{
+  lazymount_open,       /* open */
+  NULL,                 /* close */
+  NULL,                 /* read */
+  NULL,                 /* write */
+  NULL,                 /* seek */
+  NULL,                 /* ioctl */
+  NULL,                 /* mmap */
+  NULL,                 /* truncate */
+  NULL,                 /* poll */
+  NULL,                 /* readv */
+  NULL,                 /* writev */
+
+  NULL,                 /* sync */
+  NULL,                 /* dup */
+  NULL,                 /* fstat */
+  NULL,                 /* fchstat */
+
+  lazymount_opendir,    /* opendir */
+  NULL,                 /* closedir */
+  NULL,                 /* readdir */
+  NULL,                 /* rewinddir */
+
+  NULL,                 /* bind */
+  lazymount_unbind,     /* unbind */
+  lazymount_statfs,     /* statfs */
+
+  lazymount_unlink,     /* unlink */
+  lazymount_mkdir,      /* mkdir */
+  lazymount_rmdir,      /* rmdir */
+  lazymount_rename,     /* rename */
+  lazymount_stat,       /* stat */
+  lazymount_chstat,     /* chstat */
+  lazymount_syncfs      /* syncfs */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Protects the lazy mountpoints: the switch of a mountpoint to the real
+ * file system, the binding flags and the waiters below.  The inode lock
+ * can't be used, statfs() is called with it held for read by
+ * foreach_mountpoint().  Never held during a bind.
+ */
+
+static mutex_t g_lazymount_lock = NXMUTEX_INITIALIZER;
+
+/* Threads touching a mountpoint while its bind is in progress wait here.
+ * The waiters re-check the inode on wakeup, so the semaphore is shared by
+ * all lazy mountpoints and never refers to a freed lazymount_s.
+ */
+
+static sem_t g_lazymount_sem = SEM_INITIALIZER(0);
+static int g_lazymount_nwaiters;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lazymount_free
+ ****************************************************************************/
+
+static void lazymount_free(FAR struct lazymount_s *lazy)
+{
+  if (lazy->data != NULL)
+    {
+      fs_heap_free(lazy->data);
+    }
+
+  fs_heap_free(lazy);
+}
+
+/****************************************************************************
+ * Name: lazymount_get
+ *
+ * Description:
+ *   Return the lazy state of a mountpoint, or NULL if it is bound or was
+ *   unmounted.  Called with g_lazymount_lock held.
+ *
+ ****************************************************************************/
+
+static FAR struct lazymount_s *lazymount_get(FAR struct inode *mountpt)
+{
+  if (mountpt->u.i_mops != &g_lazymount_operations)
+    {
+      return NULL;
+    }
+
+  return mountpt->i_private;
+}
+
+/****************************************************************************
+ * Name: lazymount_activate
+ *
+ * Description:
+ *   Bind the file system of a lazy mountpoint if that was not done yet.
+ *   If another thread is binding it, wait for that thread.  On failure the
+ *   mountpoint stays lazy and the next access tries again.
+ *
+ ****************************************************************************/
+
+static int lazymount_activate(FAR struct inode *mountpt)
+{
+  FAR struct lazymount_s *lazy;
+  FAR void *fshandle = NULL;
+  int ret;
+
+  nxmutex_lock(&g_lazymount_lock);
+  while ((lazy = lazymount_get(mountpt)) != NULL && lazy->binding)
+    {
+      g_lazymount_nwaiters++;
+      nxmutex_unlock(&g_lazymount_lock);
+      nxsem_wait_uninterruptible(&g_lazymount_sem);
+      nxmutex_lock(&g_lazymount_lock);
+    }
+
+  if (lazy == NULL)
+    {
+      /* Bound by another thread meanwhile, or unmounted */
+
+      nxmutex_unlock(&g_lazymount_lock);
+      return mountpt->u.i_mops != &g_lazymount_operations &&
+             mountpt->u.i_mops != NULL ? OK : -ENODEV;
+    }
+
+  lazy->binding = true;
+  nxmutex_unlock(&g_lazymount_lock);
+
+  /* The driver reference taken by nx_mount() goes to the file system */
+
+  ret = lazy->mops->bind(lazy->drvr, lazy->data, &fshandle);
+
+  nxmutex_lock(&g_lazymount_lock);
+  lazy->binding = false;
+  if (ret >= 0)
+    {
+      /* The VFS reads i_mops without any lock, switch it last */
+
+      mountpt->i_private = fshandle;
+      mountpt->u.i_mops  = lazy->mops;
+
+#ifdef CONFIG_FS_LAZYMOUNT_BACKGROUND
+      /* Drop the reference of a background activation still queued */
+
+      if (work_cancel(LPWORK, &lazy->work) >= 0)
+        {
+          atomic_fetch_sub(&mountpt->i_crefs, 1);
+        }
+#endif
+    }
+  else
+    {
+      ferr("ERROR: Lazy bind failed: %d\n", ret);
+    }
+
+  while (g_lazymount_nwaiters > 0)
+    {
+      g_lazymount_nwaiters--;
+      nxsem_post(&g_lazymount_sem);
+    }
+
+  nxmutex_unlock(&g_lazymount_lock);
+
+  if (ret >= 0)
+    {
+      lazymount_free(lazy);
+    }
+
+  return ret;
+}
+
+#ifdef CONFIG_FS_LAZYMOUNT_BACKGROUND
+/****************************************************************************
+ * Name: lazymount_worker
+ ****************************************************************************/
+
+static void lazymount_worker(FAR void *arg)
+{
+  FAR struct inode *mountpt = arg;
+
+  lazymount_activate(mountpt);
+  inode_release(mountpt);
+}
+#endif
+
+/****************************************************************************
+ * Name: lazymount_open
+ ****************************************************************************/
+
+static int lazymount_open(FAR struct file *filep, FAR const char *relpath,
+                          int oflags, mode_t mode)
+{
+  FAR struct inode *mountpt = filep->f_inode;
+  int ret;
+
+  ret = lazymount_activate(mountpt);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mountpt->u.i_mops->open == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return mountpt->u.i_mops->open(filep, relpath, oflags, mode);
+}
+
+/****************************************************************************
+ * Name: lazymount_opendir
+ ****************************************************************************/
+
+static int lazymount_opendir(FAR struct inode *mountpt,
+                             FAR const char *relpath,
+                             FAR struct fs_dirent_s **dir)
+{
+  int ret;
+
+  ret = lazymount_activate(mountpt);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mountpt->u.i_mops->opendir == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return mountpt->u.i_mops->opendir(mountpt, relpath, dir);
+}
+
+/****************************************************************************
+ * Name: lazymount_unbind
+ *
+ * Description:
+ *   Unmount a mountpoint that was never bound.  Called with the inode lock
+ *   held.
+ *
+ ****************************************************************************/
+
+static int lazymount_unbind(FAR void *handle, FAR struct inode **blkdriver,
+                            unsigned int flags)
+{
+  FAR struct lazymount_s *lazy = handle;
+
+  nxmutex_lock(&g_lazymount_lock);
+  if (lazy->binding)
+    {
+      nxmutex_unlock(&g_lazymount_lock);
+      return -EBUSY;
+    }
+
+#ifdef CONFIG_FS_LAZYMOUNT_BACKGROUND
+  if (work_cancel(LPWORK, &lazy->work) >= 0)
+    {
+      atomic_fetch_sub(&lazy->mountpt->i_crefs, 1);
+    }
+#endif
+
+  /* Give the driver reference back to umount2().  umount2() clears i_mops
+   * only after this returns, hide the state from a racing access now.
+   */
+
+  *blkdriver = lazy->drvr;
+  if (lazy->mountpt != NULL)
+    {
+      lazy->mountpt->i_private = NULL;
+    }
+
+  nxmutex_unlock(&g_lazymount_lock);
+  lazymount_free(lazy);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: lazymount_statfs
+ ****************************************************************************/
+
+static int lazymount_statfs(FAR struct inode *mountpt,
+                            FAR struct statfs *buf)
+{
+  int ret;
+
+  ret = lazymount_activate(mountpt);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mountpt->u.i_mops->statfs == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return mountpt->u.i_mops->statfs(mountpt, buf);
+}
+
+/****************************************************************************
+ * Name: lazymount_unlink
+ ****************************************************************************/
+
+static int lazymount_unlink(FAR struct inode *mountpt,
+                            FAR const char *relpath)
+{
+  int ret;
+
+  ret = lazymount_activate(mountpt);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mountpt->u.i_mops->unlink == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return mountpt->u.i_mops->unlink(mountpt, relpath);
+}
+
+/****************************************************************************
+ * Name: lazymount_mkdir
+ ****************************************************************************/
+
+static int lazymount_mkdir(FAR struct inode *mountpt,
+                           FAR const char *relpath, mode_t mode)
+{
+  int ret;
+
+  ret = lazymount_activate(mountpt);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mountpt->u.i_mops->mkdir == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return mountpt->u.i_mops->mkdir(mountpt, relpath, mode);
+}
+
+/****************************************************************************
+ * Name: lazymount_rmdir
+ ****************************************************************************/
+
+static int lazymount_rmdir(FAR struct inode *mountpt,
+                           FAR const char *relpath)
+{
+  int ret;
+
+  ret = lazymount_activate(mountpt);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mountpt->u.i_mops->rmdir == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return mountpt->u.i_mops->rmdir(mountpt, relpath);
+}
+
+/****************************************************************************
+ * Name: lazymount_rename
+ ****************************************************************************/
+
+static int lazymount_rename(FAR struct inode *mountpt,
+                            FAR const char *oldrelpath,
+                            FAR const char *newrelpath)
+{
+  int ret;
+
+  ret = lazymount_activate(mountpt);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mountpt->u.i_mops->rename == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return mountpt->u.i_mops->rename(mountpt, oldrelpath, newrelpath);
+}
+
+/****************************************************************************
+ * Name: lazymount_stat
+ ****************************************************************************/
+
+static int lazymount_stat(FAR struct inode *mountpt,
+                          FAR const char *relpath, FAR struct stat *buf)
+{
+  int ret;
+
+  ret = lazymount_activate(mountpt);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mountpt->u.i_mops->stat == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return mountpt->u.i_mops->stat(mountpt, relpath, buf);
+}
+
+/****************************************************************************
+ * Name: lazymount_chstat
+ ****************************************************************************/
+
+static int lazymount_chstat(FAR struct inode *mountpt,
+                            FAR const char *relpath,
+                            FAR const struct stat *buf, int flags)
+{
+  int ret;
+
+  ret = lazymount_activate(mountpt);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (mountpt->u.i_mops->chstat == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return mountpt->u.i_mops->chstat(mountpt, relpath, buf, flags);
+}
+
+/****************************************************************************
+ * Name: lazymount_syncfs
+ *
+ * Description:
+ *   Nothing was written to a file system that is not bound yet, so sync()
+ *   does not need to bind it.
+ *
+ ****************************************************************************/
+
+static int lazymount_syncfs(FAR struct inode *mountpt)
+{
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lazymount_bind
+ *
+ * Description:
+ *   Prepare a lazy mount: record what is needed to bind the file system
+ *   later instead of binding it now.  The driver reference passed to the
+ *   file system by nx_mount() is kept until the bind.
+ *
+ * Input Parameters:
+ *   drvr   - The block or MTD driver inode
+ *   mops   - The operations of the file system
+ *   data   - The mount options, a string or NULL
+ *   handle - Location to return the handle to store in the mountpoint
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int lazymount_bind(FAR struct inode *drvr,
+                   FAR const struct mountpt_operations *mops,
+                   FAR const void *data, FAR void **handle)
+{
+  FAR struct lazymount_s *lazy;
+
+  lazy = fs_heap_zalloc(sizeof(struct lazymount_s));
+  if (lazy == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  if (data != NULL)
+    {
+      lazy->data = fs_heap_strdup(data);
+      if (lazy->data == NULL)
+        {
+          fs_heap_free(lazy);
+          return -ENOMEM;
+        }
+    }
+
+  lazy->mops = mops;
+  lazy->drvr = drvr;
+  *handle    = lazy;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: lazymount_start
+ *
+ * Description:
+ *   Called once the mountpoint inode is set up.  With
+ *   CONFIG_FS_LAZYMOUNT_BACKGROUND, schedule the bind on the low priority
+ *   work queue, otherwise the first access performs it.  Called with the
+ *   inode lock held.
+ *
+ ****************************************************************************/
+
+void lazymount_start(FAR struct inode *mountpt)
+{
+  FAR struct lazymount_s *lazy = mountpt->i_private;
+
+  lazy->mountpt = mountpt;
+
+#ifdef CONFIG_FS_LAZYMOUNT_BACKGROUND
+  /* The queued work holds a reference on the mountpoint */
+
+  atomic_fetch_add(&mountpt->i_crefs, 1);
+  if (work_queue(LPWORK, &lazy->work, lazymount_worker, mountpt,
+                 MSEC2TICK(CONFIG_FS_LAZYMOUNT_DELAY)) < 0)
+    {
+      atomic_fetch_sub(&mountpt->i_crefs, 1);
+    }
+#endif
+}
+
+#endif /* CONFIG_FS_LAZYMOUNT */
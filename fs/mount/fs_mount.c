@@ -37,6 +37,7 @@
 
 #include "driver/driver.h"
 #include "inode/inode.h"
+#include "mount/mount.h"
 #include "notify/notify.h"
 
 /****************************************************************************
@@ -455,6 +456,22 @@ int nx_mount(FAR const char *source, FAR const char *target,
 
   /* On failure, the bind method returns -errorcode */
 
+#if defined(CONFIG_FS_LAZYMOUNT) && \
+    (defined(BDFS_SUPPORT) || defined(MDFS_SUPPORT))
+  /* Only the file systems on a block or MTD driver are worth binding
+   * lazily, and only those are known to take a string as data.
+   */
+
+  if ((mountflags & MS_LAZYMOUNT) != 0 && drvr_inode != NULL)
+    {
+      ret = lazymount_bind(drvr_inode, mops, data, &fshandle);
+      if (ret >= 0)
+        {
+          mops = &g_lazymount_operations;
+        }
+    }
+  else
+#endif
 #if defined(BDFS_SUPPORT) || defined(MDFS_SUPPORT)
   ret = mops->bind(drvr_inode, data, &fshandle);
 #else
@@ -514,6 +531,13 @@ int nx_mount(FAR const char *source, FAR const char *target,
 
   mountpt_inode->u.i_mops  = mops;
   mountpt_inode->i_private = fshandle;
+#ifdef CONFIG_FS_LAZYMOUNT
+  if (mops == &g_lazymount_operations)
+    {
+      lazymount_start(mountpt_inode);
+    }
+#endif
+
   inode_unlock();
 
   /* We can release our reference to the blkdrver_inode, if the filesystem
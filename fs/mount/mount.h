@@ -36,6 +36,8 @@
  ****************************************************************************/
 
 struct statfs; /* Forward reference */
+struct inode;
+struct mountpt_operations;
 
 /* Callback used by foreach_mountpoints to traverse all mountpoints in the
  * pseudo-file system.
@@ -88,5 +90,35 @@ int foreach_mountpoint(foreach_mountpoint_t handler, FAR void *arg);
 
 FAR const char *fs_gettype(FAR struct statfs *statbuf);
 
+#ifdef CONFIG_FS_LAZYMOUNT
+/****************************************************************************
+ * Name: lazymount_bind
+ *
+ * Description:
+ *   Prepare a lazy mount (MS_LAZYMOUNT): record what is needed to bind the
+ *   file system on the first access to the mountpoint instead of binding
+ *   it now.  The handle returned must be installed in the mountpoint along
+ *   with g_lazymount_operations.
+ *
+ ****************************************************************************/
+
+int lazymount_bind(FAR struct inode *drvr,
+                   FAR const struct mountpt_operations *mops,
+                   FAR const void *data, FAR void **handle);
+
+/****************************************************************************
+ * Name: lazymount_start
+ *
+ * Description:
+ *   Called with the inode lock held once the lazy mountpoint is set up,
+ *   starts the background bind if so configured.
+ *
+ ****************************************************************************/
+
+void lazymount_start(FAR struct inode *mountpt);
+
+extern const struct mountpt_operations g_lazymount_operations;
+#endif
+
 #endif /* CONFIG_DISABLE_MOUNTPOINT */
 #endif /* __FS_MOUNT_MOUNT_H */
@@ -57,11 +57,13 @@
  ****************************************************************************/
 
 extern const struct procfs_operations g_clk_operations;
+extern const struct procfs_operations g_boot_operations;
 extern const struct procfs_operations g_cpuinfo_operations;
 extern const struct procfs_operations g_cpuload_operations;
 extern const struct procfs_operations g_cpufreq_operations;
 extern const struct procfs_operations g_critmon_operations;
 extern const struct procfs_operations g_fdt_operations;
+extern const struct procfs_operations g_heapprof_operations;
 extern const struct procfs_operations g_iobinfo_operations;
 extern const struct procfs_operations g_irq_operations;
 extern const struct procfs_operations g_meminfo_operations;
@@ -105,6 +107,10 @@ static const struct procfs_entry_s g_procfs_entries[] =
   { "[0-9]*",       &g_proc_operations,     PROCFS_DIR_TYPE    },
 #endif
 
+#ifdef CONFIG_SCHED_BOOT_TIMELINE
+  { "boot",         &g_boot_operations,     PROCFS_FILE_TYPE   },
+#endif
+
 #if defined(CONFIG_CLK) && !defined(CONFIG_FS_PROCFS_EXCLUDE_CLK)
   { "clk",          &g_clk_operations,      PROCFS_FILE_TYPE   },
 #endif
@@ -146,6 +152,10 @@ static const struct procfs_entry_s g_procfs_entries[] =
   { "fs/usage",     &g_mount_operations,    PROCFS_FILE_TYPE   },
 #endif
 
+#ifdef CONFIG_MM_HEAPPROF
+  { "heapprof",     &g_heapprof_operations, PROCFS_FILE_TYPE   },
+#endif
+
 #if defined(CONFIG_MM_IOB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IOBINFO)
   { "iobinfo",      &g_iobinfo_operations,  PROCFS_FILE_TYPE   },
 #endif
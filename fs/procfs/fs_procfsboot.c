@@ -0,0 +1,317 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsboot.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/init.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#include "fs_heap.h"
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+     defined(CONFIG_SCHED_BOOT_TIMELINE)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Determines the size of an intermediate buffer that must be large enough
+ * to handle the longest line generated by this logic.
+ */
+
+#define BOOT_LINELEN 64
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct boot_file_s
+{
+  struct procfs_file_s  base;        /* Base open file structure */
+  char line[BOOT_LINELEN];           /* Pre-allocated buffer for formatted lines */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     boot_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     boot_close(FAR struct file *filep);
+static ssize_t boot_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     boot_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     boot_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations g_boot_operations =
+{
+  boot_open,         /* open */
+  boot_close,        /* close */
+  boot_read,         /* read */
+  NULL,              /* write */
+  NULL,              /* poll */
+
+  boot_dup,          /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  boot_stat          /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: boot_usec
+ *
+ * Description:
+ *   Convert the interval between two marks to microseconds.
+ *
+ ****************************************************************************/
+
+static unsigned long boot_usec(clock_t from, clock_t to)
+{
+  struct timespec ts;
+
+  perf_convert(to - from, &ts);
+  return ts.tv_sec * 1000000ul + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: boot_open
+ ****************************************************************************/
+
+static int boot_open(FAR struct file *filep, FAR const char *relpath,
+                     int oflags, mode_t mode)
+{
+  FAR struct boot_file_s *attr;
+
+  finfo("Open '%s'\n", relpath);
+
+  /* PROCFS is read-only.  Any attempt to open with any kind of write
+   * access is not permitted.
+   */
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+    {
+      ferr("ERROR: Only O_RDONLY supported\n");
+      return -EACCES;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = fs_heap_zalloc(sizeof(struct boot_file_s));
+  if (!attr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: boot_close
+ ****************************************************************************/
+
+static int boot_close(FAR struct file *filep)
+{
+  FAR struct boot_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct boot_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  fs_heap_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: boot_read
+ *
+ * Description:
+ *   Print one line per boot phase: the start of the phase relative to the
+ *   first phase and its duration, both in microseconds.  A phase that has
+ *   not ended yet has no duration.
+ *
+ ****************************************************************************/
+
+static ssize_t boot_read(FAR struct file *filep, FAR char *buffer,
+                         size_t buflen)
+{
+  FAR const struct boot_mark_s *marks;
+  FAR struct boot_file_s *attr;
+  size_t totalsize = 0;
+  size_t linesize;
+  size_t copysize;
+  size_t nmarks;
+  off_t offset;
+  size_t i;
+
+  finfo("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct boot_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  offset = filep->f_pos;
+  nmarks = nx_boot_timeline(&marks);
+
+  linesize = procfs_snprintf(attr->line, BOOT_LINELEN, "%-24s %10s %10s\n",
+                             "PHASE", "START(us)", "TIME(us)");
+  copysize = procfs_memcpy(attr->line, linesize, buffer, buflen, &offset);
+  totalsize += copysize;
+
+  for (i = 0; i < nmarks && totalsize < buflen; i++)
+    {
+      if (marks[i].end != 0)
+        {
+          linesize = procfs_snprintf(attr->line, BOOT_LINELEN,
+                                     "%-24s %10lu %10lu\n", marks[i].name,
+                                     boot_usec(marks[0].begin,
+                                               marks[i].begin),
+                                     boot_usec(marks[i].begin,
+                                               marks[i].end));
+        }
+      else
+        {
+          linesize = procfs_snprintf(attr->line, BOOT_LINELEN,
+                                     "%-24s %10lu %10s\n", marks[i].name,
+                                     boot_usec(marks[0].begin,
+                                               marks[i].begin), "-");
+        }
+
+      copysize = procfs_memcpy(attr->line, linesize, buffer + totalsize,
+                               buflen - totalsize, &offset);
+      totalsize += copysize;
+    }
+
+  filep->f_pos += totalsize;
+  return totalsize;
+}
+
+/****************************************************************************
+ * Name: boot_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int boot_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct boot_file_s *oldattr;
+  FAR struct boot_file_s *newattr;
+
+  finfo("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct boot_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the task and attribute selection */
+
+  newattr = fs_heap_malloc(sizeof(struct boot_file_s));
+  if (!newattr)
+    {
+      ferr("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct boot_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: boot_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int boot_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  /* "boot" is the name for a read-only file */
+
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+  return OK;
+}
+
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS &&
+        * CONFIG_SCHED_BOOT_TIMELINE */
@@ -45,6 +45,7 @@
 #include <nuttx/progmem.h>
 #include <nuttx/sched.h>
 #include <nuttx/mm/mm.h>
+#include <nuttx/mm/shrinker.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/procfs.h>
 
@@ -75,6 +76,20 @@ struct meminfo_file_s
   char line[MEMINFO_LINELEN];     /* Pre-allocated buffer for formatted lines */
 };
 
+#ifdef CONFIG_MM_SHRINKER
+/* The state of meminfo_read() passed to meminfo_shrinker() */
+
+struct meminfo_shrinker_s
+{
+  FAR struct meminfo_file_s *procfile;
+  FAR char *buffer;
+  size_t buflen;
+  size_t copysize;
+  size_t totalsize;
+  off_t offset;
+};
+#endif
+
 #if defined(CONFIG_ARCH_HAVE_PROGMEM) && defined(CONFIG_FS_PROCFS_INCLUDE_PROGMEM)
 struct progmem_info_s
 {
@@ -225,6 +240,38 @@ static void meminfo_progmem(FAR struct progmem_info_s *progmem)
 }
 #endif
 
+/****************************************************************************
+ * Name: meminfo_shrinker
+ *
+ * Description:
+ *   mm_shrinker_foreach() callback, show the bytes a shrinker reclaimed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_SHRINKER
+static void meminfo_shrinker(FAR const struct mm_shrinker_s *shrinker,
+                             FAR void *arg)
+{
+  FAR struct meminfo_shrinker_s *state = arg;
+  size_t linesize;
+
+  if (state->buflen > 0)
+    {
+      state->buffer    += state->copysize;
+      state->buflen    -= state->copysize;
+
+      linesize          = procfs_snprintf(state->procfile->line,
+                                          MEMINFO_LINELEN, "%11lu %s\n",
+                                          (unsigned long)shrinker->reclaimed,
+                                          shrinker->name);
+      state->copysize   = procfs_memcpy(state->procfile->line, linesize,
+                                        state->buffer, state->buflen,
+                                        &state->offset);
+      state->totalsize += state->copysize;
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: meminfo_open
  ****************************************************************************/
@@ -403,6 +450,33 @@ static ssize_t meminfo_read(FAR struct file *filep, FAR char *buffer,
     }
 #endif
 
+#ifdef CONFIG_MM_SHRINKER
+  if (buflen > 0)
+    {
+      struct meminfo_shrinker_s state;
+
+      buffer    += copysize;
+      buflen    -= copysize;
+
+      /* Followed by the bytes given back by each shrinker */
+
+      linesize   = procfs_snprintf(procfile->line, MEMINFO_LINELEN,
+                                   "%11s %s\n", "reclaimed", "shrinker");
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                                 &offset);
+      totalsize += copysize;
+
+      state.procfile  = procfile;
+      state.buffer    = buffer;
+      state.buflen    = buflen;
+      state.copysize  = copysize;
+      state.totalsize = totalsize;
+      state.offset    = offset;
+      mm_shrinker_foreach(meminfo_shrinker, &state);
+      totalsize = state.totalsize;
+    }
+#endif
+
   /* Update the file offset */
 
   filep->f_pos += totalsize;
@@ -73,6 +73,9 @@ struct mallinfo
   int fordblks; /* This is the total size of memory occupied
                  * by free (not in use) chunks. */
   int usmblks;  /* This is the largest amount of space ever allocated */
+  int hblks;    /* This is the number of chunks allocated outside of the
+                 * heap, e.g. the pages of large allocations */
+  int hblkhd;   /* This is the total size of those chunks */
 };
 
 struct malltask
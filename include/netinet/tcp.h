@@ -58,4 +58,41 @@
                                            * Argument: max retry count */
 #define TCP_MAXSEG    (__SO_PROTOCOL + 4) /* The maximum segment size */
 
+/* TCP protocol socket operations for zero-copy receive (get only/set only):
+ * TCP_ZEROCOPY_RECEIVE lends received data to the caller without copying
+ * it and TCP_ZEROCOPY_RELEASE gives it back to the network stack.
+ */
+
+#define TCP_ZEROCOPY_RECEIVE (__SO_PROTOCOL + 5) /* Borrow received data
+                                                  * Argument: struct
+                                                  * tcp_zerocopy_receive */
+#define TCP_ZEROCOPY_RELEASE (__SO_PROTOCOL + 6) /* Return borrowed data
+                                                  * Argument: struct
+                                                  * tcp_zerocopy_receive */
+
+/* Attach an upper layer protocol to the connection.  Only "tls" (kernel
+ * TLS record layer, see include/netinet/tls.h) is supported.
+ */
+
+#define TCP_ULP       (__SO_PROTOCOL + 7) /* Upper layer protocol name
+                                           * Argument: string */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Argument of TCP_ZEROCOPY_RECEIVE and TCP_ZEROCOPY_RELEASE.  The fragments
+ * described by 'iov' stay valid until 'cookie' is released or the socket
+ * is closed.  Fragments are lent whole: the first one is always returned,
+ * further ones only while the total does not exceed 'length'.
+ */
+
+struct tcp_zerocopy_receive
+{
+  FAR struct iovec *iov;  /* Array that receives the lent fragments */
+  int       iovcnt;       /* In: size of 'iov', out: fragments lent */
+  size_t    length;       /* In: maximum bytes, out: bytes lent */
+  FAR void *cookie;       /* Out: handle to pass to TCP_ZEROCOPY_RELEASE */
+};
+
 #endif /* __INCLUDE_NETINET_TCP_H */
@@ -0,0 +1,126 @@
+/****************************************************************************
+ * include/netinet/tls.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NETINET_TLS_H
+#define __INCLUDE_NETINET_TLS_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Kernel TLS socket options at the SOL_TLS level.  The TLS handshake is
+ * done by the application; afterwards the negotiated keys are passed to
+ * the kernel with setsockopt(SOL_TLS, TLS_TX/TLS_RX) on a TCP socket that
+ * has been switched to the "tls" upper layer protocol with TCP_ULP.
+ */
+
+#define TLS_TX                       1  /* Set transmit parameters
+                                         * Argument: struct
+                                         * tls12_crypto_info_xxx */
+#define TLS_RX                       2  /* Set receive parameters
+                                         * Argument: struct
+                                         * tls12_crypto_info_xxx */
+
+/* Control message type used by recvmsg() to report the content type of a
+ * record that is not application data (handshake, alert, ...).
+ */
+
+#define TLS_GET_RECORD_TYPE          2
+
+/* Protocol versions */
+
+#define TLS_1_2_VERSION              0x0303
+#define TLS_1_3_VERSION              0x0304
+
+/* Cipher suites */
+
+#define TLS_CIPHER_AES_GCM_128       51
+#define TLS_CIPHER_AES_GCM_128_IV_SIZE       8
+#define TLS_CIPHER_AES_GCM_128_KEY_SIZE      16
+#define TLS_CIPHER_AES_GCM_128_SALT_SIZE     4
+#define TLS_CIPHER_AES_GCM_128_TAG_SIZE      16
+#define TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE  8
+
+#define TLS_CIPHER_AES_GCM_256       52
+#define TLS_CIPHER_AES_GCM_256_IV_SIZE       8
+#define TLS_CIPHER_AES_GCM_256_KEY_SIZE      32
+#define TLS_CIPHER_AES_GCM_256_SALT_SIZE     4
+#define TLS_CIPHER_AES_GCM_256_TAG_SIZE      16
+#define TLS_CIPHER_AES_GCM_256_REC_SEQ_SIZE  8
+
+#define TLS_CIPHER_CHACHA20_POLY1305 54
+#define TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE       12
+#define TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE      32
+#define TLS_CIPHER_CHACHA20_POLY1305_SALT_SIZE     0
+#define TLS_CIPHER_CHACHA20_POLY1305_TAG_SIZE      16
+#define TLS_CIPHER_CHACHA20_POLY1305_REC_SEQ_SIZE  8
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Common header of all the crypto information structures below */
+
+struct tls_crypto_info
+{
+  uint16_t version;     /* TLS_1_2_VERSION or TLS_1_3_VERSION */
+  uint16_t cipher_type; /* TLS_CIPHER_xxx */
+};
+
+/* Key material of one direction.  'iv' is the implicit IV (TLS 1.3 and
+ * ChaCha20-Poly1305) or the first explicit nonce (TLS 1.2 AES-GCM), and
+ * 'rec_seq' is the big endian sequence number of the next record.
+ */
+
+struct tls12_crypto_info_aes_gcm_128
+{
+  struct tls_crypto_info info;
+  uint8_t iv[TLS_CIPHER_AES_GCM_128_IV_SIZE];
+  uint8_t key[TLS_CIPHER_AES_GCM_128_KEY_SIZE];
+  uint8_t salt[TLS_CIPHER_AES_GCM_128_SALT_SIZE];
+  uint8_t rec_seq[TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE];
+};
+
+struct tls12_crypto_info_aes_gcm_256
+{
+  struct tls_crypto_info info;
+  uint8_t iv[TLS_CIPHER_AES_GCM_256_IV_SIZE];
+  uint8_t key[TLS_CIPHER_AES_GCM_256_KEY_SIZE];
+  uint8_t salt[TLS_CIPHER_AES_GCM_256_SALT_SIZE];
+  uint8_t rec_seq[TLS_CIPHER_AES_GCM_256_REC_SEQ_SIZE];
+};
+
+struct tls12_crypto_info_chacha20_poly1305
+{
+  struct tls_crypto_info info;
+  uint8_t iv[TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE];
+  uint8_t key[TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE];
+  uint8_t rec_seq[TLS_CIPHER_CHACHA20_POLY1305_REC_SEQ_SIZE];
+};
+
+#endif /* __INCLUDE_NETINET_TLS_H */
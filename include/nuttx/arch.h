@@ -3008,6 +3008,28 @@ int up_debugpoint_remove(int type, FAR void *addr, size_t size);
 
 #endif
 
+/****************************************************************************
+ * Name: up_heapguard_protect
+ *
+ * Description:
+ *   Make a page aligned range of the guarded allocator pool inaccessible,
+ *   or accessible again.  An access to an inaccessible page must call
+ *   heapguard_fault() with the faulting address.
+ *
+ * Input Parameters:
+ *   addr   - The start of the range, aligned to the page size
+ *   size   - The size of the range, a multiple of the page size
+ *   access - true to allow read and write access, false to forbid any
+ *
+ * Returned Value:
+ *  Zero on success; a negated errno value on failure
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_HAVE_HEAPGUARD
+int up_heapguard_protect(FAR void *addr, size_t size, bool access);
+#endif
+
 /****************************************************************************
  * Name: up_alloc_irq_msi
  *
@@ -0,0 +1,99 @@
+/****************************************************************************
+ * include/nuttx/drivers/initcall.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_DRIVERS_INITCALL_H
+#define __INCLUDE_NUTTX_DRIVERS_INITCALL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#ifdef CONFIG_DRIVERS_INITCALL
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One step of the boot initialization.  All initcalls of a level complete
+ * before any initcall of the next level starts.  Inside a level, an
+ * initcall starts once the initcalls named in depends[] have completed,
+ * independent initcalls may run concurrently.
+ */
+
+struct initcall_s
+{
+  FAR const char *name;             /* Name, referenced by depends[] */
+  CODE int (*func)(void);           /* Returns OK or a negated errno */
+  FAR const char * const *depends;  /* NULL terminated list, or NULL */
+  uint8_t level;                    /* Initialization level */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: initcall_run
+ *
+ * Description:
+ *   Run a table of initcalls, level by level, honoring the dependencies.
+ *   Once the OS is ready, up to CONFIG_DRIVERS_INITCALL_NTHREADS
+ *   initcalls run concurrently; before that they run one by one in the
+ *   calling thread.  The dependents of a failed initcall are skipped.
+ *
+ *   Dependencies on names which are not in the table are ignored, so an
+ *   initcall compiled out by the configuration needs no special care.
+ *
+ * Input Parameters:
+ *   calls  - The table of initcalls
+ *   ncalls - Number of entries in the table
+ *
+ * Returned Value:
+ *   The number of initcalls that failed or were skipped, or a negated
+ *   errno if the table is not valid (-EINVAL for a dependency cycle or a
+ *   dependency on a later level).
+ *
+ ****************************************************************************/
+
+int initcall_run(FAR const struct initcall_s *calls, size_t ncalls);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CONFIG_DRIVERS_INITCALL */
+#endif /* __INCLUDE_NUTTX_DRIVERS_INITCALL_H */
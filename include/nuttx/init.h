@@ -31,6 +31,7 @@
 #include <nuttx/compiler.h>
 
 #include <stdint.h>
+#include <time.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -47,6 +48,11 @@
 #define OSINIT_IDLELOOP()        (g_nx_initstate >= OSINIT_IDLELOOP)
 #define OSINIT_OS_INITIALIZING() (g_nx_initstate  < OSINIT_OSREADY)
 
+#ifndef CONFIG_SCHED_BOOT_TIMELINE
+#  define nx_boot_begin(name)
+#  define nx_boot_end(name)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -75,6 +81,18 @@ enum nx_initstate_e
   OSINIT_PANIC     = 7   /* Fatal error happened. */
 };
 
+#ifdef CONFIG_SCHED_BOOT_TIMELINE
+/* One entry of the boot timeline, the start and the end of a boot phase */
+
+struct boot_mark_s
+{
+  FAR const char *name;  /* Name of the phase, a string constant */
+  clock_t         begin; /* perf_gettime() when the phase started */
+  clock_t         end;   /* perf_gettime() when the phase ended, 0 while
+                          * the phase is still running */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -104,6 +122,57 @@ EXTERN volatile uint8_t g_nx_initstate;  /* See enum nx_initstate_e */
 
 void nx_start(void);
 
+#ifdef CONFIG_SCHED_BOOT_TIMELINE
+/* Functions contained in nx_boottime.c *************************************/
+
+/****************************************************************************
+ * Name: nx_boot_begin
+ *
+ * Description:
+ *   Record the start of a boot phase in the boot timeline and, once the
+ *   task lists are ready, in the note driver.  May be called at any point
+ *   of the boot, including from nx_start() before the OS is initialized.
+ *   Phases beyond CONFIG_SCHED_BOOT_TIMELINE_NMARKS are dropped.
+ *
+ * Input Parameters:
+ *   name - The name of the phase, must be a string constant
+ *
+ ****************************************************************************/
+
+void nx_boot_begin(FAR const char *name);
+
+/****************************************************************************
+ * Name: nx_boot_end
+ *
+ * Description:
+ *   Record the end of the boot phase started by nx_boot_begin() with the
+ *   same name.  Phases may run concurrently in different threads, every
+ *   phase is measured from its own begin to its own end.
+ *
+ * Input Parameters:
+ *   name - The name of the phase
+ *
+ ****************************************************************************/
+
+void nx_boot_end(FAR const char *name);
+
+/****************************************************************************
+ * Name: nx_boot_timeline
+ *
+ * Description:
+ *   Return the boot timeline recorded so far.
+ *
+ * Input Parameters:
+ *   marks - Location to return the array of marks
+ *
+ * Returned Value:
+ *   The number of marks in the array.
+ *
+ ****************************************************************************/
+
+size_t nx_boot_timeline(FAR const struct boot_mark_s **marks);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -75,12 +75,25 @@ extern "C"
 #define kumm_initialize(h,s)     umm_initialize(h,s)
 #define kumm_addregion(h,s)      umm_addregion(h,s)
 
-#define kumm_calloc(n,s)         calloc(n,s)
-#define kumm_malloc(s)           malloc(s)
+#ifdef CONFIG_MM_TASK_ARENA
+/* What the kernel allocates on behalf of a task, like its stack, may
+ * outlive the calling group, so it bypasses the arena of the caller.
+ */
+
+#  define kumm_calloc(n,s)       mm_calloc(USR_HEAP,n,s)
+#  define kumm_malloc(s)         mm_malloc(USR_HEAP,s)
+#  define kumm_zalloc(s)         mm_zalloc(USR_HEAP,s)
+#  define kumm_realloc(p,s)      mm_realloc(USR_HEAP,p,s)
+#  define kumm_memalign(a,s)     mm_memalign(USR_HEAP,a,s)
+#else
+#  define kumm_calloc(n,s)       calloc(n,s)
+#  define kumm_malloc(s)         malloc(s)
+#  define kumm_zalloc(s)         zalloc(s)
+#  define kumm_realloc(p,s)      realloc(p,s)
+#  define kumm_memalign(a,s)     memalign(a,s)
+#endif
+
 #define kumm_malloc_size(p)      malloc_size(p)
-#define kumm_zalloc(s)           zalloc(s)
-#define kumm_realloc(p,s)        realloc(p,s)
-#define kumm_memalign(a,s)       memalign(a,s)
 #define kumm_free(p)             free(p)
 #define kumm_mallinfo()          mallinfo()
 
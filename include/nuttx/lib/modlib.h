@@ -33,6 +33,7 @@
 #include <elf.h>
 
 #include <nuttx/addrenv.h>
+#include <nuttx/queue.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -147,6 +148,8 @@ typedef CODE int (*mod_initializer_t)(FAR struct mod_info_s *modinfo);
  */
 
 struct module_s;
+struct mod_symhash_s;
+struct mod_prelink_s;
 typedef CODE int (*mod_callback_t)(FAR struct module_s *modp, FAR void *arg);
 
 /* This describes the file to be loaded. */
@@ -158,6 +161,9 @@ struct module_s
   char modname[MODLIB_NAMEMAX];        /* Module name */
 #endif
   struct mod_info_s modinfo;           /* Module information */
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+  FAR struct mod_symhash_s *exphash;   /* Hash index of modinfo.exports */
+#endif
   FAR void *textalloc;                 /* Allocated kernel text memory */
   FAR void *dataalloc;                 /* Allocated kernel memory */
   uintptr_t xipbase;                   /* if elf is position independent, and use
@@ -216,11 +222,28 @@ struct mod_loadinfo_s
   uid_t         fileuid;     /* Uid of the file system */
   gid_t         filegid;     /* Gid of the file system */
   int           filemode;    /* Mode of the file system */
+#if defined(CONFIG_MODLIB_SHARED_TEXT) || defined(CONFIG_MODLIB_PRELINK)
+  FAR const char *filename;  /* Path of the file, to identify the image */
+  struct timespec filemtime; /* Time of last modification of the file */
+#endif
+#ifdef CONFIG_MODLIB_SHARED_TEXT
+  dev_t         filedev;     /* Device ID of the file */
+  ino_t         fileino;     /* Serial number of the file */
+  bool          textshared;  /* .text is shared with another instance */
+#endif
   Elf_Ehdr      ehdr;        /* Buffered module file header */
   FAR Elf_Phdr *phdr;        /* Buffered module program headers */
   FAR Elf_Shdr *shdr;        /* Buffered module section headers */
   FAR void     *exported;    /* Module exports */
   FAR uint8_t  *iobuffer;    /* File I/O buffer */
+#ifdef CONFIG_MODLIB_LOAD_STRTAB
+  FAR char     *strtab;      /* Symbol string table read in one go */
+#endif
+  dq_queue_t    symcache;    /* Resolved symbols, shared by all sections */
+#ifdef CONFIG_MODLIB_PRELINK
+  FAR struct mod_prelink_s *prelink; /* Persistent symbol resolutions */
+#endif
+  int           nsymcache;   /* Number of entries in symcache */
   uintptr_t     datasec;     /* ET_DYN - data area start from Phdr */
   uintptr_t     segpad;      /* Padding between text and data */
   uintptr_t     initarr;     /* .init_array */
@@ -0,0 +1,127 @@
+/****************************************************************************
+ * include/nuttx/mm/arena.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_ARENA_H
+#define __INCLUDE_NUTTX_MM_ARENA_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stddef.h>
+
+#ifdef CONFIG_MM_TASK_ARENA
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define mm_arena_malloc(size) mm_arena_memalign(0, size)
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+struct mm_heap_s;
+struct task_group_s;
+
+/****************************************************************************
+ * Name: mm_arena_memalign
+ *
+ * Description:
+ *   Allocate from the arena of the calling task group, adding an extent
+ *   taken from the user heap when the arena is full.  NULL is returned if
+ *   the caller has no arena (interrupt, kernel thread, early boot) or the
+ *   extent can't be allocated, the caller falls back to the user heap then.
+ *
+ * Input Parameters:
+ *   alignment - The alignment, zero for the default one
+ *   size      - The size of the memory
+ *
+ ****************************************************************************/
+
+FAR void *mm_arena_memalign(size_t alignment, size_t size);
+
+/****************************************************************************
+ * Name: mm_arena_zalloc
+ *
+ * Description:
+ *   mm_arena_malloc() and clear the memory.
+ *
+ ****************************************************************************/
+
+FAR void *mm_arena_zalloc(size_t size);
+
+/****************************************************************************
+ * Name: mm_arena_realloc
+ *
+ * Description:
+ *   Resize a block of the arena heap found by mm_arena_heap(), moving it to
+ *   another extent or the user heap when it can't grow in place.
+ *
+ ****************************************************************************/
+
+FAR void *mm_arena_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
+                           size_t size);
+
+/****************************************************************************
+ * Name: mm_arena_heap
+ *
+ * Description:
+ *   Return the heap of the arena extent that contains mem, or of the
+ *   guarded allocation mem, NULL if mem doesn't come from an arena.  The
+ *   extents are indexed by address, the lookup is logarithmic.
+ *
+ ****************************************************************************/
+
+FAR struct mm_heap_s *mm_arena_heap(FAR void *mem);
+
+/****************************************************************************
+ * Name: mm_arena_release
+ *
+ * Description:
+ *   Give all extents of the group back to the user heap at once, whatever
+ *   is still allocated in them.  Called when the last member of the group
+ *   exits.  With CONFIG_MM_TASK_ARENA_QUARANTINE the newest extents are
+ *   held back, so that a stale free into them asserts.
+ *
+ ****************************************************************************/
+
+void mm_arena_release(FAR struct task_group_s *group);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_TASK_ARENA */
+#endif /* __INCLUDE_NUTTX_MM_ARENA_H */
@@ -0,0 +1,179 @@
+/****************************************************************************
+ * include/nuttx/mm/heapguard.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_HEAPGUARD_H
+#define __INCLUDE_NUTTX_MM_HEAPGUARD_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The guarded pool lives in the kernel, user space heaps of the protected
+ * and kernel builds are not sampled.
+ */
+
+#if !defined(CONFIG_MM_HEAPGUARD) || \
+    (!defined(CONFIG_BUILD_FLAT) && !defined(__KERNEL__))
+#  define heapguard_malloc(heap, size) NULL
+#  define heapguard_free(heap, mem)    false
+#  define heapguard_release(heap)
+#  define heapguard_heap(mem)          NULL
+#  define heapguard_size(mem)          0
+#else
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+struct mm_heap_s;
+
+/****************************************************************************
+ * Name: heapguard_malloc
+ *
+ * Description:
+ *   Serve about one in CONFIG_MM_HEAPGUARD_RATE allocations from a slot of
+ *   the guarded pool.  The allocation ends at the end of its slot, so that
+ *   an overflow runs into the guard behind it.
+ *
+ * Input Parameters:
+ *   heap - The heap the allocation is made from
+ *   size - The requested size
+ *
+ * Returned Value:
+ *   The guarded allocation, or NULL if this allocation is not sampled and
+ *   must be served by the heap.
+ *
+ ****************************************************************************/
+
+FAR void *heapguard_malloc(FAR struct mm_heap_s *heap, size_t size);
+
+/****************************************************************************
+ * Name: heapguard_free
+ *
+ * Description:
+ *   Free a guarded allocation, check its guards and poison the slot
+ *   until it is reused.  Errors are reported with the
+ *   allocation and free backtraces.
+ *
+ * Input Parameters:
+ *   heap - The heap the memory is returned to
+ *   mem  - The memory to free
+ *
+ * Returned Value:
+ *   true if mem belongs to the guarded pool and was handled here.
+ *
+ ****************************************************************************/
+
+bool heapguard_free(FAR struct mm_heap_s *heap, FAR void *mem);
+
+/****************************************************************************
+ * Name: heapguard_release
+ *
+ * Description:
+ *   Free all the guarded allocations of a heap that goes away, a later
+ *   access or free of them is reported like a use after free.
+ *
+ * Input Parameters:
+ *   heap - The heap being released
+ *
+ ****************************************************************************/
+
+void heapguard_release(FAR struct mm_heap_s *heap);
+
+/****************************************************************************
+ * Name: heapguard_heap
+ *
+ * Description:
+ *   Return the heap that made the guarded allocation, or NULL if mem is
+ *   not in the guarded pool.
+ *
+ ****************************************************************************/
+
+FAR struct mm_heap_s *heapguard_heap(FAR const void *mem);
+
+/****************************************************************************
+ * Name: heapguard_size
+ *
+ * Description:
+ *   Return the usable size of a guarded allocation.
+ *
+ ****************************************************************************/
+
+size_t heapguard_size(FAR const void *mem);
+
+/****************************************************************************
+ * Name: heapguard_fault
+ *
+ * Description:
+ *   Called by the architecture when an access faults.  If the address
+ *   lies in the guarded pool, report the error and panic; otherwise return
+ *   and let the caller handle the fault.
+ *
+ * Input Parameters:
+ *   addr - The faulting address
+ *
+ ****************************************************************************/
+
+void heapguard_fault(FAR void *addr);
+
+/****************************************************************************
+ * Name: heapguard_selftest
+ *
+ * Description:
+ *   Check that sampled malloc(), memalign() and posix_memalign() calls
+ *   return usable blocks and leave the heap intact.  Run once at boot with
+ *   CONFIG_MM_HEAPGUARD_SELFTEST.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, -EFAULT if a check failed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_HEAPGUARD_SELFTEST
+int heapguard_selftest(void);
+#endif
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_HEAPGUARD */
+
+#endif /* __INCLUDE_NUTTX_MM_HEAPGUARD_H */
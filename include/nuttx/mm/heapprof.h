@@ -0,0 +1,114 @@
+/****************************************************************************
+ * include/nuttx/mm/heapprof.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_HEAPPROF_H
+#define __INCLUDE_NUTTX_MM_HEAPPROF_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stddef.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The profiler lives in the kernel, user space heaps of the protected and
+ * kernel builds are not sampled.
+ */
+
+#if !defined(CONFIG_MM_HEAPPROF) || \
+    (!defined(CONFIG_BUILD_FLAT) && !defined(__KERNEL__))
+#  define heapprof_alloc(mem, size)
+#  define heapprof_free(mem)
+#  define heapprof_move(oldmem, newmem)
+#else
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: heapprof_alloc
+ *
+ * Description:
+ *   Account an allocation to the sampler.  Allocations are sampled with a
+ *   probability proportional to their size, on average once every
+ *   CONFIG_MM_HEAPPROF_INTERVAL bytes; only sampled allocations record the
+ *   backtrace of the caller.
+ *
+ * Input Parameters:
+ *   mem  - The address returned to the caller
+ *   size - The requested size
+ *
+ ****************************************************************************/
+
+void heapprof_alloc(FAR void *mem, size_t size);
+
+/****************************************************************************
+ * Name: heapprof_free
+ *
+ * Description:
+ *   Drop the memory from the live heap profile if it was sampled.
+ *
+ * Input Parameters:
+ *   mem - The address passed to free
+ *
+ ****************************************************************************/
+
+void heapprof_free(FAR void *mem);
+
+/****************************************************************************
+ * Name: heapprof_move
+ *
+ * Description:
+ *   The allocator returns a different address than the one it accounted,
+ *   e.g. memalign trims the head of a larger allocation.  Move the sample,
+ *   if any, to the new address.
+ *
+ * Input Parameters:
+ *   oldmem - The accounted address
+ *   newmem - The address returned to the caller
+ *
+ ****************************************************************************/
+
+void heapprof_move(FAR void *oldmem, FAR void *newmem);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_HEAPPROF */
+
+#endif /* __INCLUDE_NUTTX_MM_HEAPPROF_H */
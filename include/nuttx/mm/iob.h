@@ -100,7 +100,7 @@
  * Public Types
  ****************************************************************************/
 
-typedef CODE void (*iob_free_cb_t)(FAR void *data);
+typedef CODE void (*iob_free_cb_t)(FAR void *data, FAR void *arg);
 
 /* Represents one I/O buffer.  A packet is contained by one or more I/O
  * buffers in a chain.  The io_pktlen is only valid for the I/O buffer at
@@ -128,7 +128,8 @@ struct iob_s
   unsigned int io_pktlen; /* Total length of the packet */
 
 #ifdef CONFIG_IOB_ALLOC
-  iob_free_cb_t io_free;  /* Custom free callback */
+  iob_free_cb_t io_free;     /* Custom free callback */
+  FAR void     *io_freearg;  /* Second argument of io_free */
   FAR uint8_t  *io_data;
 #else
   uint8_t       io_data[CONFIG_IOB_BUFSIZE];
@@ -261,11 +262,12 @@ FAR struct iob_s *iob_alloc_dynamic(uint16_t size);
  *   free_cb - Notify the caller when the iob is freed. The caller can
  *             perform additional operations on the data before it is freed.
  *             The free_cb is called when the iob is freed.
+ *   arg     - The second argument of free_cb, e.g. the owner of the data.
  *
  ****************************************************************************/
 
 FAR struct iob_s *iob_alloc_with_data(FAR void *data, uint16_t size,
-                                      iob_free_cb_t free_cb);
+                                      iob_free_cb_t free_cb, FAR void *arg);
 #endif
 
 /****************************************************************************
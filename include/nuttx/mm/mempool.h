@@ -32,6 +32,7 @@
 #include <nuttx/list.h>
 #include <nuttx/queue.h>
 #include <nuttx/mm/mm.h>
+#include <nuttx/mm/taskstat.h>
 #include <nuttx/nuttx.h>
 #include <nuttx/fs/procfs.h>
 #include <nuttx/spinlock.h>
@@ -119,6 +120,9 @@ struct mempool_s
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMPOOL)
   struct mempool_procfs_entry_s procfs; /* The entry of procfs */
 #endif
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+  FAR struct taskstat_s *taskstat; /* Per-task usage of the owner heap */
+#endif
 };
 
 #if CONFIG_MM_BACKTRACE >= 0
@@ -209,6 +213,22 @@ FAR void *mempool_allocate(FAR struct mempool_s *pool);
 
 void mempool_release(FAR struct mempool_s *pool, FAR void *blk);
 
+/****************************************************************************
+ * Name: mempool_trim
+ *
+ * Description:
+ *   Give the expansions whose blocks are all free back to the allocator of
+ *   the pool.  The initial block stays.
+ *
+ * Input Parameters:
+ *   pool - Address of the memory pool to be used.
+ *
+ * Returned Value:
+ *   The number of bytes passed to the free function of the pool.
+ ****************************************************************************/
+
+size_t mempool_trim(FAR struct mempool_s *pool);
+
 /****************************************************************************
  * Name: mempool_info
  *
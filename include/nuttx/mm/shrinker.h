@@ -0,0 +1,182 @@
+/****************************************************************************
+ * include/nuttx/mm/shrinker.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_SHRINKER_H
+#define __INCLUDE_NUTTX_MM_SHRINKER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stddef.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Shrinkers run from the lowest priority value up.  Memory that is merely
+ * kept free for later use goes first, caches that cost I/O or computation
+ * to refill go last.
+ */
+
+#define MM_SHRINKER_PRIORITY_POOL   10
+#define MM_SHRINKER_PRIORITY_CACHE  100
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct mm_shrinker_s;
+struct mm_heap_s;
+
+/* Give back up to target bytes to the heap, more is allowed.  Return the
+ * number of bytes really released.  The shrinker may be invoked from any
+ * thread that fails an allocation, possibly holding arbitrary locks, so it
+ * must not block: take its locks with the try variants and return zero
+ * when they are busy.
+ */
+
+typedef CODE size_t (*mm_shrink_t)(FAR struct mm_shrinker_s *shrinker,
+                                   size_t target);
+
+struct mm_shrinker_s
+{
+  FAR struct mm_shrinker_s *flink; /* Registry link, private */
+  FAR const char *name;            /* For the debug output */
+  int priority;                    /* MM_SHRINKER_PRIORITY_xxx */
+  mm_shrink_t shrink;              /* The reclaim method */
+  FAR void *arg;                   /* Private data of the owner */
+  FAR struct mm_heap_s *heap;      /* Heap the memory goes back to, NULL
+                                    * if it is not known */
+  size_t reclaimed;                /* Total bytes released so far */
+};
+
+/* Callback of mm_shrinker_foreach() */
+
+typedef CODE void (*mm_shrinker_handler_t)(
+                  FAR const struct mm_shrinker_s *shrinker, FAR void *arg);
+
+/* Reclaim is a kernel service, user space heaps in the protected and
+ * kernel builds are not covered.
+ */
+
+#if !defined(CONFIG_MM_SHRINKER) || \
+    (!defined(CONFIG_BUILD_FLAT) && !defined(__KERNEL__))
+#  define mm_shrinker_register(shrinker)
+#  define mm_shrinker_unregister(shrinker)
+#  define mm_shrinker_foreach(handler, arg)
+#  define mm_shrink(heap, target) 0
+#  define mm_shrink_watermark(heap)
+#else
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: mm_shrinker_register
+ *
+ * Description:
+ *   Add a shrinker to the registry.  name, priority and shrink must be set
+ *   by the caller.
+ *
+ ****************************************************************************/
+
+void mm_shrinker_register(FAR struct mm_shrinker_s *shrinker);
+
+/****************************************************************************
+ * Name: mm_shrinker_unregister
+ *
+ * Description:
+ *   Remove a shrinker from the registry, waiting for a running reclaim to
+ *   finish.
+ *
+ ****************************************************************************/
+
+void mm_shrinker_unregister(FAR struct mm_shrinker_s *shrinker);
+
+/****************************************************************************
+ * Name: mm_shrinker_foreach
+ *
+ * Description:
+ *   Call handler for every registered shrinker, e.g. to report how much
+ *   each of them reclaimed.
+ *
+ ****************************************************************************/
+
+void mm_shrinker_foreach(mm_shrinker_handler_t handler, FAR void *arg);
+
+/****************************************************************************
+ * Name: mm_shrink
+ *
+ * Description:
+ *   Invoke the shrinkers giving memory back to heap in priority order
+ *   until target bytes have been released or all of them ran.  Only one
+ *   reclaim runs at a time, a caller arriving while another reclaim is in
+ *   progress gets zero back.
+ *
+ * Input Parameters:
+ *   heap   - The heap that is short of memory
+ *   target - The number of bytes wanted
+ *
+ * Returned Value:
+ *   The number of bytes released.
+ *
+ ****************************************************************************/
+
+size_t mm_shrink(FAR struct mm_heap_s *heap, size_t target);
+
+/****************************************************************************
+ * Name: mm_shrink_watermark
+ *
+ * Description:
+ *   Called after an allocation from the kernel heap.  If the free heap
+ *   dropped below CONFIG_MM_SHRINKER_LOWMARK, schedule a background reclaim
+ *   up to CONFIG_MM_SHRINKER_HIGHMARK, at most once every
+ *   CONFIG_MM_SHRINKER_INTERVAL milliseconds.
+ *
+ ****************************************************************************/
+
+#if CONFIG_MM_SHRINKER_LOWMARK > 0
+void mm_shrink_watermark(FAR struct mm_heap_s *heap);
+#else
+#  define mm_shrink_watermark(heap)
+#endif
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_SHRINKER */
+
+#endif /* __INCLUDE_NUTTX_MM_SHRINKER_H */
@@ -0,0 +1,141 @@
+/****************************************************************************
+ * include/nuttx/mm/taskstat.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_TASKSTAT_H
+#define __INCLUDE_NUTTX_MM_TASKSTAT_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <nuttx/spinlock.h>
+
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* The memory held by one task */
+
+struct taskstat_entry_s
+{
+  pid_t  key;      /* pid + 1, zero marks an unused slot */
+  size_t aordblks; /* The number of allocated chunks */
+  size_t uordblks; /* The total size of the allocated chunks */
+};
+
+/* Per-task usage of one heap, kept up to date by the allocator so that
+ * mallinfo_task() doesn't have to walk the heap.  The table is open
+ * addressed by pid.  If more tasks hold memory than there are slots, the
+ * chunks of the tasks left out are only counted in nuntracked, and no new
+ * task enters the table until they are all freed.  A task has a slot only
+ * if all its chunks are in it, so its counters stay exact, the queries of
+ * the other tasks fall back to the walk meanwhile.  A zero filled
+ * structure is a valid empty table.
+ */
+
+struct taskstat_s
+{
+  spinlock_t lock;
+  size_t     nuntracked;  /* Chunks of the tasks without a slot */
+  struct taskstat_entry_s entries[CONFIG_MM_HEAP_TASKSTAT_NSLOTS];
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: taskstat_alloc
+ *
+ * Description:
+ *   Charge a chunk to its owner.  The special owners (PID_MM_MEMPOOL etc.)
+ *   are not tracked.
+ *
+ * Input Parameters:
+ *   stat - The table of the heap
+ *   pid  - The owner recorded in the chunk
+ *   size - The size of the chunk as the heap walk reports it
+ *
+ ****************************************************************************/
+
+void taskstat_alloc(FAR struct taskstat_s *stat, pid_t pid, size_t size);
+
+/****************************************************************************
+ * Name: taskstat_free
+ *
+ * Description:
+ *   Give back a chunk charged by taskstat_alloc().
+ *
+ * Input Parameters:
+ *   stat - The table of the heap
+ *   pid  - The owner recorded in the chunk
+ *   size - The size passed to taskstat_alloc()
+ *
+ ****************************************************************************/
+
+void taskstat_free(FAR struct taskstat_s *stat, pid_t pid, size_t size);
+
+/****************************************************************************
+ * Name: taskstat_info
+ *
+ * Description:
+ *   Get the memory held by one task in O(1).
+ *
+ * Input Parameters:
+ *   stat - The table of the heap
+ *   pid  - The task to query
+ *   info - Location to return the usage of the task
+ *
+ * Returned Value:
+ *   True if the counters are exact; false if the task may hold chunks not
+ *   in the table and the caller has to walk the heap instead.
+ *
+ ****************************************************************************/
+
+bool taskstat_info(FAR struct taskstat_s *stat, pid_t pid,
+                   FAR struct mallinfo_task *info);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_HEAP_TASKSTAT */
+
+#endif /* __INCLUDE_NUTTX_MM_TASKSTAT_H */
@@ -234,6 +234,13 @@ struct socket_conn_s
   uint8_t       s_ttl;       /* Default time-to-live */
 #endif
 
+#ifdef CONFIG_NETDEV_TXREADY
+  /* Link in the TX ready list of a device, see devif_txready() */
+
+  dq_entry_t    s_txnode;
+  FAR dq_queue_t *s_txqueue; /* The list holding the connection or NULL */
+#endif
+
   /* Connection-specific content may follow */
 };
 
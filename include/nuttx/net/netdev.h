@@ -528,6 +528,15 @@ struct net_driver_s
   FAR struct devif_callback_s *d_conncb_tail; /* This is the list tail */
   FAR struct devif_callback_s *d_devcb;
 
+#ifdef CONFIG_NETDEV_TXREADY
+  /* Connections with output pending on this device, only these are visited
+   * by the TX poll.  See devif_txready().
+   */
+
+  dq_queue_t d_tcpready;
+  dq_queue_t d_udpready;
+#endif
+
   /* Driver callbacks */
 
   CODE int (*d_ifup)(FAR struct net_driver_s *dev);
@@ -470,6 +470,11 @@ struct binary_s;                    /* Forward reference
                                     /* Defined in include/nuttx/binfmt/binfmt.h */
 #endif
 
+#ifdef CONFIG_MM_TASK_ARENA
+struct mm_arena_s;                  /* Forward reference                        */
+                                    /* Defined in mm/arena/arena.c              */
+#endif
+
 struct task_group_s
 {
   pid_t tg_pid;                     /* The ID of the task within the group      */
@@ -571,6 +576,12 @@ struct task_group_s
   /* Virtual memory mapping info ********************************************/
 
   struct mm_map_s tg_mm_map;        /* Task group virtual memory mappings   */
+
+#ifdef CONFIG_MM_TASK_ARENA
+  /* Heap arena *************************************************************/
+
+  FAR struct mm_arena_s *tg_arena;  /* Arena extents, newest first          */
+#endif
 };
 
 /* struct tcb_s *************************************************************/
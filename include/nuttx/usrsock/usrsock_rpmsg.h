@@ -37,6 +37,7 @@
 
 #define USRSOCK_RPMSG_DNS_REQUEST   USRSOCK_REQUEST__MAX
 
+#define USRSOCK_RPMSG_EVENT_BATCH   125
 #define USRSOCK_RPMSG_DNS_EVENT     126
 #define USRSOCK_RPMSG_FRAG_RESPONSE 127
 
@@ -62,6 +63,24 @@ begin_packed_struct struct usrsock_rpmsg_dns_event_s
   uint16_t addrlen;
 } end_packed_struct;
 
+/* Batched socket event message, followed by `count` event entries.  The
+ * server sends it only after the client sent a bare request header with
+ * reqid USRSOCK_RPMSG_EVENT_BATCH to announce that it can unpack it.
+ */
+
+begin_packed_struct struct usrsock_rpmsg_event_entry_s
+{
+  int16_t  usockid;
+  uint16_t events;
+} end_packed_struct;
+
+begin_packed_struct struct usrsock_rpmsg_event_batch_s
+{
+  struct usrsock_message_common_s head;
+
+  uint16_t count;
+} end_packed_struct;
+
 /* fragemented ack message */
 
 begin_packed_struct struct usrsock_message_frag_ack_s
@@ -50,6 +50,12 @@
 #define MS_NOSYMFOLLOW  256  /* Do not follow symlinks */
 #define MS_NOATIME      1024 /* Do not update access times. */
 
+/* NuttX specific: register the mountpoint now but bind the file system on
+ * the first access (see CONFIG_FS_LAZYMOUNT).
+ */
+
+#define MS_LAZYMOUNT    (1 << 28)
+
 /* Un-mount flags
  *
  * These flags control the behavior of umount2() when there are open file
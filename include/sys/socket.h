@@ -140,6 +140,10 @@
                                    * descriptor received through SCM_RIGHTS.
                                    */
 
+/* Send from the user buffer without copying it. */
+
+#define MSG_ZEROCOPY     0x4000000
+
 /* Protocol levels supported by get/setsockopt(): */
 
 #define SOL_SOCKET       1 /* Only socket-level options supported */
@@ -243,6 +247,7 @@
 #define SOL_RFCOMM      18 /* See options in include/netpacket/bluetooth.h */
 
 #define SOL_PACKET      19
+#define SOL_TLS         282 /* See options in include/netinet/tls.h */
 
 /* Protocol-level socket options may begin with this value */
 
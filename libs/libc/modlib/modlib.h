@@ -238,6 +238,163 @@ int modlib_reallocbuffer(FAR struct mod_loadinfo_s *loadinfo,
 
 int modlib_freebuffers(FAR struct mod_loadinfo_s *loadinfo);
 
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+
+/****************************************************************************
+ * Name: modlib_symhash
+ *
+ * Description:
+ *   Compute the hash value of a symbol name, this is the same function as
+ *   used by the GNU hash section.
+ *
+ ****************************************************************************/
+
+uint32_t modlib_symhash(FAR const char *name);
+
+/****************************************************************************
+ * Name: modlib_symhash_alloc
+ *
+ * Description:
+ *   Build the hash index of a symbol table.  The symbol table itself is
+ *   not copied, it must stay valid as long as the index is used.  The
+ *   index is released with lib_free().
+ *
+ * Returned Value:
+ *   The new hash index on success, NULL if there is no memory.
+ *
+ ****************************************************************************/
+
+FAR struct mod_symhash_s *
+modlib_symhash_alloc(FAR const struct symtab_s *symtab, int nsyms);
+
+/****************************************************************************
+ * Name: modlib_symhash_find
+ *
+ * Description:
+ *   Find the symbol with the given name and hash value (as returned by
+ *   modlib_symhash()) in a symbol table indexed by modlib_symhash_alloc().
+ *
+ * Returned Value:
+ *   The symbol on success, NULL if the symbol table doesn't hold the name.
+ *
+ ****************************************************************************/
+
+FAR const struct symtab_s *
+modlib_symhash_find(FAR const struct mod_symhash_s *hash,
+                    FAR const struct symtab_s *symtab,
+                    FAR const char *name, uint32_t hashval);
+
+#endif /* CONFIG_MODLIB_SYMBOL_HASH */
+
+#ifdef CONFIG_MODLIB_SHARED_TEXT
+
+/****************************************************************************
+ * Name: modlib_textcache_get
+ *
+ * Description:
+ *   Look for the text of another loaded instance of the same binary.  If
+ *   there is one, a reference is taken and loadinfo->textalloc is set to
+ *   it.
+ *
+ * Returned Value:
+ *   true if the text is shared, false if it must be loaded.
+ *
+ ****************************************************************************/
+
+bool modlib_textcache_get(FAR struct mod_loadinfo_s *loadinfo);
+
+/****************************************************************************
+ * Name: modlib_textcache_add
+ *
+ * Description:
+ *   Offer the text just loaded to later instances of the same binary.
+ *   Nothing is done if the binary is not position independent.
+ *
+ ****************************************************************************/
+
+void modlib_textcache_add(FAR struct mod_loadinfo_s *loadinfo);
+
+/****************************************************************************
+ * Name: modlib_textcache_release
+ *
+ * Description:
+ *   Drop one reference to a text allocation.
+ *
+ * Returned Value:
+ *   true if the text is still used by another instance, false if the
+ *   caller must free it.
+ *
+ ****************************************************************************/
+
+bool modlib_textcache_release(uintptr_t textalloc);
+
+#endif /* CONFIG_MODLIB_SHARED_TEXT */
+
+#ifdef CONFIG_MODLIB_PRELINK
+
+/****************************************************************************
+ * Name: modlib_prelink_load
+ *
+ * Description:
+ *   Prepare the symbol resolution cache of a load, reading the cache file
+ *   of the binary if it is still valid.  Nothing is cached while an
+ *   installed module exports symbols.
+ *
+ ****************************************************************************/
+
+void modlib_prelink_load(FAR struct module_s *modp,
+                         FAR struct mod_loadinfo_s *loadinfo,
+                         FAR const struct symtab_s *exports, int nexports);
+
+/****************************************************************************
+ * Name: modlib_prelink_find
+ *
+ * Description:
+ *   Look up the value of an undefined symbol by the offset of its name.
+ *
+ * Returned Value:
+ *   true if the cache holds the symbol.
+ *
+ ****************************************************************************/
+
+bool modlib_prelink_find(FAR struct mod_loadinfo_s *loadinfo,
+                         Elf_Word name, FAR uintptr_t *value);
+
+/****************************************************************************
+ * Name: modlib_prelink_record
+ *
+ * Description:
+ *   Remember the value of an undefined symbol resolved from the base
+ *   symbol table, to be written by modlib_prelink_save().
+ *
+ ****************************************************************************/
+
+void modlib_prelink_record(FAR struct mod_loadinfo_s *loadinfo,
+                           Elf_Word name, uintptr_t value);
+
+/****************************************************************************
+ * Name: modlib_prelink_save
+ *
+ * Description:
+ *   Write the symbols resolved by this load to the cache file, if the file
+ *   was missing or stale.
+ *
+ ****************************************************************************/
+
+void modlib_prelink_save(FAR struct mod_loadinfo_s *loadinfo);
+
+/****************************************************************************
+ * Name: modlib_prelink_free
+ *
+ * Description:
+ *   Release the symbol resolution cache of a load.
+ *
+ ****************************************************************************/
+
+void modlib_prelink_free(FAR struct mod_loadinfo_s *loadinfo);
+
+#endif /* CONFIG_MODLIB_PRELINK */
+
 #ifdef CONFIG_ARCH_ADDRENV
 
 /****************************************************************************
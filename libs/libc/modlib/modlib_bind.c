@@ -187,12 +187,10 @@ static int modlib_relocate(FAR struct module_s *modp,
   FAR Elf_SymCache *cache;
   FAR Elf_Sym      *sym;
   FAR dq_entry_t   *e;
-  dq_queue_t        q;
   uintptr_t         addr;
   int               symidx;
   int               ret = OK;
   int               i;
-  int               j;
 
   /* Define potential architecture specific elf data container */
 
@@ -205,14 +203,12 @@ static int modlib_relocate(FAR struct module_s *modp,
       return -ENOMEM;
     }
 
-  dq_init(&q);
-
   /* Examine each relocation in the section.  'relsec' is the section
    * containing the relations.  'dstsec' is the section containing the data
    * to be relocated.
    */
 
-  for (i = j = 0; i < relsec->sh_size / sizeof(Elf_Rel); i++)
+  for (i = 0; i < relsec->sh_size / sizeof(Elf_Rel); i++)
     {
       /* Read the relocation entry into memory */
 
@@ -237,16 +233,18 @@ static int modlib_relocate(FAR struct module_s *modp,
 
       symidx = ELF_R_SYM(rel->r_info);
 
-      /* First try the cache */
+      /* First try the cache, it is shared by all the relocation sections
+       * of the module, since the symbol values don't depend on them.
+       */
 
       sym = NULL;
-      for (e = dq_peek(&q); e; e = dq_next(e))
+      for (e = dq_peek(&loadinfo->symcache); e; e = dq_next(e))
         {
           cache = (FAR Elf_SymCache *)e;
           if (cache->idx == symidx)
             {
-              dq_rem(&cache->entry, &q);
-              dq_addfirst(&cache->entry, &q);
+              dq_rem(&cache->entry, &loadinfo->symcache);
+              dq_addfirst(&cache->entry, &loadinfo->symcache);
               sym = &cache->sym;
               break;
             }
@@ -258,7 +256,7 @@ static int modlib_relocate(FAR struct module_s *modp,
 
       if (sym == NULL)
         {
-          if (j < CONFIG_MODLIB_SYMBOL_CACHECOUNT)
+          if (loadinfo->nsymcache < CONFIG_MODLIB_SYMBOL_CACHECOUNT)
             {
               cache = lib_malloc(sizeof(Elf_SymCache));
               if (!cache)
@@ -268,11 +266,11 @@ static int modlib_relocate(FAR struct module_s *modp,
                   break;
                 }
 
-              j++;
+              loadinfo->nsymcache++;
             }
           else
             {
-              cache = (FAR Elf_SymCache *)dq_remlast(&q);
+              cache = (FAR Elf_SymCache *)dq_remlast(&loadinfo->symcache);
             }
 
           sym = &cache->sym;
@@ -286,6 +284,7 @@ static int modlib_relocate(FAR struct module_s *modp,
               berr("ERROR: Section %d reloc %d: "
                    "Failed to read symbol[%d]: %d\n",
                    relidx, i, symidx, ret);
+              loadinfo->nsymcache--;
               lib_free(cache);
               break;
             }
@@ -318,13 +317,14 @@ static int modlib_relocate(FAR struct module_s *modp,
                   berr("ERROR: Section %d reloc %d: "
                        "Failed to get value of symbol[%d]: %d\n",
                        relidx, i, symidx, ret);
+                  loadinfo->nsymcache--;
                   lib_free(cache);
                   break;
                 }
             }
 
           cache->idx = symidx;
-          dq_addfirst(&cache->entry, &q);
+          dq_addfirst(&cache->entry, &loadinfo->symcache);
         }
 
       if (sym->st_shndx == SHN_UNDEF && sym->st_name == 0)
@@ -416,12 +416,6 @@ static int modlib_relocate(FAR struct module_s *modp,
     }
 
   lib_free(rels);
-  while ((e = dq_peek(&q)) != NULL)
-    {
-      dq_rem(e, &q);
-      lib_free(e);
-    }
-
   return ret;
 }
 
@@ -438,12 +432,10 @@ static int modlib_relocateadd(FAR struct module_s *modp,
   FAR Elf_SymCache *cache;
   FAR Elf_Sym      *sym;
   FAR dq_entry_t   *e;
-  dq_queue_t        q;
   uintptr_t         addr;
   int               symidx;
   int               ret = OK;
   int               i;
-  int               j;
 
   /* Define potential architecture specific elf data container */
 
@@ -457,14 +449,12 @@ static int modlib_relocateadd(FAR struct module_s *modp,
       return -ENOMEM;
     }
 
-  dq_init(&q);
-
   /* Examine each relocation in the section.  'relsec' is the section
    * containing the relations.  'dstsec' is the section containing the data
    * to be relocated.
    */
 
-  for (i = j = 0; i < relsec->sh_size / sizeof(Elf_Rela); i++)
+  for (i = 0; i < relsec->sh_size / sizeof(Elf_Rela); i++)
     {
       /* Read the relocation entry into memory */
 
@@ -489,16 +479,18 @@ static int modlib_relocateadd(FAR struct module_s *modp,
 
       symidx = ELF_R_SYM(rela->r_info);
 
-      /* First try the cache */
+      /* First try the cache, it is shared by all the relocation sections
+       * of the module, since the symbol values don't depend on them.
+       */
 
       sym = NULL;
-      for (e = dq_peek(&q); e; e = dq_next(e))
+      for (e = dq_peek(&loadinfo->symcache); e; e = dq_next(e))
         {
           cache = (FAR Elf_SymCache *)e;
           if (cache->idx == symidx)
             {
-              dq_rem(&cache->entry, &q);
-              dq_addfirst(&cache->entry, &q);
+              dq_rem(&cache->entry, &loadinfo->symcache);
+              dq_addfirst(&cache->entry, &loadinfo->symcache);
               sym = &cache->sym;
               break;
             }
@@ -510,7 +502,7 @@ static int modlib_relocateadd(FAR struct module_s *modp,
 
       if (sym == NULL)
         {
-          if (j < CONFIG_MODLIB_SYMBOL_CACHECOUNT)
+          if (loadinfo->nsymcache < CONFIG_MODLIB_SYMBOL_CACHECOUNT)
             {
               cache = lib_malloc(sizeof(Elf_SymCache));
               if (!cache)
@@ -520,11 +512,11 @@ static int modlib_relocateadd(FAR struct module_s *modp,
                   break;
                 }
 
-              j++;
+              loadinfo->nsymcache++;
             }
           else
             {
-              cache = (FAR Elf_SymCache *)dq_remlast(&q);
+              cache = (FAR Elf_SymCache *)dq_remlast(&loadinfo->symcache);
             }
 
           sym = &cache->sym;
@@ -538,6 +530,7 @@ static int modlib_relocateadd(FAR struct module_s *modp,
               berr("ERROR: Section %d reloc %d: "
                    "Failed to read symbol[%d]: %d\n",
                    relidx, i, symidx, ret);
+              loadinfo->nsymcache--;
               lib_free(cache);
               break;
             }
@@ -570,13 +563,14 @@ static int modlib_relocateadd(FAR struct module_s *modp,
                   berr("ERROR: Section %d reloc %d: "
                        "Failed to get value of symbol[%d]: %d\n",
                        relidx, i, symidx, ret);
+                  loadinfo->nsymcache--;
                   lib_free(cache);
                   break;
                 }
             }
 
           cache->idx = symidx;
-          dq_addfirst(&cache->entry, &q);
+          dq_addfirst(&cache->entry, &loadinfo->symcache);
         }
 
       if (sym->st_shndx == SHN_UNDEF && sym->st_name == 0)
@@ -612,12 +606,6 @@ static int modlib_relocateadd(FAR struct module_s *modp,
     }
 
   lib_free(relas);
-  while ((e = dq_peek(&q)) != NULL)
-    {
-      dq_rem(e, &q);
-      lib_free(e);
-    }
-
   return ret;
 }
 
@@ -941,6 +929,13 @@ int modlib_bind(FAR struct module_s *modp,
       return ret;
     }
 
+#ifdef CONFIG_MODLIB_PRELINK
+  if (loadinfo->ehdr.e_type == ET_REL)
+    {
+      modlib_prelink_load(modp, loadinfo, exports, nexports);
+    }
+#endif
+
   /* Process relocations in every allocated section */
 
   for (i = 1; i < loadinfo->ehdr.e_shnum; i++)
@@ -1048,6 +1043,12 @@ int modlib_bind(FAR struct module_s *modp,
 
   modp->xipbase = loadinfo->xipbase;
 
+#ifdef CONFIG_MODLIB_PRELINK
+  /* Everything resolved, let the next load of the binary skip the lookups */
+
+  modlib_prelink_save(loadinfo);
+#endif
+
   /* Ensure that the I and D caches are coherent before starting the newly
    * loaded module by cleaning the D cache (i.e., flushing the D cache
    * contents to memory and invalidating the I cache).
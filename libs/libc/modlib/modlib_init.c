@@ -76,6 +76,14 @@ static inline int modlib_fileinfo(FAR struct mod_loadinfo_s *loadinfo)
   loadinfo->fileuid  = buf.st_uid;
   loadinfo->filegid  = buf.st_gid;
   loadinfo->filemode = buf.st_mode;
+#if defined(CONFIG_MODLIB_SHARED_TEXT) || defined(CONFIG_MODLIB_PRELINK)
+  loadinfo->filemtime = buf.st_mtim;
+#endif
+#ifdef CONFIG_MODLIB_SHARED_TEXT
+  loadinfo->filedev   = buf.st_dev;
+  loadinfo->fileino   = buf.st_ino;
+#endif
+
   return OK;
 }
 
@@ -106,6 +114,9 @@ int modlib_initialize(FAR const char *filename,
   /* Clear the load info structure */
 
   memset(loadinfo, 0, sizeof(struct mod_loadinfo_s));
+#if defined(CONFIG_MODLIB_SHARED_TEXT) || defined(CONFIG_MODLIB_PRELINK)
+  loadinfo->filename = filename;
+#endif
 
   /* Open the binary file for reading (only) */
 
@@ -275,6 +275,59 @@ static int modlib_vma2lma(FAR struct mod_loadinfo_s *loadinfo,
 }
 #endif
 
+/****************************************************************************
+ * Name: modlib_xipbase
+ *
+ * Description:
+ *   Check whether the text of a position independent binary can be
+ *   executed in place from the memory mapped storage holding the file, e.g.
+ *   romfs on NOR flash or on a RAM disk.  That needs every text section to
+ *   be present in the file at an address meeting its alignment.  If so,
+ *   loadinfo->xipbase is set and only the data is loaded to RAM, otherwise
+ *   it is left zero and the text is copied as usual.
+ *
+ ****************************************************************************/
+
+static void modlib_xipbase(FAR struct mod_loadinfo_s *loadinfo)
+{
+  uintptr_t xipbase = 0;
+  int i;
+
+  if (ioctl(loadinfo->filfd, FIOC_XIPBASE, (unsigned long)&xipbase) < 0 ||
+      xipbase == 0)
+    {
+      return;
+    }
+
+  for (i = 0; i < loadinfo->ehdr.e_shnum; i++)
+    {
+      FAR Elf_Shdr *shdr = &loadinfo->shdr[i];
+
+      /* Only the sections which would go to the text region matter */
+
+      if ((shdr->sh_flags & SHF_ALLOC) == 0 || shdr->sh_size == 0 ||
+          (shdr->sh_flags & SHF_WRITE) != 0
+#ifdef CONFIG_ARCH_HAVE_TEXT_HEAP_WORD_ALIGNED_READ
+          || (shdr->sh_flags & SHF_EXECINSTR) == 0
+#endif
+          )
+        {
+          continue;
+        }
+
+      if (shdr->sh_type == SHT_NOBITS ||
+          (shdr->sh_addralign > 1 &&
+           (xipbase + shdr->sh_offset) % shdr->sh_addralign != 0))
+        {
+          binfo("Section %d can't be executed in place\n", i);
+          return;
+        }
+    }
+
+  binfo("Execute in place from %p\n", (FAR void *)xipbase);
+  loadinfo->xipbase = xipbase;
+}
+
 /****************************************************************************
  * Name: modlib_set_emptysect_vma
  *
@@ -419,10 +472,30 @@ static inline int modlib_loadfile(FAR struct mod_loadinfo_s *loadinfo)
                 }
             }
 
-          if ((shdr->sh_flags & SHF_WRITE) == 0 && loadinfo->xipbase != 0)
+          if (loadinfo->xipbase != 0 && pptr != &data &&
+              (shdr->sh_flags & SHF_WRITE) == 0)
+            {
+              /* Execute in place, the section is used where it lies in
+               * the file.  modlib_xipbase() checked the alignment.
+               */
+
+              if (pptr == &text)
+                {
+                  text = (FAR uint8_t *)(loadinfo->xipbase +
+                                         shdr->sh_offset);
+                }
+
+              goto skipload;
+            }
+
+#ifdef CONFIG_MODLIB_SHARED_TEXT
+          /* The shared text is already in place, only compute where */
+
+          if (pptr == &text && loadinfo->textshared)
             {
               goto skipload;
             }
+#endif
 
           /* SHT_NOBITS indicates that there is no data in the file for the
            * section.
@@ -554,11 +627,7 @@ int modlib_load(FAR struct mod_loadinfo_s *loadinfo)
   if (loadinfo->gotindex >= 0)
     {
       binfo("GOT section found! index %d\n", loadinfo->gotindex);
-      if (ioctl(loadinfo->filfd, FIOC_XIPBASE,
-                (unsigned long)&loadinfo->xipbase) >= 0)
-        {
-          binfo("can use xipbase %zu\n", loadinfo->xipbase);
-        }
+      modlib_xipbase(loadinfo);
     }
 
   /* Determine total size to allocate */
@@ -584,6 +653,13 @@ int modlib_load(FAR struct mod_loadinfo_s *loadinfo)
           loadinfo->textalloc = loadinfo->xipbase +
                                 loadinfo->shdr[1].sh_offset;
         }
+#    ifdef CONFIG_MODLIB_SHARED_TEXT
+      else if (modlib_textcache_get(loadinfo))
+        {
+          binfo("Share text %p with a loaded instance\n",
+                (FAR void *)loadinfo->textalloc);
+        }
+#    endif
       else if (loadinfo->textsize > 0)
         {
 #    ifdef CONFIG_ARCH_USE_TEXT_HEAP
@@ -653,6 +729,15 @@ int modlib_load(FAR struct mod_loadinfo_s *loadinfo)
       goto errout_with_buffers;
     }
 
+#ifdef CONFIG_MODLIB_SHARED_TEXT
+  /* The text is complete now, later instances may use it */
+
+  if (!loadinfo->textshared)
+    {
+      modlib_textcache_add(loadinfo);
+    }
+#endif
+
 #ifdef CONFIG_MODLIB_EXIDX_SECTNAME
   ret = modlib_findsection(loadinfo, CONFIG_MODLIB_EXIDX_SECTNAME);
   if (ret < 0)
@@ -710,11 +795,7 @@ int modlib_load_with_addrenv(FAR struct mod_loadinfo_s *loadinfo)
   if (loadinfo->gotindex >= 0)
     {
       binfo("GOT section found! index %d\n", loadinfo->gotindex);
-      if (ioctl(loadinfo->filfd, FIOC_XIPBASE,
-                (unsigned long)&loadinfo->xipbase) >= 0)
-        {
-          binfo("can use xipbase %zu\n", loadinfo->xipbase);
-        }
+      modlib_xipbase(loadinfo);
     }
 
   /* Determine total size to allocate */
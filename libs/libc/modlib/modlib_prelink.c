@@ -0,0 +1,566 @@
+/****************************************************************************
+ * libs/libc/modlib/modlib_prelink.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <debug.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/lib/lib.h>
+#include <nuttx/lib/modlib.h>
+#include <nuttx/symtab.h>
+
+#include "libc.h"
+#include "modlib/modlib.h"
+
+#ifdef CONFIG_MODLIB_PRELINK
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MODLIB_PRELINK_MAGIC   0x4b4e4c50  /* "PLNK" */
+#define MODLIB_PRELINK_SUFFIX  ".prelink"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The cache file is a header followed by the entries sorted by name, with
+ * no duplicates.  It is only ever read back by the system that wrote it.
+ */
+
+struct mod_prelink_hdr_s
+{
+  uint32_t magic;               /* MODLIB_PRELINK_MAGIC */
+  uint32_t symhash;             /* Hash of the base symbol table */
+  uint32_t filelen;             /* Size of the binary */
+  uint32_t nentries;            /* Number of entries that follow */
+  int64_t  mtime_sec;           /* Modification time of the binary */
+  int32_t  mtime_nsec;
+  uint32_t checksum;            /* FNV hash of the entries */
+};
+
+struct mod_prelink_entry_s
+{
+  uintptr_t value;              /* Value in the base symbol table */
+  Elf_Word  name;               /* Offset of the name in the strtab */
+};
+
+struct mod_prelink_s
+{
+  uint32_t symhash;             /* Hash of the base symbol table */
+  bool     valid;               /* Entries come from a valid cache file */
+  uint32_t nentries;            /* Number of entries in use */
+  uint32_t nalloc;              /* Number of entries allocated */
+  FAR struct mod_prelink_entry_s *entries;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The hash of the base symbol table is computed once, protected by the
+ * registry lock.
+ */
+
+static FAR const struct symtab_s *g_prelink_symtab;
+static int g_prelink_nsymbols;
+static uint32_t g_prelink_symhash;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: modlib_prelink_fnv
+ ****************************************************************************/
+
+static uint32_t modlib_prelink_fnv(uint32_t hash, FAR const void *data,
+                                   size_t len)
+{
+  FAR const uint8_t *ptr = data;
+
+  while (len-- > 0)
+    {
+      hash = (hash ^ *ptr++) * 16777619u;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: modlib_prelink_symhash
+ *
+ * Description:
+ *   Hash the names and values of the base symbol table, so a cache file
+ *   written against another kernel image is not used.
+ *
+ ****************************************************************************/
+
+static uint32_t modlib_prelink_symhash(FAR const struct symtab_s *exports,
+                                       int nexports)
+{
+  uint32_t hash;
+  int i;
+
+  modlib_registry_lock();
+  if (g_prelink_symtab != exports || g_prelink_nsymbols != nexports)
+    {
+      hash = 2166136261u;
+      for (i = 0; i < nexports; i++)
+        {
+          hash = modlib_prelink_fnv(hash, exports[i].sym_name,
+                                    strlen(exports[i].sym_name) + 1);
+          hash = modlib_prelink_fnv(hash, &exports[i].sym_value,
+                                    sizeof(exports[i].sym_value));
+        }
+
+      g_prelink_symtab   = exports;
+      g_prelink_nsymbols = nexports;
+      g_prelink_symhash  = hash;
+    }
+
+  hash = g_prelink_symhash;
+  modlib_registry_unlock();
+  return hash;
+}
+
+/****************************************************************************
+ * Name: modlib_prelink_modcallback
+ *
+ * Description:
+ *   modlib_registry_foreach() callback function.  Stop at the first
+ *   installed module that exports symbols.
+ *
+ ****************************************************************************/
+
+static int modlib_prelink_modcallback(FAR struct module_s *modp,
+                                      FAR void *arg)
+{
+  return modp != arg && modp->modinfo.nexports > 0 ? 1 : 0;
+}
+
+/****************************************************************************
+ * Name: modlib_prelink_path
+ *
+ * Description:
+ *   Get the path of the cache file in CONFIG_MODLIB_PRELINK_DIR.  The full
+ *   path of the binary, with '/' replaced by '_', names the file, so two
+ *   binaries of the same name do not evict each other.
+ *
+ ****************************************************************************/
+
+static FAR char *modlib_prelink_path(FAR struct mod_loadinfo_s *loadinfo)
+{
+  FAR const char *dir = CONFIG_MODLIB_PRELINK_DIR;
+  FAR char *path;
+  FAR char *ptr;
+  int len;
+
+  if (dir[0] == '\0')
+    {
+      return NULL;
+    }
+
+  path = lib_get_pathbuffer();
+  if (path == NULL)
+    {
+      return NULL;
+    }
+
+  len = snprintf(path, PATH_MAX, "%s/%s" MODLIB_PRELINK_SUFFIX, dir,
+                 loadinfo->filename);
+  if (len >= PATH_MAX)
+    {
+      lib_put_pathbuffer(path);
+      return NULL;
+    }
+
+  for (ptr = path + strlen(dir) + 1; *ptr != '\0'; ptr++)
+    {
+      if (*ptr == '/')
+        {
+          *ptr = '_';
+        }
+    }
+
+  return path;
+}
+
+/****************************************************************************
+ * Name: modlib_prelink_compare
+ ****************************************************************************/
+
+static int modlib_prelink_compare(FAR const void *a, FAR const void *b)
+{
+  FAR const struct mod_prelink_entry_s *ea = a;
+  FAR const struct mod_prelink_entry_s *eb = b;
+
+  return ea->name < eb->name ? -1 : ea->name > eb->name;
+}
+
+/****************************************************************************
+ * Name: modlib_prelink_read
+ *
+ * Description:
+ *   Read the cache file, if it matches the binary and the symbol table.
+ *
+ ****************************************************************************/
+
+static int modlib_prelink_read(FAR struct mod_loadinfo_s *loadinfo,
+                               FAR struct mod_prelink_s *prelink,
+                               FAR const char *path)
+{
+  FAR struct mod_prelink_entry_s *entries;
+  struct mod_prelink_hdr_s hdr;
+  struct stat buf;
+  ssize_t nbytes;
+  size_t size;
+  uint32_t i;
+  int ret = -ENOENT;
+  int fd;
+
+  fd = _NX_OPEN(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    {
+      return ret;
+    }
+
+  nbytes = _NX_READ(fd, &hdr, sizeof(hdr));
+  if (nbytes != sizeof(hdr) ||
+      hdr.magic != MODLIB_PRELINK_MAGIC ||
+      hdr.symhash != prelink->symhash ||
+      hdr.filelen != (uint32_t)loadinfo->filelen ||
+      hdr.mtime_sec != loadinfo->filemtime.tv_sec ||
+      hdr.mtime_nsec != loadinfo->filemtime.tv_nsec)
+    {
+      binfo("Stale prelink cache %s\n", path);
+      goto out;
+    }
+
+  /* The entries must fill the rest of the file exactly, which also keeps
+   * the size below from overflowing.
+   */
+
+  if (_NX_STAT(fd, &buf) < 0 || buf.st_size < sizeof(hdr) ||
+      hdr.nentries == 0 ||
+      hdr.nentries != (buf.st_size - sizeof(hdr)) /
+                      sizeof(struct mod_prelink_entry_s) ||
+      (buf.st_size - sizeof(hdr)) % sizeof(struct mod_prelink_entry_s))
+    {
+      berr("ERROR: Bad prelink cache size %s\n", path);
+      goto out;
+    }
+
+  size    = sizeof(struct mod_prelink_entry_s) * hdr.nentries;
+  entries = lib_malloc(size);
+  if (entries == NULL)
+    {
+      ret = -ENOMEM;
+      goto out;
+    }
+
+  nbytes = _NX_READ(fd, entries, size);
+  if (nbytes != size ||
+      modlib_prelink_fnv(2166136261u, entries, size) != hdr.checksum)
+    {
+      berr("ERROR: Corrupted prelink cache %s\n", path);
+      lib_free(entries);
+      goto out;
+    }
+
+  /* bsearch() needs the names strictly ascending */
+
+  for (i = 1; i < hdr.nentries; i++)
+    {
+      if (entries[i - 1].name >= entries[i].name)
+        {
+          berr("ERROR: Unsorted prelink cache %s\n", path);
+          lib_free(entries);
+          goto out;
+        }
+    }
+
+  prelink->entries  = entries;
+
+  prelink->nentries = hdr.nentries;
+  prelink->nalloc   = hdr.nentries;
+  prelink->valid    = true;
+  ret = OK;
+
+out:
+  _NX_CLOSE(fd);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: modlib_prelink_load
+ *
+ * Description:
+ *   Prepare the symbol resolution cache of a load, reading the cache file
+ *   of the binary if it is still valid.
+ *
+ ****************************************************************************/
+
+void modlib_prelink_load(FAR struct module_s *modp,
+                         FAR struct mod_loadinfo_s *loadinfo,
+                         FAR const struct symtab_s *exports, int nexports)
+{
+  FAR struct mod_prelink_s *prelink;
+  FAR char *path;
+
+  if (loadinfo->filename == NULL || loadinfo->prelink != NULL)
+    {
+      return;
+    }
+
+  /* An installed module that exports symbols takes precedence over the
+   * base symbol table, the cache only holds what the base table gave.  Go
+   * through the normal lookup while any such module is installed.
+   */
+
+  if (modlib_registry_foreach(modlib_prelink_modcallback, modp) != 0)
+    {
+      return;
+    }
+
+  prelink = lib_zalloc(sizeof(*prelink));
+  if (prelink == NULL)
+    {
+      return;
+    }
+
+  prelink->symhash  = modlib_prelink_symhash(exports, nexports);
+  loadinfo->prelink = prelink;
+
+  path = modlib_prelink_path(loadinfo);
+  if (path != NULL)
+    {
+      if (modlib_prelink_read(loadinfo, prelink, path) >= 0)
+        {
+          binfo("Using prelink cache %s, %" PRIu32 " symbols\n",
+                path, prelink->nentries);
+        }
+
+      lib_put_pathbuffer(path);
+    }
+}
+
+/****************************************************************************
+ * Name: modlib_prelink_find
+ *
+ * Description:
+ *   Look up the value of an undefined symbol by the offset of its name.
+ *
+ * Returned Value:
+ *   true if the cache holds the symbol.
+ *
+ ****************************************************************************/
+
+bool modlib_prelink_find(FAR struct mod_loadinfo_s *loadinfo,
+                         Elf_Word name, FAR uintptr_t *value)
+{
+  FAR struct mod_prelink_s *prelink = loadinfo->prelink;
+  FAR struct mod_prelink_entry_s *entry;
+  struct mod_prelink_entry_s key;
+
+  if (prelink == NULL || !prelink->valid)
+    {
+      return false;
+    }
+
+  key.name = name;
+  entry = bsearch(&key, prelink->entries, prelink->nentries,
+                  sizeof(key), modlib_prelink_compare);
+  if (entry == NULL)
+    {
+      return false;
+    }
+
+  *value = entry->value;
+  return true;
+}
+
+/****************************************************************************
+ * Name: modlib_prelink_record
+ *
+ * Description:
+ *   Remember the value of an undefined symbol resolved from the base
+ *   symbol table, to be written by modlib_prelink_save().  The same symbol
+ *   may be recorded more than once, modlib_prelink_save() drops the
+ *   duplicates.
+ *
+ ****************************************************************************/
+
+void modlib_prelink_record(FAR struct mod_loadinfo_s *loadinfo,
+                           Elf_Word name, uintptr_t value)
+{
+  FAR struct mod_prelink_s *prelink = loadinfo->prelink;
+  FAR struct mod_prelink_entry_s *entries;
+
+  if (prelink == NULL || prelink->valid)
+    {
+      return;
+    }
+
+  if (prelink->nentries == prelink->nalloc)
+    {
+      uint32_t nalloc = prelink->nalloc ? prelink->nalloc * 2 : 64;
+
+      entries = lib_realloc(prelink->entries, sizeof(*entries) * nalloc);
+      if (entries == NULL)
+        {
+          return;
+        }
+
+      /* The entries are written to the cache file as they are, clear the
+       * tail padding of the new ones.
+       */
+
+      memset(entries + prelink->nalloc, 0,
+             sizeof(*entries) * (nalloc - prelink->nalloc));
+
+      prelink->entries = entries;
+      prelink->nalloc  = nalloc;
+    }
+
+  prelink->entries[prelink->nentries].name  = name;
+  prelink->entries[prelink->nentries].value = value;
+  prelink->nentries++;
+}
+
+/****************************************************************************
+ * Name: modlib_prelink_save
+ *
+ * Description:
+ *   Write the symbols resolved by this load to the cache file, if the file
+ *   was missing or stale.  Failures are not reported, the file system may
+ *   well be read-only.
+ *
+ ****************************************************************************/
+
+void modlib_prelink_save(FAR struct mod_loadinfo_s *loadinfo)
+{
+  FAR struct mod_prelink_s *prelink = loadinfo->prelink;
+  FAR struct mod_prelink_entry_s *entries;
+  struct mod_prelink_hdr_s hdr;
+  FAR char *path;
+  uint32_t i;
+  uint32_t j;
+  size_t size;
+  int fd;
+
+  if (prelink == NULL || prelink->valid || prelink->nentries == 0)
+    {
+      return;
+    }
+
+  path = modlib_prelink_path(loadinfo);
+  if (path == NULL)
+    {
+      return;
+    }
+
+  fd = _NX_OPEN(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0)
+    {
+      binfo("Cannot create prelink cache %s\n", path);
+      lib_put_pathbuffer(path);
+      return;
+    }
+
+  entries = prelink->entries;
+  qsort(entries, prelink->nentries, sizeof(struct mod_prelink_entry_s),
+        modlib_prelink_compare);
+
+  for (i = 0, j = 1; j < prelink->nentries; j++)
+    {
+      if (entries[j].name != entries[i].name)
+        {
+          entries[++i] = entries[j];
+        }
+    }
+
+  prelink->nentries = i + 1;
+  size = sizeof(struct mod_prelink_entry_s) * prelink->nentries;
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic      = MODLIB_PRELINK_MAGIC;
+  hdr.symhash    = prelink->symhash;
+  hdr.filelen    = loadinfo->filelen;
+  hdr.nentries   = prelink->nentries;
+  hdr.mtime_sec  = loadinfo->filemtime.tv_sec;
+  hdr.mtime_nsec = loadinfo->filemtime.tv_nsec;
+  hdr.checksum   = modlib_prelink_fnv(2166136261u, entries, size);
+
+  /* A short file is rejected by the next load, no need to clean it up */
+
+  if (_NX_WRITE(fd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+      _NX_WRITE(fd, prelink->entries, size) == size)
+    {
+      binfo("Wrote prelink cache %s, %" PRIu32 " symbols\n",
+            path, prelink->nentries);
+    }
+
+  _NX_CLOSE(fd);
+  lib_put_pathbuffer(path);
+}
+
+/****************************************************************************
+ * Name: modlib_prelink_free
+ *
+ * Description:
+ *   Release the symbol resolution cache of a load.
+ *
+ ****************************************************************************/
+
+void modlib_prelink_free(FAR struct mod_loadinfo_s *loadinfo)
+{
+  FAR struct mod_prelink_s *prelink = loadinfo->prelink;
+
+  if (prelink != NULL)
+    {
+      lib_free(prelink->entries);
+      lib_free(prelink);
+      loadinfo->prelink = NULL;
+    }
+}
+
+#endif /* CONFIG_MODLIB_PRELINK */
@@ -31,6 +31,8 @@
 #include <nuttx/lib/lib.h>
 #include <nuttx/lib/modlib.h>
 
+#include "modlib/modlib.h"
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -132,7 +134,11 @@ int modlib_uninit(FAR struct module_s *modp)
           modp->sectalloc = NULL;
           modp->nsect = 0;
 #else
-          if (modp->xipbase == 0)
+          if (modp->xipbase == 0
+#  ifdef CONFIG_MODLIB_SHARED_TEXT
+              && !modlib_textcache_release((uintptr_t)modp->textalloc)
+#  endif
+              )
             {
 #  if defined(CONFIG_ARCH_USE_TEXT_HEAP)
               up_textheap_free((FAR void *)modp->textalloc);
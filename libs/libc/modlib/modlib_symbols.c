@@ -57,6 +57,9 @@ struct mod_exportinfo_s
   FAR const char *name;              /* Symbol name to find */
   FAR struct module_s *modp;         /* The module that needs the symbol */
   FAR const struct symtab_s *symbol; /* Symbol info returned (if found) */
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+  uint32_t hash;                     /* Hash value of the name */
+#endif
 };
 
 struct eptable_s
@@ -72,15 +75,69 @@ struct eptable_s
 extern struct eptable_s global_table[];
 extern int nglobals;
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+/* Hash index of the base symbol table, protected by the registry lock */
+
+static FAR const struct symtab_s *g_hashed_symtab;
+static int g_hashed_nsymbols;
+static FAR struct mod_symhash_s *g_symtab_hash;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: modlib_loadstrtab
+ *
+ * Description:
+ *   Read the whole symbol string table into loadinfo->strtab.
+ *
+ * Returned Value:
+ *   0 (OK) is returned on success and a negated errno is returned on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MODLIB_LOAD_STRTAB
+static int modlib_loadstrtab(FAR struct mod_loadinfo_s *loadinfo)
+{
+  FAR Elf_Shdr *strtab = &loadinfo->shdr[loadinfo->strtabidx];
+  int ret;
+
+  /* One extra byte terminates a corrupted last string */
+
+  loadinfo->strtab = lib_malloc(strtab->sh_size + 1);
+  if (loadinfo->strtab == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  ret = modlib_read(loadinfo, (FAR uint8_t *)loadinfo->strtab,
+                    strtab->sh_size, strtab->sh_offset);
+  if (ret < 0)
+    {
+      berr("ERROR: Failed to read string table: %d\n", ret);
+      lib_free(loadinfo->strtab);
+      loadinfo->strtab = NULL;
+      return ret;
+    }
+
+  loadinfo->strtab[strtab->sh_size] = '\0';
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: modlib_symname
  *
  * Description:
- *   Get the symbol name in loadinfo->iobuffer[].
+ *   Get the symbol name, either from the string table loaded in memory or
+ *   read into loadinfo->iobuffer[].
  *
  * Returned Value:
  *   0 (OK) is returned on success and a negated errno is returned on
@@ -93,8 +150,12 @@ extern int nglobals;
  ****************************************************************************/
 
 static int modlib_symname(FAR struct mod_loadinfo_s *loadinfo,
-                          FAR const Elf_Sym *sym, Elf_Off sh_offset)
+                          FAR const Elf_Sym *sym, Elf_Off sh_offset,
+                          FAR const char **name)
 {
+#ifdef CONFIG_MODLIB_LOAD_STRTAB
+  FAR Elf_Shdr *strtab = &loadinfo->shdr[loadinfo->strtabidx];
+#endif
   FAR uint8_t *buffer;
   off_t  offset;
   size_t readlen;
@@ -111,6 +172,33 @@ static int modlib_symname(FAR struct mod_loadinfo_s *loadinfo,
       return -ESRCH;
     }
 
+#ifdef CONFIG_MODLIB_LOAD_STRTAB
+  /* Use the string table in memory if the name lies there, fall back to
+   * reading the file if the table could not be loaded.
+   */
+
+  if (loadinfo->strtabidx != 0 && strtab->sh_offset == sh_offset)
+    {
+      if (loadinfo->strtab == NULL)
+        {
+          modlib_loadstrtab(loadinfo);
+        }
+
+      if (loadinfo->strtab != NULL)
+        {
+          if (sym->st_name >= strtab->sh_size)
+            {
+              berr("ERROR: Bad symbol name offset: %" PRIu32 "\n",
+                   (uint32_t)sym->st_name);
+              return -EINVAL;
+            }
+
+          *name = loadinfo->strtab + sym->st_name;
+          return OK;
+        }
+    }
+#endif
+
   /* Allocate an I/O buffer.  This buffer is used by mod_symname() to
    * accumulate the variable length symbol name.
    */
@@ -162,6 +250,7 @@ static int modlib_symname(FAR struct mod_loadinfo_s *loadinfo,
         {
           /* Yes, the buffer contains a NUL terminator. */
 
+          *name = (FAR const char *)loadinfo->iobuffer;
           return OK;
         }
 
@@ -203,9 +292,21 @@ static int modlib_symcallback(FAR struct module_s *modp, FAR void *arg)
 
   /* Check if this module exports a symbol of that name */
 
-  exportinfo->symbol = symtab_findbyname(modp->modinfo.exports,
-                                         exportinfo->name,
-                                         modp->modinfo.nexports);
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+  if (modp->exphash != NULL)
+    {
+      exportinfo->symbol = modlib_symhash_find(modp->exphash,
+                                               modp->modinfo.exports,
+                                               exportinfo->name,
+                                               exportinfo->hash);
+    }
+  else
+#endif
+    {
+      exportinfo->symbol = symtab_findbyname(modp->modinfo.exports,
+                                             exportinfo->name,
+                                             modp->modinfo.nexports);
+    }
 
   if (exportinfo->symbol != NULL)
     {
@@ -228,6 +329,58 @@ static int modlib_symcallback(FAR struct module_s *modp, FAR void *arg)
   return SYM_NOT_FOUND;
 }
 
+/****************************************************************************
+ * Name: modlib_findexport
+ *
+ * Description:
+ *   Find a symbol in the base symbol table.
+ *
+ * Returned Value:
+ *   The symbol on success, NULL if the symbol table doesn't hold the name.
+ *
+ ****************************************************************************/
+
+static FAR const struct symtab_s *
+modlib_findexport(FAR struct mod_exportinfo_s *exportinfo,
+                  FAR const struct symtab_s *exports, int nexports)
+{
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+  FAR const struct symtab_s *symbol;
+
+  /* Index the table on first use, or again if another one was selected.
+   * If there is no memory for the index, the linear search still works.
+   */
+
+  modlib_registry_lock();
+  if (g_hashed_symtab != exports || g_hashed_nsymbols != nexports)
+    {
+      if (g_symtab_hash != NULL)
+        {
+          lib_free(g_symtab_hash);
+        }
+
+      g_symtab_hash     = modlib_symhash_alloc(exports, nexports);
+      g_hashed_symtab   = exports;
+      g_hashed_nsymbols = nexports;
+    }
+
+  if (g_symtab_hash != NULL)
+    {
+      symbol = modlib_symhash_find(g_symtab_hash, exports,
+                                   exportinfo->name, exportinfo->hash);
+    }
+  else
+    {
+      symbol = symtab_findbyname(exports, exportinfo->name, nexports);
+    }
+
+  modlib_registry_unlock();
+  return symbol;
+#else
+  return symtab_findbyname(exports, exportinfo->name, nexports);
+#endif
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -344,7 +497,11 @@ int modlib_symvalue(FAR struct module_s *modp,
 {
   FAR const struct symtab_s *symbol;
   struct mod_exportinfo_s exportinfo;
+  FAR const char *name;
   uintptr_t secbase;
+#ifdef CONFIG_MODLIB_PRELINK
+  uintptr_t value;
+#endif
   int ret;
 
   switch (sym->st_shndx)
@@ -367,9 +524,19 @@ int modlib_symvalue(FAR struct module_s *modp,
 
     case SHN_UNDEF:
       {
+#ifdef CONFIG_MODLIB_PRELINK
+        /* A previous load of the binary may have resolved it already */
+
+        if (modlib_prelink_find(loadinfo, sym->st_name, &value))
+          {
+            sym->st_value += value;
+            break;
+          }
+#endif
+
         /* Get the name of the undefined symbol */
 
-        ret = modlib_symname(loadinfo, sym, sh_offset);
+        ret = modlib_symname(loadinfo, sym, sh_offset, &name);
         if (ret < 0)
           {
             /* There are a few relocations for a few architectures that do
@@ -388,9 +555,12 @@ int modlib_symvalue(FAR struct module_s *modp,
          * recently installed will take precedence.
          */
 
-        exportinfo.name   = (FAR const char *)loadinfo->iobuffer;
+        exportinfo.name   = name;
         exportinfo.modp   = modp;
         exportinfo.symbol = NULL;
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+        exportinfo.hash   = modlib_symhash(name);
+#endif
 
         ret = modlib_registry_foreach(modlib_symcallback,
                                       (FAR void *)&exportinfo);
@@ -408,8 +578,14 @@ int modlib_symvalue(FAR struct module_s *modp,
 
         if (symbol == NULL)
           {
-            symbol = symtab_findbyname(exports, exportinfo.name,
-                                       nexports);
+            symbol = modlib_findexport(&exportinfo, exports, nexports);
+#ifdef CONFIG_MODLIB_PRELINK
+            if (symbol != NULL)
+              {
+                modlib_prelink_record(loadinfo, sym->st_name,
+                                      (uintptr_t)symbol->sym_value);
+              }
+#endif
           }
 
         /* Was the symbol found from any exporter? */
@@ -417,7 +593,7 @@ int modlib_symvalue(FAR struct module_s *modp,
         if (symbol == NULL)
           {
             berr("ERROR: SHN_UNDEF: Exported symbol \"%s\" not found\n",
-                 loadinfo->iobuffer);
+                 name);
             return -ENOENT;
           }
 
@@ -427,7 +603,7 @@ int modlib_symvalue(FAR struct module_s *modp,
 
         binfo("SHN_UNDEF: name=%s "
               "%08" PRIxPTR "+%08" PRIxPTR "=%08" PRIxPTR "\n",
-              loadinfo->iobuffer,
+              name,
               (uintptr_t)sym->st_value, (uintptr_t)symbol->sym_value,
               (uintptr_t)(sym->st_value + (uintptr_t)symbol->sym_value));
 
@@ -483,6 +659,7 @@ int modlib_insertsymtab(FAR struct module_s *modp,
 {
   FAR struct symtab_s *symbol;
   FAR Elf_Shdr *strtab = &loadinfo->shdr[shdr->sh_link];
+  FAR const char *name;
   int ret = 0;
   int i;
   int j;
@@ -526,7 +703,8 @@ int modlib_insertsymtab(FAR struct module_s *modp,
                   ELF_ST_TYPE(sym[i].st_info) != STT_NOTYPE &&
                   ELF_ST_VISIBILITY(sym[i].st_other) == STV_DEFAULT)
                 {
-                  ret = modlib_symname(loadinfo, &sym[i], strtab->sh_offset);
+                  ret = modlib_symname(loadinfo, &sym[i], strtab->sh_offset,
+                                       &name);
                   if (ret < 0)
                     {
                       lib_free((FAR void *)modp->modinfo.exports);
@@ -534,8 +712,7 @@ int modlib_insertsymtab(FAR struct module_s *modp,
                       return ret;
                     }
 
-                  symbol[j].sym_name =
-                      strdup((FAR char *)loadinfo->iobuffer);
+                  symbol[j].sym_name = strdup(name);
                   symbol[j].sym_value =
                       (FAR const void *)(uintptr_t)sym[i].st_value;
                   j++;
@@ -545,6 +722,12 @@ int modlib_insertsymtab(FAR struct module_s *modp,
 #ifdef CONFIG_SYMTAB_ORDEREDBYNAME
           symtab_sortbyname(symbol, symcount);
 #endif
+
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+          /* Without the index the exports are still found linearly */
+
+          modp->exphash = modlib_symhash_alloc(symbol, symcount);
+#endif
         }
       else
         {
@@ -594,14 +777,15 @@ void *modlib_findglobal(FAR struct module_s *modp,
   int ret;
   struct eptable_s key;
   FAR struct eptable_s *res;
+  FAR const char *name;
 
-  ret = modlib_symname(loadinfo, sym, strtab->sh_offset);
+  ret = modlib_symname(loadinfo, sym, strtab->sh_offset, &name);
   if (ret < 0)
     {
       return NULL;
     }
 
-  key.epname = loadinfo->iobuffer;
+  key.epname = (FAR uint8_t *)name;
   res = bsearch(&key, global_table, nglobals,
                 sizeof(struct eptable_s), findep);
   if (res != NULL)
@@ -639,4 +823,12 @@ void modlib_freesymtab(FAR struct module_s *modp)
 
       lib_free((FAR void *)symbol);
     }
+
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+  if (modp->exphash != NULL)
+    {
+      lib_free(modp->exphash);
+      modp->exphash = NULL;
+    }
+#endif
 }
@@ -0,0 +1,169 @@
+/****************************************************************************
+ * libs/libc/modlib/modlib_symhash.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <debug.h>
+
+#include <nuttx/symtab.h>
+#include <nuttx/lib/modlib.h>
+
+#include "libc.h"
+#include "modlib/modlib.h"
+
+#ifdef CONFIG_MODLIB_SYMBOL_HASH
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The chains store "index + 1" so that zero can terminate them */
+
+struct mod_symhash_s
+{
+  uint32_t      nbuckets;   /* Number of buckets, a power of two */
+  FAR uint32_t *buckets;    /* First entry of each bucket */
+  FAR uint32_t *chain;      /* Next entry in the same bucket */
+  FAR uint32_t *hashes;     /* Full hash value of each entry */
+};
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: modlib_symhash
+ *
+ * Description:
+ *   Compute the hash value of a symbol name, this is the same function as
+ *   used by the GNU hash section.
+ *
+ ****************************************************************************/
+
+uint32_t modlib_symhash(FAR const char *name)
+{
+  uint32_t hash = 5381;
+
+  while (*name != '\0')
+    {
+      hash = (hash << 5) + hash + (uint8_t)*name++;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: modlib_symhash_alloc
+ *
+ * Description:
+ *   Build the hash index of a symbol table.  The symbol table itself is
+ *   not copied, it must stay valid as long as the index is used.
+ *
+ * Returned Value:
+ *   The new hash index on success, NULL if there is no memory.
+ *
+ ****************************************************************************/
+
+FAR struct mod_symhash_s *
+modlib_symhash_alloc(FAR const struct symtab_s *symtab, int nsyms)
+{
+  FAR struct mod_symhash_s *hash;
+  uint32_t nbuckets = 1;
+  uint32_t bucket;
+  int i;
+
+  /* Aim at two entries per bucket */
+
+  while (nbuckets * 2 < nsyms)
+    {
+      nbuckets <<= 1;
+    }
+
+  hash = lib_zalloc(sizeof(*hash) +
+                    sizeof(uint32_t) * (nbuckets + 2 * nsyms));
+  if (hash == NULL)
+    {
+      berr("ERROR: Failed to allocate hash for %d symbols\n", nsyms);
+      return NULL;
+    }
+
+  hash->nbuckets = nbuckets;
+  hash->buckets  = (FAR uint32_t *)(hash + 1);
+  hash->chain    = hash->buckets + nbuckets;
+  hash->hashes   = hash->chain + nsyms;
+
+  /* Insert backwards, so the first of several symbols with the same name
+   * is found first, as the linear search would do.
+   */
+
+  for (i = nsyms - 1; i >= 0; i--)
+    {
+      hash->hashes[i]       = modlib_symhash(symtab[i].sym_name);
+      bucket                = hash->hashes[i] & (nbuckets - 1);
+      hash->chain[i]        = hash->buckets[bucket];
+      hash->buckets[bucket] = i + 1;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: modlib_symhash_find
+ *
+ * Description:
+ *   Find the symbol with the given name and hash value (as returned by
+ *   modlib_symhash()) in a symbol table indexed by modlib_symhash_alloc().
+ *
+ * Returned Value:
+ *   The symbol on success, NULL if the symbol table doesn't hold the name.
+ *
+ ****************************************************************************/
+
+FAR const struct symtab_s *
+modlib_symhash_find(FAR const struct mod_symhash_s *hash,
+                    FAR const struct symtab_s *symtab,
+                    FAR const char *name, uint32_t hashval)
+{
+  uint32_t entry = hash->buckets[hashval & (hash->nbuckets - 1)];
+
+  while (entry != 0)
+    {
+      entry--;
+      if (hash->hashes[entry] == hashval &&
+          strcmp(symtab[entry].sym_name, name) == 0)
+        {
+          return &symtab[entry];
+        }
+
+      entry = hash->chain[entry];
+    }
+
+  return NULL;
+}
+
+#endif /* CONFIG_MODLIB_SYMBOL_HASH */
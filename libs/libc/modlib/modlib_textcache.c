@@ -0,0 +1,271 @@
+/****************************************************************************
+ * libs/libc/modlib/modlib_textcache.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <string.h>
+#include <debug.h>
+
+#include <nuttx/lib/modlib.h>
+
+#include "libc.h"
+#include "modlib/modlib.h"
+
+#ifdef CONFIG_MODLIB_SHARED_TEXT
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One shared text allocation.  NuttX file systems don't always report
+ * st_ino, so the path is part of the key.
+ */
+
+struct mod_textcache_s
+{
+  FAR struct mod_textcache_s *flink; /* Supports a singly linked list */
+  FAR char       *filename;          /* Path of the binary */
+  off_t           filelen;           /* Size of the binary */
+  struct timespec filemtime;         /* Modification time of the binary */
+  dev_t           filedev;           /* Device ID of the binary */
+  ino_t           fileino;           /* Serial number of the binary */
+  uintptr_t       textalloc;         /* The shared text allocation */
+  size_t          textsize;          /* Size of the text allocation */
+  int             crefs;             /* Number of loaded instances */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The list is protected by the registry lock */
+
+static FAR struct mod_textcache_s *g_textcache;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: modlib_textcache_shareable
+ *
+ * Description:
+ *   Only the text of position independent relocatable binaries is never
+ *   written by the relocations, binaries executed in place are already
+ *   shared.
+ *
+ *   Only modlib_relocate() (SHT_REL) routes the relocations through the
+ *   GOT and skips the read-only sections.  modlib_relocateadd() (SHT_RELA,
+ *   e.g. RISC-V, Xtensa, AArch64 and x86_64) patches its target section in
+ *   place, so a binary with RELA relocations against a read-only section
+ *   keeps a private text.
+ *
+ ****************************************************************************/
+
+static bool modlib_textcache_shareable(FAR struct mod_loadinfo_s *loadinfo)
+{
+  FAR Elf_Shdr *dstsec;
+  int i;
+
+  if (loadinfo->ehdr.e_type != ET_REL || loadinfo->gotindex < 0 ||
+      loadinfo->xipbase != 0 || loadinfo->textsize == 0 ||
+      loadinfo->filename == NULL)
+    {
+      return false;
+    }
+
+  for (i = 0; i < loadinfo->ehdr.e_shnum; i++)
+    {
+      if (loadinfo->shdr[i].sh_type != SHT_RELA ||
+          loadinfo->shdr[i].sh_info >= loadinfo->ehdr.e_shnum)
+        {
+          continue;
+        }
+
+      dstsec = &loadinfo->shdr[loadinfo->shdr[i].sh_info];
+      if ((dstsec->sh_flags & SHF_ALLOC) != 0 &&
+          (dstsec->sh_flags & SHF_WRITE) == 0)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: modlib_textcache_get
+ *
+ * Description:
+ *   Look for the text of another loaded instance of the same binary.  If
+ *   there is one, a reference is taken and loadinfo->textalloc is set to
+ *   it.
+ *
+ * Returned Value:
+ *   true if the text is shared, false if it must be loaded.
+ *
+ ****************************************************************************/
+
+bool modlib_textcache_get(FAR struct mod_loadinfo_s *loadinfo)
+{
+  FAR struct mod_textcache_s *cache;
+
+  if (!modlib_textcache_shareable(loadinfo))
+    {
+      return false;
+    }
+
+  modlib_registry_lock();
+  for (cache = g_textcache; cache != NULL; cache = cache->flink)
+    {
+      if (cache->filelen == loadinfo->filelen &&
+          cache->textsize == loadinfo->textsize &&
+          cache->filedev == loadinfo->filedev &&
+          cache->fileino == loadinfo->fileino &&
+          cache->filemtime.tv_sec == loadinfo->filemtime.tv_sec &&
+          cache->filemtime.tv_nsec == loadinfo->filemtime.tv_nsec &&
+          strcmp(cache->filename, loadinfo->filename) == 0)
+        {
+          cache->crefs++;
+          loadinfo->textalloc  = cache->textalloc;
+          loadinfo->textshared = true;
+          break;
+        }
+    }
+
+  modlib_registry_unlock();
+  return loadinfo->textshared;
+}
+
+/****************************************************************************
+ * Name: modlib_textcache_add
+ *
+ * Description:
+ *   Offer the text just loaded to later instances of the same binary.
+ *   Nothing is done if the binary is not position independent.
+ *
+ ****************************************************************************/
+
+void modlib_textcache_add(FAR struct mod_loadinfo_s *loadinfo)
+{
+  FAR struct mod_textcache_s *cache;
+
+  if (!modlib_textcache_shareable(loadinfo))
+    {
+      return;
+    }
+
+  /* Without memory the text is simply not shared */
+
+  cache = lib_malloc(sizeof(*cache));
+  if (cache == NULL)
+    {
+      return;
+    }
+
+  cache->filename = strdup(loadinfo->filename);
+  if (cache->filename == NULL)
+    {
+      lib_free(cache);
+      return;
+    }
+
+  cache->filelen   = loadinfo->filelen;
+  cache->filemtime = loadinfo->filemtime;
+  cache->filedev   = loadinfo->filedev;
+  cache->fileino   = loadinfo->fileino;
+  cache->textalloc = loadinfo->textalloc;
+  cache->textsize  = loadinfo->textsize;
+  cache->crefs     = 1;
+
+  modlib_registry_lock();
+  cache->flink = g_textcache;
+  g_textcache  = cache;
+  modlib_registry_unlock();
+
+  binfo("Text of %s (%zu bytes) may be shared\n",
+        cache->filename, cache->textsize);
+}
+
+/****************************************************************************
+ * Name: modlib_textcache_release
+ *
+ * Description:
+ *   Drop one reference to a text allocation.
+ *
+ * Returned Value:
+ *   true if the text is still used by another instance, false if the
+ *   caller must free it.
+ *
+ ****************************************************************************/
+
+bool modlib_textcache_release(uintptr_t textalloc)
+{
+  FAR struct mod_textcache_s *cache;
+  FAR struct mod_textcache_s *prev = NULL;
+  bool inuse = false;
+
+  modlib_registry_lock();
+  for (cache = g_textcache; cache != NULL; cache = cache->flink)
+    {
+      if (cache->textalloc == textalloc)
+        {
+          if (--cache->crefs > 0)
+            {
+              inuse = true;
+            }
+          else if (prev != NULL)
+            {
+              prev->flink = cache->flink;
+            }
+          else
+            {
+              g_textcache = cache->flink;
+            }
+
+          break;
+        }
+
+      prev = cache;
+    }
+
+  modlib_registry_unlock();
+
+  if (cache != NULL && !inuse)
+    {
+      lib_free(cache->filename);
+      lib_free(cache);
+    }
+
+  return inuse;
+}
+
+#endif /* CONFIG_MODLIB_SHARED_TEXT */
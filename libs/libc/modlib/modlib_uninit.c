@@ -83,6 +83,8 @@ int modlib_uninitialize(FAR struct mod_loadinfo_s *loadinfo)
 
 int modlib_freebuffers(FAR struct mod_loadinfo_s *loadinfo)
 {
+  FAR dq_entry_t *e;
+
   /* Release all working allocations  */
 
   if (loadinfo->shdr != NULL)
@@ -104,5 +106,24 @@ int modlib_freebuffers(FAR struct mod_loadinfo_s *loadinfo)
       loadinfo->buflen   = 0;
     }
 
+#ifdef CONFIG_MODLIB_LOAD_STRTAB
+  if (loadinfo->strtab != NULL)
+    {
+      lib_free(loadinfo->strtab);
+      loadinfo->strtab = NULL;
+    }
+#endif
+
+#ifdef CONFIG_MODLIB_PRELINK
+  modlib_prelink_free(loadinfo);
+#endif
+
+  while ((e = dq_remfirst(&loadinfo->symcache)) != NULL)
+    {
+      lib_free(e);
+    }
+
+  loadinfo->nsymcache = 0;
+
   return OK;
 }
@@ -100,7 +100,11 @@ int modlib_unload(FAR struct mod_loadinfo_s *loadinfo)
 
       lib_free(loadinfo->sectalloc);
 #else
-      if (loadinfo->textalloc != 0 && loadinfo->xipbase == 0)
+      if (loadinfo->textalloc != 0 && loadinfo->xipbase == 0
+#  ifdef CONFIG_MODLIB_SHARED_TEXT
+          && !modlib_textcache_release(loadinfo->textalloc)
+#  endif
+          )
         {
 #  if defined(CONFIG_ARCH_USE_TEXT_HEAP)
           up_textheap_free((FAR void *)loadinfo->textalloc);
@@ -0,0 +1,442 @@
+/****************************************************************************
+ * mm/arena/arena.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/tree.h>
+
+#include <assert.h>
+#include <debug.h>
+#include <string.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/init.h>
+#include <nuttx/irq.h>
+#include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/mm.h>
+#include <nuttx/mm/arena.h>
+#include <nuttx/mm/heapguard.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Room for the heap structure and the node overhead of an extent */
+
+#define ARENA_OVERHEAD (CONFIG_MM_TASK_ARENA_EXTENT / 4)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* An extent of an arena, a chunk of the user heap managed as a heap of its
+ * own.  The extents of a group are linked newest first through flink, so
+ * are the released extents in quarantine.
+ */
+
+struct mm_arena_s
+{
+  RB_ENTRY(mm_arena_s) link;      /* All extents by end, for the lookup */
+  FAR struct mm_arena_s *flink;   /* The next extent of the same group */
+  FAR struct mm_heap_s *heap;     /* The heap inside the extent */
+  FAR char *end;                  /* The end of the extent */
+  bool released;                  /* The group exited, in quarantine */
+};
+
+RB_HEAD(mm_arena_tree_s, mm_arena_s);
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int arena_compare(FAR struct mm_arena_s *a, FAR struct mm_arena_s *b);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The extents don't overlap, so the one holding an address is the one with
+ * the lowest end above it.
+ */
+
+static struct mm_arena_tree_s g_arenas = RB_INITIALIZER(&g_arenas);
+static spinlock_t g_arena_lock = SP_UNLOCKED;
+
+#if CONFIG_MM_TASK_ARENA_QUARANTINE > 0
+static FAR struct mm_arena_s *g_arena_quarantine;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: arena_compare
+ ****************************************************************************/
+
+static int arena_compare(FAR struct mm_arena_s *a, FAR struct mm_arena_s *b)
+{
+  return a->end < b->end ? -1 : a->end > b->end;
+}
+
+RB_GENERATE_STATIC(mm_arena_tree_s, mm_arena_s, link, arena_compare);
+
+/****************************************************************************
+ * Name: arena_group
+ *
+ * Description:
+ *   Return the group whose arena serves the caller, NULL if the caller
+ *   must use the user heap.
+ *
+ ****************************************************************************/
+
+static FAR struct task_group_s *arena_group(void)
+{
+  FAR struct task_group_s *group;
+
+  if (!OSINIT_TASK_READY() || up_interrupt_context())
+    {
+      return NULL;
+    }
+
+  group = nxsched_self()->group;
+  if (group == NULL || (group->tg_flags & GROUP_FLAG_PRIVILEGED) != 0)
+    {
+      return NULL;
+    }
+
+  return group;
+}
+
+/****************************************************************************
+ * Name: arena_alloc
+ ****************************************************************************/
+
+static FAR void *arena_alloc(FAR struct mm_arena_s *arena,
+                             size_t alignment, size_t size)
+{
+  if (alignment == 0)
+    {
+      return mm_malloc(arena->heap, size);
+    }
+
+  return mm_memalign(arena->heap, alignment, size);
+}
+
+/****************************************************************************
+ * Name: arena_extend
+ *
+ * Description:
+ *   Add an extent large enough for size bytes to the arena of the group.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_arena_s *arena_extend(FAR struct task_group_s *group,
+                                           size_t size)
+{
+  FAR struct mm_arena_s *arena;
+  size_t extent = CONFIG_MM_TASK_ARENA_EXTENT;
+  irqstate_t flags;
+
+  if (size > extent - ARENA_OVERHEAD)
+    {
+      extent = size + ARENA_OVERHEAD;
+    }
+
+  arena = mm_malloc(USR_HEAP, extent);
+  if (arena == NULL)
+    {
+      return NULL;
+    }
+
+  /* No name keeps the extent heaps out of /proc/meminfo, they show up as
+   * used memory of the user heap.
+   */
+
+  arena->heap     = mm_initialize(NULL, arena + 1, extent - sizeof(*arena));
+  arena->end      = (FAR char *)arena + extent;
+  arena->released = false;
+
+  /* Other members of the group walk the list without the lock, the new
+   * extent becomes visible with the single store of the head.
+   */
+
+  flags = spin_lock_irqsave(&g_arena_lock);
+  RB_INSERT(mm_arena_tree_s, &g_arenas, arena);
+  arena->flink = group->tg_arena;
+  group->tg_arena = arena;
+  spin_unlock_irqrestore(&g_arena_lock, flags);
+
+  minfo("group %d: extent %p size %zu\n", group->tg_pid, arena, extent);
+  return arena;
+}
+
+/****************************************************************************
+ * Name: arena_find
+ ****************************************************************************/
+
+static FAR struct mm_arena_s *arena_find(FAR struct mm_arena_s *arena,
+                                         FAR void *mem)
+{
+  for (; arena != NULL; arena = arena->flink)
+    {
+      if ((FAR char *)mem > (FAR char *)arena &&
+          (FAR char *)mem < arena->end)
+        {
+          break;
+        }
+    }
+
+  return arena;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_arena_memalign
+ ****************************************************************************/
+
+FAR void *mm_arena_memalign(size_t alignment, size_t size)
+{
+  FAR struct task_group_s *group = arena_group();
+  FAR struct mm_arena_s *arena;
+  FAR void *ret;
+
+  if (group == NULL)
+    {
+      return NULL;
+    }
+
+  for (arena = group->tg_arena; arena != NULL; arena = arena->flink)
+    {
+      ret = arena_alloc(arena, alignment, size);
+      if (ret != NULL)
+        {
+          return ret;
+        }
+    }
+
+  arena = arena_extend(group, alignment + size);
+  if (arena == NULL)
+    {
+      return NULL;
+    }
+
+  return arena_alloc(arena, alignment, size);
+}
+
+/****************************************************************************
+ * Name: mm_arena_zalloc
+ ****************************************************************************/
+
+FAR void *mm_arena_zalloc(size_t size)
+{
+  FAR void *ret = mm_arena_malloc(size);
+
+  if (ret != NULL)
+    {
+      memset(ret, 0, size);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mm_arena_realloc
+ ****************************************************************************/
+
+FAR void *mm_arena_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
+                           size_t size)
+{
+  FAR void *ret;
+  size_t oldsize;
+
+  ret = mm_realloc(heap, oldmem, size);
+  if (ret != NULL || size == 0)
+    {
+      return ret;
+    }
+
+  /* The extent is full, move the block */
+
+  ret = mm_arena_malloc(size);
+  if (ret == NULL)
+    {
+      ret = mm_malloc(USR_HEAP, size);
+      if (ret == NULL)
+        {
+          return NULL;
+        }
+    }
+
+  oldsize = mm_malloc_size(heap, oldmem);
+  memcpy(ret, oldmem, oldsize < size ? oldsize : size);
+  mm_free(heap, oldmem);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mm_arena_heap
+ ****************************************************************************/
+
+FAR struct mm_heap_s *mm_arena_heap(FAR void *mem)
+{
+  FAR struct task_group_s *group;
+  FAR struct mm_arena_s *arena;
+  FAR struct mm_heap_s *heap;
+  struct mm_arena_s key;
+  irqstate_t flags;
+
+  if (mem == NULL)
+    {
+      return NULL;
+    }
+
+  /* A sampled allocation of an extent heap lives in the guarded pool */
+
+  heap = heapguard_heap(mem);
+  if (heap != NULL)
+    {
+      return heap;
+    }
+
+  if (RB_EMPTY(&g_arenas))
+    {
+      return NULL;
+    }
+
+  /* Memory usually goes back to the group that allocated it, look there
+   * first, then through the extents of all groups.
+   */
+
+  group = arena_group();
+  if (group != NULL)
+    {
+      arena = arena_find(group->tg_arena, mem);
+      if (arena != NULL)
+        {
+          return arena->heap;
+        }
+    }
+
+  key.end = (FAR char *)mem + 1;
+
+  flags = spin_lock_irqsave(&g_arena_lock);
+  arena = RB_NFIND(mm_arena_tree_s, &g_arenas, &key);
+  if (arena != NULL && (FAR char *)mem <= (FAR char *)arena)
+    {
+      arena = NULL;
+    }
+
+  spin_unlock_irqrestore(&g_arena_lock, flags);
+
+  if (arena == NULL)
+    {
+      return NULL;
+    }
+
+  /* The group that allocated the memory exited.  The heap of an extent in
+   * quarantine is still intact, so the free does no harm without the
+   * assertions.
+   */
+
+  DEBUGASSERT(!arena->released);
+  return arena->heap;
+}
+
+/****************************************************************************
+ * Name: mm_arena_release
+ ****************************************************************************/
+
+void mm_arena_release(FAR struct task_group_s *group)
+{
+  FAR struct mm_arena_s *arena;
+  FAR struct mm_arena_s *next;
+  irqstate_t flags;
+#if CONFIG_MM_TASK_ARENA_QUARANTINE > 0
+  FAR struct mm_arena_s **link;
+  int n;
+#endif
+
+  for (arena = group->tg_arena; arena != NULL; arena = arena->flink)
+    {
+      heapguard_release(arena->heap);
+    }
+
+  flags = spin_lock_irqsave(&g_arena_lock);
+  arena = group->tg_arena;
+  group->tg_arena = NULL;
+
+#if CONFIG_MM_TASK_ARENA_QUARANTINE > 0
+  /* Keep the newest released extents in the lookup, so that a stale free
+   * into them is caught, and only give back the oldest ones.
+   */
+
+  if (arena != NULL)
+    {
+      for (next = arena; ; next = next->flink)
+        {
+          next->released = true;
+          if (next->flink == NULL)
+            {
+              break;
+            }
+        }
+
+      next->flink = g_arena_quarantine;
+      g_arena_quarantine = arena;
+    }
+
+  link = &g_arena_quarantine;
+  for (n = 0; *link != NULL && n < CONFIG_MM_TASK_ARENA_QUARANTINE; n++)
+    {
+      link = &(*link)->flink;
+    }
+
+  arena = *link;
+  *link = NULL;
+#endif
+
+  for (next = arena; next != NULL; next = next->flink)
+    {
+      RB_REMOVE(mm_arena_tree_s, &g_arenas, next);
+    }
+
+  spin_unlock_irqrestore(&g_arena_lock, flags);
+
+  /* The blocks inside the extents are never visited */
+
+  for (; arena != NULL; arena = next)
+    {
+      next = arena->flink;
+      minfo("release extent %p\n", arena);
+      mm_uninitialize(arena->heap);
+      mm_free(USR_HEAP, arena);
+    }
+}
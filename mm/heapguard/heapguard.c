@@ -0,0 +1,795 @@
+/****************************************************************************
+ * mm/heapguard/heapguard.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <malloc.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/compiler.h>
+#include <nuttx/irq.h>
+#include <nuttx/sched.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/heapguard.h>
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define HEAPGUARD_SLOTSIZE    CONFIG_MM_HEAPGUARD_SLOTSIZE
+#define HEAPGUARD_NSLOTS      CONFIG_MM_HEAPGUARD_NSLOTS
+
+/* With page protection every slot is surrounded by inaccessible pages,
+ * otherwise by a short canary that is checked when the slot is freed.
+ */
+
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+#  define HEAPGUARD_GUARDSIZE CONFIG_MM_HEAPGUARD_SLOTSIZE
+#else
+#  define HEAPGUARD_GUARDSIZE 32
+#endif
+
+#define HEAPGUARD_STRIDE      (HEAPGUARD_SLOTSIZE + HEAPGUARD_GUARDSIZE)
+#define HEAPGUARD_POOLSIZE    (HEAPGUARD_GUARDSIZE + \
+                               HEAPGUARD_NSLOTS * HEAPGUARD_STRIDE)
+
+#define HEAPGUARD_SLOT(i)     (g_heapguard_pool + HEAPGUARD_GUARDSIZE + \
+                               (i) * HEAPGUARD_STRIDE)
+
+/* The same alignment as the heap managers give to malloc */
+
+#if CONFIG_MM_DEFAULT_ALIGNMENT == 0
+#  define HEAPGUARD_ALIGN     (2 * sizeof(uintptr_t))
+#else
+#  define HEAPGUARD_ALIGN     CONFIG_MM_DEFAULT_ALIGNMENT
+#endif
+
+#define HEAPGUARD_MAGIC       0xa5 /* Canary around allocations */
+#define HEAPGUARD_FREE_MAGIC  0xfd /* Freed slots without page protection */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Who allocated or freed a slot */
+
+struct heapguard_trace_s
+{
+  pid_t pid;
+  FAR void *backtrace[CONFIG_MM_HEAPGUARD_DEPTH];
+};
+
+struct heapguard_slot_s
+{
+  FAR struct mm_heap_s *heap;      /* Owner, NULL if never used */
+  FAR uint8_t *mem;                /* Address given to the caller */
+  size_t size;                     /* Requested size */
+  bool inuse;                      /* Allocated and not freed yet */
+  struct heapguard_trace_s alloc;  /* Last allocation */
+  struct heapguard_trace_s free;   /* Last free */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t g_heapguard_pool[HEAPGUARD_POOLSIZE]
+  aligned_data(HEAPGUARD_SLOTSIZE);
+static struct heapguard_slot_s g_heapguard_slots[HEAPGUARD_NSLOTS];
+static spinlock_t g_heapguard_lock = SP_UNLOCKED;
+
+/* Allocations to the next sample.  It is updated without the lock, a
+ * lost update only moves the next sample a little.
+ */
+
+static volatile size_t g_heapguard_countdown = CONFIG_MM_HEAPGUARD_RATE;
+
+static uint32_t g_heapguard_seed;
+static unsigned int g_heapguard_next;
+static bool g_heapguard_ready;
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+static bool g_heapguard_pages;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapguard_interval
+ *
+ * Description:
+ *   Return the number of allocations to the next sample, uniform in
+ *   [1, 2 * CONFIG_MM_HEAPGUARD_RATE] so that samples do not lock to a
+ *   periodic allocation pattern.  Called with g_heapguard_lock held.
+ *
+ ****************************************************************************/
+
+static size_t heapguard_interval(void)
+{
+  uint32_t x = g_heapguard_seed;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  g_heapguard_seed = x;
+
+  return x % (2 * CONFIG_MM_HEAPGUARD_RATE) + 1;
+}
+
+/****************************************************************************
+ * Name: heapguard_protect
+ ****************************************************************************/
+
+static void heapguard_protect(FAR uint8_t *addr, size_t size, bool access)
+{
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+  if (g_heapguard_pages)
+    {
+      up_heapguard_protect(addr, size, access);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: heapguard_initialize
+ *
+ * Description:
+ *   Poison the pool on first use.  Called with g_heapguard_lock held.
+ *
+ ****************************************************************************/
+
+static void heapguard_initialize(void)
+{
+  g_heapguard_seed = (uint32_t)perf_gettime() | 1;
+
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+  /* Fall back to canaries if the pages cannot be protected, e.g. the host
+   * page size is larger than the slot size.
+   */
+
+  g_heapguard_pages = up_heapguard_protect(g_heapguard_pool,
+                                           HEAPGUARD_POOLSIZE, false) >= 0;
+  if (!g_heapguard_pages)
+    {
+      mwarn("WARNING: page protection failed, using canaries\n");
+    }
+  else
+#endif
+    {
+      memset(g_heapguard_pool, HEAPGUARD_FREE_MAGIC, HEAPGUARD_POOLSIZE);
+    }
+
+  g_heapguard_ready = true;
+}
+
+/****************************************************************************
+ * Name: heapguard_backtrace
+ ****************************************************************************/
+
+static void heapguard_backtrace(FAR struct heapguard_trace_s *trace)
+{
+  int n;
+
+  trace->pid = _SCHED_GETTID();
+  n = sched_backtrace(trace->pid, trace->backtrace,
+                      CONFIG_MM_HEAPGUARD_DEPTH, 1);
+  if (n < CONFIG_MM_HEAPGUARD_DEPTH)
+    {
+      trace->backtrace[n] = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: heapguard_checkmagic
+ *
+ * Description:
+ *   Return the first byte of the range that does not hold the magic, or
+ *   NULL if the range is intact.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *heapguard_checkmagic(FAR uint8_t *addr, size_t size,
+                                         uint8_t magic)
+{
+  FAR uint8_t *end = addr + size;
+
+  for (; addr < end; addr++)
+    {
+      if (*addr != magic)
+        {
+          return addr;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: heapguard_showtrace
+ ****************************************************************************/
+
+static void heapguard_showtrace(FAR const char *what,
+                                FAR struct heapguard_trace_s *trace)
+{
+  char buf[BACKTRACE_BUFFER_SIZE(CONFIG_MM_HEAPGUARD_DEPTH)];
+
+  backtrace_format(buf, sizeof(buf), trace->backtrace,
+                   CONFIG_MM_HEAPGUARD_DEPTH);
+  _alert("%s by pid %d: %s\n", what, trace->pid, buf);
+}
+
+/****************************************************************************
+ * Name: heapguard_report
+ *
+ * Description:
+ *   Report an error on a slot with its allocation and free backtraces.
+ *
+ ****************************************************************************/
+
+static void heapguard_report(FAR const char *error, FAR const void *addr,
+                             FAR struct heapguard_slot_s *slot)
+{
+  FAR const uint8_t *ptr = addr;
+
+  _alert("heapguard detected %s at %p\n", error, addr);
+  if (slot->heap != NULL)
+    {
+      if (ptr < slot->mem)
+        {
+          _alert("%zu bytes left of %zu-byte region %p\n",
+                 (size_t)(slot->mem - ptr), slot->size, slot->mem);
+        }
+      else if (ptr >= slot->mem + slot->size)
+        {
+          _alert("%zu bytes right of %zu-byte region %p\n",
+                 (size_t)(ptr - slot->mem - slot->size), slot->size,
+                 slot->mem);
+        }
+      else
+        {
+          _alert("%zu bytes inside %zu-byte region %p\n",
+                 (size_t)(ptr - slot->mem), slot->size, slot->mem);
+        }
+
+      heapguard_showtrace("allocated", &slot->alloc);
+      if (!slot->inuse)
+        {
+          heapguard_showtrace("freed", &slot->free);
+        }
+    }
+
+#ifdef CONFIG_MM_HEAPGUARD_PANIC
+  PANIC();
+#else
+  dump_stack();
+#endif
+}
+
+/****************************************************************************
+ * Name: heapguard_slot
+ *
+ * Description:
+ *   Return the slot that owns addr, the slot before it for a guard
+ *   between two slots, or NULL if addr is not in the pool.
+ *
+ ****************************************************************************/
+
+static FAR struct heapguard_slot_s *heapguard_slot(FAR const void *addr)
+{
+  FAR const uint8_t *ptr = addr;
+  size_t index;
+
+  if (ptr < g_heapguard_pool + HEAPGUARD_GUARDSIZE ||
+      ptr >= g_heapguard_pool + HEAPGUARD_POOLSIZE)
+    {
+      return NULL;
+    }
+
+  index = (ptr - g_heapguard_pool - HEAPGUARD_GUARDSIZE) / HEAPGUARD_STRIDE;
+  return &g_heapguard_slots[index];
+}
+
+/****************************************************************************
+ * Name: heapguard_check
+ *
+ * Description:
+ *   Verify the canaries of an allocated slot.  The guards are checked too
+ *   when they are not protected by the MMU.  Called with g_heapguard_lock
+ *   held.
+ *
+ ****************************************************************************/
+
+static void heapguard_check(FAR struct heapguard_slot_s *slot)
+{
+  FAR uint8_t *base = HEAPGUARD_SLOT(slot - g_heapguard_slots);
+  FAR uint8_t *end = base + HEAPGUARD_SLOTSIZE;
+  FAR uint8_t *bad;
+
+  bad = heapguard_checkmagic(slot->mem + slot->size,
+                             end - slot->mem - slot->size, HEAPGUARD_MAGIC);
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+  if (bad == NULL && !g_heapguard_pages)
+#else
+  if (bad == NULL)
+#endif
+    {
+      bad = heapguard_checkmagic(end, HEAPGUARD_GUARDSIZE,
+                                 HEAPGUARD_FREE_MAGIC);
+    }
+
+  if (bad != NULL)
+    {
+      heapguard_report("heap-buffer-overflow", bad, slot);
+      return;
+    }
+
+  bad = heapguard_checkmagic(base, slot->mem - base, HEAPGUARD_MAGIC);
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+  if (bad == NULL && !g_heapguard_pages)
+#else
+  if (bad == NULL)
+#endif
+    {
+      bad = heapguard_checkmagic(base - HEAPGUARD_GUARDSIZE,
+                                 HEAPGUARD_GUARDSIZE, HEAPGUARD_FREE_MAGIC);
+    }
+
+  if (bad != NULL)
+    {
+      heapguard_report("heap-buffer-underflow", bad, slot);
+    }
+}
+
+/****************************************************************************
+ * Name: heapguard_retire
+ *
+ * Description:
+ *   Check the guards of a slot being freed and poison it until it is
+ *   reused.  Called with g_heapguard_lock held.
+ *
+ ****************************************************************************/
+
+static void heapguard_retire(FAR struct heapguard_slot_s *slot,
+                             FAR const struct heapguard_trace_s *trace)
+{
+  heapguard_check(slot);
+
+  slot->inuse = false;
+  slot->free  = *trace;
+
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+  if (!g_heapguard_pages)
+#endif
+    {
+      memset(HEAPGUARD_SLOT(slot - g_heapguard_slots),
+             HEAPGUARD_FREE_MAGIC, HEAPGUARD_SLOTSIZE);
+    }
+
+  heapguard_protect(HEAPGUARD_SLOT(slot - g_heapguard_slots),
+                    HEAPGUARD_SLOTSIZE, false);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapguard_malloc
+ *
+ * Description:
+ *   Serve about one in CONFIG_MM_HEAPGUARD_RATE allocations from a slot of
+ *   the guarded pool.  The allocation ends at the end of its slot, so that
+ *   an overflow runs into the guard behind it.
+ *
+ * Input Parameters:
+ *   heap - The heap the allocation is made from
+ *   size - The requested size
+ *
+ * Returned Value:
+ *   The guarded allocation, or NULL if this allocation is not sampled and
+ *   must be served by the heap.
+ *
+ ****************************************************************************/
+
+FAR void *heapguard_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct heapguard_slot_s *slot = NULL;
+  struct heapguard_trace_s trace;
+  FAR uint8_t *base;
+  FAR uint8_t *bad;
+  irqstate_t flags;
+  unsigned int i;
+
+  if (g_heapguard_countdown > 1)
+    {
+      g_heapguard_countdown--;
+      return NULL;
+    }
+
+  /* Sample the next allocation that fits in a slot */
+
+  if (size == 0 || size > HEAPGUARD_SLOTSIZE)
+    {
+      return NULL;
+    }
+
+  heapguard_backtrace(&trace);
+
+  flags = spin_lock_irqsave(&g_heapguard_lock);
+  if (!g_heapguard_ready)
+    {
+      heapguard_initialize();
+    }
+
+  g_heapguard_countdown = heapguard_interval();
+
+  /* Take the free slot after the last one used, so that a freed slot
+   * stays poisoned as long as possible.
+   */
+
+  for (i = 0; i < HEAPGUARD_NSLOTS; i++)
+    {
+      if (!g_heapguard_slots[g_heapguard_next].inuse)
+        {
+          slot = &g_heapguard_slots[g_heapguard_next];
+          break;
+        }
+
+      g_heapguard_next = (g_heapguard_next + 1) % HEAPGUARD_NSLOTS;
+    }
+
+  if (slot == NULL)
+    {
+      spin_unlock_irqrestore(&g_heapguard_lock, flags);
+      return NULL;
+    }
+
+  g_heapguard_next = (g_heapguard_next + 1) % HEAPGUARD_NSLOTS;
+  base = HEAPGUARD_SLOT(slot - g_heapguard_slots);
+
+#ifdef CONFIG_MM_HEAPGUARD_PAGES
+  if (!g_heapguard_pages)
+#endif
+    {
+      /* A write to the slot after it was freed changed the poison */
+
+      bad = heapguard_checkmagic(base, HEAPGUARD_SLOTSIZE,
+                                 HEAPGUARD_FREE_MAGIC);
+      if (bad != NULL)
+        {
+          heapguard_report("heap-use-after-free write", bad, slot);
+        }
+    }
+
+  heapguard_protect(base, HEAPGUARD_SLOTSIZE, true);
+
+  slot->heap  = heap;
+  slot->mem   = base + HEAPGUARD_SLOTSIZE -
+                ((size + HEAPGUARD_ALIGN - 1) & ~(HEAPGUARD_ALIGN - 1));
+  slot->size  = size;
+  slot->inuse = true;
+  slot->alloc = trace;
+
+  memset(base, HEAPGUARD_MAGIC, HEAPGUARD_SLOTSIZE);
+  spin_unlock_irqrestore(&g_heapguard_lock, flags);
+
+  return slot->mem;
+}
+
+/****************************************************************************
+ * Name: heapguard_free
+ *
+ * Description:
+ *   Free a guarded allocation, check its guards and poison the slot
+ *   until it is reused.  Errors are reported with the allocation and free
+ *   backtraces.
+ *
+ * Input Parameters:
+ *   heap - The heap the memory is returned to
+ *   mem  - The memory to free
+ *
+ * Returned Value:
+ *   true if mem belongs to the guarded pool and was handled here.
+ *
+ ****************************************************************************/
+
+bool heapguard_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct heapguard_slot_s *slot;
+  struct heapguard_trace_s trace;
+  irqstate_t flags;
+
+  slot = heapguard_slot(mem);
+  if (slot == NULL)
+    {
+      return false;
+    }
+
+  heapguard_backtrace(&trace);
+
+  flags = spin_lock_irqsave(&g_heapguard_lock);
+  if (!slot->inuse)
+    {
+      heapguard_report(slot->heap ? "double-free" : "invalid-free",
+                       mem, slot);
+    }
+  else if (mem != slot->mem)
+    {
+      heapguard_report("invalid-free", mem, slot);
+    }
+  else
+    {
+      DEBUGASSERT(slot->heap == heap);
+      heapguard_retire(slot, &trace);
+    }
+
+  spin_unlock_irqrestore(&g_heapguard_lock, flags);
+  return true;
+}
+
+/****************************************************************************
+ * Name: heapguard_release
+ *
+ * Description:
+ *   Free all the guarded allocations of a heap that goes away, a later
+ *   access or free of them is reported like a use after free.
+ *
+ * Input Parameters:
+ *   heap - The heap being released
+ *
+ ****************************************************************************/
+
+void heapguard_release(FAR struct mm_heap_s *heap)
+{
+  FAR struct heapguard_slot_s *slot;
+  struct heapguard_trace_s trace;
+  irqstate_t flags;
+
+  heapguard_backtrace(&trace);
+
+  flags = spin_lock_irqsave(&g_heapguard_lock);
+  for (slot = g_heapguard_slots;
+       slot < g_heapguard_slots + HEAPGUARD_NSLOTS; slot++)
+    {
+      if (slot->inuse && slot->heap == heap)
+        {
+          heapguard_retire(slot, &trace);
+        }
+    }
+
+  spin_unlock_irqrestore(&g_heapguard_lock, flags);
+}
+
+/****************************************************************************
+ * Name: heapguard_heap
+ *
+ * Description:
+ *   Return the heap that made the guarded allocation, or NULL if mem is
+ *   not in the guarded pool.
+ *
+ ****************************************************************************/
+
+FAR struct mm_heap_s *heapguard_heap(FAR const void *mem)
+{
+  FAR struct heapguard_slot_s *slot = heapguard_slot(mem);
+
+  return slot != NULL ? slot->heap : NULL;
+}
+
+/****************************************************************************
+ * Name: heapguard_size
+ *
+ * Description:
+ *   Return the usable size of a guarded allocation.
+ *
+ ****************************************************************************/
+
+size_t heapguard_size(FAR const void *mem)
+{
+  FAR struct heapguard_slot_s *slot = heapguard_slot(mem);
+
+  return slot != NULL ? slot->size : 0;
+}
+
+/****************************************************************************
+ * Name: heapguard_fault
+ *
+ * Description:
+ *   Called by the architecture when an access faults.  If the address
+ *   lies in the guarded pool, report the error and panic; otherwise return
+ *   and let the caller handle the fault.
+ *
+ * Input Parameters:
+ *   addr - The faulting address
+ *
+ ****************************************************************************/
+
+void heapguard_fault(FAR void *addr)
+{
+  FAR struct heapguard_slot_s *slot;
+  FAR uint8_t *ptr = addr;
+  FAR uint8_t *base;
+
+  if (ptr >= g_heapguard_pool &&
+      ptr < g_heapguard_pool + HEAPGUARD_GUARDSIZE)
+    {
+      /* The guard in front of the first slot */
+
+      slot = &g_heapguard_slots[0];
+    }
+  else
+    {
+      slot = heapguard_slot(addr);
+      if (slot == NULL)
+        {
+          return;
+        }
+    }
+
+  base = HEAPGUARD_SLOT(slot - g_heapguard_slots);
+  if (ptr >= base && ptr < base + HEAPGUARD_SLOTSIZE)
+    {
+      /* An allocated slot is accessible, this one is free */
+
+      heapguard_report(slot->heap != NULL ? "heap-use-after-free" :
+                       "wild-access", addr, slot);
+    }
+  else if (ptr < base)
+    {
+      heapguard_report("heap-buffer-underflow", addr, slot);
+    }
+  else if (slot + 1 < g_heapguard_slots + HEAPGUARD_NSLOTS &&
+           (slot + 1)->inuse && ptr >= base + HEAPGUARD_SLOTSIZE +
+           HEAPGUARD_GUARDSIZE / 2)
+    {
+      /* The second half of a guard is closer to the next slot */
+
+      heapguard_report("heap-buffer-underflow", addr, slot + 1);
+    }
+  else
+    {
+      heapguard_report("heap-buffer-overflow", addr, slot);
+    }
+}
+
+/****************************************************************************
+ * Name: heapguard_selftest
+ *
+ * Description:
+ *   Force the sampling of malloc() and memalign() calls and check that the
+ *   returned blocks are usable and leave the heap intact.  memalign()
+ *   must not split a guarded slot as if it was a heap chunk.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, -EFAULT if a check failed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MM_HEAPGUARD_SELFTEST
+int heapguard_selftest(void)
+{
+  static const size_t aligns[] =
+  {
+    16, 64, 256, 4096
+  };
+
+  static const size_t sizes[] =
+  {
+    1, 100, HEAPGUARD_SLOTSIZE / 4
+  };
+
+  struct mallinfo before;
+  struct mallinfo after;
+  FAR void *mem;
+  unsigned int i;
+  unsigned int j;
+  int ret = OK;
+
+  /* The next allocation that fits in a slot is sampled */
+
+  g_heapguard_countdown = 1;
+  mem = kmm_malloc(sizes[1]);
+  if (mem == NULL || heapguard_heap(mem) == NULL)
+    {
+      merr("ERROR: malloc() was not sampled\n");
+      ret = -EFAULT;
+    }
+
+  kmm_free(mem);
+
+  for (i = 0; i < nitems(aligns); i++)
+    {
+      for (j = 0; j < nitems(sizes); j++)
+        {
+          before = kmm_mallinfo();
+
+          g_heapguard_countdown = 1;
+          mem = kmm_memalign(aligns[i], sizes[j]);
+          if (mem == NULL || (uintptr_t)mem % aligns[i] != 0 ||
+              kmm_malloc_size(mem) < sizes[j] || !kmm_heapmember(mem))
+            {
+              merr("ERROR: memalign(%zu, %zu) returned %p\n",
+                   aligns[i], sizes[j], mem);
+              ret = -EFAULT;
+            }
+          else
+            {
+              memset(mem, 0x5a, sizes[j]);
+            }
+
+          kmm_free(mem);
+
+#ifdef CONFIG_BUILD_FLAT
+          g_heapguard_countdown = 1;
+          if (posix_memalign(&mem, aligns[i], sizes[j]) != 0 ||
+              (uintptr_t)mem % aligns[i] != 0)
+            {
+              merr("ERROR: posix_memalign(%zu, %zu) failed\n",
+                   aligns[i], sizes[j]);
+              ret = -EFAULT;
+            }
+          else
+            {
+              memset(mem, 0xa5, sizes[j]);
+              free(mem);
+            }
+#endif
+
+          /* A guarded slot freed as a heap chunk would corrupt the usage
+           * counters and the free lists.
+           */
+
+          after = kmm_mallinfo();
+          if (after.uordblks != before.uordblks)
+            {
+              merr("ERROR: memalign(%zu, %zu) leaked %d bytes\n",
+                   aligns[i], sizes[j], after.uordblks - before.uordblks);
+              ret = -EFAULT;
+            }
+        }
+    }
+
+  kmm_checkcorruption();
+  return ret;
+}
+#endif
+
+#endif /* CONFIG_BUILD_FLAT || __KERNEL__ */
@@ -0,0 +1,725 @@
+/****************************************************************************
+ * mm/heapprof/heapprof.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/irq.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/lib/math32.h>
+#include <nuttx/sched.h>
+#include <nuttx/spinlock.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/mm/heapprof.h>
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Frames of heapprof_sample() and heapprof_alloc() */
+
+#define HEAPPROF_SKIP      2
+
+/* Live samples are chained by address, a bucket holds the index + 1 of its
+ * first sample so that an empty bucket is zero.
+ */
+
+#define HEAPPROF_NBUCKETS  (4 * CONFIG_MM_HEAPPROF_NSAMPLES)
+#define HEAPPROF_BUCKET(m) (((uintptr_t)(m) >> 3) % HEAPPROF_NBUCKETS)
+
+/* ln(2) in 16.16 fixed point */
+
+#define HEAPPROF_LN2       45426
+
+/* The longest line: four counters and the backtrace */
+
+#define HEAPPROF_LINELEN   (80 + 19 * CONFIG_MM_HEAPPROF_DEPTH)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The allocations sampled with one backtrace */
+
+struct heapprof_stack_s
+{
+  size_t alloc_count;                          /* Sampled allocations */
+  size_t alloc_bytes;                          /* Bytes of them */
+  size_t live_count;                           /* Not freed yet */
+  size_t live_bytes;                           /* Bytes of them */
+  uint32_t hash;                               /* Hash of backtrace */
+  FAR void *backtrace[CONFIG_MM_HEAPPROF_DEPTH];
+};
+
+/* One sampled allocation that is not freed yet */
+
+struct heapprof_sample_s
+{
+  FAR void *mem;                               /* NULL if the slot is free */
+  size_t size;                                 /* Requested size */
+  uint16_t stack;                              /* Index of the stack */
+  uint16_t next;                               /* Next in bucket, index + 1 */
+};
+
+/* The sampler state of one CPU, only touched with interrupts disabled */
+
+struct heapprof_cpu_s
+{
+  size_t countdown;                            /* Bytes to next sample */
+  uint32_t seed;                               /* Random state, 0 at boot */
+};
+
+#ifdef CONFIG_FS_PROCFS
+
+/* This structure describes one open "file" */
+
+struct heapprof_file_s
+{
+  struct procfs_file_s base;                   /* Base open file structure */
+  char line[HEAPPROF_LINELEN];                 /* Pre-allocated buffer for formatted lines */
+};
+
+#endif
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_PROCFS
+static int     heapprof_open(FAR struct file *filep, FAR const char *relpath,
+                             int oflags, mode_t mode);
+static int     heapprof_close(FAR struct file *filep);
+static ssize_t heapprof_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen);
+static ssize_t heapprof_write(FAR struct file *filep,
+                              FAR const char *buffer, size_t buflen);
+static int     heapprof_dup(FAR const struct file *oldp,
+                            FAR struct file *newp);
+static int     heapprof_stat(FAR const char *relpath,
+                             FAR struct stat *buf);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static spinlock_t g_heapprof_lock = SP_UNLOCKED;
+static struct heapprof_cpu_s g_heapprof_cpu[CONFIG_SMP_NCPUS];
+static struct heapprof_stack_s g_heapprof_stacks[CONFIG_MM_HEAPPROF_NSTACKS];
+static struct heapprof_sample_s
+g_heapprof_samples[CONFIG_MM_HEAPPROF_NSAMPLES];
+static uint16_t g_heapprof_buckets[HEAPPROF_NBUCKETS];
+static size_t g_heapprof_nstacks;
+static size_t g_heapprof_dropped;
+static clock_t g_heapprof_start;
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_PROCFS
+const struct procfs_operations g_heapprof_operations =
+{
+  heapprof_open,   /* open */
+  heapprof_close,  /* close */
+  heapprof_read,   /* read */
+  heapprof_write,  /* write */
+  NULL,            /* poll */
+  heapprof_dup,    /* dup */
+  NULL,            /* opendir */
+  NULL,            /* closedir */
+  NULL,            /* readdir */
+  NULL,            /* rewinddir */
+  heapprof_stat    /* stat */
+};
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapprof_interval
+ *
+ * Description:
+ *   Return the number of bytes to the next sample.  Sampling every byte
+ *   with probability 1 / CONFIG_MM_HEAPPROF_INTERVAL makes the gaps
+ *   between samples exponentially distributed, so draw the gap as
+ *   -ln(u) * CONFIG_MM_HEAPPROF_INTERVAL with u uniform in (0, 1].  The
+ *   logarithm is computed in fixed point, the kernel does not touch the
+ *   FPU.
+ *
+ ****************************************************************************/
+
+static size_t heapprof_interval(FAR struct heapprof_cpu_s *cpu)
+{
+  uint32_t x = cpu->seed;
+  uint32_t nlog2;
+  uint64_t m;
+  int msb;
+  int i;
+
+  /* xorshift32, never returns zero */
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  cpu->seed = x;
+
+  /* log2(x) = msb + log2(m), m = x / 2^msb in [1, 2) kept as Q1.31.  Each
+   * squaring of m yields one more fraction bit.
+   */
+
+  msb   = flsx(x) - 1;
+  m     = (uint64_t)x << (31 - msb);
+  nlog2 = msb << 16;
+
+  for (i = 15; i >= 0; i--)
+    {
+      m = (m * m) >> 31;
+      if (m >= ((uint64_t)1 << 32))
+        {
+          nlog2 |= 1 << i;
+          m >>= 1;
+        }
+    }
+
+  /* -ln(x / 2^32) = (32 - log2(x)) * ln(2) */
+
+  nlog2 = (32 << 16) - nlog2;
+  return (((uint64_t)CONFIG_MM_HEAPPROF_INTERVAL * nlog2 *
+           HEAPPROF_LN2) >> 32) + 1;
+}
+
+/****************************************************************************
+ * Name: heapprof_unlink
+ *
+ * Description:
+ *   Remove the live sample of mem from its bucket and return its index,
+ *   or -1 if mem was not sampled.  Called with g_heapprof_lock held.
+ *
+ ****************************************************************************/
+
+static int heapprof_unlink(FAR void *mem)
+{
+  FAR uint16_t *next = &g_heapprof_buckets[HEAPPROF_BUCKET(mem)];
+  int index;
+
+  for (; *next != 0; next = &g_heapprof_samples[index].next)
+    {
+      index = *next - 1;
+      if (g_heapprof_samples[index].mem == mem)
+        {
+          *next = g_heapprof_samples[index].next;
+          return index;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: heapprof_link
+ *
+ * Description:
+ *   Add a live sample to the bucket of its address.  Called with
+ *   g_heapprof_lock held.
+ *
+ ****************************************************************************/
+
+static void heapprof_link(int index)
+{
+  FAR struct heapprof_sample_s *sample = &g_heapprof_samples[index];
+  FAR uint16_t *bucket = &g_heapprof_buckets[HEAPPROF_BUCKET(sample->mem)];
+
+  sample->next = *bucket;
+  *bucket = index + 1;
+}
+
+/****************************************************************************
+ * Name: heapprof_findstack
+ *
+ * Description:
+ *   Return the index of the stack with the backtrace, adding it if it is
+ *   new, or -1 if the stack table is full.  Called with g_heapprof_lock
+ *   held.
+ *
+ ****************************************************************************/
+
+static int heapprof_findstack(FAR void **backtrace, uint32_t hash)
+{
+  FAR struct heapprof_stack_s *stack;
+  size_t i;
+
+  for (i = 0; i < g_heapprof_nstacks; i++)
+    {
+      stack = &g_heapprof_stacks[i];
+      if (stack->hash == hash &&
+          memcmp(stack->backtrace, backtrace,
+                 sizeof(stack->backtrace)) == 0)
+        {
+          return i;
+        }
+    }
+
+  if (g_heapprof_nstacks >= CONFIG_MM_HEAPPROF_NSTACKS)
+    {
+      return -1;
+    }
+
+  stack = &g_heapprof_stacks[g_heapprof_nstacks];
+  stack->hash = hash;
+  memcpy(stack->backtrace, backtrace, sizeof(stack->backtrace));
+  return g_heapprof_nstacks++;
+}
+
+/****************************************************************************
+ * Name: heapprof_sample
+ *
+ * Description:
+ *   Record a sampled allocation.  Never inlined, HEAPPROF_SKIP counts on
+ *   its frame.
+ *
+ ****************************************************************************/
+
+noinline_function static void heapprof_sample(FAR void *mem, size_t size)
+{
+  FAR void *backtrace[CONFIG_MM_HEAPPROF_DEPTH];
+  FAR struct heapprof_stack_s *stack;
+  irqstate_t flags;
+  uint32_t hash = 0;
+  int index;
+  int n;
+  int i;
+
+  /* Unwind outside of the lock, it is the expensive part */
+
+  memset(backtrace, 0, sizeof(backtrace));
+  n = sched_backtrace(_SCHED_GETTID(), backtrace,
+                      CONFIG_MM_HEAPPROF_DEPTH, HEAPPROF_SKIP);
+  for (i = 0; i < n; i++)
+    {
+      hash = (hash ^ (uintptr_t)backtrace[i]) * 16777619u;
+    }
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+
+  index = heapprof_findstack(backtrace, hash);
+  if (index < 0)
+    {
+      g_heapprof_dropped++;
+      goto out;
+    }
+
+  stack = &g_heapprof_stacks[index];
+  stack->alloc_count++;
+  stack->alloc_bytes += size;
+
+  /* Track the allocation in the live heap profile if a slot is free */
+
+  for (i = 0; i < CONFIG_MM_HEAPPROF_NSAMPLES; i++)
+    {
+      if (g_heapprof_samples[i].mem == NULL)
+        {
+          g_heapprof_samples[i].mem   = mem;
+          g_heapprof_samples[i].size  = size;
+          g_heapprof_samples[i].stack = index;
+          heapprof_link(i);
+
+          stack->live_count++;
+          stack->live_bytes += size;
+          goto out;
+        }
+    }
+
+  g_heapprof_dropped++;
+
+out:
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+#ifdef CONFIG_FS_PROCFS
+
+/****************************************************************************
+ * Name: heapprof_getstack
+ *
+ * Description:
+ *   Copy a stack out of the table, the lock is not held while formatting.
+ *
+ ****************************************************************************/
+
+static bool heapprof_getstack(size_t index,
+                              FAR struct heapprof_stack_s *stack)
+{
+  irqstate_t flags;
+  bool valid;
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+  valid = index < g_heapprof_nstacks;
+  if (valid)
+    {
+      memcpy(stack, &g_heapprof_stacks[index], sizeof(*stack));
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+  return valid;
+}
+
+/****************************************************************************
+ * Name: heapprof_open
+ ****************************************************************************/
+
+static int heapprof_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct heapprof_file_s *procfile;
+
+  procfile = kmm_zalloc(sizeof(struct heapprof_file_s));
+  if (procfile == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  filep->f_priv = procfile;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: heapprof_close
+ ****************************************************************************/
+
+static int heapprof_close(FAR struct file *filep)
+{
+  kmm_free(filep->f_priv);
+  filep->f_priv = NULL;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: heapprof_read
+ *
+ * Description:
+ *   Print the profile in the legacy text heap profile format understood
+ *   by pprof:
+ *
+ *     heap profile: <live>: <live bytes> [<allocs>: <alloc bytes>] @
+ *       heap_v2/<interval>
+ *     <live>: <live bytes> [<allocs>: <alloc bytes>] @ <pc> <pc> ...
+ *
+ *   The counters are the raw sampled values, the reader scales them back
+ *   with the interval.  Comment lines carry the time the allocation
+ *   counters cover and the number of dropped samples.
+ *
+ ****************************************************************************/
+
+static ssize_t heapprof_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  FAR struct heapprof_file_s *procfile;
+  struct heapprof_stack_s total;
+  struct heapprof_stack_s stack;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+  off_t offset;
+  size_t i;
+  int j;
+
+  offset   = filep->f_pos;
+  procfile = filep->f_priv;
+
+  memset(&total, 0, sizeof(total));
+  for (i = 0; heapprof_getstack(i, &stack); i++)
+    {
+      total.alloc_count += stack.alloc_count;
+      total.alloc_bytes += stack.alloc_bytes;
+      total.live_count  += stack.live_count;
+      total.live_bytes  += stack.live_bytes;
+    }
+
+  linesize  = procfs_snprintf(procfile->line, HEAPPROF_LINELEN,
+                              "heap profile: %zu: %zu [%zu: %zu] @ "
+                              "heap_v2/%d\n"
+                              "# duration_ms: %lu\n"
+                              "# dropped: %zu\n",
+                              total.live_count, total.live_bytes,
+                              total.alloc_count, total.alloc_bytes,
+                              CONFIG_MM_HEAPPROF_INTERVAL,
+                              (unsigned long)TICK2MSEC(
+                                clock_systime_ticks() - g_heapprof_start),
+                              g_heapprof_dropped);
+  copysize  = procfs_memcpy(procfile->line, linesize, buffer, buflen,
+                            &offset);
+  totalsize = copysize;
+
+  for (i = 0; totalsize < buflen && heapprof_getstack(i, &stack); i++)
+    {
+      if (stack.alloc_count == 0 && stack.live_count == 0)
+        {
+          continue;
+        }
+
+      linesize = procfs_snprintf(procfile->line, HEAPPROF_LINELEN,
+                                 "%zu: %zu [%zu: %zu] @",
+                                 stack.live_count, stack.live_bytes,
+                                 stack.alloc_count, stack.alloc_bytes);
+
+      for (j = 0; j < CONFIG_MM_HEAPPROF_DEPTH &&
+                  stack.backtrace[j] != NULL; j++)
+        {
+          linesize += procfs_snprintf(procfile->line + linesize,
+                                      HEAPPROF_LINELEN - linesize,
+                                      " %p", stack.backtrace[j]);
+        }
+
+      linesize += procfs_snprintf(procfile->line + linesize,
+                                  HEAPPROF_LINELEN - linesize, "\n");
+
+      copysize   = procfs_memcpy(procfile->line, linesize,
+                                 buffer + totalsize, buflen - totalsize,
+                                 &offset);
+      totalsize += copysize;
+    }
+
+  filep->f_pos += totalsize;
+  return totalsize;
+}
+
+/****************************************************************************
+ * Name: heapprof_write
+ *
+ * Description:
+ *   Any write restarts the allocation counters, so that the allocation
+ *   profile covers the time from the write to the next read.  The live
+ *   heap profile is not affected.
+ *
+ ****************************************************************************/
+
+static ssize_t heapprof_write(FAR struct file *filep,
+                              FAR const char *buffer, size_t buflen)
+{
+  irqstate_t flags;
+  size_t i;
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+  for (i = 0; i < g_heapprof_nstacks; i++)
+    {
+      g_heapprof_stacks[i].alloc_count = 0;
+      g_heapprof_stacks[i].alloc_bytes = 0;
+    }
+
+  g_heapprof_dropped = 0;
+  g_heapprof_start   = clock_systime_ticks();
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: heapprof_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int heapprof_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct heapprof_file_s *oldattr;
+  FAR struct heapprof_file_s *newattr;
+
+  oldattr = oldp->f_priv;
+  newattr = kmm_malloc(sizeof(struct heapprof_file_s));
+  if (newattr == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldattr, sizeof(struct heapprof_file_s));
+  newp->f_priv = newattr;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: heapprof_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int heapprof_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  memset(buf, 0, sizeof(struct stat));
+  buf->st_mode = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+  return 0;
+}
+
+#endif /* CONFIG_FS_PROCFS */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapprof_alloc
+ *
+ * Description:
+ *   Account an allocation to the sampler.  Allocations are sampled with a
+ *   probability proportional to their size, on average once every
+ *   CONFIG_MM_HEAPPROF_INTERVAL bytes; only sampled allocations record the
+ *   backtrace of the caller.
+ *
+ * Input Parameters:
+ *   mem  - The address returned to the caller
+ *   size - The requested size
+ *
+ ****************************************************************************/
+
+void heapprof_alloc(FAR void *mem, size_t size)
+{
+  FAR struct heapprof_cpu_s *cpu;
+  irqstate_t flags;
+
+  /* The common case only counts down the bytes to the next sample */
+
+  flags = up_irq_save();
+  cpu = &g_heapprof_cpu[this_cpu()];
+  if (size < cpu->countdown)
+    {
+      cpu->countdown -= size;
+      up_irq_restore(flags);
+      return;
+    }
+
+  if (cpu->seed == 0)
+    {
+      /* The first allocation on this CPU, draw the first interval */
+
+      cpu->seed = (uint32_t)perf_gettime() ^ (uint32_t)(uintptr_t)mem;
+      cpu->seed = cpu->seed != 0 ? cpu->seed : 1;
+      cpu->countdown = heapprof_interval(cpu);
+      up_irq_restore(flags);
+      return;
+    }
+
+  cpu->countdown = heapprof_interval(cpu);
+  up_irq_restore(flags);
+
+  heapprof_sample(mem, size);
+}
+
+/****************************************************************************
+ * Name: heapprof_free
+ *
+ * Description:
+ *   Drop the memory from the live heap profile if it was sampled.
+ *
+ * Input Parameters:
+ *   mem - The address passed to free
+ *
+ ****************************************************************************/
+
+void heapprof_free(FAR void *mem)
+{
+  FAR struct heapprof_sample_s *sample;
+  FAR struct heapprof_stack_s *stack;
+  irqstate_t flags;
+  int index;
+
+  /* Most buckets are empty, look without the lock first.  The sample of
+   * mem, if any, was linked before the allocation returned, so it is
+   * visible here.
+   */
+
+  if (g_heapprof_buckets[HEAPPROF_BUCKET(mem)] == 0)
+    {
+      return;
+    }
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+  index = heapprof_unlink(mem);
+  if (index >= 0)
+    {
+      sample = &g_heapprof_samples[index];
+      stack  = &g_heapprof_stacks[sample->stack];
+      stack->live_count--;
+      stack->live_bytes -= sample->size;
+      sample->mem = NULL;
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+/****************************************************************************
+ * Name: heapprof_move
+ *
+ * Description:
+ *   The allocator returns a different address than the one it accounted,
+ *   e.g. memalign trims the head of a larger allocation.  Move the sample,
+ *   if any, to the new address.
+ *
+ * Input Parameters:
+ *   oldmem - The accounted address
+ *   newmem - The address returned to the caller
+ *
+ ****************************************************************************/
+
+void heapprof_move(FAR void *oldmem, FAR void *newmem)
+{
+  irqstate_t flags;
+  int index;
+
+  if (oldmem == newmem ||
+      g_heapprof_buckets[HEAPPROF_BUCKET(oldmem)] == 0)
+    {
+      return;
+    }
+
+  flags = spin_lock_irqsave(&g_heapprof_lock);
+  index = heapprof_unlink(oldmem);
+  if (index >= 0)
+    {
+      g_heapprof_samples[index].mem = newmem;
+      heapprof_link(index);
+    }
+
+  spin_unlock_irqrestore(&g_heapprof_lock, flags);
+}
+
+#endif /* CONFIG_BUILD_FLAT || __KERNEL__ */
@@ -263,10 +263,11 @@ static FAR struct iob_s *iob_allocwait(bool throttled, unsigned int timeout)
  *
  * Input Parameters:
  *   data -
+ *   arg  -
  *
  ****************************************************************************/
 
-static void iob_free_dynamic(FAR void *data)
+static void iob_free_dynamic(FAR void *data, FAR void *arg)
 {
 }
 #endif
@@ -378,6 +379,7 @@ FAR struct iob_s *iob_alloc_dynamic(uint16_t size)
       iob->io_bufsize = size;             /* Total length of the iob buffer */
       iob->io_pktlen  = 0;                /* Total length of the packet */
       iob->io_free    = iob_free_dynamic; /* Customer free callback */
+      iob->io_freearg = NULL;
       iob->io_data    = (FAR uint8_t *)ROUNDUP((uintptr_t)(iob + 1),
                                                CONFIG_IOB_ALIGNMENT);
     }
@@ -405,11 +407,12 @@ FAR struct iob_s *iob_alloc_dynamic(uint16_t size)
  *   free_cb - Notify the caller when the iob is freed. The caller can
  *             perform additional operations on the data before it is freed.
  *             The free_cb is called when the iob is freed.
+ *   arg     - The second argument of free_cb, e.g. the owner of the data.
  *
  ****************************************************************************/
 
 FAR struct iob_s *iob_alloc_with_data(FAR void *data, uint16_t size,
-                                      iob_free_cb_t free_cb)
+                                      iob_free_cb_t free_cb, FAR void *arg)
 {
   FAR struct iob_s *iob;
 
@@ -424,6 +427,7 @@ FAR struct iob_s *iob_alloc_with_data(FAR void *data, uint16_t size,
       iob->io_bufsize = size;    /* Total length of the iob buffer */
       iob->io_pktlen  = 0;       /* Total length of the packet */
       iob->io_free    = free_cb; /* Customer free callback */
+      iob->io_freearg = arg;
       iob->io_data    = data;
     }
 
@@ -122,6 +122,13 @@ static inline void mempool_add_backtrace(FAR struct mempool_s *pool,
       buf->backtrace[0] = NULL;
     }
 #  endif
+
+#  ifdef CONFIG_MM_HEAP_TASKSTAT
+  if (pool->taskstat != NULL)
+    {
+      taskstat_alloc(pool->taskstat, buf->pid, MEMPOOL_REALBLOCKSIZE(pool));
+    }
+#  endif
 }
 
 static void mempool_foreach(FAR struct mempool_s *pool,
@@ -432,6 +439,12 @@ void mempool_release(FAR struct mempool_s *pool, FAR void *blk)
   DEBUGASSERT(buf->magic == MEMPOOL_MAGIC_ALLOC);
   buf->magic = MEMPOOL_MAGIC_FREE;
 
+#  ifdef CONFIG_MM_HEAP_TASKSTAT
+  if (pool->taskstat != NULL)
+    {
+      taskstat_free(pool->taskstat, buf->pid, blocksize);
+    }
+#  endif
 #endif
 
   pool->nalloc--;
@@ -471,6 +484,120 @@ void mempool_release(FAR struct mempool_s *pool, FAR void *blk)
     }
 }
 
+/****************************************************************************
+ * Name: mempool_trim
+ *
+ * Description:
+ *   Give the expansions whose blocks are all free back to the allocator of
+ *   the pool.  Each expansion is checked with the lock held for one pass
+ *   over the free queue only, so the interrupt latency stays bounded.
+ *
+ * Input Parameters:
+ *   pool - Address of the memory pool to be used.
+ *
+ * Returned Value:
+ *   The number of bytes passed to the free function of the pool.
+ ****************************************************************************/
+
+size_t mempool_trim(FAR struct mempool_s *pool)
+{
+  size_t blocksize = MEMPOOL_REALBLOCKSIZE(pool);
+  FAR sq_entry_t *expand;
+  FAR sq_entry_t *prev;
+  FAR sq_entry_t *next;
+  FAR sq_entry_t *blk;
+  FAR char *base;
+  size_t released = 0;
+  size_t nexpand;
+  size_t nfree;
+  size_t index = 0;
+  size_t size;
+  size_t i;
+  irqstate_t flags;
+
+  if (pool->expandsize < blocksize + sizeof(sq_entry_t))
+    {
+      return 0;
+    }
+
+  nexpand = (pool->expandsize - sizeof(sq_entry_t)) / blocksize;
+  size = nexpand * blocksize + sizeof(sq_entry_t);
+
+  /* The initial block heads the expand queue, it is not trimmed */
+
+  if (pool->initialsize >= blocksize + sizeof(sq_entry_t))
+    {
+      index++;
+    }
+
+  for (; ; )
+    {
+      flags = spin_lock_irqsave(&pool->lock);
+      expand = sq_peek(&pool->equeue);
+      for (i = 0; expand != NULL && i < index; i++)
+        {
+          expand = sq_next(expand);
+        }
+
+      if (expand == NULL)
+        {
+          spin_unlock_irqrestore(&pool->lock, flags);
+          break;
+        }
+
+      /* The entry in the expand queue follows the blocks */
+
+      base = (FAR char *)expand - nexpand * blocksize;
+      nfree = 0;
+      sq_for_every(&pool->queue, blk)
+        {
+          if ((FAR char *)blk >= base && blk < expand)
+            {
+              nfree++;
+            }
+        }
+
+      if (nfree < nexpand)
+        {
+          spin_unlock_irqrestore(&pool->lock, flags);
+          index++;
+          continue;
+        }
+
+      /* Every block is free, unlink them and the expansion */
+
+      prev = NULL;
+      for (blk = sq_peek(&pool->queue); blk != NULL; blk = next)
+        {
+          next = sq_next(blk);
+          if ((FAR char *)blk >= base && blk < expand)
+            {
+              if (prev == NULL)
+                {
+                  sq_remfirst(&pool->queue);
+                }
+              else
+                {
+                  sq_remafter(prev, &pool->queue);
+                }
+            }
+          else
+            {
+              prev = blk;
+            }
+        }
+
+      sq_rem(expand, &pool->equeue);
+      spin_unlock_irqrestore(&pool->lock, flags);
+
+      base = kasan_unpoison(base, size);
+      pool->free(pool, base);
+      released += size;
+    }
+
+  return released;
+}
+
 /****************************************************************************
  * Name: mempool_info
  *
@@ -34,6 +34,7 @@
 #include <nuttx/kmalloc.h>
 #include <nuttx/mm/mempool.h>
 #include <nuttx/mm/kasan.h>
+#include <nuttx/mm/shrinker.h>
 
 /****************************************************************************
  * Private Types
@@ -90,9 +91,16 @@ struct mempool_multiple_s
   sq_queue_t                    chunk_queue;
   size_t                        chunk_size;
   size_t                        dict_used;
+  size_t                        dict_free;   /* The index + 1 of the first
+                                              * released dictionary entry
+                                              */
   size_t                        dict_col_num_log2;
   size_t                        dict_row_num;
   FAR struct mpool_dict_s     **dict;
+
+#ifdef CONFIG_MM_SHRINKER
+  struct mm_shrinker_s          shrinker;    /* Gives free expansions back */
+#endif
 };
 
 /****************************************************************************
@@ -206,6 +214,7 @@ mempool_multiple_free_chunk(FAR struct mempool_multiple_s *mpool,
 
   if (mpool->chunk_size < mpool->expandsize)
     {
+      mpool->alloced -= mpool->alloc_size(mpool->arg, ptr);
       mpool->free(mpool->arg, ptr);
       return;
     }
@@ -219,6 +228,7 @@ mempool_multiple_free_chunk(FAR struct mempool_multiple_s *mpool,
           if (--chunk->used == 0)
             {
               sq_rem(&chunk->entry, &mpool->chunk_queue);
+              mpool->alloced -= mpool->alloc_size(mpool->arg, chunk->start);
               mpool->free(mpool->arg, chunk->start);
             }
 
@@ -234,6 +244,7 @@ static FAR void *mempool_multiple_alloc_callback(FAR struct mempool_s *pool,
 {
   FAR struct mempool_multiple_s *mpool = pool->priv;
   FAR void *ret;
+  size_t index;
   size_t row;
   size_t col;
 
@@ -246,13 +257,25 @@ static FAR void *mempool_multiple_alloc_callback(FAR struct mempool_s *pool,
       return NULL;
     }
 
-  row = mpool->dict_used >> mpool->dict_col_num_log2;
+  /* Reuse the entry of an expansion given back by the shrinker first */
+
+  if (mpool->dict_free != 0)
+    {
+      index = mpool->dict_free - 1;
+      row = index >> mpool->dict_col_num_log2;
+      col = index - (row << mpool->dict_col_num_log2);
+      mpool->dict_free = mpool->dict[row][col].size;
+      goto found;
+    }
+
+  index = mpool->dict_used++;
+  row = index >> mpool->dict_col_num_log2;
 
   /* There is no new pointer address to store the dictionaries */
 
   DEBUGASSERT(mpool->dict_row_num > row);
 
-  col = mpool->dict_used - (row << mpool->dict_col_num_log2);
+  col = index - (row << mpool->dict_col_num_log2);
 
   if (mpool->dict[row] == NULL)
     {
@@ -262,10 +285,11 @@ static FAR void *mempool_multiple_alloc_callback(FAR struct mempool_s *pool,
                                      * sizeof(struct mpool_dict_s));
     }
 
+found:
   mpool->dict[row][col].pool = pool;
   mpool->dict[row][col].addr = ret;
   mpool->dict[row][col].size = mpool->minpoolsize + size;
-  *(FAR size_t *)ret = mpool->dict_used++;
+  *(FAR size_t *)ret = index;
   nxrmutex_unlock(&mpool->lock);
   return (FAR char *)ret + mpool->minpoolsize;
 }
@@ -274,11 +298,63 @@ static void mempool_multiple_free_callback(FAR struct mempool_s *pool,
                                            FAR void *addr)
 {
   FAR struct mempool_multiple_s *mpool = pool->priv;
+  FAR char *start = (FAR char *)addr - mpool->minpoolsize;
+  size_t index = *(FAR size_t *)start;
+  size_t row = index >> mpool->dict_col_num_log2;
+  size_t col = index - (row << mpool->dict_col_num_log2);
 
-  mempool_multiple_free_chunk(mpool,
-                              (FAR char *)addr - mpool->minpoolsize);
+  /* Forget the expansion so that the memory isn't taken for a mempool
+   * block once the heap hands it out again, and queue the entry for reuse
+   */
+
+  nxrmutex_lock(&mpool->lock);
+  mpool->dict[row][col].pool = NULL;
+  mpool->dict[row][col].addr = NULL;
+  mpool->dict[row][col].size = mpool->dict_free;
+  mpool->dict_free = index + 1;
+  mempool_multiple_free_chunk(mpool, start);
+  nxrmutex_unlock(&mpool->lock);
 }
 
+#ifdef CONFIG_MM_SHRINKER
+
+/****************************************************************************
+ * Name: mempool_multiple_shrink
+ *
+ * Description:
+ *   The shrinker of the multiple mempool, trim the pools from the smallest
+ *   block size up until target bytes went back to the heap.  Expansions
+ *   carved from a chunk only go back once the whole chunk is unused, so
+ *   the result is measured on the heap side.  Nothing is done when the
+ *   caller is inside the multiple mempool already, e.g. an expansion
+ *   running out of heap, the chunk queue is in use then.
+ *
+ ****************************************************************************/
+
+static size_t mempool_multiple_shrink(FAR struct mm_shrinker_s *shrinker,
+                                      size_t target)
+{
+  FAR struct mempool_multiple_s *mpool = shrinker->arg;
+  size_t alloced;
+  size_t i;
+
+  if (nxrmutex_is_hold(&mpool->lock) || nxrmutex_trylock(&mpool->lock) < 0)
+    {
+      return 0;
+    }
+
+  alloced = mpool->alloced;
+  for (i = 0; i < mpool->npools && alloced - mpool->alloced < target; i++)
+    {
+      mempool_trim(mpool->pools + i);
+    }
+
+  alloced -= mpool->alloced;
+  nxrmutex_unlock(&mpool->lock);
+  return alloced;
+}
+#endif
+
 /****************************************************************************
  * Name: mempool_multiple_get_dict
  *
@@ -486,6 +562,7 @@ mempool_multiple_init(FAR const char *name,
     }
 
   mpool->dict_used = 0;
+  mpool->dict_free = 0;
   mpool->dict_col_num_log2 = fls(dict_expendsize /
                                  sizeof(struct mpool_dict_s));
 
@@ -502,6 +579,21 @@ mempool_multiple_init(FAR const char *name,
          mpool->dict_row_num * sizeof(FAR struct mpool_dict_s *));
   nxrmutex_init(&mpool->lock);
 
+#ifdef CONFIG_MM_SHRINKER
+  mpool->shrinker.name = name;
+  mpool->shrinker.priority = MM_SHRINKER_PRIORITY_POOL;
+  mpool->shrinker.shrink = mempool_multiple_shrink;
+  mpool->shrinker.arg = mpool;
+  mpool->shrinker.reclaimed = 0;
+
+  /* A heap mempool gives its expansions back with mm_free(heap) */
+
+  mpool->shrinker.heap = free == (mempool_multiple_free_t)mm_free ?
+                         arg : NULL;
+
+  mm_shrinker_register(&mpool->shrinker);
+#endif
+
   return mpool;
 
 err_with_pools:
@@ -870,6 +962,10 @@ void mempool_multiple_deinit(FAR struct mempool_multiple_s *mpool)
       return;
     }
 
+#ifdef CONFIG_MM_SHRINKER
+  mm_shrinker_unregister(&mpool->shrinker);
+#endif
+
   for (i = 0; i < mpool->npools; i++)
     {
       DEBUGVERIFY(mempool_deinit(mpool->pools + i));
@@ -34,6 +34,7 @@
 #include <nuttx/fs/procfs.h>
 #include <nuttx/lib/math32.h>
 #include <nuttx/mm/mempool.h>
+#include <nuttx/mm/taskstat.h>
 
 #include <assert.h>
 #include <sys/types.h>
@@ -108,6 +109,21 @@
 #  define MM_ADD_BACKTRACE(heap, ptr)
 #endif
 
+/* Charge an allocated chunk to, or give it back from, the task recorded in
+ * its header.  Must be balanced wherever the owner or the size of a chunk
+ * changes, mirroring the bookkeeping of mm_curused.
+ */
+
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+#  define MM_TASKSTAT_ALLOC(heap, node) \
+     taskstat_alloc(&(heap)->mm_taskstat, (node)->pid, MM_SIZEOF_NODE(node))
+#  define MM_TASKSTAT_FREE(heap, node) \
+     taskstat_free(&(heap)->mm_taskstat, (node)->pid, MM_SIZEOF_NODE(node))
+#else
+#  define MM_TASKSTAT_ALLOC(heap, node)
+#  define MM_TASKSTAT_FREE(heap, node)
+#endif
+
 /* All other definitions derive from these two */
 
 #define MM_MIN_CHUNK     (1 << MM_MIN_SHIFT)
@@ -271,6 +287,12 @@ struct mm_heap_s
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMINFO)
   struct procfs_meminfo_entry_s mm_procfs;
 #endif
+
+  /* The memory held by each task, heap and mempool chunks together */
+
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+  struct taskstat_s mm_taskstat;
+#endif
 };
 
 /* This describes the callback for mm_foreach */
@@ -297,6 +319,10 @@ void mm_shrinkchunk(FAR struct mm_heap_s *heap,
 void mm_foreach(FAR struct mm_heap_s *heap, mm_node_handler_t handler,
                 FAR void *arg);
 
+/* Functions contained in mm_malloc.c ***************************************/
+
+FAR void *mm_malloc_nosample(FAR struct mm_heap_s *heap, size_t size);
+
 /* Functions contained in mm_free.c *****************************************/
 
 void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay);
@@ -96,6 +96,12 @@ void mm_extend(FAR struct mm_heap_s *heap, FAR void *mem, size_t size,
 
   oldnode->size = size | (oldnode->size & MM_MASK_BIT);
 
+  /* Charge the new block to the owner of the old node, mm_free below gives
+   * it back.
+   */
+
+  MM_TASKSTAT_ALLOC(heap, oldnode);
+
   /* The old node should already be marked as allocated */
 
   DEBUGASSERT(MM_NODE_IS_ALLOC(oldnode));
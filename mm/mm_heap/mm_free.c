@@ -32,6 +32,8 @@
 #include <nuttx/arch.h>
 #include <nuttx/sched.h>
 #include <nuttx/mm/mm.h>
+#include <nuttx/mm/heapguard.h>
+#include <nuttx/mm/heapprof.h>
 #include <nuttx/mm/kasan.h>
 #include <nuttx/sched_note.h>
 
@@ -135,6 +137,7 @@ void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem, bool delay)
 
   DEBUGASSERT(MM_NODE_IS_ALLOC(node));
 
+  MM_TASKSTAT_FREE(heap, node);
   node->size &= ~MM_ALLOC_BIT;
 
   /* Update heap statistics */
@@ -240,6 +243,12 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
       return;
     }
 
+  heapprof_free(mem);
+  if (heapguard_free(heap, mem))
+    {
+      return;
+    }
+
   DEBUGASSERT(mm_heapmember(heap, mem));
 
 #ifdef CONFIG_MM_HEAP_MEMPOOL
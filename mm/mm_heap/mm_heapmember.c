@@ -30,6 +30,7 @@
 #include <debug.h>
 
 #include <nuttx/mm/mm.h>
+#include <nuttx/mm/heapguard.h>
 #include <nuttx/mm/kasan.h>
 
 #include "mm_heap/mm.h"
@@ -57,10 +58,20 @@
 
 bool mm_heapmember(FAR struct mm_heap_s *heap, FAR void *mem)
 {
-  mem = kasan_reset_tag(mem);
 #if CONFIG_MM_REGIONS > 1
   int i;
+#endif
+
+  mem = kasan_reset_tag(mem);
+
+  /* Guarded allocations live outside of the heap regions */
 
+  if (heapguard_heap(mem) == heap)
+    {
+      return true;
+    }
+
+#if CONFIG_MM_REGIONS > 1
   /* A valid address from the heap for this region would have to lie
    * between the region's two guard nodes.
    */
@@ -69,6 +69,7 @@ static FAR void *mempool_memalign(FAR void *arg, size_t alignment,
     {
       node = (FAR struct mm_allocnode_s *)
       ((uintptr_t)ret - MM_SIZEOF_ALLOCNODE);
+      MM_TASKSTAT_FREE((FAR struct mm_heap_s *)arg, node);
       node->pid = PID_MM_MEMPOOL;
     }
 
@@ -78,6 +79,21 @@ static FAR void *mempool_memalign(FAR void *arg, size_t alignment,
 #  define mempool_memalign mm_memalign
 #endif
 
+#if defined(CONFIG_MM_HEAP_MEMPOOL) && defined(CONFIG_MM_HEAP_TASKSTAT)
+
+/****************************************************************************
+ * Name: mempool_taskstat
+ *
+ * Description:
+ *   Let the pools of the heap charge their blocks to the heap's counters.
+ ****************************************************************************/
+
+static void mempool_taskstat(FAR struct mempool_s *pool, FAR void *arg)
+{
+  pool->taskstat = arg;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -347,6 +363,13 @@ mm_initialize_pool(FAR const char *name,
                                (mempool_multiple_free_t)mm_free, heap,
                                init->chunksize, init->expandsize,
                                init->dict_expendsize);
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+      if (heap->mm_mpool != NULL)
+        {
+          mempool_multiple_foreach(heap->mm_mpool, mempool_taskstat,
+                                   &heap->mm_taskstat);
+        }
+#endif
     }
 
   return heap;
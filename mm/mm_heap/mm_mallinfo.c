@@ -28,6 +28,7 @@
 
 #include <assert.h>
 #include <debug.h>
+#include <limits.h>
 
 #include <nuttx/mm/mm.h>
 
@@ -169,6 +170,16 @@ struct mallinfo_task mm_mallinfo_task(FAR struct mm_heap_s *heap,
       0, 0
     };
 
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+  /* The usage of each task is kept up to date, no need to walk the heap */
+
+  if (task->pid >= 0 && task->seqmin == 0 && task->seqmax == ULONG_MAX &&
+      taskstat_info(&heap->mm_taskstat, task->pid, &info))
+    {
+      return info;
+    }
+#endif
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   info = mempool_multiple_info_task(heap->mm_mpool, task);
 #endif
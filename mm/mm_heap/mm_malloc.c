@@ -32,6 +32,9 @@
 
 #include <nuttx/arch.h>
 #include <nuttx/mm/mm.h>
+#include <nuttx/mm/heapguard.h>
+#include <nuttx/mm/heapprof.h>
+#include <nuttx/mm/shrinker.h>
 #include <nuttx/mm/kasan.h>
 #include <nuttx/sched.h>
 #include <nuttx/sched_note.h>
@@ -157,22 +160,23 @@ void mm_free_delaylist(FAR struct mm_heap_s *heap)
 }
 
 /****************************************************************************
- * Name: mm_malloc
+ * Name: mm_malloc_nosample
  *
  * Description:
- *  Find the smallest chunk that satisfies the request. Take the memory from
- *  that chunk, save the remaining, smaller chunk (if any).
- *
- *  8-byte alignment of the allocated data is assured.
+ *  Like mm_malloc(), but never serve the request from the guarded pool.
+ *  Used by mm_memalign(), which needs a real heap chunk to split.
  *
  ****************************************************************************/
 
-FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+FAR void *mm_malloc_nosample(FAR struct mm_heap_s *heap, size_t size)
 {
   FAR struct mm_freenode_s *node;
   size_t alignsize;
   size_t nodesize;
   FAR void *ret = NULL;
+#ifdef CONFIG_MM_SHRINKER
+  bool shrunk = false;
+#endif
   int ndx;
 
   /* Free the delay list first */
@@ -185,6 +189,7 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       ret = mempool_multiple_alloc(heap->mm_mpool, size);
       if (ret != NULL)
         {
+          heapprof_alloc(ret, size);
           return ret;
         }
     }
@@ -210,6 +215,10 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   DEBUGASSERT(alignsize >= MM_ALIGN);
 
+#ifdef CONFIG_MM_SHRINKER
+retry:
+#endif
+
   /* We need to hold the MM mutex while we muck with the nodelist. */
 
   DEBUGVERIFY(mm_lock(heap));
@@ -333,6 +342,7 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   if (ret)
     {
       MM_ADD_BACKTRACE(heap, node);
+      MM_TASKSTAT_ALLOC(heap, node);
       ret = kasan_unpoison(ret, nodesize - MM_ALLOCNODE_OVERHEAD);
 #ifdef CONFIG_MM_FILL_ALLOCATIONS
       memset(ret, MM_ALLOC_MAGIC, alignsize - MM_ALLOCNODE_OVERHEAD);
@@ -340,6 +350,14 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 #ifdef CONFIG_DEBUG_MM
       minfo("Allocated %p, size %zu\n", ret, alignsize);
 #endif
+#if CONFIG_MM_SHRINKER_LOWMARK > 0
+      if (MM_INTERNAL_HEAP(heap))
+        {
+          mm_shrink_watermark(heap);
+        }
+#endif
+
+      heapprof_alloc(ret, size);
     }
 
 #if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
@@ -347,7 +365,17 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   else if (free_delaylist(heap, true))
     {
-      return mm_malloc(heap, size);
+      return mm_malloc_nosample(heap, size);
+    }
+#endif
+
+#ifdef CONFIG_MM_SHRINKER
+  /* Try once more after the shrinkers gave memory back */
+
+  else if (MM_INTERNAL_HEAP(heap) && !shrunk && mm_shrink(heap, size) > 0)
+    {
+      shrunk = true;
+      goto retry;
     }
 #endif
 
@@ -411,3 +439,30 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   DEBUGASSERT(ret == NULL || ((uintptr_t)ret) % MM_ALIGN == 0);
   return ret;
 }
+
+/****************************************************************************
+ * Name: mm_malloc
+ *
+ * Description:
+ *  Find the smallest chunk that satisfies the request. Take the memory from
+ *  that chunk, save the remaining, smaller chunk (if any).
+ *
+ *  8-byte alignment of the allocated data is assured.
+ *
+ ****************************************************************************/
+
+FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR void *ret;
+
+  /* Serve a sampled allocation from the guarded pool */
+
+  ret = heapguard_malloc(heap, size);
+  if (ret != NULL)
+    {
+      heapprof_alloc(ret, size);
+      return ret;
+    }
+
+  return mm_malloc_nosample(heap, size);
+}
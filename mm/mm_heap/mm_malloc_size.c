@@ -30,6 +30,7 @@
 #include <debug.h>
 
 #include <nuttx/mm/mm.h>
+#include <nuttx/mm/heapguard.h>
 
 #include "mm_heap/mm.h"
 
@@ -40,6 +41,12 @@
 size_t mm_malloc_size(FAR struct mm_heap_s *heap, FAR void *mem)
 {
   FAR struct mm_freenode_s *node;
+
+  if (heapguard_heap(mem) != NULL)
+    {
+      return heapguard_size(mem);
+    }
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   if (heap->mm_mpool)
     {
@@ -30,6 +30,7 @@
 #include <debug.h>
 
 #include <nuttx/mm/mm.h>
+#include <nuttx/mm/heapprof.h>
 #include <nuttx/mm/kasan.h>
 #include <nuttx/sched_note.h>
 
@@ -56,6 +57,7 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
                       size_t size)
 {
   FAR struct mm_allocnode_s *node;
+  FAR void *rawmem;
   uintptr_t rawchunk;
   uintptr_t alignedchunk;
   size_t mask;
@@ -82,6 +84,7 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
       node = mempool_multiple_memalign(heap->mm_mpool, alignment, size);
       if (node != NULL)
         {
+          heapprof_alloc(node, size);
           return node;
         }
     }
@@ -131,14 +134,18 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
       return NULL;
     }
 
-  /* Then malloc that size */
+  /* Then malloc that size.  The chunk is split below, so it must not be a
+   * sampled slot of the guarded pool.
+   */
 
-  rawchunk = (uintptr_t)mm_malloc(heap, allocsize);
-  if (rawchunk == 0)
+  rawmem = mm_malloc_nosample(heap, allocsize);
+  if (rawmem == NULL)
     {
       return NULL;
     }
 
+  rawchunk = (uintptr_t)rawmem;
+
   kasan_poison((FAR void *)rawchunk,
                mm_malloc_size(heap, (FAR void *)rawchunk));
 
@@ -156,6 +163,7 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
 
   node = (FAR struct mm_allocnode_s *)(rawchunk - MM_SIZEOF_ALLOCNODE);
   heap->mm_curused -= MM_SIZEOF_NODE(node);
+  MM_TASKSTAT_FREE(heap, node);
 
   /* Find the aligned subregion */
 
@@ -284,11 +292,16 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
   mm_unlock(heap);
 
   MM_ADD_BACKTRACE(heap, node);
+  MM_TASKSTAT_ALLOC(heap, node);
 
   alignedchunk = (uintptr_t)kasan_unpoison((FAR const void *)alignedchunk,
                                            size - MM_ALLOCNODE_OVERHEAD);
   DEBUGASSERT(alignedchunk % alignment == 0);
   minfo("Aligned %"PRIxPTR" to %"PRIxPTR", size %zu\n",
         rawchunk, alignedchunk, size);
+
+  /* mm_malloc accounted the raw chunk, move the sample if it was sampled */
+
+  heapprof_move(rawmem, (FAR void *)alignedchunk);
   return (FAR void *)alignedchunk;
 }
@@ -33,6 +33,8 @@
 #include <assert.h>
 
 #include <nuttx/mm/mm.h>
+#include <nuttx/mm/heapguard.h>
+#include <nuttx/mm/heapprof.h>
 #include <nuttx/mm/kasan.h>
 #include <nuttx/sched_note.h>
 
@@ -84,6 +86,20 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       return mm_malloc(heap, size);
     }
 
+  /* A guarded allocation is not resized in place */
+
+  if (heapguard_heap(oldmem) != NULL)
+    {
+      newmem = mm_malloc(heap, size);
+      if (newmem != NULL)
+        {
+          memcpy(newmem, oldmem, MIN(size, heapguard_size(oldmem)));
+          mm_free(heap, oldmem);
+        }
+
+      return newmem;
+    }
+
   DEBUGASSERT(mm_heapmember(heap, oldmem));
 
 #ifdef CONFIG_MM_HEAP_MEMPOOL
@@ -92,6 +108,8 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       newmem = mempool_multiple_realloc(heap->mm_mpool, oldmem, size);
       if (newmem != NULL)
         {
+          heapprof_free(oldmem);
+          heapprof_alloc(newmem, size);
           return newmem;
         }
       else if (size <= heap->mm_threshold ||
@@ -144,6 +162,8 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
   oldsize = MM_SIZEOF_NODE(oldnode);
   if (newsize <= oldsize)
     {
+      MM_TASKSTAT_FREE(heap, oldnode);
+
       /* Handle the special case where we are not going to change the size
        * of the allocation.
        */
@@ -160,6 +180,7 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
       mm_unlock(heap);
       MM_ADD_BACKTRACE(heap, oldnode);
+      MM_TASKSTAT_ALLOC(heap, oldnode);
 
       return oldmem;
     }
@@ -193,6 +214,8 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       size_t takeprev;
       size_t takenext;
 
+      MM_TASKSTAT_FREE(heap, oldnode);
+
       /* Check if we can extend into the previous chunk and if the
        * previous chunk is smaller than the next chunk.
        */
@@ -389,6 +412,7 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
                       heap->mm_curused);
       mm_unlock(heap);
       MM_ADD_BACKTRACE(heap, (FAR char *)newmem - MM_SIZEOF_ALLOCNODE);
+      MM_TASKSTAT_ALLOC(heap, oldnode);
 
       newmem = kasan_unpoison(newmem, MM_SIZEOF_NODE(oldnode) -
                               MM_ALLOCNODE_OVERHEAD);
@@ -401,6 +425,8 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
           memcpy(newmem, oldmem, oldsize - MM_ALLOCNODE_OVERHEAD);
         }
 
+      heapprof_free(oldmem);
+      heapprof_alloc(newmem, size);
       return newmem;
     }
 
@@ -0,0 +1,218 @@
+/****************************************************************************
+ * mm/shrinker/shrinker.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/mutex.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/mm/mm.h>
+#include <nuttx/mm/shrinker.h>
+
+#if defined(CONFIG_BUILD_FLAT) || defined(__KERNEL__)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The shrinkers sorted by priority, the lock also serializes reclaims */
+
+static FAR struct mm_shrinker_s *g_shrinkers;
+static mutex_t g_shrinker_lock = NXMUTEX_INITIALIZER;
+
+#if CONFIG_MM_SHRINKER_LOWMARK > 0
+static struct work_s g_shrinker_work;
+static clock_t g_shrinker_last;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#if CONFIG_MM_SHRINKER_LOWMARK > 0
+
+/****************************************************************************
+ * Name: mm_shrink_worker
+ *
+ * Description:
+ *   Background reclaim, bring the free heap back to the high watermark.
+ *
+ ****************************************************************************/
+
+static void mm_shrink_worker(FAR void *arg)
+{
+  FAR struct mm_heap_s *heap = arg;
+  size_t remaining = mm_heapfree(heap);
+
+  if (remaining < CONFIG_MM_SHRINKER_HIGHMARK)
+    {
+      mm_shrink(heap, CONFIG_MM_SHRINKER_HIGHMARK - remaining);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_shrinker_register
+ ****************************************************************************/
+
+void mm_shrinker_register(FAR struct mm_shrinker_s *shrinker)
+{
+  FAR struct mm_shrinker_s **link;
+
+  DEBUGASSERT(shrinker != NULL && shrinker->shrink != NULL);
+
+  nxmutex_lock(&g_shrinker_lock);
+  for (link = &g_shrinkers; *link != NULL; link = &(*link)->flink)
+    {
+      if ((*link)->priority > shrinker->priority)
+        {
+          break;
+        }
+    }
+
+  shrinker->flink = *link;
+  *link = shrinker;
+  nxmutex_unlock(&g_shrinker_lock);
+}
+
+/****************************************************************************
+ * Name: mm_shrinker_unregister
+ ****************************************************************************/
+
+void mm_shrinker_unregister(FAR struct mm_shrinker_s *shrinker)
+{
+  FAR struct mm_shrinker_s **link;
+
+  nxmutex_lock(&g_shrinker_lock);
+  for (link = &g_shrinkers; *link != NULL; link = &(*link)->flink)
+    {
+      if (*link == shrinker)
+        {
+          *link = shrinker->flink;
+          break;
+        }
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+}
+
+/****************************************************************************
+ * Name: mm_shrinker_foreach
+ ****************************************************************************/
+
+void mm_shrinker_foreach(mm_shrinker_handler_t handler, FAR void *arg)
+{
+  FAR struct mm_shrinker_s *shrinker;
+
+  nxmutex_lock(&g_shrinker_lock);
+  for (shrinker = g_shrinkers; shrinker != NULL; shrinker = shrinker->flink)
+    {
+      handler(shrinker, arg);
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+}
+
+/****************************************************************************
+ * Name: mm_shrink
+ ****************************************************************************/
+
+size_t mm_shrink(FAR struct mm_heap_s *heap, size_t target)
+{
+  FAR struct mm_shrinker_s *shrinker;
+  size_t reclaimed = 0;
+  size_t released;
+
+  /* Never block here: the caller may be a failing allocation in any
+   * context, or a shrinker allocating behind our back.
+   */
+
+  if (up_interrupt_context() || nxmutex_trylock(&g_shrinker_lock) < 0)
+    {
+      return 0;
+    }
+
+  for (shrinker = g_shrinkers; shrinker != NULL && reclaimed < target;
+       shrinker = shrinker->flink)
+    {
+      if (shrinker->heap != NULL && shrinker->heap != heap)
+        {
+          continue;
+        }
+
+      released = shrinker->shrink(shrinker, target - reclaimed);
+      if (released > 0)
+        {
+          minfo("%s: released %zu bytes\n", shrinker->name, released);
+          shrinker->reclaimed += released;
+          reclaimed += released;
+        }
+    }
+
+  nxmutex_unlock(&g_shrinker_lock);
+  return reclaimed;
+}
+
+/****************************************************************************
+ * Name: mm_shrink_watermark
+ ****************************************************************************/
+
+#if CONFIG_MM_SHRINKER_LOWMARK > 0
+void mm_shrink_watermark(FAR struct mm_heap_s *heap)
+{
+  clock_t now;
+
+  if (mm_heapfree(heap) >= CONFIG_MM_SHRINKER_LOWMARK ||
+      !work_available(&g_shrinker_work))
+    {
+      return;
+    }
+
+  /* A heap that stays low would queue a reclaim after every allocation,
+   * even when there is nothing left to give back.
+   */
+
+  now = clock_systime_ticks();
+  if (g_shrinker_last != 0 &&
+      now - g_shrinker_last < MSEC2TICK(CONFIG_MM_SHRINKER_INTERVAL))
+    {
+      return;
+    }
+
+  g_shrinker_last = now;
+  work_queue(LPWORK, &g_shrinker_work, mm_shrink_worker, heap, 0);
+}
+#endif
+
+#endif /* CONFIG_BUILD_FLAT || __KERNEL__ */
@@ -0,0 +1,235 @@
+/****************************************************************************
+ * mm/taskstat/taskstat.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+
+#include <nuttx/spinlock.h>
+#include <nuttx/mm/taskstat.h>
+
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if CONFIG_MM_HEAP_TASKSTAT_NSLOTS & (CONFIG_MM_HEAP_TASKSTAT_NSLOTS - 1)
+#  error CONFIG_MM_HEAP_TASKSTAT_NSLOTS must be a power of two
+#endif
+
+#define TASKSTAT_MASK     (CONFIG_MM_HEAP_TASKSTAT_NSLOTS - 1)
+
+/* Pids are handed out sequentially, the low bits spread them well */
+
+#define TASKSTAT_HOME(k)  ((k) & TASKSTAT_MASK)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: taskstat_find
+ *
+ * Description:
+ *   Look up the slot of a task, claim an unused one if insert is true.
+ *   Return NULL if the task isn't found or the table is full.
+ *
+ ****************************************************************************/
+
+static FAR struct taskstat_entry_s *
+taskstat_find(FAR struct taskstat_s *stat, pid_t key, bool insert)
+{
+  FAR struct taskstat_entry_s *entry;
+  size_t index = TASKSTAT_HOME(key);
+  size_t n;
+
+  for (n = 0; n < CONFIG_MM_HEAP_TASKSTAT_NSLOTS; n++)
+    {
+      entry = &stat->entries[index];
+      if (entry->key == key)
+        {
+          return entry;
+        }
+      else if (entry->key == 0)
+        {
+          if (!insert)
+            {
+              return NULL;
+            }
+
+          entry->key = key;
+          return entry;
+        }
+
+      index = (index + 1) & TASKSTAT_MASK;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: taskstat_remove
+ *
+ * Description:
+ *   Release the slot of a task that no longer holds memory.  The following
+ *   entries of the probe sequence are shifted back, so lookups never need
+ *   tombstones.
+ *
+ ****************************************************************************/
+
+static void taskstat_remove(FAR struct taskstat_s *stat,
+                            FAR struct taskstat_entry_s *entry)
+{
+  size_t hole = entry - stat->entries;
+  size_t index = hole;
+  size_t home;
+
+  for (; ; )
+    {
+      index = (index + 1) & TASKSTAT_MASK;
+      entry = &stat->entries[index];
+      if (entry->key == 0)
+        {
+          break;
+        }
+
+      /* The entry may fill the hole unless its home lies cyclically
+       * between the hole and itself.
+       */
+
+      home = TASKSTAT_HOME(entry->key);
+      if (((index - home) & TASKSTAT_MASK) >=
+          ((index - hole) & TASKSTAT_MASK))
+        {
+          stat->entries[hole] = *entry;
+          hole = index;
+        }
+    }
+
+  stat->entries[hole].key      = 0;
+  stat->entries[hole].aordblks = 0;
+  stat->entries[hole].uordblks = 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: taskstat_alloc
+ ****************************************************************************/
+
+void taskstat_alloc(FAR struct taskstat_s *stat, pid_t pid, size_t size)
+{
+  FAR struct taskstat_entry_s *entry;
+  irqstate_t flags;
+
+  if (pid < 0)
+    {
+      return;
+    }
+
+  /* No task enters the table while untracked chunks remain, their owner
+   * would get a slot that misses them.
+   */
+
+  flags = spin_lock_irqsave(&stat->lock);
+  entry = taskstat_find(stat, pid + 1, stat->nuntracked == 0);
+  if (entry != NULL)
+    {
+      entry->aordblks++;
+      entry->uordblks += size;
+    }
+  else
+    {
+      stat->nuntracked++;
+    }
+
+  spin_unlock_irqrestore(&stat->lock, flags);
+}
+
+/****************************************************************************
+ * Name: taskstat_free
+ ****************************************************************************/
+
+void taskstat_free(FAR struct taskstat_s *stat, pid_t pid, size_t size)
+{
+  FAR struct taskstat_entry_s *entry;
+  irqstate_t flags;
+
+  if (pid < 0)
+    {
+      return;
+    }
+
+  flags = spin_lock_irqsave(&stat->lock);
+  entry = taskstat_find(stat, pid + 1, false);
+  if (entry == NULL)
+    {
+      /* Once the last untracked chunk is gone the table is complete */
+
+      DEBUGASSERT(stat->nuntracked > 0);
+      stat->nuntracked--;
+    }
+  else if (--entry->aordblks == 0)
+    {
+      taskstat_remove(stat, entry);
+    }
+  else
+    {
+      DEBUGASSERT(entry->uordblks >= size);
+      entry->uordblks -= size;
+    }
+
+  spin_unlock_irqrestore(&stat->lock, flags);
+}
+
+/****************************************************************************
+ * Name: taskstat_info
+ ****************************************************************************/
+
+bool taskstat_info(FAR struct taskstat_s *stat, pid_t pid,
+                   FAR struct mallinfo_task *info)
+{
+  FAR struct taskstat_entry_s *entry;
+  irqstate_t flags;
+  bool exact;
+
+  flags = spin_lock_irqsave(&stat->lock);
+  entry = taskstat_find(stat, pid + 1, false);
+  exact = entry != NULL || stat->nuntracked == 0;
+  if (exact)
+    {
+      info->aordblks = entry != NULL ? entry->aordblks : 0;
+      info->uordblks = entry != NULL ? entry->uordblks : 0;
+    }
+
+  spin_unlock_irqrestore(&stat->lock, flags);
+  return exact;
+}
+
+#endif /* CONFIG_MM_HEAP_TASKSTAT */
@@ -31,6 +31,7 @@
 #include <assert.h>
 #include <debug.h>
 #include <execinfo.h>
+#include <limits.h>
 #include <sched.h>
 #include <stdio.h>
 #include <string.h>
@@ -40,8 +41,12 @@
 #include <nuttx/fs/procfs.h>
 #include <nuttx/mutex.h>
 #include <nuttx/mm/mm.h>
+#include <nuttx/mm/heapguard.h>
+#include <nuttx/mm/heapprof.h>
 #include <nuttx/mm/kasan.h>
 #include <nuttx/mm/mempool.h>
+#include <nuttx/mm/shrinker.h>
+#include <nuttx/mm/taskstat.h>
 #include <nuttx/sched_note.h>
 
 #include "tlsf/tlsf.h"
@@ -54,6 +59,25 @@
 #  define MEMPOOL_NPOOLS (CONFIG_MM_HEAP_MEMPOOL_THRESHOLD / tlsf_align_size())
 #endif
 
+/* Charge a block to, or give it back from, the task recorded in its
+ * trailing backtrace.  size is the usable size, the counters hold the
+ * block size as tlsf_walk_pool() reports it.
+ */
+
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+#  define MM_TASKSTAT_PID(mem, size) \
+     ((FAR struct memdump_backtrace_s *)((FAR char *)(mem) + (size)))->pid
+#  define MM_TASKSTAT_ALLOC(heap, mem, size) \
+     taskstat_alloc(&(heap)->mm_taskstat, MM_TASKSTAT_PID(mem, size), \
+                    (size) + sizeof(struct memdump_backtrace_s))
+#  define MM_TASKSTAT_FREE(heap, mem, size) \
+     taskstat_free(&(heap)->mm_taskstat, MM_TASKSTAT_PID(mem, size), \
+                   (size) + sizeof(struct memdump_backtrace_s))
+#else
+#  define MM_TASKSTAT_ALLOC(heap, mem, size)
+#  define MM_TASKSTAT_FREE(heap, mem, size)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -112,6 +136,12 @@ struct mm_heap_s
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMINFO)
   struct procfs_meminfo_entry_s mm_procfs;
 #endif
+
+  /* The memory held by each task, heap and mempool blocks together */
+
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+  struct taskstat_s mm_taskstat;
+#endif
 };
 
 #if CONFIG_MM_BACKTRACE >= 0
@@ -391,6 +421,8 @@ static FAR void *mempool_memalign(FAR void *arg, size_t alignment,
   if (ret)
     {
       buf = ret + mm_malloc_size(arg, ret);
+      MM_TASKSTAT_FREE((FAR struct mm_heap_s *)arg, ret,
+                       mm_malloc_size(arg, ret));
       buf->pid = PID_MM_MEMPOOL;
     }
 
@@ -400,6 +432,21 @@ static FAR void *mempool_memalign(FAR void *arg, size_t alignment,
 #  define mempool_memalign mm_memalign
 #endif
 
+#if defined(CONFIG_MM_HEAP_MEMPOOL) && defined(CONFIG_MM_HEAP_TASKSTAT)
+
+/****************************************************************************
+ * Name: mempool_taskstat
+ *
+ * Description:
+ *   Let the pools of the heap charge their blocks to the heap's counters.
+ ****************************************************************************/
+
+static void mempool_taskstat(FAR struct mempool_s *pool, FAR void *arg)
+{
+  pool->taskstat = arg;
+}
+#endif
+
 /****************************************************************************
  * Name: mallinfo_handler
  ****************************************************************************/
@@ -621,6 +668,7 @@ static void mm_delayfree(FAR struct mm_heap_s *heap, FAR void *mem,
         {
           /* Update heap statistics */
 
+          MM_TASKSTAT_FREE(heap, mem, size);
           heap->mm_curused -= size;
           sched_note_heap(NOTE_HEAP_FREE, heap, mem, size, heap->mm_curused);
           tlsf_free(heap->mm_tlsf, mem);
@@ -874,6 +922,12 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
       return;
     }
 
+  heapprof_free(mem);
+  if (heapguard_free(heap, mem))
+    {
+      return;
+    }
+
   DEBUGASSERT(mm_heapmember(heap, mem));
 
 #ifdef CONFIG_MM_HEAP_MEMPOOL
@@ -910,7 +964,16 @@ bool mm_heapmember(FAR struct mm_heap_s *heap, FAR void *mem)
 {
 #if CONFIG_MM_REGIONS > 1
   int i;
+#endif
+
+  /* Guarded allocations live outside of the heap regions */
 
+  if (heapguard_heap(mem) == heap)
+    {
+      return true;
+    }
+
+#if CONFIG_MM_REGIONS > 1
   /* A valid address from the heap for this region would have to lie
    * between the region's two guard nodes.
    */
@@ -1063,6 +1126,13 @@ mm_initialize_pool(FAR const char *name,
                                (mempool_multiple_free_t)mm_free, heap,
                                init->chunksize, init->expandsize,
                                init->dict_expendsize);
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+      if (heap->mm_mpool != NULL)
+        {
+          mempool_multiple_foreach(heap->mm_mpool, mempool_taskstat,
+                                   &heap->mm_taskstat);
+        }
+#endif
     }
 
   return heap;
@@ -1135,6 +1205,16 @@ struct mallinfo_task mm_mallinfo_task(FAR struct mm_heap_s *heap,
 #define region 0
 #endif
 
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+  /* The usage of each task is kept up to date, no need to walk the heap */
+
+  if (task->pid >= 0 && task->seqmin == 0 && task->seqmax == ULONG_MAX &&
+      taskstat_info(&heap->mm_taskstat, task->pid, &info))
+    {
+      return info;
+    }
+#endif
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   info = mempool_multiple_info_task(heap->mm_mpool, task);
 #endif
@@ -1270,6 +1350,11 @@ void mm_memdump(FAR struct mm_heap_s *heap,
 
 size_t mm_malloc_size(FAR struct mm_heap_s *heap, FAR void *mem)
 {
+  if (heapguard_heap(mem) != NULL)
+    {
+      return heapguard_size(mem);
+    }
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   if (heap->mm_mpool)
     {
@@ -1303,6 +1388,9 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 {
   size_t nodesize;
   FAR void *ret;
+#ifdef CONFIG_MM_SHRINKER
+  bool shrunk = false;
+#endif
 
   /* In case of zero-length allocations allocate the minimum size object */
 
@@ -1311,12 +1399,22 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       size = 1;
     }
 
+  /* Serve a sampled allocation from the guarded pool */
+
+  ret = heapguard_malloc(heap, size);
+  if (ret != NULL)
+    {
+      heapprof_alloc(ret, size);
+      return ret;
+    }
+
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   if (heap->mm_mpool)
     {
       ret = mempool_multiple_alloc(heap->mm_mpool, size);
       if (ret != NULL)
         {
+          heapprof_alloc(ret, size);
           return ret;
         }
     }
@@ -1326,6 +1424,10 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   free_delaylist(heap, false);
 
+#ifdef CONFIG_MM_SHRINKER
+retry:
+#endif
+
   /* Allocate from the tlsf pool */
 
   DEBUGVERIFY(mm_lock(heap));
@@ -1357,6 +1459,7 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       FAR struct memdump_backtrace_s *buf = ret + nodesize;
 
       memdump_backtrace(heap, buf);
+      MM_TASKSTAT_ALLOC(heap, ret, nodesize);
 #endif
 
       ret = kasan_unpoison(ret, nodesize);
@@ -1364,6 +1467,14 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 #ifdef CONFIG_MM_FILL_ALLOCATIONS
       memset(ret, MM_ALLOC_MAGIC, nodesize);
 #endif
+#if CONFIG_MM_SHRINKER_LOWMARK > 0
+      if (MM_INTERNAL_HEAP(heap))
+        {
+          mm_shrink_watermark(heap);
+        }
+#endif
+
+      heapprof_alloc(ret, size);
     }
 
 #if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
@@ -1375,6 +1486,16 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
     }
 #endif
 
+#ifdef CONFIG_MM_SHRINKER
+  /* Try once more after the shrinkers gave memory back */
+
+  else if (MM_INTERNAL_HEAP(heap) && !shrunk && mm_shrink(heap, size) > 0)
+    {
+      shrunk = true;
+      goto retry;
+    }
+#endif
+
   return ret;
 }
 
@@ -1396,6 +1517,9 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
 {
   size_t nodesize;
   FAR void *ret;
+#ifdef CONFIG_MM_SHRINKER
+  bool shrunk = false;
+#endif
 
 #ifdef CONFIG_MM_HEAP_MEMPOOL
   if (heap->mm_mpool)
@@ -1403,6 +1527,7 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
       ret = mempool_multiple_memalign(heap->mm_mpool, alignment, size);
       if (ret != NULL)
         {
+          heapprof_alloc(ret, size);
           return ret;
         }
     }
@@ -1412,6 +1537,10 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
 
   free_delaylist(heap, false);
 
+#ifdef CONFIG_MM_SHRINKER
+retry:
+#endif
+
   /* Allocate from the tlsf pool */
 
   DEBUGVERIFY(mm_lock(heap));
@@ -1443,8 +1572,17 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
       FAR struct memdump_backtrace_s *buf = ret + nodesize;
 
       memdump_backtrace(heap, buf);
+      MM_TASKSTAT_ALLOC(heap, ret, nodesize);
 #endif
       ret = kasan_unpoison(ret, nodesize);
+#if CONFIG_MM_SHRINKER_LOWMARK > 0
+      if (MM_INTERNAL_HEAP(heap))
+        {
+          mm_shrink_watermark(heap);
+        }
+#endif
+
+      heapprof_alloc(ret, size);
     }
 
 #if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
@@ -1456,6 +1594,16 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
     }
 #endif
 
+#ifdef CONFIG_MM_SHRINKER
+  /* Try once more after the shrinkers gave memory back */
+
+  else if (MM_INTERNAL_HEAP(heap) && !shrunk && mm_shrink(heap, size) > 0)
+    {
+      shrunk = true;
+      goto retry;
+    }
+#endif
+
   return ret;
 }
 
@@ -1490,6 +1638,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
   size_t oldsize;
   size_t newsize;
 #endif
+#if defined(CONFIG_MM_SHRINKER) && !defined(CONFIG_MM_KASAN)
+  bool shrunk = false;
+#endif
 
   /* If oldmem is NULL, then realloc is equivalent to malloc */
 
@@ -1498,6 +1649,20 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       return mm_malloc(heap, size);
     }
 
+  /* A guarded allocation is not resized in place */
+
+  if (heapguard_heap(oldmem) != NULL)
+    {
+      newmem = mm_malloc(heap, size);
+      if (newmem != NULL)
+        {
+          memcpy(newmem, oldmem, MIN(size, heapguard_size(oldmem)));
+          mm_free(heap, oldmem);
+        }
+
+      return newmem;
+    }
+
   /* If size is zero, reallocate to the minim size object, so
    * the memory pointed by oldmem is freed
    */
@@ -1513,6 +1678,8 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       newmem = mempool_multiple_realloc(heap->mm_mpool, oldmem, size);
       if (newmem != NULL)
         {
+          heapprof_free(oldmem);
+          heapprof_alloc(newmem, size);
           return newmem;
         }
       else if (size <= heap->mm_threshold ||
@@ -1546,11 +1713,16 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
   free_delaylist(heap, false);
 
+#ifdef CONFIG_MM_SHRINKER
+retry:
+#endif
+
   /* Allocate from the tlsf pool */
 
   DEBUGVERIFY(mm_lock(heap));
   oldsize = mm_malloc_size(heap, oldmem);
   heap->mm_curused -= oldsize;
+  MM_TASKSTAT_FREE(heap, oldmem, oldsize);
 #if CONFIG_MM_BACKTRACE >= 0
   newmem = tlsf_realloc(heap->mm_tlsf, oldmem, size +
                         sizeof(struct memdump_backtrace_s));
@@ -1572,6 +1744,14 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       sched_note_heap(NOTE_HEAP_ALLOC, heap, newmem, newsize,
                       heap->mm_curused);
     }
+#ifdef CONFIG_MM_HEAP_TASKSTAT
+  else
+    {
+      /* The old block is left in place, charge it again */
+
+      MM_TASKSTAT_ALLOC(heap, oldmem, oldsize);
+    }
+#endif
 
   mm_unlock(heap);
 
@@ -1580,7 +1760,10 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 #if CONFIG_MM_BACKTRACE >= 0
       FAR struct memdump_backtrace_s *buf = newmem + newsize;
       memdump_backtrace(heap, buf);
+      MM_TASKSTAT_ALLOC(heap, newmem, newsize);
 #endif
+      heapprof_free(oldmem);
+      heapprof_alloc(newmem, size);
     }
 
 #if CONFIG_MM_FREE_DELAYCOUNT_MAX > 0
@@ -1592,6 +1775,16 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
     }
 #endif
 
+#ifdef CONFIG_MM_SHRINKER
+  /* Try once more after the shrinkers gave memory back */
+
+  else if (MM_INTERNAL_HEAP(heap) && !shrunk && mm_shrink(heap, size) > 0)
+    {
+      shrunk = true;
+      goto retry;
+    }
+#endif
+
 #endif
   return newmem;
 }
@@ -48,8 +48,11 @@
 #undef calloc /* See mm/README.txt */
 FAR void *calloc(size_t n, size_t elem_size)
 {
-#if defined(CONFIG_ARCH_ADDRENV) && defined(CONFIG_BUILD_KERNEL)
-  /* Use zalloc() because it implements the sbrk() logic */
+#if (defined(CONFIG_ARCH_ADDRENV) && defined(CONFIG_BUILD_KERNEL)) || \
+    defined(CONFIG_MM_TASK_ARENA) || defined(CONFIG_MM_LARGE_ALLOC)
+  /* Use zalloc() because it implements the sbrk(), the arena and the large
+   * allocation logic
+   */
 
   FAR void *mem = NULL;
   /* Verify input parameters
@@ -64,8 +67,6 @@ FAR void *calloc(size_t n, size_t elem_size)
 
   if (elem_size == 0 || n <= (SIZE_MAX / elem_size))
     {
-      /* Use zalloc() because it implements the sbrk() logic */
-
       mem = zalloc(n * elem_size);
     }
 
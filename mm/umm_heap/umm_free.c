@@ -28,6 +28,7 @@
 
 #include <stdlib.h>
 
+#include <nuttx/mm/arena.h>
 #include <nuttx/mm/mm.h>
 
 #include "umm_heap/umm_heap.h"
@@ -48,5 +49,23 @@
 #undef free /* See mm/README.txt */
 void free(FAR void *mem)
 {
+#ifdef CONFIG_MM_TASK_ARENA
+  FAR struct mm_heap_s *heap = mm_arena_heap(mem);
+
+  if (heap != NULL)
+    {
+      mm_free(heap, mem);
+      return;
+    }
+#endif
+
+#ifdef CONFIG_MM_LARGE_ALLOC
+  if (umm_large_member(mem))
+    {
+      umm_large_free(mem);
+      return;
+    }
+#endif
+
   mm_free(USR_HEAP, mem);
 }
@@ -29,6 +29,9 @@
 
 #include <nuttx/config.h>
 
+#include <malloc.h>
+#include <stdbool.h>
+
 #include <nuttx/addrenv.h>
 #include <nuttx/mm/mm.h>
 
@@ -44,4 +47,14 @@
 void umm_try_initialize(void);
 #endif
 
+#ifdef CONFIG_MM_LARGE_ALLOC
+void umm_large_initialize(FAR void *heap_start, FAR size_t *heap_size);
+FAR void *umm_large_alloc(size_t size);
+FAR void *umm_large_realloc(FAR void *oldmem, size_t size);
+void umm_large_free(FAR void *mem);
+bool umm_large_member(FAR void *mem);
+size_t umm_large_size(FAR void *mem);
+void umm_large_info(FAR struct mallinfo *info);
+#endif
+
 #endif /* __MM_UMM_HEAP_UMM_HEAP_H */
@@ -52,5 +52,12 @@
 
 bool umm_heapmember(FAR void *mem)
 {
+#ifdef CONFIG_MM_LARGE_ALLOC
+  if (umm_large_member(mem))
+    {
+      return true;
+    }
+#endif
+
   return mm_heapmember(USR_HEAP, mem);
 }
@@ -86,6 +86,10 @@
 
 void umm_initialize(FAR void *heap_start, size_t heap_size)
 {
+#ifdef CONFIG_MM_LARGE_ALLOC
+  umm_large_initialize(heap_start, &heap_size);
+#endif
+
 #ifdef CONFIG_BUILD_KERNEL
   USR_HEAP = mm_initialize_pool(NULL, heap_start, heap_size, NULL);
 #else
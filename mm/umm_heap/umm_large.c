@@ -0,0 +1,249 @@
+/****************************************************************************
+ * mm/umm_heap/umm_large.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nuttx/atomic.h>
+#include <nuttx/mutex.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/mm/gran.h>
+
+#include "umm_heap/umm_heap.h"
+
+#ifdef CONFIG_MM_LARGE_ALLOC
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define LARGE_PAGESIZE  (1 << CONFIG_MM_LARGE_ALLOC_LOG2PAGE)
+
+/* Each block starts with its size, keep the user part aligned like the
+ * heap does.
+ */
+
+#if CONFIG_MM_DEFAULT_ALIGNMENT == 0
+#  define LARGE_HEADER  (2 * sizeof(uintptr_t))
+#else
+#  define LARGE_HEADER  CONFIG_MM_DEFAULT_ALIGNMENT
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR char *g_large_start;
+static FAR char *g_large_end;
+
+/* The granule allocator takes its state from the kernel heap, which may
+ * not be ready when the user heap is, so it is created on first use.
+ */
+
+static GRAN_HANDLE g_large;
+static mutex_t g_large_lock = NXMUTEX_INITIALIZER;
+
+static atomic_int g_large_nblks;
+/* The pages may span more than 2GiB, keep the byte count as wide as
+ * size_t.
+ */
+
+static atomic_ulong g_large_nbytes;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static GRAN_HANDLE umm_large_handle(void)
+{
+  if (g_large == NULL && g_large_end > g_large_start &&
+      nxmutex_lock(&g_large_lock) >= 0)
+    {
+      if (g_large == NULL)
+        {
+          g_large = gran_initialize(g_large_start,
+                                    g_large_end - g_large_start,
+                                    CONFIG_MM_LARGE_ALLOC_LOG2PAGE,
+                                    CONFIG_MM_LARGE_ALLOC_LOG2PAGE);
+        }
+
+      nxmutex_unlock(&g_large_lock);
+    }
+
+  return g_large;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: umm_large_initialize
+ *
+ * Description:
+ *   Take CONFIG_MM_LARGE_ALLOC_PERCENT of the initial user heap region
+ *   for the pages of the large allocations.
+ *
+ ****************************************************************************/
+
+void umm_large_initialize(FAR void *heap_start, FAR size_t *heap_size)
+{
+  size_t size = *heap_size / 100 * CONFIG_MM_LARGE_ALLOC_PERCENT;
+
+  g_large_end = (FAR char *)heap_start + *heap_size;
+  g_large_start = (FAR char *)ALIGN_UP((uintptr_t)g_large_end - size,
+                                       LARGE_PAGESIZE);
+  if (g_large_start >= g_large_end)
+    {
+      g_large_start = g_large_end;
+      return;
+    }
+
+  *heap_size = g_large_start - (FAR char *)heap_start;
+}
+
+/****************************************************************************
+ * Name: umm_large_alloc
+ *
+ * Description:
+ *   Allocate size bytes from the pages if it's above the threshold.  NULL
+ *   means the caller should use the heap.
+ *
+ ****************************************************************************/
+
+FAR void *umm_large_alloc(size_t size)
+{
+  GRAN_HANDLE handle;
+  FAR size_t *blk;
+
+  if (size < CONFIG_MM_LARGE_ALLOC_THRESHOLD ||
+      size > SIZE_MAX - LARGE_HEADER ||
+      (handle = umm_large_handle()) == NULL)
+    {
+      return NULL;
+    }
+
+  size += LARGE_HEADER;
+  blk = gran_alloc(handle, size);
+  if (blk == NULL)
+    {
+      return NULL;
+    }
+
+  *blk = size;
+  atomic_fetch_add(&g_large_nblks, 1);
+  atomic_fetch_add(&g_large_nbytes, ALIGN_UP(size, LARGE_PAGESIZE));
+  return (FAR char *)blk + LARGE_HEADER;
+}
+
+/****************************************************************************
+ * Name: umm_large_realloc
+ ****************************************************************************/
+
+FAR void *umm_large_realloc(FAR void *oldmem, size_t size)
+{
+  size_t oldsize = umm_large_size(oldmem);
+  FAR void *mem;
+
+  if (size == 0)
+    {
+      umm_large_free(oldmem);
+      return NULL;
+    }
+
+  /* Stay while the pages hold the block and it's still large */
+
+  if (size <= oldsize && size >= CONFIG_MM_LARGE_ALLOC_THRESHOLD)
+    {
+      return oldmem;
+    }
+
+  mem = malloc(size);
+  if (mem != NULL)
+    {
+      memcpy(mem, oldmem, oldsize < size ? oldsize : size);
+      umm_large_free(oldmem);
+    }
+
+  return mem;
+}
+
+/****************************************************************************
+ * Name: umm_large_free
+ ****************************************************************************/
+
+void umm_large_free(FAR void *mem)
+{
+  FAR size_t *blk = (FAR size_t *)((FAR char *)mem - LARGE_HEADER);
+  size_t size = *blk;
+
+  atomic_fetch_sub(&g_large_nblks, 1);
+  atomic_fetch_sub(&g_large_nbytes, ALIGN_UP(size, LARGE_PAGESIZE));
+  gran_free(g_large, blk, size);
+}
+
+/****************************************************************************
+ * Name: umm_large_member
+ ****************************************************************************/
+
+bool umm_large_member(FAR void *mem)
+{
+  return (FAR char *)mem >= g_large_start && (FAR char *)mem < g_large_end;
+}
+
+/****************************************************************************
+ * Name: umm_large_size
+ ****************************************************************************/
+
+size_t umm_large_size(FAR void *mem)
+{
+  FAR size_t *blk = (FAR size_t *)((FAR char *)mem - LARGE_HEADER);
+
+  return ALIGN_UP(*blk, LARGE_PAGESIZE) - LARGE_HEADER;
+}
+
+/****************************************************************************
+ * Name: umm_large_info
+ *
+ * Description:
+ *   Report the large allocations the way mmap()ed chunks are reported
+ *   elsewhere: their number in hblks and their size in hblkhd.
+ *
+ ****************************************************************************/
+
+void umm_large_info(FAR struct mallinfo *info)
+{
+  unsigned long nbytes = atomic_load(&g_large_nbytes);
+
+  info->hblks = atomic_load(&g_large_nblks);
+  info->hblkhd = nbytes > INT_MAX ? INT_MAX : nbytes;
+}
+
+#endif /* CONFIG_MM_LARGE_ALLOC */
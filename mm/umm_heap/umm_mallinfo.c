@@ -47,7 +47,14 @@
 
 struct mallinfo mallinfo(void)
 {
+#ifdef CONFIG_MM_LARGE_ALLOC
+  struct mallinfo info = mm_mallinfo(USR_HEAP);
+
+  umm_large_info(&info);
+  return info;
+#else
   return mm_mallinfo(USR_HEAP);
+#endif
 }
 
 /****************************************************************************
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
+#include <nuttx/mm/arena.h>
 #include <nuttx/mm/mm.h>
 
 #include "umm_heap/umm_heap.h"
@@ -59,11 +60,34 @@ FAR void *malloc(size_t size)
 
   return memalign(sizeof(FAR void *), size);
 #else
-  FAR void *ret;
+  FAR void *ret = NULL;
+
+  /* Large requests go to the pages before anything else, the task arena
+   * extents are too small to hold them.
+   */
+
+#ifdef CONFIG_MM_LARGE_ALLOC
+  ret = umm_large_alloc(size);
+#endif
+
+#ifdef CONFIG_MM_TASK_ARENA
+  if (ret == NULL)
+    {
+      ret = mm_arena_malloc(size);
+      if (ret != NULL)
+        {
+          return ret;
+        }
+    }
+#endif
 
   /* Use mm_malloc() because it implements the clear */
 
-  ret = mm_malloc(USR_HEAP, size);
+  if (ret == NULL)
+    {
+      ret = mm_malloc(USR_HEAP, size);
+    }
+
   if (ret == NULL)
     {
       set_errno(ENOMEM);
@@ -28,6 +28,7 @@
 
 #include <malloc.h>
 
+#include <nuttx/mm/arena.h>
 #include <nuttx/mm/mm.h>
 
 #include "umm_heap.h"
@@ -39,5 +40,21 @@
 #undef malloc_size /* See mm/README.txt */
 size_t malloc_size(FAR void *mem)
 {
+#ifdef CONFIG_MM_TASK_ARENA
+  FAR struct mm_heap_s *heap = mm_arena_heap(mem);
+
+  if (heap != NULL)
+    {
+      return mm_malloc_size(heap, mem);
+    }
+#endif
+
+#ifdef CONFIG_MM_LARGE_ALLOC
+  if (umm_large_member(mem))
+    {
+      return umm_large_size(mem);
+    }
+#endif
+
   return mm_malloc_size(USR_HEAP, mem);
 }
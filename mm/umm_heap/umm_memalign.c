@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
+#include <nuttx/mm/arena.h>
 #include <nuttx/mm/mm.h>
 
 #include "umm_heap/umm_heap.h"
@@ -90,6 +91,14 @@ FAR void *memalign(size_t alignment, size_t size)
 #else
   FAR void *ret;
 
+#ifdef CONFIG_MM_TASK_ARENA
+  ret = mm_arena_memalign(alignment, size);
+  if (ret != NULL)
+    {
+      return ret;
+    }
+#endif
+
   ret = mm_memalign(USR_HEAP, alignment, size);
   if (ret == NULL)
     {
@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
+#include <nuttx/mm/arena.h>
 #include <nuttx/mm/mm.h>
 
 #include "umm_heap/umm_heap.h"
@@ -92,6 +93,39 @@ FAR void *realloc(FAR void *oldmem, size_t size)
 #else
   FAR void *ret;
 
+#ifdef CONFIG_MM_TASK_ARENA
+  FAR struct mm_heap_s *heap = mm_arena_heap(oldmem);
+
+  if (heap != NULL)
+    {
+      ret = mm_arena_realloc(heap, oldmem, size);
+      if (ret == NULL && size > 0)
+        {
+          set_errno(ENOMEM);
+        }
+
+      return ret;
+    }
+#endif
+
+#ifdef CONFIG_MM_LARGE_ALLOC
+  if (umm_large_member(oldmem))
+    {
+      return umm_large_realloc(oldmem, size);
+    }
+#endif
+
+#if defined(CONFIG_MM_TASK_ARENA) || defined(CONFIG_MM_LARGE_ALLOC)
+  /* Use malloc() because it implements the arena and the large allocation
+   * logic
+   */
+
+  if (oldmem == NULL)
+    {
+      return malloc(size);
+    }
+#endif
+
   ret = mm_realloc(USR_HEAP, oldmem, size);
   if (ret == NULL)
     {
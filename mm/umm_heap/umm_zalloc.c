@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <nuttx/mm/arena.h>
 #include <nuttx/mm/mm.h>
 
 #include "umm_heap/umm_heap.h"
@@ -65,11 +66,38 @@ FAR void *zalloc(size_t size)
 
   return mem;
 #else
-  FAR void *ret;
+  FAR void *ret = NULL;
+
+  /* Large requests go to the pages before anything else, the task arena
+   * extents are too small to hold them.
+   */
+
+#ifdef CONFIG_MM_LARGE_ALLOC
+  ret = umm_large_alloc(size);
+  if (ret != NULL)
+    {
+      memset(ret, 0, size);
+    }
+#endif
+
+#ifdef CONFIG_MM_TASK_ARENA
+  if (ret == NULL)
+    {
+      ret = mm_arena_zalloc(size);
+      if (ret != NULL)
+        {
+          return ret;
+        }
+    }
+#endif
 
   /* Use mm_zalloc() because it implements the clear */
 
-  ret = mm_zalloc(USR_HEAP, size);
+  if (ret == NULL)
+    {
+      ret = mm_zalloc(USR_HEAP, size);
+    }
+
   if (ret == NULL)
     {
       set_errno(ENOMEM);
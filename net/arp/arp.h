@@ -45,6 +45,7 @@
 #include <netinet/arp.h>
 #include <netinet/in.h>
 
+#include <nuttx/mm/iob.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/semaphore.h>
 
@@ -68,6 +69,26 @@
 #  define CONFIG_ARP_SEND_DELAYMSEC 20
 #endif
 
+#ifndef CONFIG_NET_ARP_ALLOC_ENTRIES
+#  define CONFIG_NET_ARP_ALLOC_ENTRIES 0
+#endif
+
+#ifndef CONFIG_NET_ARP_MAX_ENTRIES
+#  define CONFIG_NET_ARP_MAX_ENTRIES 0
+#endif
+
+#ifndef CONFIG_NET_ARP_HASHSIZE
+#  define CONFIG_NET_ARP_HASHSIZE 16
+#endif
+
+#ifndef CONFIG_NET_ARP_REACHABLE
+#  define CONFIG_NET_ARP_REACHABLE 30
+#endif
+
+#ifndef CONFIG_NET_ARP_QUEUELEN
+#  define CONFIG_NET_ARP_QUEUELEN 0
+#endif
+
 /* ARP Definitions **********************************************************/
 
 #define ARP_REQUEST    1
@@ -77,6 +98,20 @@
 
 #define RASIZE         4  /* Size of ROUTER ALERT */
 
+/* ARP table entry states.  An entry is created INCOMPLETE when the first
+ * packet for an unknown address is sent, turns REACHABLE with the reply
+ * and STALE when it was not confirmed for CONFIG_NET_ARP_REACHABLE seconds.
+ * Using a STALE entry sends a new request (PROBE) with the next poll of the
+ * device; the entry is dropped if that remains unanswered.  FAILED entries
+ * remember an address that did not answer at all.
+ */
+
+#define ARP_STATE_INCOMPLETE 0
+#define ARP_STATE_REACHABLE  1
+#define ARP_STATE_STALE      2
+#define ARP_STATE_PROBE      3
+#define ARP_STATE_FAILED     4
+
 /* Allocate a new ARP data callback */
 
 #define arp_callback_alloc(dev)   devif_callback_alloc(dev, \
@@ -161,10 +196,20 @@ struct arp_notify_s
 
 struct arp_entry_s
 {
+  dq_entry_t               at_node;     /* Link in the hash bucket */
+  dq_entry_t               at_lru;      /* Link in the LRU list */
   in_addr_t                at_ipaddr;   /* IP address */
   struct ether_addr        at_ethaddr;  /* Hardware address */
-  clock_t                  at_time;     /* Time of last usage */
+  uint8_t                  at_state;    /* See ARP_STATE_* definitions */
+  clock_t                  at_time;     /* Time of last reply or request */
   FAR struct net_driver_s *at_dev;      /* The device driver structure */
+#ifdef CONFIG_NET_ARP_SEND
+  bool                     at_probe;    /* The PROBE request is not sent yet */
+#endif
+#if CONFIG_NET_ARP_QUEUELEN > 0
+  uint8_t                  at_nqueued;  /* Number of packets in at_queue */
+  struct iob_queue_s       at_queue;    /* Packets waiting for resolution */
+#endif
 };
 
 /****************************************************************************
@@ -508,6 +553,59 @@ int arp_update(FAR struct net_driver_s *dev, in_addr_t ipaddr,
 void arp_hdr_update(FAR struct net_driver_s *dev, FAR uint16_t *pipaddr,
                     FAR const uint8_t *ethaddr);
 
+/****************************************************************************
+ * Name: arp_queue
+ *
+ * Description:
+ *   Keep a copy of the outgoing IPv4 packet in the device buffer until the
+ *   ARP request for its next hop is answered.  An INCOMPLETE ARP table
+ *   entry is created for the address if there is none yet.
+ *
+ * Input Parameters:
+ *   dev    - The device driver structure holding the packet
+ *   ipaddr - The next hop IP address in network order
+ *
+ * Assumptions
+ *   The network is locked to assure exclusive access to the ARP table
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_ARP_QUEUELEN > 0
+void arp_queue(FAR struct net_driver_s *dev, in_addr_t ipaddr);
+#else
+#  define arp_queue(d,i)
+#endif
+
+/****************************************************************************
+ * Name: arp_queue_poll
+ *
+ * Description:
+ *   Send the requests of the STALE entries arp_find() moved to PROBE and
+ *   the packets kept by arp_queue() whose next hop address got resolved.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll() with the network locked.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_ARP_QUEUELEN > 0 || defined(CONFIG_NET_ARP_SEND)
+int arp_queue_poll(FAR struct net_driver_s *dev,
+                   devif_poll_callback_t callback);
+#else
+#  define arp_queue_poll(d,c) (0)
+#endif
+
+/****************************************************************************
+ * Name: arp_count
+ *
+ * Description:
+ *   Return the number of entries currently in the ARP table.
+ *
+ ****************************************************************************/
+
+unsigned int arp_count(void);
+
 /****************************************************************************
  * Name: arp_snapshot
  *
@@ -625,6 +723,9 @@ void arp_acd_setup(FAR struct net_driver_s *dev);
 #  define arp_cleanup(d)
 #  define arp_update(d,i,m);
 #  define arp_hdr_update(d,i,m);
+#  define arp_queue(d,i)
+#  define arp_queue_poll(d,c) (0)
+#  define arp_count() (0)
 #  define arp_snapshot(s,n) (0)
 #  define arp_dump(arp)
 
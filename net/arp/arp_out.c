@@ -267,10 +267,16 @@ void arp_out(FAR struct net_driver_s *dev)
     {
       ninfo("ARP request for IP %08lx\n", (unsigned long)ipaddr);
 
-      /* The destination address was not in our ARP table, so we overwrite
-       * the IP packet with an ARP request.
+      /* The destination address was not in our ARP table, so we keep a
+       * copy of the IP packet for when the reply arrives and overwrite it
+       * with an ARP request.
        */
 
+      if (ret == -ENOENT)
+        {
+          arp_queue(dev, ipaddr);
+        }
+
       arp_format(dev, ipaddr);
       arp_dump(ARPBUF);
       return;
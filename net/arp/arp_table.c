@@ -56,6 +56,7 @@
 #include <net/ethernet.h>
 
 #include <nuttx/clock.h>
+#include <nuttx/nuttx.h>
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
@@ -63,6 +64,7 @@
 
 #include "netdev/netdev.h"
 #include "netlink/netlink.h"
+#include "utils/utils.h"
 #include "arp/arp.h"
 
 #ifdef CONFIG_NET_ARP
@@ -71,7 +73,17 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define ARP_MAXAGE_TICK SEC2TICK(10 * CONFIG_NET_ARP_MAXAGE)
+#define ARP_MAXAGE_TICK    SEC2TICK(10 * CONFIG_NET_ARP_MAXAGE)
+#define ARP_REACHABLE_TICK SEC2TICK(CONFIG_NET_ARP_REACHABLE)
+
+/* How long an INCOMPLETE or PROBE entry waits for the reply */
+
+#define ARP_PROBE_TICK     SEC2TICK(3)
+
+/* An entry in these states provides a usable hardware address */
+
+#define ARP_RESOLVED(e) \
+  ((e)->at_state >= ARP_STATE_REACHABLE && (e)->at_state <= ARP_STATE_PROBE)
 
 /****************************************************************************
  * Private Types
@@ -87,9 +99,31 @@ struct arp_table_info_s
  * Private Data
  ****************************************************************************/
 
-/* The table of known address mappings */
+/* The pool of ARP table entries */
+
+NET_BUFPOOL_DECLARE(g_arp_entries, sizeof(struct arp_entry_s),
+                    CONFIG_NET_ARPTAB_SIZE, CONFIG_NET_ARP_ALLOC_ENTRIES,
+                    CONFIG_NET_ARP_MAX_ENTRIES);
+
+/* The entries in use, hashed by IP address and ordered by last use (most
+ * recently used first).
+ */
+
+static dq_queue_t g_arp_hash[CONFIG_NET_ARP_HASHSIZE];
+static dq_queue_t g_arp_lru;
+static unsigned int g_arp_nentries;
+
+#if CONFIG_NET_ARP_QUEUELEN > 0
+/* The number of resolved entries that still hold queued packets */
+
+static unsigned int g_arp_nready;
+#endif
+
+#ifdef CONFIG_NET_ARP_SEND
+/* The number of entries waiting for arp_queue_poll() to send a PROBE */
 
-static struct arp_entry_s g_arptable[CONFIG_NET_ARPTAB_SIZE];
+static unsigned int g_arp_nprobe;
+#endif
 
 static const struct ether_addr g_zero_ethaddr =
 {
@@ -149,31 +183,225 @@ static int arp_match(FAR struct net_driver_s *dev, FAR void *arg)
 }
 
 /****************************************************************************
- * Name: arp_return_old_entry
+ * Name: arp_hash
+ *
+ * Description:
+ *   Return the hash bucket of an IP address.
+ *
+ ****************************************************************************/
+
+static inline FAR dq_queue_t *arp_hash(in_addr_t ipaddr)
+{
+  uint32_t hash = ipaddr;
+
+  hash ^= hash >> 16;
+  hash ^= hash >> 8;
+  return &g_arp_hash[hash % CONFIG_NET_ARP_HASHSIZE];
+}
+
+/****************************************************************************
+ * Name: arp_get_arpreq
+ *
+ * Description:
+ *   Translate (struct arp_entry_s) to (struct arpreq) for netlink notify.
+ *
+ * Input Parameters:
+ *   output - Location to return the ARP table copy
+ *   input  - The arp entry in table
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETLINK_ROUTE
+static void arp_get_arpreq(FAR struct arpreq *output,
+                           FAR struct arp_entry_s *input)
+{
+  FAR struct sockaddr_in *outaddr;
+
+  DEBUGASSERT(output != NULL && input != NULL);
+
+  outaddr = (FAR struct sockaddr_in *)&output->arp_pa;
+  outaddr->sin_family      = AF_INET;
+  outaddr->sin_port        = 0;
+  outaddr->sin_addr.s_addr = input->at_ipaddr;
+  memcpy(output->arp_ha.sa_data, input->at_ethaddr.ether_addr_octet,
+         sizeof(struct ether_addr));
+  strlcpy((FAR char *)output->arp_dev, input->at_dev->d_ifname,
+          sizeof(output->arp_dev));
+}
+#endif
+
+/****************************************************************************
+ * Name: arp_set_state
  *
  * Description:
- *   Compare and return the old ARP table entry.
+ *   Move an entry to a new state and restart its timer.  Packets queued on
+ *   the entry become ready to send once it is resolved and are dropped if
+ *   the resolution failed.
  *
  ****************************************************************************/
 
-static FAR struct arp_entry_s *
-arp_return_old_entry(FAR struct arp_entry_s *e1, FAR struct arp_entry_s *e2)
+static void arp_set_state(FAR struct arp_entry_s *tabptr, uint8_t state)
 {
-  if (e1->at_ipaddr == 0)
+#if CONFIG_NET_ARP_QUEUELEN > 0
+  bool resolved = ARP_RESOLVED(tabptr);
+#endif
+
+#ifdef CONFIG_NET_ARP_SEND
+  /* A reply or a failure makes the pending probe pointless */
+
+  if (tabptr->at_probe && state != ARP_STATE_PROBE)
     {
-      return e1;
+      tabptr->at_probe = false;
+      g_arp_nprobe--;
     }
-  else if (e2->at_ipaddr == 0)
+#endif
+
+  tabptr->at_state = state;
+  tabptr->at_time  = clock_systime_ticks();
+
+#if CONFIG_NET_ARP_QUEUELEN > 0
+  if (tabptr->at_nqueued > 0 && resolved != ARP_RESOLVED(tabptr))
     {
-      return e2;
+      if (resolved)
+        {
+          g_arp_nready--;
+        }
+      else
+        {
+          g_arp_nready++;
+          netdev_txnotify_dev(tabptr->at_dev);
+        }
     }
-  else if ((int)(e1->at_time - e2->at_time) <= 0)
+
+  if (state == ARP_STATE_FAILED && tabptr->at_nqueued > 0)
     {
-      return e1;
+      iob_free_queue(&tabptr->at_queue);
+      tabptr->at_nqueued = 0;
     }
-  else
+#endif
+}
+
+/****************************************************************************
+ * Name: arp_free_entry
+ *
+ * Description:
+ *   Remove an entry from the ARP table and return it to the pool.
+ *
+ ****************************************************************************/
+
+static void arp_free_entry(FAR struct arp_entry_s *tabptr)
+{
+#ifdef CONFIG_NETLINK_ROUTE
+  struct arpreq arp_notify;
+
+  /* Entries that never had an address were never announced */
+
+  if (tabptr->at_state != ARP_STATE_INCOMPLETE)
+    {
+      arp_get_arpreq(&arp_notify, tabptr);
+      netlink_neigh_notify(&arp_notify, RTM_DELNEIGH, AF_INET);
+    }
+#endif
+
+#if CONFIG_NET_ARP_QUEUELEN > 0
+  if (tabptr->at_nqueued > 0)
+    {
+      if (ARP_RESOLVED(tabptr))
+        {
+          g_arp_nready--;
+        }
+
+      iob_free_queue(&tabptr->at_queue);
+    }
+#endif
+
+#ifdef CONFIG_NET_ARP_SEND
+  if (tabptr->at_probe)
     {
-      return e2;
+      g_arp_nprobe--;
+    }
+#endif
+
+  dq_rem(&tabptr->at_node, arp_hash(tabptr->at_ipaddr));
+  dq_rem(&tabptr->at_lru, &g_arp_lru);
+  g_arp_nentries--;
+
+  NET_BUFPOOL_FREE(g_arp_entries, tabptr);
+}
+
+/****************************************************************************
+ * Name: arp_alloc_entry
+ *
+ * Description:
+ *   Add a new INCOMPLETE entry to the ARP table.  The least recently used
+ *   entry is recycled when the table is full.
+ *
+ ****************************************************************************/
+
+static FAR struct arp_entry_s *arp_alloc_entry(in_addr_t ipaddr,
+                                               FAR struct net_driver_s *dev)
+{
+  FAR struct arp_entry_s *tabptr;
+  FAR dq_entry_t *oldest;
+
+  tabptr = NET_BUFPOOL_TRYALLOC(g_arp_entries);
+  if (tabptr == NULL)
+    {
+      oldest = dq_tail(&g_arp_lru);
+      if (oldest == NULL)
+        {
+          return NULL;
+        }
+
+      arp_free_entry(container_of(oldest, struct arp_entry_s, at_lru));
+      tabptr = NET_BUFPOOL_TRYALLOC(g_arp_entries);
+      if (tabptr == NULL)
+        {
+          return NULL;
+        }
+    }
+
+  tabptr->at_ipaddr = ipaddr;
+  tabptr->at_dev    = dev;
+  tabptr->at_state  = ARP_STATE_INCOMPLETE;
+  tabptr->at_time   = clock_systime_ticks();
+
+  dq_addfirst(&tabptr->at_node, arp_hash(ipaddr));
+  dq_addfirst(&tabptr->at_lru, &g_arp_lru);
+  g_arp_nentries++;
+
+  return tabptr;
+}
+
+/****************************************************************************
+ * Name: arp_expired
+ *
+ * Description:
+ *   Advance the state of an entry with the time passed since its last
+ *   reply or request.  Returns true if the entry should be dropped.
+ *
+ ****************************************************************************/
+
+static bool arp_expired(FAR struct arp_entry_s *tabptr, clock_t now)
+{
+  clock_t elapsed = now - tabptr->at_time;
+
+  switch (tabptr->at_state)
+    {
+      case ARP_STATE_INCOMPLETE:
+      case ARP_STATE_PROBE:
+        return elapsed > ARP_PROBE_TICK;
+
+      case ARP_STATE_REACHABLE:
+        if (elapsed > ARP_REACHABLE_TICK)
+          {
+            tabptr->at_state = ARP_STATE_STALE;
+          }
+
+        /* Fall through */
+
+      default:
+        return elapsed > ARP_MAXAGE_TICK;
     }
 }
 
@@ -182,6 +410,8 @@ arp_return_old_entry(FAR struct arp_entry_s *e1, FAR struct arp_entry_s *e2)
  *
  * Description:
  *   Find the ARP entry corresponding to this IP address in the ARP table.
+ *   A found entry becomes the most recently used one, an expired entry is
+ *   dropped.
  *
  * Input Parameters:
  *   ipaddr - Refers to an IP address in network order
@@ -197,17 +427,28 @@ static FAR struct arp_entry_s *arp_lookup(in_addr_t ipaddr,
                                           FAR struct net_driver_s *dev)
 {
   FAR struct arp_entry_s *tabptr;
-  int i;
+  FAR dq_entry_t *node;
 
   /* Check if the IPv4 address is already in the ARP table. */
 
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
+  for (node = dq_peek(arp_hash(ipaddr)); node != NULL; node = dq_next(node))
     {
-      tabptr = &g_arptable[i];
+      tabptr = container_of(node, struct arp_entry_s, at_node);
       if (tabptr->at_dev == dev &&
-          net_ipv4addr_cmp(ipaddr, tabptr->at_ipaddr) &&
-          clock_systime_ticks() - tabptr->at_time <= ARP_MAXAGE_TICK)
+          net_ipv4addr_cmp(ipaddr, tabptr->at_ipaddr))
         {
+          if (arp_expired(tabptr, clock_systime_ticks()))
+            {
+              arp_free_entry(tabptr);
+              return NULL;
+            }
+
+          if (dq_peek(&g_arp_lru) != &tabptr->at_lru)
+            {
+              dq_rem(&tabptr->at_lru, &g_arp_lru);
+              dq_addfirst(&tabptr->at_lru, &g_arp_lru);
+            }
+
           return tabptr;
         }
     }
@@ -217,37 +458,6 @@ static FAR struct arp_entry_s *arp_lookup(in_addr_t ipaddr,
   return NULL;
 }
 
-/****************************************************************************
- * Name: arp_get_arpreq
- *
- * Description:
- *   Translate (struct arp_entry_s) to (struct arpreq) for netlink notify.
- *
- * Input Parameters:
- *   output - Location to return the ARP table copy
- *   input  - The arp entry in table
- *
- ****************************************************************************/
-
-#ifdef CONFIG_NETLINK_ROUTE
-static void arp_get_arpreq(FAR struct arpreq *output,
-                           FAR struct arp_entry_s *input)
-{
-  FAR struct sockaddr_in *outaddr;
-
-  DEBUGASSERT(output != NULL && input != NULL);
-
-  outaddr = (FAR struct sockaddr_in *)&output->arp_pa;
-  outaddr->sin_family      = AF_INET;
-  outaddr->sin_port        = 0;
-  outaddr->sin_addr.s_addr = input->at_ipaddr;
-  memcpy(output->arp_ha.sa_data, input->at_ethaddr.ether_addr_octet,
-         sizeof(struct ether_addr));
-  strlcpy((FAR char *)output->arp_dev, input->at_dev->d_ifname,
-          sizeof(output->arp_dev));
-}
-#endif
-
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -276,73 +486,49 @@ static void arp_get_arpreq(FAR struct arpreq *output,
 int arp_update(FAR struct net_driver_s *dev, in_addr_t ipaddr,
                FAR const uint8_t *ethaddr)
 {
-  FAR struct arp_entry_s *tabptr = &g_arptable[0];
+  FAR struct arp_entry_s *tabptr;
 #ifdef CONFIG_NETLINK_ROUTE
   struct arpreq arp_notify;
-  bool found = false;
   bool new_entry;
 #endif
-  int i;
+  uint8_t state = ARP_STATE_REACHABLE;
 
-  /* Walk through the ARP mapping table and try to find an entry to
-   * update. If none is found, the IP -> MAC address mapping is
-   * inserted in the ARP table.
+  /* Find the entry to update.  If none is found, the IP -> MAC address
+   * mapping is inserted in the ARP table.
    */
 
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
+  tabptr = arp_lookup(ipaddr, dev);
+  if (tabptr == NULL)
     {
-      /* Check if the source IP address of the incoming packet matches
-       * the IP address in this ARP table entry.
-       */
-
-      if (g_arptable[i].at_dev == dev &&
-          g_arptable[i].at_ipaddr != 0 &&
-          net_ipv4addr_cmp(ipaddr, g_arptable[i].at_ipaddr))
+      tabptr = arp_alloc_entry(ipaddr, dev);
+      if (tabptr == NULL)
         {
-          /* An old entry found, break. */
-
-          tabptr = &g_arptable[i];
-#ifdef CONFIG_NETLINK_ROUTE
-          found = true;
-#endif
-          break;
-        }
-      else
-        {
-          /* Record the oldest entry. */
-
-          tabptr = arp_return_old_entry(tabptr, &g_arptable[i]);
+          return -ENOMEM;
         }
     }
 
+  /* A NULL address records that the IP address did not answer */
+
   if (ethaddr == NULL)
     {
       ethaddr = g_zero_ethaddr.ether_addr_octet;
+      state   = ARP_STATE_FAILED;
     }
 
-  /* When overwite old entry, notify old entry RTM_DELNEIGH */
+  /* Need to notify when entry is new or changes in table */
 
 #ifdef CONFIG_NETLINK_ROUTE
-  if (!found && tabptr->at_ipaddr != 0)
-    {
-      arp_get_arpreq(&arp_notify, tabptr);
-      netlink_neigh_notify(&arp_notify, RTM_DELNEIGH, AF_INET);
-    }
-
-  /* Need to notify when entry is not found or changes in table */
-
-  new_entry = !found || memcmp(tabptr->at_ethaddr.ether_addr_octet,
-                               ethaddr, ETHER_ADDR_LEN) != 0;
+  new_entry = tabptr->at_state == ARP_STATE_INCOMPLETE ||
+              memcmp(tabptr->at_ethaddr.ether_addr_octet,
+                     ethaddr, ETHER_ADDR_LEN) != 0;
 #endif
 
   /* Now, tabptr is the ARP table entry which we will fill with the new
    * information.
    */
 
-  tabptr->at_ipaddr = ipaddr;
   memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
-  tabptr->at_dev = dev;
-  tabptr->at_time = clock_systime_ticks();
+  arp_set_state(tabptr, state);
 
   /* Notify the new entry */
 
@@ -417,18 +603,33 @@ int arp_find(in_addr_t ipaddr, FAR uint8_t *ethaddr,
   /* Check if the IPv4 address is already in the ARP table. */
 
   tabptr = arp_lookup(ipaddr, dev);
-  if (tabptr != NULL)
+  if (tabptr != NULL && tabptr->at_state != ARP_STATE_INCOMPLETE)
     {
       /* Addresses that have failed to be searched will return a special
        * error code so that the upper layer can return faster.
        */
 
-      if (memcmp(&tabptr->at_ethaddr, &g_zero_ethaddr,
-                 sizeof(tabptr->at_ethaddr)) == 0)
+      if (tabptr->at_state == ARP_STATE_FAILED)
         {
           return -ENETUNREACH;
         }
 
+#ifdef CONFIG_NET_ARP_SEND
+      /* The address was not confirmed for a while, ask again.  The entry
+       * keeps being used until the probe times out.  This may run in the
+       * middle of devif_poll(), so the request is sent by the next poll
+       * of the device from arp_queue_poll().
+       */
+
+      if (tabptr->at_state == ARP_STATE_STALE)
+        {
+          arp_set_state(tabptr, ARP_STATE_PROBE);
+          tabptr->at_probe = true;
+          g_arp_nprobe++;
+          netdev_txnotify_dev(tabptr->at_dev);
+        }
+#endif
+
       /* Yes.. return the Ethernet MAC address if the caller has provided a
        * non-NULL address in 'ethaddr'.
        */
@@ -481,24 +682,15 @@ int arp_find(in_addr_t ipaddr, FAR uint8_t *ethaddr,
 int arp_delete(in_addr_t ipaddr, FAR struct net_driver_s *dev)
 {
   FAR struct arp_entry_s *tabptr;
-#ifdef CONFIG_NETLINK_ROUTE
-  struct arpreq arp_notify;
-#endif
+
   /* Check if the IPv4 address is in the ARP table. */
 
   tabptr = arp_lookup(ipaddr, dev);
   if (tabptr != NULL)
     {
-      /* Notify to netlink */
-
-#ifdef CONFIG_NETLINK_ROUTE
-      arp_get_arpreq(&arp_notify, tabptr);
-      netlink_neigh_notify(&arp_notify, RTM_DELNEIGH, AF_INET);
-#endif
-
-      /* Yes.. Set the IP address to zero to "delete" it */
+      /* Yes.. remove it, this notifies netlink */
 
-      tabptr->at_ipaddr = 0;
+      arp_free_entry(tabptr);
       return OK;
     }
 
@@ -521,17 +713,222 @@ int arp_delete(in_addr_t ipaddr, FAR struct net_driver_s *dev)
 
 void arp_cleanup(FAR struct net_driver_s *dev)
 {
-  int i;
+  FAR struct arp_entry_s *tabptr;
+  FAR dq_entry_t *node;
+  FAR dq_entry_t *next;
 
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
+  for (node = dq_peek(&g_arp_lru); node != NULL; node = next)
     {
-      if (dev == g_arptable[i].at_dev)
+      next   = dq_next(node);
+      tabptr = container_of(node, struct arp_entry_s, at_lru);
+      if (tabptr->at_dev == dev)
         {
-          memset(&g_arptable[i], 0, sizeof(g_arptable[i]));
+          arp_free_entry(tabptr);
         }
     }
 }
 
+/****************************************************************************
+ * Name: arp_queue
+ *
+ * Description:
+ *   Keep a copy of the outgoing IPv4 packet in the device buffer until the
+ *   ARP request for its next hop is answered.  An INCOMPLETE ARP table
+ *   entry is created for the address if there is none yet.
+ *
+ * Input Parameters:
+ *   dev    - The device driver structure holding the packet
+ *   ipaddr - The next hop IP address in network order
+ *
+ * Assumptions
+ *   The network is locked to assure exclusive access to the ARP table
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_ARP_QUEUELEN > 0
+void arp_queue(FAR struct net_driver_s *dev, in_addr_t ipaddr)
+{
+  FAR struct arp_entry_s *tabptr;
+  FAR struct iob_s *iob;
+
+  if (dev->d_iob == NULL)
+    {
+      return;
+    }
+
+  tabptr = arp_lookup(ipaddr, dev);
+  if (tabptr == NULL)
+    {
+      tabptr = arp_alloc_entry(ipaddr, dev);
+      if (tabptr == NULL)
+        {
+          return;
+        }
+    }
+  else if (tabptr->at_state != ARP_STATE_INCOMPLETE)
+    {
+      /* Resolved entries send directly, failed ones drop the packet */
+
+      return;
+    }
+
+  iob = netdev_iob_clone(dev, true);
+  if (iob == NULL)
+    {
+      return;
+    }
+
+  /* Make room by dropping the oldest packet */
+
+  if (tabptr->at_nqueued >= CONFIG_NET_ARP_QUEUELEN)
+    {
+      iob_free_chain(iob_remove_queue(&tabptr->at_queue));
+      tabptr->at_nqueued--;
+    }
+
+  if (iob_tryadd_queue(iob, &tabptr->at_queue) < 0)
+    {
+      iob_free_chain(iob);
+      return;
+    }
+
+  tabptr->at_nqueued++;
+}
+#endif /* CONFIG_NET_ARP_QUEUELEN > 0 */
+
+/****************************************************************************
+ * Name: arp_queue_poll
+ *
+ * Description:
+ *   Send the requests of the STALE entries arp_find() moved to PROBE and
+ *   the packets kept by arp_queue() whose next hop address got resolved.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll() with the network locked.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_ARP_QUEUELEN > 0 || defined(CONFIG_NET_ARP_SEND)
+int arp_queue_poll(FAR struct net_driver_s *dev,
+                   devif_poll_callback_t callback)
+{
+  FAR struct arp_entry_s *tabptr;
+  FAR dq_entry_t *node;
+#if CONFIG_NET_ARP_QUEUELEN > 0
+  FAR struct iob_s *iob;
+  bool reused = false;
+#endif
+  int bstop = 0;
+
+#ifdef CONFIG_NET_ARP_SEND
+  while (!bstop && g_arp_nprobe > 0)
+    {
+      for (node = dq_peek(&g_arp_lru); node != NULL; node = dq_next(node))
+        {
+          tabptr = container_of(node, struct arp_entry_s, at_lru);
+          if (tabptr->at_dev == dev && tabptr->at_probe)
+            {
+              break;
+            }
+        }
+
+      if (node == NULL)
+        {
+          break;
+        }
+
+      tabptr->at_probe = false;
+      g_arp_nprobe--;
+
+      /* Build the request in the device buffer and send */
+
+      arp_format(dev, tabptr->at_ipaddr);
+      if (dev->d_len > 0)
+        {
+          bstop = callback(dev);
+        }
+    }
+
+  if (bstop && g_arp_nprobe > 0)
+    {
+      netdev_txnotify_dev(dev);
+    }
+#endif
+
+#if CONFIG_NET_ARP_QUEUELEN > 0
+  while (!bstop && g_arp_nready > 0)
+    {
+      /* Sending a packet may reorder or drop entries, so look for the next
+       * ready entry of the device from the start each time.
+       */
+
+      for (node = dq_peek(&g_arp_lru); node != NULL; node = dq_next(node))
+        {
+          tabptr = container_of(node, struct arp_entry_s, at_lru);
+          if (tabptr->at_dev == dev && tabptr->at_nqueued > 0 &&
+              ARP_RESOLVED(tabptr))
+            {
+              break;
+            }
+        }
+
+      if (node == NULL)
+        {
+          break;
+        }
+
+      iob = iob_remove_queue(&tabptr->at_queue);
+      if (--tabptr->at_nqueued == 0)
+        {
+          g_arp_nready--;
+        }
+
+      /* Replace the device buffer, build the L2 header and send */
+
+      reused = true;
+      netdev_iob_replace(dev, iob);
+      devif_out(dev);
+
+      if (dev->d_len > 0)
+        {
+          bstop = callback(dev);
+        }
+    }
+
+  /* Come back for the rest if the driver is out of buffers */
+
+  if (bstop && g_arp_nready > 0)
+    {
+      netdev_txnotify_dev(dev);
+    }
+
+  /* Reuse iob buffer */
+
+  if (!bstop && reused)
+    {
+      iob_update_pktlen(dev->d_iob, 0, false);
+      netdev_iob_prepare(dev, true, 0);
+    }
+#endif
+
+  return bstop;
+}
+#endif
+
+/****************************************************************************
+ * Name: arp_count
+ *
+ * Description:
+ *   Return the number of entries currently in the ARP table.
+ *
+ ****************************************************************************/
+
+unsigned int arp_count(void)
+{
+  return g_arp_nentries;
+}
+
 /****************************************************************************
  * Name: arp_snapshot
  *
@@ -557,19 +954,19 @@ unsigned int arp_snapshot(FAR struct arpreq *snapshot,
                           unsigned int nentries)
 {
   FAR struct arp_entry_s *tabptr;
+  FAR dq_entry_t *node;
   clock_t now;
   unsigned int ncopied;
-  int i;
 
-  /* Copy all non-empty, non-expired entries in the ARP table. */
+  /* Copy all resolved (or failed), non-expired entries in the ARP table */
 
-  for (i = 0, now = clock_systime_ticks(), ncopied = 0;
-       nentries > ncopied && i < CONFIG_NET_ARPTAB_SIZE;
-       i++)
+  for (node = dq_peek(&g_arp_lru), now = clock_systime_ticks(), ncopied = 0;
+       nentries > ncopied && node != NULL;
+       node = dq_next(node))
     {
-      tabptr = &g_arptable[i];
-      if (tabptr->at_ipaddr != 0 &&
-          now - tabptr->at_time <= ARP_MAXAGE_TICK)
+      tabptr = container_of(node, struct arp_entry_s, at_lru);
+      if (tabptr->at_state != ARP_STATE_INCOMPLETE &&
+          !arp_expired(tabptr, now))
         {
           arp_get_arpreq(&snapshot[ncopied], tabptr);
           ncopied++;
@@ -529,6 +529,30 @@ void devif_out(FAR struct net_driver_s *dev);
 int devif_poll_out(FAR struct net_driver_s *dev,
                    devif_poll_callback_t callback);
 
+/****************************************************************************
+ * Name: devif_txready, devif_txready_remove and devif_txready_flush
+ *
+ * Description:
+ *   Maintain the TX ready lists of the devices: connections put themselves
+ *   on d_tcpready or d_udpready when they have something to send and the
+ *   TX poll visits only those, dropping a connection again when polling it
+ *   produced nothing.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_TXREADY
+void devif_txready(FAR dq_queue_t *queue, FAR struct socket_conn_s *conn);
+void devif_txready_remove(FAR struct socket_conn_s *conn);
+void devif_txready_flush(FAR struct net_driver_s *dev);
+#else
+#  define devif_txready(queue, conn)
+#  define devif_txready_remove(conn)
+#  define devif_txready_flush(dev)
+#endif
+
 /****************************************************************************
  * Name: devif_is_loopback
  *
@@ -30,6 +30,7 @@
 #include <debug.h>
 
 #include <nuttx/clock.h>
+#include <nuttx/mm/iob.h>
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/net.h>
@@ -37,6 +38,7 @@
 #include "devif/devif.h"
 #include "netdev/netdev.h"
 #include "arp/arp.h"
+#include "neighbor/neighbor.h"
 #include "can/can.h"
 #include "tcp/tcp.h"
 #include "udp/udp.h"
@@ -582,6 +584,53 @@ static inline int devif_poll_mld(FAR struct net_driver_s *dev,
  ****************************************************************************/
 
 #ifdef NET_UDP_HAVE_STACK
+#ifdef CONFIG_NETDEV_TXREADY
+static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
+                                      devif_poll_callback_t callback)
+{
+  FAR struct udp_conn_s *conn;
+  FAR dq_entry_t *node;
+  dq_entry_t cursor;
+  bool idle;
+  int bstop = 0;
+
+  /* Only the connections on the ready list of the device are polled, see
+   * devif_poll_tcp_connections().
+   */
+
+  node = dq_peek(&dev->d_udpready);
+  while (!bstop && node != NULL)
+    {
+      conn = container_of(node, struct udp_conn_s, sconn.s_txnode);
+      dq_addafter(node, &cursor, &dev->d_udpready);
+
+#ifdef CONFIG_NET_UDP_WRITE_BUFFERS
+      if (dev != conn->dev)
+        {
+          devif_txready_remove(&conn->sconn);
+        }
+      else
+#endif
+        {
+          udp_poll(dev, conn);
+
+          idle = dev->d_len == 0 && iob_navail(false) > 0;
+          if (idle && cursor.blink == node)
+            {
+              devif_txready_remove(&conn->sconn);
+            }
+
+          devif_packet_conversion(dev, DEVIF_UDP);
+          bstop = devif_poll_local_out(dev, callback);
+        }
+
+      node = cursor.flink;
+      dq_rem(&cursor, &dev->d_udpready);
+    }
+
+  return bstop;
+}
+#else
 static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
                                       devif_poll_callback_t callback)
 {
@@ -616,6 +665,7 @@ static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
 
   return bstop;
 }
+#endif /* CONFIG_NETDEV_TXREADY */
 #endif /* NET_UDP_HAVE_STACK */
 
 /****************************************************************************
@@ -630,7 +680,59 @@ static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
  *
  ****************************************************************************/
 
-#ifdef NET_TCP_HAVE_STACK
+#if defined(NET_TCP_HAVE_STACK) && defined(CONFIG_NETDEV_TXREADY)
+static inline int devif_poll_tcp_connections(FAR struct net_driver_s *dev,
+                                             devif_poll_callback_t callback)
+{
+  FAR struct tcp_conn_s *conn;
+  FAR dq_entry_t *node;
+  dq_entry_t cursor;
+  bool idle;
+  int bstop = 0;
+
+  /* Only the connections that queued output, received a segment or had a
+   * timer expire since they were last found idle are on the ready list.
+   * The poll and the output may free any connection of the list, freeing
+   * takes it off the list, so a cursor entry follows the connection being
+   * polled to continue the walk.
+   */
+
+  node = dq_peek(&dev->d_tcpready);
+  while (!bstop && node != NULL)
+    {
+      conn = container_of(node, struct tcp_conn_s, sconn.s_txnode);
+      dq_addafter(node, &cursor, &dev->d_tcpready);
+
+      if (dev != conn->dev)
+        {
+          devif_txready_remove(&conn->sconn);
+        }
+      else
+        {
+          tcp_poll(dev, conn);
+
+          /* Nothing to send: the connection stays off the list until it is
+           * notified again.  Without IOBs the poll could not even try, the
+           * connection is kept then.
+           */
+
+          idle = dev->d_len == 0 && iob_navail(false) > 0;
+          if (idle && cursor.blink == node)
+            {
+              devif_txready_remove(&conn->sconn);
+            }
+
+          devif_packet_conversion(dev, DEVIF_TCP);
+          bstop = devif_poll_local_out(dev, callback);
+        }
+
+      node = cursor.flink;
+      dq_rem(&cursor, &dev->d_tcpready);
+    }
+
+  return bstop;
+}
+#elif defined(NET_TCP_HAVE_STACK)
 static inline int devif_poll_tcp_connections(FAR struct net_driver_s *dev,
                                              devif_poll_callback_t callback)
 {
@@ -785,6 +887,24 @@ static int devif_poll_connections(FAR struct net_driver_s *dev,
   bstop = devif_poll_ipfrag(dev, callback);
   if (!bstop)
 #endif
+#ifdef CONFIG_NET_ARP
+    {
+      /* Send the packets that were waiting for an ARP reply */
+
+      bstop = arp_queue_poll(dev, callback);
+    }
+
+  if (!bstop)
+#endif
+#ifdef CONFIG_NET_IPv6
+    {
+      /* Send the packets that were waiting for a Neighbor Advertisement */
+
+      bstop = neighbor_queue_poll(dev, callback);
+    }
+
+  if (!bstop)
+#endif
 #ifdef CONFIG_NET_ARP_SEND
     {
       /* Check for pending ARP requests */
@@ -1196,6 +1316,76 @@ int devif_poll_out(FAR struct net_driver_s *dev,
   return 0;
 }
 
+/****************************************************************************
+ * Name: devif_txready
+ *
+ * Description:
+ *   Put a connection on a TX ready list of a device so that the next TX
+ *   poll of the device visits it.  A connection is on one list at most,
+ *   it leaves the previous one.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_TXREADY
+void devif_txready(FAR dq_queue_t *queue, FAR struct socket_conn_s *conn)
+{
+  if (conn->s_txqueue != queue)
+    {
+      devif_txready_remove(conn);
+      dq_addlast(&conn->s_txnode, queue);
+      conn->s_txqueue = queue;
+    }
+}
+
+/****************************************************************************
+ * Name: devif_txready_remove
+ *
+ * Description:
+ *   Take a connection off its TX ready list, if any.  Must be called
+ *   before the connection is freed.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void devif_txready_remove(FAR struct socket_conn_s *conn)
+{
+  if (conn->s_txqueue != NULL)
+    {
+      dq_rem(&conn->s_txnode, conn->s_txqueue);
+      conn->s_txqueue = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: devif_txready_flush
+ *
+ * Description:
+ *   Empty the TX ready lists of a device that goes away.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void devif_txready_flush(FAR struct net_driver_s *dev)
+{
+  FAR struct socket_conn_s *conn;
+  FAR dq_entry_t *node;
+
+  while ((node = dq_remfirst(&dev->d_tcpready)) != NULL ||
+         (node = dq_remfirst(&dev->d_udpready)) != NULL)
+    {
+      conn = container_of(node, struct socket_conn_s, s_txnode);
+      conn->s_txqueue = NULL;
+    }
+}
+#endif /* CONFIG_NETDEV_TXREADY */
+
 /****************************************************************************
  * Name: devif_get_mtu
  *
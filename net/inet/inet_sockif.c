@@ -975,6 +975,9 @@ static int inet_set_socketlevel_option(FAR struct socket *psock, int option,
               /* Save the receive buffer size */
 
               tcp->rcv_bufs = buffersize;
+#ifdef CONFIG_NET_TCP_RCVBUF_AUTOTUNE
+              tcp->flags   |= TCP_RCVBUF_LOCK;
+#endif
             }
           else
 #endif
@@ -1036,6 +1039,9 @@ static int inet_set_socketlevel_option(FAR struct socket *psock, int option,
               /* Save the send buffer size */
 
               tcp->snd_bufs = buffersize;
+#ifdef CONFIG_NET_TCP_SNDBUF_AUTOTUNE
+              tcp->flags   |= TCP_SNDBUF_LOCK;
+#endif
             }
           else
 #endif
@@ -1132,6 +1138,11 @@ static int inet_setsockopt(FAR struct socket *psock, int level, int option,
         return tcp_setsockopt(psock, option, value, value_len);
 #endif
 
+#ifdef CONFIG_NET_TCP_KTLS
+      case SOL_TLS:    /* Kernel TLS options (see include/netinet/tls.h) */
+        return tcp_tls_setsockopt(psock, option, value, value_len);
+#endif
+
 #ifdef CONFIG_NET_UDPPROTO_OPTIONS
       case IPPROTO_UDP:/* UDP protocol socket options (see include/netinet/udp.h) */
         return udp_setsockopt(psock, option, value, value_len);
@@ -1751,6 +1762,16 @@ static ssize_t inet_send(FAR struct socket *psock, FAR const void *buf,
 #ifdef CONFIG_NET_TCP
       case SOCK_STREAM:
         {
+#if defined(NET_TCP_HAVE_STACK) && defined(CONFIG_NET_TCP_KTLS)
+          /* The data must be framed and encrypted whatever the device */
+
+          if (tcp_tls_txenabled(psock))
+            {
+              ret = tcp_tls_send(psock, buf, len, flags);
+              break;
+            }
+#endif
+
 #ifdef CONFIG_NET_6LOWPAN
           /* Try 6LoWPAN TCP packet send */
 
@@ -2232,6 +2253,17 @@ static ssize_t inet_sendfile(FAR struct socket *psock,
 #ifdef NET_TCP_HAVE_STACK
   if (psock->s_type == SOCK_STREAM)
     {
+#ifdef CONFIG_NET_TCP_KTLS
+      /* File data must be encrypted, let the VFS fall back to read() and
+       * send() through the TLS record layer.
+       */
+
+      if (tcp_tls_txenabled(psock))
+        {
+          return -ENOSYS;
+        }
+#endif
+
       return tcp_sendfile(psock, infile, offset, count);
     }
 #endif
@@ -2322,6 +2354,14 @@ static ssize_t inet_recvmsg(FAR struct socket *psock,
     case SOCK_STREAM:
       {
 #ifdef NET_TCP_HAVE_STACK
+#ifdef CONFIG_NET_TCP_KTLS
+        if (tcp_tls_rxenabled(psock))
+          {
+            ret = tcp_tls_recvmsg(psock, msg, flags);
+            break;
+          }
+#endif
+
         ret = psock_tcp_recvfrom(psock, msg, flags);
 #else
         ret = -ENOSYS;
@@ -27,6 +27,7 @@
 #include <nuttx/config.h>
 
 #include <debug.h>
+#include <string.h>
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/net/icmpv6.h>
@@ -37,6 +38,7 @@
 #include "icmp/icmp.h"
 #include "icmpv6/icmpv6.h"
 #include "ipfilter/ipfilter.h"
+#include "ipforward/ipforward.h"
 #include "utils/utils.h"
 
 #ifdef CONFIG_NET_IPFILTER
@@ -65,15 +67,79 @@
 #define IPv6_L4HDR(ipv6, proto) \
   ((FAR void *)(net_ipv6_payload((FAR struct ipv6_hdr_s *)(ipv6), &(proto))))
 
+/* The compiled classifier splits each chain into rule lists by protocol,
+ * TCP and UDP rules matching a single destination port are further hashed
+ * by that port.  A packet only needs to be checked against the list of its
+ * protocol and, for TCP and UDP, the list of its destination port bucket.
+ */
+
+#define IPFILTER_BUCKET_TCP    0
+#define IPFILTER_BUCKET_UDP    1
+#define IPFILTER_BUCKET_ICMP   2
+#define IPFILTER_BUCKET_ICMP6  3
+#define IPFILTER_BUCKET_OTHER  4
+#define IPFILTER_NBUCKETS      5
+
+#define IPFILTER_NPORTHASH     16
+#define IPFILTER_PORTHASH(port) \
+  (((port) ^ ((port) >> 4) ^ ((port) >> 8)) & (IPFILTER_NPORTHASH - 1))
+
+/* List IDs: one list per protocol bucket, followed by the port hashed lists
+ * of the TCP and UDP buckets.
+ */
+
+#define IPFILTER_LIST_ANY(bucket)        (bucket)
+#define IPFILTER_LIST_PORT(bucket, hash) \
+  (IPFILTER_NBUCKETS + (bucket) * IPFILTER_NPORTHASH + (hash))
+#define IPFILTER_NLISTS \
+  IPFILTER_LIST_PORT(IPFILTER_BUCKET_ICMP, 0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The compiled form of one chain */
+
+struct ipfilter_list_s
+{
+  uint16_t off;                       /* Offset of the list in vec */
+  uint16_t len;                       /* Number of rules in the list */
+};
+
+struct ipfilter_class_s
+{
+  FAR struct ipfilter_entry_s **vec;  /* Storage of all the lists */
+  struct ipfilter_list_s list[IPFILTER_NLISTS];
+  bool dirty;                         /* Chain changed since compiled */
+  bool valid;                         /* Compiled successfully */
+};
+
+/* The packet being classified */
+
+struct ipfilter_pkt_s
+{
+  FAR const struct net_driver_s *indev;
+  FAR const struct net_driver_s *outdev;
+  FAR const void *iphdr;
+  FAR const void *l4hdr;
+  uint16_t len;
+  uint8_t proto;
+};
+
+typedef CODE bool (*ipfilter_match_t)(FAR const struct ipfilter_entry_s *,
+                                      FAR const struct ipfilter_pkt_s *);
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
 #ifdef CONFIG_NET_IPv4
 static sq_queue_t g_ipv4_filters[IPFILTER_CHAIN_MAX];
+static struct ipfilter_class_s g_ipv4_class[IPFILTER_CHAIN_MAX];
 #endif
 #ifdef CONFIG_NET_IPv6
 static sq_queue_t g_ipv6_filters[IPFILTER_CHAIN_MAX];
+static struct ipfilter_class_s g_ipv6_class[IPFILTER_CHAIN_MAX];
 #endif
 
 /****************************************************************************
@@ -189,85 +255,423 @@ static bool ipfilter_match_proto(FAR const struct ipfilter_entry_s *entry,
 }
 
 /****************************************************************************
- * Name: ipv4_filter_match / ipv6_filter_match
+ * Name: ipfilter_bucket
+ *
+ * Description:
+ *   Get the classifier bucket of a protocol.
+ *
+ ****************************************************************************/
+
+static int ipfilter_bucket(uint8_t proto)
+{
+  switch (proto)
+    {
+      case IP_PROTO_TCP:
+        return IPFILTER_BUCKET_TCP;
+
+      case IP_PROTO_UDP:
+        return IPFILTER_BUCKET_UDP;
+
+      case IP_PROTO_ICMP:
+        return IPFILTER_BUCKET_ICMP;
+
+      case IP_PROTO_ICMP6:
+        return IPFILTER_BUCKET_ICMP6;
+
+      default:
+        return IPFILTER_BUCKET_OTHER;
+    }
+}
+
+/****************************************************************************
+ * Name: ipfilter_listid
  *
  * Description:
- *   Match the input packet with the filter entries in the specified chain.
+ *   Get the list of the bucket that the filter entry belongs to.
  *
  * Input Parameters:
- *   indev     - The network device that the packet comes from
- *   outdev    - The network device that the packet goes to
- *   ipv4/ipv6 - The IPv4/IPv6 header
- *   chain     - The chain to match the filter entries
+ *   entry  - The filter entry
+ *   bucket - The protocol bucket
  *
  * Returned Value:
- *   IPFILTER_TARGET_ACCEPT(0)  - The input packet is accepted
- *   IPFILTER_TARGET_DROP(-1)   - The input packet needs to be dropped
- *   IPFILTER_TARGET_REJECT(-2) - The input packet is rejected
+ *   The list ID, or -1 if the entry can never match packets of the bucket.
  *
  ****************************************************************************/
 
-#ifdef CONFIG_NET_IPv4
-static int ipv4_filter_match(FAR const struct net_driver_s *indev,
-                             FAR const struct net_driver_s *outdev,
-                             FAR const struct ipv4_hdr_s *ipv4,
-                             enum ipfilter_chain_e chain)
+static int ipfilter_listid(FAR const struct ipfilter_entry_s *entry,
+                           int bucket)
 {
-  FAR const struct ipv4_filter_entry_s *filter;
-  FAR const sq_queue_t *queue = &g_ipv4_filters[chain];
-  FAR const sq_entry_t *entry;
-  FAR const void *l4hdr;
-  in_addr_t ipaddr;
-  bool matched;
+  int own;
 
-  /* Handle unexpected status, return ACCEPT to indicate doing nothing. */
+  if (entry->proto != 0)
+    {
+      /* The other bucket holds many protocols, so an inversed protocol
+       * may still match there.
+       */
+
+      own = ipfilter_bucket(entry->proto);
+      if (entry->inv_proto ? own == bucket &&
+                             bucket != IPFILTER_BUCKET_OTHER :
+                             own != bucket)
+        {
+          return -1;
+        }
+    }
 
-  if ((indev == NULL && outdev == NULL) || ipv4 == NULL)
+  if (bucket <= IPFILTER_BUCKET_UDP && entry->proto != 0 &&
+      !entry->inv_proto && entry->match_tcpudp && !entry->inv_dport &&
+      entry->match.tcpudp.dports[0] == entry->match.tcpudp.dports[1])
     {
-      return IPFILTER_TARGET_ACCEPT;
+      return IPFILTER_LIST_PORT(bucket,
+                         IPFILTER_PORTHASH(entry->match.tcpudp.dports[0]));
     }
 
-  l4hdr = IPv4_L4HDR(ipv4);
+  return IPFILTER_LIST_ANY(bucket);
+}
+
+/****************************************************************************
+ * Name: ipfilter_compile
+ *
+ * Description:
+ *   Compile the filter entries of a chain into the per protocol and port
+ *   lists.  The entries keep their chain order inside each list.  If the
+ *   lists cannot be allocated, the chain stays invalid and is scanned
+ *   linearly until it is changed again.
+ *
+ * Input Parameters:
+ *   cls   - The compiled form of the chain
+ *   queue - The filter entries of the chain
+ *
+ ****************************************************************************/
+
+static void ipfilter_compile(FAR struct ipfilter_class_s *cls,
+                             FAR sq_queue_t *queue)
+{
+  FAR struct ipfilter_entry_s *entry;
+  FAR sq_entry_t *node;
+  uint32_t total = 0;
+  uint32_t index = 0;
+  int bucket;
+  int id;
+
+  kmm_free(cls->vec);
+  memset(cls, 0, sizeof(*cls));
 
-  sq_for_every(queue, entry)
+  /* Count the size of each list first */
+
+  sq_for_every(queue, node)
     {
-      filter = (FAR struct ipv4_filter_entry_s *)entry;
+      entry = (FAR struct ipfilter_entry_s *)node;
+      entry->index = index++;
 
-      /* Match device */
+      for (bucket = 0; bucket < IPFILTER_NBUCKETS; bucket++)
+        {
+          id = ipfilter_listid(entry, bucket);
+          if (id >= 0)
+            {
+              cls->list[id].len++;
+              total++;
+            }
+        }
+    }
 
-      if (!ipfilter_match_device(&filter->common, indev, outdev))
+  if (index > UINT16_MAX || total > UINT16_MAX)
+    {
+      nwarn("WARNING: Too many filter entries to compile\n");
+      return;
+    }
+
+  if (total > 0)
+    {
+      cls->vec = kmm_malloc(total * sizeof(FAR struct ipfilter_entry_s *));
+      if (cls->vec == NULL)
         {
-          continue;
+          nerr("ERROR: Failed to compile filter entries\n");
+          return;
         }
+    }
 
-      /* Match addresses */
+  for (total = 0, id = 0; id < IPFILTER_NLISTS; id++)
+    {
+      cls->list[id].off = total;
+      total += cls->list[id].len;
+      cls->list[id].len = 0;
+    }
 
-      ipaddr  = net_ip4addr_conv32(ipv4->srcipaddr);
-      matched = net_ipv4addr_maskcmp(filter->sip, ipaddr, filter->smsk)
-                ^ filter->common.inv_srcip;
-      if (!matched)
+  /* Then fill the lists in chain order */
+
+  sq_for_every(queue, node)
+    {
+      entry = (FAR struct ipfilter_entry_s *)node;
+
+      for (bucket = 0; bucket < IPFILTER_NBUCKETS; bucket++)
         {
-          continue;
+          id = ipfilter_listid(entry, bucket);
+          if (id >= 0)
+            {
+              cls->vec[cls->list[id].off + cls->list[id].len++] = entry;
+            }
         }
+    }
 
-      ipaddr  = net_ip4addr_conv32(ipv4->destipaddr);
-      matched = net_ipv4addr_maskcmp(filter->dip, ipaddr, filter->dmsk)
-                ^ filter->common.inv_dstip;
-      if (!matched)
+  cls->valid = true;
+}
+
+/****************************************************************************
+ * Name: ipfilter_classify
+ *
+ * Description:
+ *   Find the first filter entry of a chain matching the packet.  Only the
+ *   entries in the protocol list and, for TCP and UDP, the destination
+ *   port list of the packet are checked.
+ *
+ * Input Parameters:
+ *   cls   - The compiled form of the chain
+ *   queue - The filter entries of the chain
+ *   pkt   - The packet to classify
+ *   match - The function to match the packet with an entry
+ *
+ * Returned Value:
+ *   The first matched entry, NULL if no entry matched.
+ *
+ ****************************************************************************/
+
+static FAR struct ipfilter_entry_s *
+ipfilter_classify(FAR struct ipfilter_class_s *cls, FAR sq_queue_t *queue,
+                  FAR const struct ipfilter_pkt_s *pkt,
+                  ipfilter_match_t match)
+{
+  FAR struct ipfilter_entry_s **any;
+  FAR struct ipfilter_entry_s **port = NULL;
+  FAR struct ipfilter_entry_s *entry;
+  FAR sq_entry_t *node;
+  uint16_t nport = 0;
+  uint16_t nany;
+  uint16_t i = 0;
+  uint16_t j = 0;
+  int bucket;
+  int id;
+
+  if (cls->dirty)
+    {
+      ipfilter_compile(cls, queue);
+    }
+
+  if (!cls->valid)
+    {
+      /* Not compiled, fall back to scan the whole chain */
+
+      sq_for_every(queue, node)
         {
-          continue;
+          entry = (FAR struct ipfilter_entry_s *)node;
+          if (match(entry, pkt))
+            {
+              return entry;
+            }
         }
 
-      /* Match protocol */
+      return NULL;
+    }
+
+  if (cls->vec == NULL)
+    {
+      return NULL;
+    }
+
+  bucket = ipfilter_bucket(pkt->proto);
+  id     = IPFILTER_LIST_ANY(bucket);
+  any    = cls->vec + cls->list[id].off;
+  nany   = cls->list[id].len;
+
+  if (bucket <= IPFILTER_BUCKET_UDP)
+    {
+      /* Ports in TCP & UDP headers have same offset. */
+
+      FAR const struct udp_hdr_s *udp = pkt->l4hdr;
 
-      if (!ipfilter_match_proto(&filter->common, l4hdr, ipv4->proto))
+      id    = IPFILTER_LIST_PORT(bucket,
+                                 IPFILTER_PORTHASH(NTOHS(udp->destport)));
+      port  = cls->vec + cls->list[id].off;
+      nport = cls->list[id].len;
+    }
+
+  /* Merge the two lists in chain order, the first match wins. */
+
+  while (i < nany || j < nport)
+    {
+      if (j >= nport || (i < nany && any[i]->index < port[j]->index))
         {
-          continue;
+          entry = any[i++];
+        }
+      else
+        {
+          entry = port[j++];
         }
 
+      if (match(entry, pkt))
+        {
+          return entry;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ipv4_filter_entry_match / ipv6_filter_entry_match
+ *
+ * Description:
+ *   Match the packet with one filter entry.
+ *
+ * Input Parameters:
+ *   entry - The filter entry to match
+ *   pkt   - The packet to match
+ *
+ * Returned Value:
+ *   true  - The packet is matched
+ *   false - The packet is not matched
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+static bool ipv4_filter_entry_match(FAR const struct ipfilter_entry_s *entry,
+                                    FAR const struct ipfilter_pkt_s *pkt)
+{
+  FAR const struct ipv4_filter_entry_s *filter =
+    (FAR const struct ipv4_filter_entry_s *)entry;
+  FAR const struct ipv4_hdr_s *ipv4 = pkt->iphdr;
+  in_addr_t ipaddr;
+  bool matched;
+
+  /* Match device */
+
+  if (!ipfilter_match_device(entry, pkt->indev, pkt->outdev))
+    {
+      return false;
+    }
+
+  /* Match addresses */
+
+  ipaddr  = net_ip4addr_conv32(ipv4->srcipaddr);
+  matched = net_ipv4addr_maskcmp(filter->sip, ipaddr, filter->smsk)
+            ^ entry->inv_srcip;
+  if (!matched)
+    {
+      return false;
+    }
+
+  ipaddr  = net_ip4addr_conv32(ipv4->destipaddr);
+  matched = net_ipv4addr_maskcmp(filter->dip, ipaddr, filter->dmsk)
+            ^ entry->inv_dstip;
+  if (!matched)
+    {
+      return false;
+    }
+
+  /* Match protocol */
+
+  return ipfilter_match_proto(entry, pkt->l4hdr, pkt->proto);
+}
+#endif
+
+#ifdef CONFIG_NET_IPv6
+static bool ipv6_filter_entry_match(FAR const struct ipfilter_entry_s *entry,
+                                    FAR const struct ipfilter_pkt_s *pkt)
+{
+  FAR const struct ipv6_filter_entry_s *filter =
+    (FAR const struct ipv6_filter_entry_s *)entry;
+  FAR const struct ipv6_hdr_s *ipv6 = pkt->iphdr;
+  bool matched;
+
+  /* Match device */
+
+  if (!ipfilter_match_device(entry, pkt->indev, pkt->outdev))
+    {
+      return false;
+    }
+
+  /* Match addresses */
+
+  matched = net_ipv6addr_maskcmp(filter->sip, ipv6->srcipaddr,
+                                 filter->smsk)
+            ^ entry->inv_srcip;
+  if (!matched)
+    {
+      return false;
+    }
+
+  matched = net_ipv6addr_maskcmp(filter->dip, ipv6->destipaddr,
+                                 filter->dmsk)
+            ^ entry->inv_dstip;
+  if (!matched)
+    {
+      return false;
+    }
+
+  /* Match protocol */
+
+  return ipfilter_match_proto(entry, pkt->l4hdr, pkt->proto);
+}
+#endif
+
+/****************************************************************************
+ * Name: ipv4_filter_match / ipv6_filter_match
+ *
+ * Description:
+ *   Match the input packet with the filter entries in the specified chain,
+ *   and count the hit on the matched entry.
+ *
+ * Input Parameters:
+ *   indev     - The network device that the packet comes from
+ *   outdev    - The network device that the packet goes to
+ *   ipv4/ipv6 - The IPv4/IPv6 header
+ *   chain     - The chain to match the filter entries
+ *   matched   - The location to return the matched entry, may be NULL
+ *
+ * Returned Value:
+ *   IPFILTER_TARGET_ACCEPT(0)  - The input packet is accepted
+ *   IPFILTER_TARGET_DROP(-1)   - The input packet needs to be dropped
+ *   IPFILTER_TARGET_REJECT(-2) - The input packet is rejected
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+static int ipv4_filter_match(FAR const struct net_driver_s *indev,
+                             FAR const struct net_driver_s *outdev,
+                             FAR const struct ipv4_hdr_s *ipv4,
+                             enum ipfilter_chain_e chain,
+                             FAR struct ipfilter_entry_s **matched)
+{
+  FAR struct ipfilter_entry_s *entry;
+  struct ipfilter_pkt_s pkt;
+
+  /* Handle unexpected status, return ACCEPT to indicate doing nothing. */
+
+  if ((indev == NULL && outdev == NULL) || ipv4 == NULL)
+    {
+      return IPFILTER_TARGET_ACCEPT;
+    }
+
+  pkt.indev  = indev;
+  pkt.outdev = outdev;
+  pkt.iphdr  = ipv4;
+  pkt.l4hdr  = IPv4_L4HDR(ipv4);
+  pkt.len    = ((uint16_t)ipv4->len[0] << 8) + ipv4->len[1];
+  pkt.proto  = ipv4->proto;
+
+  entry = ipfilter_classify(&g_ipv4_class[chain], &g_ipv4_filters[chain],
+                            &pkt, ipv4_filter_entry_match);
+  if (matched != NULL)
+    {
+      *matched = entry;
+    }
+
+  if (entry != NULL)
+    {
       /* Return the target action if matched. */
 
-      return filter->common.target;
+      ipfilter_count(entry, pkt.len);
+      return entry->target;
     }
 
   /* Normally there should be a default rule in chain, won't reach here. */
@@ -281,14 +685,12 @@ static int ipv4_filter_match(FAR const struct net_driver_s *indev,
 static int ipv6_filter_match(FAR const struct net_driver_s *indev,
                              FAR const struct net_driver_s *outdev,
                              FAR const struct ipv6_hdr_s *ipv6,
-                             enum ipfilter_chain_e chain)
+                             enum ipfilter_chain_e chain,
+                             FAR struct ipfilter_entry_s **matched)
 {
-  FAR const struct ipv6_filter_entry_s *filter;
-  FAR const sq_queue_t *queue = &g_ipv6_filters[chain];
-  FAR const sq_entry_t *entry;
-  FAR const void *l4hdr;
+  FAR struct ipfilter_entry_s *entry;
+  struct ipfilter_pkt_s pkt;
   uint8_t proto;
-  bool matched;
 
   /* Handle unexpected status, return ACCEPT to indicate doing nothing. */
 
@@ -297,47 +699,26 @@ static int ipv6_filter_match(FAR const struct net_driver_s *indev,
       return IPFILTER_TARGET_ACCEPT;
     }
 
-  l4hdr = IPv6_L4HDR(ipv6, proto);
+  pkt.indev  = indev;
+  pkt.outdev = outdev;
+  pkt.iphdr  = ipv6;
+  pkt.l4hdr  = IPv6_L4HDR(ipv6, proto);
+  pkt.len    = ((uint16_t)ipv6->len[0] << 8) + ipv6->len[1] + IPv6_HDRLEN;
+  pkt.proto  = proto;
 
-  sq_for_every(queue, entry)
+  entry = ipfilter_classify(&g_ipv6_class[chain], &g_ipv6_filters[chain],
+                            &pkt, ipv6_filter_entry_match);
+  if (matched != NULL)
     {
-      filter = (FAR struct ipv6_filter_entry_s *)entry;
-
-      /* Match device */
-
-      if (!ipfilter_match_device(&filter->common, indev, outdev))
-        {
-          continue;
-        }
-
-      /* Match addresses */
-
-      matched = net_ipv6addr_maskcmp(filter->sip, ipv6->srcipaddr,
-                                     filter->smsk)
-                ^ filter->common.inv_srcip;
-      if (!matched)
-        {
-          continue;
-        }
-
-      matched = net_ipv6addr_maskcmp(filter->dip, ipv6->destipaddr,
-                                     filter->dmsk)
-                ^ filter->common.inv_dstip;
-      if (!matched)
-        {
-          continue;
-        }
-
-      /* Match protocol */
-
-      if (!ipfilter_match_proto(&filter->common, l4hdr, proto))
-        {
-          continue;
-        }
+      *matched = entry;
+    }
 
+  if (entry != NULL)
+    {
       /* Return the target action if matched. */
 
-      return filter->common.target;
+      ipfilter_count(entry, pkt.len);
+      return entry->target;
     }
 
   /* Normally there should be a default rule in chain, won't reach here. */
@@ -411,6 +792,10 @@ void ipfilter_cfg_add(FAR struct ipfilter_entry_s *entry,
   if (family == PF_INET)
     {
       sq_addlast((FAR sq_entry_t *)entry, &g_ipv4_filters[chain]);
+      g_ipv4_class[chain].dirty = true;
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+      ipfwd_flow_flush();
+#endif
     }
 #endif
 
@@ -418,6 +803,10 @@ void ipfilter_cfg_add(FAR struct ipfilter_entry_s *entry,
   if (family == PF_INET6)
     {
       sq_addlast((FAR sq_entry_t *)entry, &g_ipv6_filters[chain]);
+      g_ipv6_class[chain].dirty = true;
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+      ipfwd_flow_flush();
+#endif
     }
 #endif
 }
@@ -448,6 +837,11 @@ void ipfilter_cfg_clear(sa_family_t family, enum ipfilter_chain_e chain)
         {
           kmm_free(sq_remfirst(queue));
         }
+
+      g_ipv4_class[chain].dirty = true;
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+      ipfwd_flow_flush();
+#endif
     }
 #endif
 
@@ -459,10 +853,54 @@ void ipfilter_cfg_clear(sa_family_t family, enum ipfilter_chain_e chain)
         {
           kmm_free(sq_remfirst(queue));
         }
+
+      g_ipv6_class[chain].dirty = true;
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+      ipfwd_flow_flush();
+#endif
     }
 #endif
 }
 
+/****************************************************************************
+ * Name: ipfilter_cfg_first
+ *
+ * Description:
+ *   Get the first filter configuration entry of the specified chain, the
+ *   following entries can be reached through the flink of each entry.
+ *   Mainly used to read the hit counters of the entries.
+ *
+ * Input Parameters:
+ *   family - The address family of the filter entries
+ *   chain  - The chain to get the filter entry from
+ *
+ * Returned Value:
+ *   The first entry of the chain, NULL if the chain is empty.
+ *
+ ****************************************************************************/
+
+FAR struct ipfilter_entry_s *ipfilter_cfg_first(sa_family_t family,
+                                               enum ipfilter_chain_e chain)
+{
+#ifdef CONFIG_NET_IPv4
+  if (family == PF_INET)
+    {
+      return (FAR struct ipfilter_entry_s *)
+             sq_peek(&g_ipv4_filters[chain]);
+    }
+#endif
+
+#ifdef CONFIG_NET_IPv6
+  if (family == PF_INET6)
+    {
+      return (FAR struct ipfilter_entry_s *)
+             sq_peek(&g_ipv6_filters[chain]);
+    }
+#endif
+
+  return NULL;
+}
+
 /****************************************************************************
  * Name: ipv4_filter_in / ipv6_filter_in
  *
@@ -488,7 +926,8 @@ void ipfilter_cfg_clear(sa_family_t family, enum ipfilter_chain_e chain)
 int ipv4_filter_in(FAR struct net_driver_s *dev)
 {
   FAR struct ipv4_hdr_s *ipv4 = IPv4BUF;
-  int ret = ipv4_filter_match(dev, NULL, ipv4, IPFILTER_CHAIN_INPUT);
+  int ret = ipv4_filter_match(dev, NULL, ipv4, IPFILTER_CHAIN_INPUT,
+                              NULL);
 
   if (ret == IPFILTER_TARGET_DROP)
     {
@@ -511,7 +950,8 @@ int ipv4_filter_in(FAR struct net_driver_s *dev)
 int ipv6_filter_in(FAR struct net_driver_s *dev)
 {
   FAR struct ipv6_hdr_s *ipv6 = IPv6BUF;
-  int ret = ipv6_filter_match(dev, NULL, ipv6, IPFILTER_CHAIN_INPUT);
+  int ret = ipv6_filter_match(dev, NULL, ipv6, IPFILTER_CHAIN_INPUT,
+                              NULL);
 
   if (ret == IPFILTER_TARGET_DROP)
     {
@@ -559,7 +999,8 @@ void ipfilter_out(FAR struct net_driver_s *dev)
   if (IFF_IS_IPv4(dev->d_flags))
     {
       FAR struct ipv4_hdr_s *ipv4 = IPv4BUF;
-      int ret = ipv4_filter_match(NULL, dev, ipv4, IPFILTER_CHAIN_OUTPUT);
+      int ret = ipv4_filter_match(NULL, dev, ipv4,
+                                    IPFILTER_CHAIN_OUTPUT, NULL);
 
       if (ret == IPFILTER_TARGET_DROP)
         {
@@ -579,7 +1020,8 @@ void ipfilter_out(FAR struct net_driver_s *dev)
   if (IFF_IS_IPv6(dev->d_flags))
     {
       FAR struct ipv6_hdr_s *ipv6 = IPv6BUF;
-      int ret = ipv6_filter_match(NULL, dev, ipv6, IPFILTER_CHAIN_OUTPUT);
+      int ret = ipv6_filter_match(NULL, dev, ipv6,
+                                    IPFILTER_CHAIN_OUTPUT, NULL);
 
       if (ret == IPFILTER_TARGET_DROP)
         {
@@ -594,6 +1036,27 @@ void ipfilter_out(FAR struct net_driver_s *dev)
 #endif
 }
 
+/****************************************************************************
+ * Name: ipfilter_count
+ *
+ * Description:
+ *   Count a packet on the hit counters of a filter entry.
+ *
+ * Input Parameters:
+ *   entry - The matched filter entry
+ *   len   - The length of the IP packet
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void ipfilter_count(FAR struct ipfilter_entry_s *entry, uint16_t len)
+{
+  entry->pcnt++;
+  entry->bcnt += len;
+}
+
 /****************************************************************************
  * Name: ipv4_filter_fwd / ipv6_filter_fwd
  *
@@ -605,6 +1068,7 @@ void ipfilter_out(FAR struct net_driver_s *dev)
  *   indev     - The network device that the packet comes from
  *   outdev    - The network device that the packet goes to
  *   ipv4/ipv6 - The IPv4/IPv6 header
+ *   matched   - The location to return the matched entry, may be NULL
  *
  * Returned Value:
  *   IPFILTER_TARGET_ACCEPT(0)  - The input packet is accepted
@@ -619,18 +1083,22 @@ void ipfilter_out(FAR struct net_driver_s *dev)
 #if defined(CONFIG_NET_IPFORWARD) && defined(CONFIG_NET_IPv4)
 int ipv4_filter_fwd(FAR struct net_driver_s *indev,
                     FAR struct net_driver_s *outdev,
-                    FAR struct ipv4_hdr_s *ipv4)
+                    FAR struct ipv4_hdr_s *ipv4,
+                    FAR struct ipfilter_entry_s **matched)
 {
-  return ipv4_filter_match(indev, outdev, ipv4, IPFILTER_CHAIN_FORWARD);
+  return ipv4_filter_match(indev, outdev, ipv4, IPFILTER_CHAIN_FORWARD,
+                           matched);
 }
 #endif
 
 #if defined(CONFIG_NET_IPFORWARD) && defined(CONFIG_NET_IPv6)
 int ipv6_filter_fwd(FAR struct net_driver_s *indev,
                     FAR struct net_driver_s *outdev,
-                    FAR struct ipv6_hdr_s *ipv6)
+                    FAR struct ipv6_hdr_s *ipv6,
+                    FAR struct ipfilter_entry_s **matched)
 {
-  return ipv6_filter_match(indev, outdev, ipv6, IPFILTER_CHAIN_FORWARD);
+  return ipv6_filter_match(indev, outdev, ipv6, IPFILTER_CHAIN_FORWARD,
+                           matched);
 }
 #endif
 
@@ -81,6 +81,12 @@ struct ipfilter_entry_s
 
   uint8_t proto;          /* Protocol to match, 0 = ALL (Same as Linux) */
   int8_t  target;
+  uint16_t index;         /* Position in the chain, set by the classifier */
+
+  /* Hit counters */
+
+  uint64_t pcnt;          /* Number of packets matched */
+  uint64_t bcnt;          /* Number of bytes matched */
 
   /* Match flags, whether we need to match protocol in detail */
 
@@ -182,6 +188,26 @@ void ipfilter_cfg_add(FAR struct ipfilter_entry_s *entry,
 
 void ipfilter_cfg_clear(sa_family_t family, enum ipfilter_chain_e chain);
 
+/****************************************************************************
+ * Name: ipfilter_cfg_first
+ *
+ * Description:
+ *   Get the first filter configuration entry of the specified chain, the
+ *   following entries can be reached through the flink of each entry.
+ *   Mainly used to read the hit counters of the entries.
+ *
+ * Input Parameters:
+ *   family - The address family of the filter entries
+ *   chain  - The chain to get the filter entry from
+ *
+ * Returned Value:
+ *   The first entry of the chain, NULL if the chain is empty.
+ *
+ ****************************************************************************/
+
+FAR struct ipfilter_entry_s *ipfilter_cfg_first(sa_family_t family,
+                                               enum ipfilter_chain_e chain);
+
 /****************************************************************************
  * Name: ipv4_filter_in / ipv6_filter_in
  *
@@ -231,6 +257,25 @@ int ipv6_filter_in(FAR struct net_driver_s *dev);
 
 void ipfilter_out(FAR struct net_driver_s *dev);
 
+/****************************************************************************
+ * Name: ipfilter_count
+ *
+ * Description:
+ *   Count a packet on the hit counters of a filter entry.  Used for the
+ *   packets that matched the entry, and for the later packets of a flow
+ *   the entry accepted (see the forward flow cache).
+ *
+ * Input Parameters:
+ *   entry - The matched filter entry
+ *   len   - The length of the IP packet
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void ipfilter_count(FAR struct ipfilter_entry_s *entry, uint16_t len);
+
 /****************************************************************************
  * Name: ipv4_filter_fwd / ipv6_filter_fwd
  *
@@ -242,6 +287,7 @@ void ipfilter_out(FAR struct net_driver_s *dev);
  *   indev     - The network device that the packet comes from
  *   outdev    - The network device that the packet goes to
  *   ipv4/ipv6 - The IPv4/IPv6 header
+ *   matched   - The location to return the matched entry, may be NULL
  *
  * Returned Value:
  *   IPFILTER_TARGET_ACCEPT(0)  - The input packet is accepted
@@ -256,12 +302,14 @@ void ipfilter_out(FAR struct net_driver_s *dev);
 #if defined(CONFIG_NET_IPFORWARD) && defined(CONFIG_NET_IPv4)
 int ipv4_filter_fwd(FAR struct net_driver_s *indev,
                     FAR struct net_driver_s *outdev,
-                    FAR struct ipv4_hdr_s *ipv4);
+                    FAR struct ipv4_hdr_s *ipv4,
+                    FAR struct ipfilter_entry_s **matched);
 #endif
 #if defined(CONFIG_NET_IPFORWARD) && defined(CONFIG_NET_IPv6)
 int ipv6_filter_fwd(FAR struct net_driver_s *indev,
                     FAR struct net_driver_s *outdev,
-                    FAR struct ipv6_hdr_s *ipv6);
+                    FAR struct ipv6_hdr_s *ipv6,
+                    FAR struct ipfilter_entry_s **matched);
 #endif
 
 #endif /* CONFIG_NET_IPFILTER */
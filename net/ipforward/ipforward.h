@@ -30,6 +30,7 @@
 #include <nuttx/config.h>
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 #undef HAVE_FWDALLOC
@@ -45,6 +46,18 @@
 #  define CONFIG_NET_IPFORWARD_NSTRUCT 4
 #endif
 
+#ifndef CONFIG_NET_IPFORWARD_FLOWCACHE_SIZE
+#  define CONFIG_NET_IPFORWARD_FLOWCACHE_SIZE 64
+#endif
+
+/* Addresses in the flow key are stored as 32-bit words */
+
+#ifdef CONFIG_NET_IPv6
+#  define IPFWD_ADDRWORDS 4
+#else
+#  define IPFWD_ADDRWORDS 1
+#endif
+
 static_assert(CONFIG_IOB_NBUFFERS > CONFIG_NET_IPFORWARD_NSTRUCT,
               "IP forward may consume all the IOB and break netdev logic");
 
@@ -64,6 +77,7 @@ static_assert(CONFIG_IOB_NBUFFERS > CONFIG_NET_IPFORWARD_NSTRUCT,
 struct devif_callback_s; /* Forward reference */
 struct net_driver_s;     /* Forward reference */
 struct iob_s;            /* Forward reference */
+struct ipfilter_entry_s; /* Forward reference */
 
 struct forward_s
 {
@@ -76,6 +90,21 @@ struct forward_s
 #endif
 };
 
+/* The key identifying a forwarded flow.  Zero fill before use, the key is
+ * compared as a whole.
+ */
+
+struct ipfwd_flowkey_s
+{
+  FAR struct net_driver_s *dev;          /* Ingress device */
+  uint32_t src[IPFWD_ADDRWORDS];         /* Source address */
+  uint32_t dst[IPFWD_ADDRWORDS];         /* Destination address */
+  uint16_t sport;                        /* Source port or ICMP type */
+  uint16_t dport;                        /* Destination port */
+  uint8_t  domain;                       /* PF_INET or PF_INET6 */
+  uint8_t  proto;                        /* L4 protocol */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -368,5 +397,95 @@ void ipv4_dropstats(FAR struct ipv4_hdr_s *ipv4);
 #  define ipv4_dropstats(ipv4)
 #endif
 
+/****************************************************************************
+ * Name: ipv4_fwdflow_key / ipv6_fwdflow_key
+ *
+ * Description:
+ *   Build the flow cache key of a packet to be forwarded.
+ *
+ * Input Parameters:
+ *   dev       - The device on which the packet was received
+ *   ipv4/ipv6 - The IPv4/IPv6 header of the packet
+ *   key       - The location to return the key
+ *
+ * Returned Value:
+ *   True if the packet may use the flow cache.  Fragments and packets
+ *   with IPv6 extension headers are always forwarded the slow way.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_IPFORWARD_FLOWCACHE) && defined(CONFIG_NET_IPv4)
+bool ipv4_fwdflow_key(FAR struct net_driver_s *dev,
+                      FAR const struct ipv4_hdr_s *ipv4,
+                      FAR struct ipfwd_flowkey_s *key);
+#endif
+
+#if defined(CONFIG_NET_IPFORWARD_FLOWCACHE) && defined(CONFIG_NET_IPv6)
+bool ipv6_fwdflow_key(FAR struct net_driver_s *dev,
+                      FAR const struct ipv6_hdr_s *ipv6,
+                      FAR struct ipfwd_flowkey_s *key);
+#endif
+
+/****************************************************************************
+ * Name: ipfwd_flow_lookup
+ *
+ * Description:
+ *   Look up a flow that has been forwarded before.
+ *
+ * Input Parameters:
+ *   key - The flow key of the packet
+ *   len - The length of the IP packet, counted on the forward filter entry
+ *         that accepted the flow
+ *
+ * Returned Value:
+ *   The device the flow is forwarded on, NULL if the flow is not cached.
+ *   A cached flow has passed the route lookup and the forward filter.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+FAR struct net_driver_s *
+ipfwd_flow_lookup(FAR const struct ipfwd_flowkey_s *key, uint16_t len);
+#endif
+
+/****************************************************************************
+ * Name: ipfwd_flow_add
+ *
+ * Description:
+ *   Remember the forwarding device of a flow after its first packet has
+ *   been forwarded, replacing any other flow in the same slot.
+ *
+ * Input Parameters:
+ *   key    - The flow key of the packet
+ *   fwddev - The device the packet was forwarded on
+ *   filter - The forward filter entry that accepted the packet, or NULL
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+void ipfwd_flow_add(FAR const struct ipfwd_flowkey_s *key,
+                    FAR struct net_driver_s *fwddev,
+                    FAR struct ipfilter_entry_s *filter);
+#endif
+
+/****************************************************************************
+ * Name: ipfwd_flow_flush
+ *
+ * Description:
+ *   Invalidate all cached flows.  Must be called whenever a route, a
+ *   filter rule or the address or state of a device changes.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+void ipfwd_flow_flush(void);
+#endif
+
 #endif /* CONFIG_NET_IPFORWARD */
 #endif /* __NET_IPFORWARD_IPFORWARD_H */
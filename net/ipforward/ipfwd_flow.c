@@ -0,0 +1,304 @@
+/****************************************************************************
+ * net/ipforward/ipfwd_flow.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/net/icmp.h>
+#include <nuttx/net/icmpv6.h>
+#include <nuttx/net/ip.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/udp.h>
+
+#include "ipfilter/ipfilter.h"
+#include "ipforward/ipforward.h"
+
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One cached flow.  The entry is only valid while gen equals the current
+ * generation, so the whole cache is flushed by bumping the generation.
+ */
+
+struct ipfwd_flow_s
+{
+  struct ipfwd_flowkey_s key;
+  FAR struct net_driver_s *fwddev;  /* Egress device */
+#ifdef CONFIG_NET_IPFILTER
+  FAR struct ipfilter_entry_s *filter; /* Forward rule that accepted it */
+#endif
+  uint32_t gen;                     /* Generation the entry was added in */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The cache is direct mapped, a new flow replaces the flow in its slot */
+
+static struct ipfwd_flow_s
+g_ipfwd_flows[CONFIG_NET_IPFORWARD_FLOWCACHE_SIZE];
+static uint32_t g_ipfwd_flowgen = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ipfwd_flow_slot
+ *
+ * Description:
+ *   Return the cache slot of a flow key.
+ *
+ ****************************************************************************/
+
+static FAR struct ipfwd_flow_s *
+ipfwd_flow_slot(FAR const struct ipfwd_flowkey_s *key)
+{
+  uint32_t hash = (uint32_t)(uintptr_t)key->dev;
+  int i;
+
+  for (i = 0; i < IPFWD_ADDRWORDS; i++)
+    {
+      hash = (hash ^ key->src[i]) * 0x9e3779b1;
+      hash = (hash ^ key->dst[i]) * 0x9e3779b1;
+    }
+
+  hash  = (hash ^ ((uint32_t)key->sport << 16 | key->dport)) * 0x9e3779b1;
+  hash ^= key->proto;
+  hash ^= hash >> 16;
+
+  return &g_ipfwd_flows[hash % CONFIG_NET_IPFORWARD_FLOWCACHE_SIZE];
+}
+
+/****************************************************************************
+ * Name: ipfwd_flow_ports
+ *
+ * Description:
+ *   Fill the ports (or the ICMP type) of the flow key from the L4 header.
+ *
+ * Returned Value:
+ *   True if the protocol can be cached.
+ *
+ ****************************************************************************/
+
+static bool ipfwd_flow_ports(FAR struct ipfwd_flowkey_s *key,
+                             FAR const void *l4hdr)
+{
+  switch (key->proto)
+    {
+      case IP_PROTO_TCP:
+      case IP_PROTO_UDP:
+        {
+          /* Ports in TCP & UDP headers have same offset. */
+
+          FAR const struct udp_hdr_s *udp = l4hdr;
+
+          key->sport = udp->srcport;
+          key->dport = udp->destport;
+          return true;
+        }
+
+      case IP_PROTO_ICMP:
+        key->sport = ((FAR const struct icmp_hdr_s *)l4hdr)->type;
+        return true;
+
+      case IP_PROTO_ICMP6:
+        key->sport = ((FAR const struct icmpv6_hdr_s *)l4hdr)->type;
+        return true;
+
+      default:
+        return false;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ipv4_fwdflow_key / ipv6_fwdflow_key
+ *
+ * Description:
+ *   Build the flow cache key of a packet to be forwarded.
+ *
+ * Input Parameters:
+ *   dev       - The device on which the packet was received
+ *   ipv4/ipv6 - The IPv4/IPv6 header of the packet
+ *   key       - The location to return the key
+ *
+ * Returned Value:
+ *   True if the packet may use the flow cache.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+bool ipv4_fwdflow_key(FAR struct net_driver_s *dev,
+                      FAR const struct ipv4_hdr_s *ipv4,
+                      FAR struct ipfwd_flowkey_s *key)
+{
+  /* Only the first fragment carries the ports, so don't cache any. */
+
+  if ((ipv4->ipoffset[0] & 0x3f) != 0 || ipv4->ipoffset[1] != 0)
+    {
+      return false;
+    }
+
+  memset(key, 0, sizeof(*key));
+  key->dev    = dev;
+  key->src[0] = net_ip4addr_conv32(ipv4->srcipaddr);
+  key->dst[0] = net_ip4addr_conv32(ipv4->destipaddr);
+  key->domain = PF_INET;
+  key->proto  = ipv4->proto;
+
+  return ipfwd_flow_ports(key, (FAR const uint8_t *)ipv4 +
+                               ((ipv4->vhl & IPv4_HLMASK) << 2));
+}
+#endif
+
+#ifdef CONFIG_NET_IPv6
+bool ipv6_fwdflow_key(FAR struct net_driver_s *dev,
+                      FAR const struct ipv6_hdr_s *ipv6,
+                      FAR struct ipfwd_flowkey_s *key)
+{
+  memset(key, 0, sizeof(*key));
+  key->dev    = dev;
+  memcpy(key->src, ipv6->srcipaddr, sizeof(net_ipv6addr_t));
+  memcpy(key->dst, ipv6->destipaddr, sizeof(net_ipv6addr_t));
+  key->domain = PF_INET6;
+  key->proto  = ipv6->proto;
+
+  /* Extension headers (including fragments) are not looked into here, the
+   * protocol check below leaves those packets to the slow path.
+   */
+
+  return ipfwd_flow_ports(key, (FAR const uint8_t *)ipv6 + IPv6_HDRLEN);
+}
+#endif
+
+/****************************************************************************
+ * Name: ipfwd_flow_lookup
+ *
+ * Description:
+ *   Look up a flow that has been forwarded before.
+ *
+ * Input Parameters:
+ *   key - The flow key of the packet
+ *   len - The length of the IP packet
+ *
+ * Returned Value:
+ *   The device the flow is forwarded on, NULL if the flow is not cached.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+FAR struct net_driver_s *
+ipfwd_flow_lookup(FAR const struct ipfwd_flowkey_s *key, uint16_t len)
+{
+  FAR struct ipfwd_flow_s *flow = ipfwd_flow_slot(key);
+
+  if (flow->gen == g_ipfwd_flowgen &&
+      memcmp(&flow->key, key, sizeof(*key)) == 0 &&
+      IFF_IS_UP(flow->fwddev->d_flags))
+    {
+#ifdef CONFIG_NET_IPFILTER
+      /* The packet skips the forward filter, count it on the rule that
+       * accepted the flow as if it had matched again.  A rule change
+       * flushes the cache, so the entry is still in its chain.
+       */
+
+      if (flow->filter != NULL)
+        {
+          ipfilter_count(flow->filter, len);
+        }
+#endif
+
+      return flow->fwddev;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ipfwd_flow_add
+ *
+ * Description:
+ *   Remember the forwarding device of a flow.
+ *
+ * Input Parameters:
+ *   key    - The flow key of the packet
+ *   fwddev - The device the packet was forwarded on
+ *   filter - The forward filter entry that accepted the packet, or NULL
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void ipfwd_flow_add(FAR const struct ipfwd_flowkey_s *key,
+                    FAR struct net_driver_s *fwddev,
+                    FAR struct ipfilter_entry_s *filter)
+{
+  FAR struct ipfwd_flow_s *flow = ipfwd_flow_slot(key);
+
+  memcpy(&flow->key, key, sizeof(*key));
+  flow->fwddev = fwddev;
+#ifdef CONFIG_NET_IPFILTER
+  flow->filter = filter;
+#endif
+  flow->gen    = g_ipfwd_flowgen;
+}
+
+/****************************************************************************
+ * Name: ipfwd_flow_flush
+ *
+ * Description:
+ *   Invalidate all cached flows.
+ *
+ ****************************************************************************/
+
+void ipfwd_flow_flush(void)
+{
+  /* Zero is the generation of never used slots, clear the stale entries
+   * when the generation wraps around so they can't become valid again.
+   */
+
+  if (++g_ipfwd_flowgen == 0)
+    {
+      memset(g_ipfwd_flows, 0, sizeof(g_ipfwd_flows));
+      g_ipfwd_flowgen = 1;
+    }
+}
+
+#endif /* CONFIG_NET_IPFORWARD_FLOWCACHE */
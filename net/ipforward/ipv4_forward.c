@@ -199,6 +199,9 @@ static int ipv4_decr_ttl(FAR struct ipv4_hdr_s *ipv4)
  *              contains the IPv4 packet.
  *   fwdddev  - The device on which the packet must be forwarded.
  *   ipv4     - A pointer to the IPv4 header in within the IPv4 packet
+ *   filter   - The location to return the forward filter entry matching
+ *              the packet, NULL if the flow of the packet was accepted by
+ *              the forward filter before (see the flow cache).
  *
  * Returned Value:
  *   Zero is returned if the packet was successfully forward;  A negated
@@ -209,7 +212,8 @@ static int ipv4_decr_ttl(FAR struct ipv4_hdr_s *ipv4)
 
 static int ipv4_dev_forward(FAR struct net_driver_s *dev,
                             FAR struct net_driver_s *fwddev,
-                            FAR struct ipv4_hdr_s *ipv4)
+                            FAR struct ipv4_hdr_s *ipv4,
+                            FAR struct ipfilter_entry_s **filter)
 {
   FAR struct forward_s *fwd = NULL;
 #ifdef CONFIG_DEBUG_NET_WARN
@@ -219,10 +223,11 @@ static int ipv4_dev_forward(FAR struct net_driver_s *dev,
 
 #ifdef CONFIG_NET_IPFILTER
   /* Do filter before forwarding, to make sure we drop silently before
-   * replying any other errors.
+   * replying any other errors.  Cached flows were accepted already.
    */
 
-  ret = ipv4_filter_fwd(dev, fwddev, ipv4);
+  ret = filter == NULL ? IPFILTER_TARGET_ACCEPT :
+                         ipv4_filter_fwd(dev, fwddev, ipv4, filter);
   if (ret < 0)
     {
       ninfo("Drop/Reject FORWARD packet due to filter %d\n", ret);
@@ -365,6 +370,7 @@ static int ipv4_forward_callback(FAR struct net_driver_s *fwddev,
                                  FAR void *arg)
 {
   FAR struct net_driver_s *dev = (FAR struct net_driver_s *)arg;
+  FAR struct ipfilter_entry_s *filter;
   FAR struct ipv4_hdr_s *ipv4;
   FAR struct iob_s *iob;
   int ret;
@@ -403,7 +409,7 @@ static int ipv4_forward_callback(FAR struct net_driver_s *fwddev,
 
       /* Send the packet asynchrously on the forwarding device. */
 
-      ret = ipv4_dev_forward(dev, fwddev, ipv4);
+      ret = ipv4_dev_forward(dev, fwddev, ipv4, &filter);
       if (ret < 0)
         {
           iob_free_chain(iob);
@@ -458,6 +464,12 @@ int ipv4_forward(FAR struct net_driver_s *dev, FAR struct ipv4_hdr_s *ipv4)
   in_addr_t destipaddr;
   in_addr_t srcipaddr;
   FAR struct net_driver_s *fwddev;
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  struct ipfwd_flowkey_s key;
+  bool cacheable;
+#endif
+  FAR struct ipfilter_entry_s *filter = NULL;
+  bool cached = false;
   int ret;
 #if defined(CONFIG_NET_ICMP) && !defined(CONFIG_NET_ICMP_NO_STACK)
   int icmp_reply_type;
@@ -469,7 +481,19 @@ int ipv4_forward(FAR struct net_driver_s *dev, FAR struct ipv4_hdr_s *ipv4)
   destipaddr = net_ip4addr_conv32(ipv4->destipaddr);
   srcipaddr  = net_ip4addr_conv32(ipv4->srcipaddr);
 
-  fwddev     = netdev_findby_ripv4addr(srcipaddr, destipaddr);
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  /* Try the flow cache first, established flows skip the route lookup. */
+
+  cacheable = ipv4_fwdflow_key(dev, ipv4, &key);
+  fwddev    = cacheable ? ipfwd_flow_lookup(&key, (ipv4->len[0] << 8) +
+                                                ipv4->len[1]) : NULL;
+  cached    = fwddev != NULL;
+  if (!cached)
+#endif
+    {
+      fwddev = netdev_findby_ripv4addr(srcipaddr, destipaddr);
+    }
+
   if (fwddev == NULL)
     {
       nwarn("WARNING: Not routable\n");
@@ -485,12 +509,25 @@ int ipv4_forward(FAR struct net_driver_s *dev, FAR struct ipv4_hdr_s *ipv4)
     {
       /* Send the packet asynchrously on the forwarding device. */
 
-      ret = ipv4_dev_forward(dev, fwddev, ipv4);
+      ret = ipv4_dev_forward(dev, fwddev, ipv4,
+                             cached ? NULL : &filter);
       if (ret < 0)
         {
           nwarn("WARNING: ipv4_dev_forward failed: %d\n", ret);
           goto drop;
         }
+
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+      /* Remember the flow so that its next packets skip the route lookup
+       * and the forward filter.  They are still counted on the filter entry
+       * that accepted the flow.
+       */
+
+      if (cacheable && !cached)
+        {
+          ipfwd_flow_add(&key, fwddev, filter);
+        }
+#endif
     }
   else
     {
@@ -322,6 +322,9 @@ static int ipv6_packet_conversion(FAR struct net_driver_s *dev,
  *              contains the IPv6 packet.
  *   fwdddev  - The device on which the packet must be forwarded.
  *   ipv6     - A pointer to the IPv6 header in within the IPv6 packet
+ *   filter   - The location to return the forward filter entry matching
+ *              the packet, NULL if the flow of the packet was accepted by
+ *              the forward filter before (see the flow cache).
  *
  * Returned Value:
  *   Zero is returned if the packet was successfully forwarded;  A negated
@@ -332,7 +335,8 @@ static int ipv6_packet_conversion(FAR struct net_driver_s *dev,
 
 static int ipv6_dev_forward(FAR struct net_driver_s *dev,
                             FAR struct net_driver_s *fwddev,
-                            FAR struct ipv6_hdr_s *ipv6)
+                            FAR struct ipv6_hdr_s *ipv6,
+                            FAR struct ipfilter_entry_s **filter)
 {
   FAR struct forward_s *fwd = NULL;
 #ifdef CONFIG_DEBUG_NET_WARN
@@ -342,10 +346,11 @@ static int ipv6_dev_forward(FAR struct net_driver_s *dev,
 
 #ifdef CONFIG_NET_IPFILTER
   /* Do filter before forwarding, to make sure we drop silently before
-   * replying any other errors.
+   * replying any other errors.  Cached flows were accepted already.
    */
 
-  ret = ipv6_filter_fwd(dev, fwddev, ipv6);
+  ret = filter == NULL ? IPFILTER_TARGET_ACCEPT :
+                         ipv6_filter_fwd(dev, fwddev, ipv6, filter);
   if (ret < 0)
     {
       ninfo("Drop/Reject FORWARD packet due to filter %d\n", ret);
@@ -504,6 +509,7 @@ static int ipv6_forward_callback(FAR struct net_driver_s *fwddev,
                                  FAR void *arg)
 {
   FAR struct net_driver_s *dev = (FAR struct net_driver_s *)arg;
+  FAR struct ipfilter_entry_s *filter;
   FAR struct ipv6_hdr_s *ipv6;
   FAR struct iob_s *iob;
   int ret;
@@ -542,7 +548,7 @@ static int ipv6_forward_callback(FAR struct net_driver_s *fwddev,
 
       /* Send the packet asynchrously on the forwarding device. */
 
-      ret = ipv6_dev_forward(dev, fwddev, ipv6);
+      ret = ipv6_dev_forward(dev, fwddev, ipv6, &filter);
       if (ret < 0)
         {
           iob_free_chain(iob);
@@ -595,6 +601,12 @@ static int ipv6_forward_callback(FAR struct net_driver_s *fwddev,
 int ipv6_forward(FAR struct net_driver_s *dev, FAR struct ipv6_hdr_s *ipv6)
 {
   FAR struct net_driver_s *fwddev;
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  struct ipfwd_flowkey_s key;
+  bool cacheable;
+#endif
+  FAR struct ipfilter_entry_s *filter = NULL;
+  bool cached = false;
   int ret;
 #ifdef CONFIG_NET_ICMPv6
   int icmpv6_reply_type;
@@ -604,7 +616,21 @@ int ipv6_forward(FAR struct net_driver_s *dev, FAR struct ipv6_hdr_s *ipv6)
 
   /* Search for a device that can forward this packet. */
 
-  fwddev = netdev_findby_ripv6addr(ipv6->srcipaddr, ipv6->destipaddr);
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  /* Try the flow cache first, established flows skip the route lookup. */
+
+  cacheable = ipv6_fwdflow_key(dev, ipv6, &key);
+  fwddev    = cacheable ? ipfwd_flow_lookup(&key, (ipv6->len[0] << 8) +
+                                                ipv6->len[1] + IPv6_HDRLEN) :
+                          NULL;
+  cached    = fwddev != NULL;
+  if (!cached)
+#endif
+    {
+      fwddev = netdev_findby_ripv6addr(ipv6->srcipaddr,
+                                       ipv6->destipaddr);
+    }
+
   if (fwddev == NULL)
     {
       nwarn("WARNING: Not routable\n");
@@ -620,12 +646,25 @@ int ipv6_forward(FAR struct net_driver_s *dev, FAR struct ipv6_hdr_s *ipv6)
     {
       /* Send the packet asynchrously on the forwarding device. */
 
-      ret = ipv6_dev_forward(dev, fwddev, ipv6);
+      ret = ipv6_dev_forward(dev, fwddev, ipv6,
+                             cached ? NULL : &filter);
       if (ret < 0)
         {
           nwarn("WARNING: ipv6_dev_forward failed: %d\n", ret);
           goto drop;
         }
+
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+      /* Remember the flow so that its next packets skip the route lookup
+       * and the forward filter.  They are still counted on the filter entry
+       * that accepted the flow.
+       */
+
+      if (cacheable && !cached)
+        {
+          ipfwd_flow_add(&key, fwddev, filter);
+        }
+#endif
     }
   else
 #if defined(CONFIG_NET_6LOWPAN) /* REVISIT:  Currently only support for 6LoWPAN */
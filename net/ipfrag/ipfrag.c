@@ -94,7 +94,17 @@ do  \
 
 /* The maximum I/O buffer occupied by fragment reassembly cache */
 
-#define REASSEMBLY_MAXOCCUPYIOB        CONFIG_IOB_NBUFFERS / 5
+#if CONFIG_NET_IPFRAG_REASS_MAXIOB > 0
+#  define REASSEMBLY_MAXOCCUPYIOB      CONFIG_NET_IPFRAG_REASS_MAXIOB
+#else
+#  define REASSEMBLY_MAXOCCUPYIOB      (CONFIG_IOB_NBUFFERS / 5)
+#endif
+
+/* The largest reassembled payload (fragment offset + length) */
+
+#define REASSEMBLY_MAXPAYLOAD          UINT16_MAX
+
+#define REASSEMBLY_BUCKETS             CONFIG_NET_IPFRAG_REASS_BUCKETS
 
 /* Deciding whether to fragment outgoing packets which target is to ourself */
 
@@ -117,25 +127,23 @@ static struct work_s g_wkfragtimeout;
 
 /* Remember the number of I/O buffers currently in reassembly cache */
 
-static uint8_t       g_bufoccupy;
+static uint32_t      g_bufoccupy;
 
-/* Queue header definition, it links all fragments of all NICs by ascending
- * ipid.
- */
+/* Hash buckets of the datagrams being reassembled on all NICs */
 
-static sq_queue_t    g_assemblyhead_ipid;
+static dq_queue_t    g_assemblyhead_hash[REASSEMBLY_BUCKETS];
 
 /* Queue header definition, which connects all fragments of all NICs in order
  * of addition time.
  */
 
-static sq_queue_t    g_assemblyhead_time;
+static dq_queue_t    g_assemblyhead_time;
 
 /****************************************************************************
  * Public Data
  ****************************************************************************/
 
-/* Only one thread can access g_assemblyhead_ipid and g_assemblyhead_time
+/* Only one thread can access g_assemblyhead_hash and g_assemblyhead_time
  * at a time.
  */
 
@@ -149,8 +157,10 @@ static void ip_fragin_timerout_expiry(wdparm_t arg);
 static void ip_fragin_timerwork(FAR void *arg);
 static inline FAR struct ip_fraglink_s *
 ip_fragin_freelink(FAR struct ip_fraglink_s *fraglink);
-static void ip_fragin_check(FAR struct ip_fragsnode_s *fragsnode);
-static void ip_fragin_cachemonitor(FAR struct ip_fragsnode_s *curnode);
+static void ip_fragin_freenode(FAR struct ip_fragsnode_s *node);
+static uint32_t ip_fragin_hash(FAR const struct ip_fragkey_s *key);
+static bool ip_fragin_cachemonitor(FAR struct ip_fragsnode_s *curnode,
+                                   uint32_t bufcnt);
 static inline FAR struct iob_s *
 ip_fragout_allocfragbuf(FAR struct iob_queue_s *fragq);
 
@@ -193,8 +203,8 @@ static void ip_fragin_timerwork(FAR void *arg)
 {
   clock_t curtick = clock_systime_ticks();
   sclock_t interval = 0;
-  FAR sq_entry_t *entry;
-  FAR sq_entry_t *entrynext;
+  FAR dq_entry_t *entry;
+  FAR dq_entry_t *entrynext;
   FAR struct ip_fragsnode_s *node;
 
   ninfo("Start reassembly work queue\n");
@@ -205,13 +215,12 @@ static void ip_fragin_timerwork(FAR void *arg)
    * interval
    */
 
-  entry = sq_peek(&g_assemblyhead_time);
+  entry = dq_peek(&g_assemblyhead_time);
   while (entry != NULL)
     {
-      entrynext = sq_next(entry);
+      entrynext = dq_next(entry);
 
-      node = (FAR struct ip_fragsnode_s *)
-             container_of(entry, FAR struct ip_fragsnode_s, flinkat);
+      node = container_of(entry, struct ip_fragsnode_s, flinkat);
 
       /* Check for timeout, be careful with the calculation formula,
        * the tick counter may overflow
@@ -270,22 +279,9 @@ static void ip_fragin_timerwork(FAR void *arg)
             }
 #endif
 
-          /* Remove fragments of this node */
-
-          if (node->frags != NULL)
-            {
-              FAR struct ip_fraglink_s *fraglink = node->frags;
+          /* Remove fragments of this node and free node memory */
 
-              while (fraglink)
-                {
-                  fraglink = ip_fragin_freelink(fraglink);
-                }
-            }
-
-          /* Remove node from single-list and free node memory */
-
-          ip_frag_remnode(node);
-          kmm_free(node);
+          ip_fragin_freenode(node);
         }
       else
         {
@@ -305,7 +301,7 @@ static void ip_fragin_timerwork(FAR void *arg)
 
   /* Be sure to start the timer, if there are nodes in the linked list */
 
-  if (sq_peek(&g_assemblyhead_time) != NULL)
+  if (dq_peek(&g_assemblyhead_time) != NULL)
     {
       clock_t delay = REASSEMBLY_TIMEOUT_MINIMALTICKS;
 
@@ -363,115 +359,112 @@ ip_fragin_freelink(FAR struct ip_fraglink_s *fraglink)
 }
 
 /****************************************************************************
- * Name: ip_fragin_check
+ * Name: ip_fragin_freenode
  *
  * Description:
- *   Check whether the zero fragment has been received or all fragments have
- *   been received.
+ *   Free all fragments of a node, unlink the node from the reassembly
+ *   lists and free it.
  *
  * Input Parameters:
- *   fragsnode - node of the upper-level linked list, it maintains
- *               information bout all fragments belonging to an IP datagram
+ *   node - node of the upper-level linked list, it maintains information
+ *          about all fragments belonging to an IP datagram
  *
  * Returned Value:
  *   None
  *
  ****************************************************************************/
 
-static void ip_fragin_check(FAR struct ip_fragsnode_s *fragsnode)
+static void ip_fragin_freenode(FAR struct ip_fragsnode_s *node)
 {
-  uint16_t formerlen = 0;
-  FAR struct ip_fraglink_s *entry;
+  FAR struct ip_fraglink_s *fraglink = node->frags;
 
-  if (fragsnode->verifyflag & IP_FRAGVERIFY_RECVDTAILFRAG)
+  while (fraglink != NULL)
     {
-      entry = fragsnode->frags;
-      while (entry != NULL)
-        {
-          if (entry->morefrags)
-            {
-              formerlen += entry->fraglen;
-            }
-          else
-            {
-              /* Only the last entry has a 0 morefrags flag */
-
-              if (entry->fragoff == formerlen)
-                {
-                  fragsnode->verifyflag |= IP_FRAGVERIFY_RECVDALLFRAGS;
-                }
-            }
-
-          entry = entry->flink;
-        }
+      fraglink = ip_fragin_freelink(fraglink);
     }
+
+  ip_frag_remnode(node);
+  kmm_free(node);
 }
 
 /****************************************************************************
- * Name: ip_fragin_cachemonitor
+ * Name: ip_fragin_hash
  *
  * Description:
- *   Check the reassembly cache buffer size, if it exceeds the configured
- *   threshold, some I/O buffers need to be freed
+ *   Hash the key of a datagram.
  *
  * Input Parameters:
- *   curnode - node of the upper-level linked list, it maintains information
- *             about all fragments belonging to an IP datagram
+ *   key - Identifies the datagram
  *
  * Returned Value:
- *   none
+ *   The hash value, the bucket is the value modulo REASSEMBLY_BUCKETS.
  *
  ****************************************************************************/
 
-static void ip_fragin_cachemonitor(FAR struct ip_fragsnode_s *curnode)
+static uint32_t ip_fragin_hash(FAR const struct ip_fragkey_s *key)
 {
-  uint32_t        cleancnt = 0;
-  uint32_t        bufcnt;
-  FAR sq_entry_t *entry;
-  FAR sq_entry_t *entrynext;
-  FAR struct ip_fragsnode_s *node;
+  uint32_t hash = key->ipid;
+  int i;
 
-  /* Start cache cleaning if g_bufoccupy exceeds the cache threshold */
-
-  if (g_bufoccupy > REASSEMBLY_MAXOCCUPYIOB)
+  for (i = 0; i < 8; i++)
     {
-      cleancnt = g_bufoccupy - REASSEMBLY_MAXOCCUPYIOB;
-      entry = sq_peek(&g_assemblyhead_time);
-
-      while (entry != NULL && cleancnt > 0)
-        {
-          entrynext = sq_next(entry);
+      hash = (hash ^ key->srcipaddr[i]) * 0x9e3779b1;
+      hash = (hash ^ key->destipaddr[i]) * 0x9e3779b1;
+    }
 
-          node = (FAR struct ip_fragsnode_s *)
-                 container_of(entry, FAR struct ip_fragsnode_s, flinkat);
+  hash ^= key->proto;
+  hash ^= hash >> 16;
 
-          /* Skip specified node */
+  return hash;
+}
 
-          if (node != curnode)
-            {
-              /* Remove fragments of this node */
+/****************************************************************************
+ * Name: ip_fragin_cachemonitor
+ *
+ * Description:
+ *   Check whether 'bufcnt' more I/O buffers fit in the reassembly cache.
+ *   If they do not, the oldest datagrams other than 'curnode' are dropped
+ *   until they do.
+ *
+ * Input Parameters:
+ *   curnode - node of the upper-level linked list, it maintains information
+ *             about all fragments belonging to an IP datagram, or NULL for
+ *             a new datagram
+ *   bufcnt  - Number of I/O buffers to be added
+ *
+ * Returned Value:
+ *   True if the buffers fit, false if the cache is full even without the
+ *   other datagrams.
+ *
+ ****************************************************************************/
 
-              if (node->frags != NULL)
-                {
-                  FAR struct ip_fraglink_s *fraglink = node->frags;
+static bool ip_fragin_cachemonitor(FAR struct ip_fragsnode_s *curnode,
+                                   uint32_t bufcnt)
+{
+  FAR dq_entry_t *entry;
+  FAR dq_entry_t *entrynext;
+  FAR struct ip_fragsnode_s *node;
 
-                  while (fraglink != NULL)
-                    {
-                      fraglink = ip_fragin_freelink(fraglink);
-                    }
-                }
+  /* Start cache cleaning if g_bufoccupy would exceed the cache threshold */
 
-              /* Remove node from single-list and free node memory */
+  entry = dq_peek(&g_assemblyhead_time);
+  while (entry != NULL && g_bufoccupy + bufcnt > REASSEMBLY_MAXOCCUPYIOB)
+    {
+      entrynext = dq_next(entry);
 
-              bufcnt = ip_frag_remnode(node);
-              kmm_free(node);
+      node = container_of(entry, struct ip_fragsnode_s, flinkat);
 
-              cleancnt = cleancnt > bufcnt ? cleancnt - bufcnt : 0;
-            }
+      /* Skip specified node */
 
-          entry = entrynext;
+      if (node != curnode)
+        {
+          ip_fragin_freenode(node);
         }
+
+      entry = entrynext;
     }
+
+  return g_bufoccupy + bufcnt <= REASSEMBLY_MAXOCCUPYIOB;
 }
 
 /****************************************************************************
@@ -530,8 +523,9 @@ uint32_t ip_frag_remnode(FAR struct ip_fragsnode_s *node)
   g_bufoccupy -= node->bufcnt;
   ASSERT(g_bufoccupy < CONFIG_IOB_NBUFFERS);
 
-  sq_rem((FAR sq_entry_t *)node, &g_assemblyhead_ipid);
-  sq_rem((FAR sq_entry_t *)&node->flinkat, &g_assemblyhead_time);
+  dq_rem(&node->flink, &g_assemblyhead_hash[node->hash %
+                                            REASSEMBLY_BUCKETS]);
+  dq_rem(&node->flinkat, &g_assemblyhead_time);
 
   return node->bufcnt;
 }
@@ -542,213 +536,241 @@ uint32_t ip_frag_remnode(FAR struct ip_fragsnode_s *node)
  * Description:
  *   Enqueue one fragment.
  *   All fragments belonging to one IP frame are organized in a linked list
- *   form, that is a ip_fragsnode_s node. All ip_fragsnode_s nodes are also
- *   organized in an upper-level linked list.
+ *   form, that is a ip_fragsnode_s node. The nodes are looked up in a hash
+ *   table by their key and are also linked in order of creation for the
+ *   reassembly timer.
  *
  * Input Parameters:
  *   dev         - NIC Device instance
+ *   key         - Identifies the datagram the fragment belongs to
  *   curfraglink - node of the lower-level linked list, it maintains
  *                 information of one fragment
  *
  * Returned Value:
- *   Whether queue is empty before enqueue the new node
+ *   OK on success, or a negated errno value if the fragment was dropped
+ *   (see ipfrag.h).
  *
  ****************************************************************************/
 
-bool ip_fragin_enqueue(FAR struct net_driver_s *dev,
-                       FAR struct ip_fraglink_s *curfraglink)
+int ip_fragin_enqueue(FAR struct net_driver_s *dev,
+                      FAR const struct ip_fragkey_s *key,
+                      FAR struct ip_fraglink_s *curfraglink)
 {
-  FAR struct ip_fragsnode_s *node;
-  FAR sq_entry_t            *entry;
-  FAR sq_entry_t            *entrylast = NULL;
-  bool                       empty;
-
-  /* The linked list is ordered by IP ID value, walk through it and try to
-   * find a node that has the same IP ID value, otherwise need to create a
-   * new node and insert it into the linked list.
+  FAR struct ip_fragsnode_s *node = NULL;
+  FAR struct ip_fraglink_s  *fraglink = NULL;
+  FAR struct ip_fraglink_s  *lastlink = NULL;
+  FAR dq_queue_t            *bucket;
+  FAR dq_entry_t            *entry;
+  uint32_t                   curend;
+  uint32_t                   bufcnt;
+  uint32_t                   hash;
+  int                        ret;
+
+  curend = curfraglink->fragoff + curfraglink->fraglen;
+  bufcnt = IOBUF_CNT(curfraglink->frag);
+
+  /* Drop malformed fragments early: all but the tail fragment must carry
+   * a non-zero multiple of 8 bytes, and the datagram cannot grow beyond
+   * the 16-bit length field.
    */
 
-  entry = sq_peek(&g_assemblyhead_ipid);
-  empty = (entry == NULL) ? true : false;
-
-  while (entry != NULL)
+  if ((curfraglink->morefrags &&
+       (curfraglink->fraglen == 0 || (curfraglink->fraglen & 0x7) != 0)) ||
+      curend > REASSEMBLY_MAXPAYLOAD)
     {
-      node = (struct ip_fragsnode_s *)entry;
+      ret = -EBADMSG;
+      goto errout;
+    }
+
+  /* Find the node of this datagram in its hash bucket */
 
-      if (dev == node->dev && curfraglink->ipid <= node->ipid)
+  hash   = ip_fragin_hash(key);
+  bucket = &g_assemblyhead_hash[hash % REASSEMBLY_BUCKETS];
+
+  for (entry = dq_peek(bucket); entry != NULL; entry = dq_next(entry))
+    {
+      node = (FAR struct ip_fragsnode_s *)entry;
+      if (node->hash == hash && node->dev == dev &&
+          memcmp(&node->key, key, sizeof(*key)) == 0)
         {
           break;
         }
-
-      entrylast = entry;
-      entry = sq_next(entry);
     }
 
   node = (FAR struct ip_fragsnode_s *)entry;
 
-  if (node != NULL && curfraglink->ipid == node->ipid)
+  if (node != NULL)
     {
-      FAR struct ip_fraglink_s *fraglink;
-      FAR struct ip_fraglink_s *lastlink = NULL;
-
-      /* Found a previously created ip_fragsnode_s, insert this new
-       * ip_fraglink_s to the subchain of this node.
-       */
-
-      fraglink = node->frags;
-
-      /* An ip_fragsnode_s must have an ip_fraglink_s because we allocate a
-       * new ip_fraglink_s when caching a new ip_fraglink_s with a new IP ID
+      /* Find the neighbours of the new fragment in the offset ordered
+       * list.  Fragments mostly arrive in order, so try the tail first.
        */
 
-      while (fraglink != NULL)
+      if (curfraglink->fragoff > node->lastlink->fragoff)
         {
-          /* The fragment list is ordered by fragment offset value */
-
-          if (curfraglink->fragoff <= fraglink->fragoff)
+          lastlink = node->lastlink;
+        }
+      else
+        {
+          fraglink = node->frags;
+          while (fraglink != NULL &&
+                 fraglink->fragoff < curfraglink->fragoff)
             {
-              break;
+              lastlink = fraglink;
+              fraglink = fraglink->flink;
             }
-
-          lastlink = fraglink;
-          fraglink = fraglink->flink;
         }
 
-      if (fraglink == NULL)
+      if (fraglink != NULL && fraglink->fragoff == curfraglink->fragoff &&
+          fraglink->fraglen == curfraglink->fraglen)
         {
-          /* This fragment offset is greater than the previous fragments,
-           * added to the last position
+          /* Fragments with same offset and length contain the same data,
+           * keep the copy already queued.
            */
 
-          lastlink->flink      = curfraglink;
+          ret = -EEXIST;
+          goto errout;
+        }
 
-          /* Remember I/O buffer count */
+      /* The fragment must neither overlap its neighbours (RFC 5722), nor
+       * disagree with the known end of the datagram.
+       */
 
-          node->bufcnt += IOBUF_CNT(curfraglink->frag);
-          g_bufoccupy  += IOBUF_CNT(curfraglink->frag);
+      if ((lastlink != NULL &&
+           lastlink->fragoff + lastlink->fraglen > curfraglink->fragoff) ||
+          (fraglink != NULL && curend > fraglink->fragoff) ||
+          ((node->verifyflag & IP_FRAGVERIFY_RECVDTAILFRAG) != 0 &&
+           (curend > node->totallen ||
+            (!curfraglink->morefrags && curend != node->totallen))) ||
+          (!curfraglink->morefrags && node->lastlink->fragoff +
+                                      node->lastlink->fraglen > curend))
+        {
+          nwarn("WARNING: Overlapping fragments, datagram dropped\n");
+          ip_fragin_freenode(node);
+          ret = -EBADMSG;
+          goto errout;
         }
-      else if (curfraglink->fragoff == fraglink->fragoff)
+
+      /* Keep the reassembly cache within its limit */
+
+      if (!ip_fragin_cachemonitor(node, bufcnt))
         {
-          /* Fragments with same offset value contain the same data, use the
-           * more recently arrived copy. Refer to RFC791, Section3.2, Page29.
-           * Replace and removed the old packet from the fragment list
-           */
+          nwarn("WARNING: Reassembly cache full, datagram dropped\n");
+          ip_fragin_freenode(node);
+          ret = -ENOMEM;
+          goto errout;
+        }
 
-          curfraglink->flink = fraglink->flink;
-          if (lastlink == NULL)
-            {
-              node->frags = curfraglink;
-            }
-          else
-            {
-              lastlink->flink = curfraglink;
-            }
+      /* Insert into the fragment list */
 
-          iob_free_chain(fraglink->frag);
-          kmm_free(fraglink);
+      curfraglink->flink = fraglink;
+      if (lastlink == NULL)
+        {
+          node->frags = curfraglink;
         }
       else
         {
-          /* Insert into the fragment list */
-
-          if (lastlink == NULL)
-            {
-              /* Insert before the first node */
-
-              curfraglink->flink = node->frags;
-              node->frags = curfraglink;
-            }
-          else
-            {
-              /* Insert this node after lastlink */
-
-              curfraglink->flink = lastlink->flink;
-              lastlink->flink = curfraglink;
-            }
-
-          /* Remember I/O buffer count */
+          lastlink->flink = curfraglink;
+        }
 
-          node->bufcnt += IOBUF_CNT(curfraglink->frag);
-          g_bufoccupy  += IOBUF_CNT(curfraglink->frag);
+      if (fraglink == NULL)
+        {
+          node->lastlink = curfraglink;
         }
     }
   else
     {
-      /* It's a new IP ID fragment, malloc a new node and insert it into the
-       * linked list
+      /* It's a new datagram, malloc a new node and insert it into its hash
+       * bucket
        */
 
+      if (!ip_fragin_cachemonitor(NULL, bufcnt))
+        {
+          nwarn("WARNING: Reassembly cache full, fragment dropped\n");
+          ret = -ENOMEM;
+          goto errout;
+        }
+
       node = kmm_malloc(sizeof(struct ip_fragsnode_s));
       if (node == NULL)
         {
           nerr("ERROR: Failed to allocate buffer.\n");
-          return -ENOMEM;
+          ret = -ENOMEM;
+          goto errout;
         }
 
-      node->flink      = NULL;
-      node->flinkat    = NULL;
+      memcpy(&node->key, key, sizeof(*key));
+      node->hash       = hash;
       node->dev        = dev;
-      node->ipid       = curfraglink->ipid;
       node->frags      = curfraglink;
+      node->lastlink   = curfraglink;
       node->tick       = clock_systime_ticks();
-      node->bufcnt     = IOBUF_CNT(curfraglink->frag);
-      g_bufoccupy     += IOBUF_CNT(curfraglink->frag);
+      node->bufcnt     = 0;
+      node->recvdlen   = 0;
+      node->totallen   = 0;
       node->verifyflag = 0;
       node->outgoframe = NULL;
 
-      /* Insert this new node into linked list identified by
-       * g_assemblyhead_ipid with correct position
-       */
+      curfraglink->flink = NULL;
 
-      if (sq_peek(&g_assemblyhead_ipid) == NULL || entrylast == NULL)
-        {
-          sq_addfirst((FAR sq_entry_t *)node, &g_assemblyhead_ipid);
-        }
-      else
-        {
-          sq_addafter(entrylast, (FAR sq_entry_t *)node,
-                      &g_assemblyhead_ipid);
-        }
+      dq_addfirst(&node->flink, bucket);
 
       /* Add this new node to the tail of linked list identified by
-       * g_assemblyhead_time
+       * g_assemblyhead_time, (re)starting the reassembly timer if it was
+       * empty
        */
 
-      sq_addlast((FAR sq_entry_t *)&node->flinkat, &g_assemblyhead_time);
+      if (dq_peek(&g_assemblyhead_time) == NULL)
+        {
+          ip_frag_startwdog();
+        }
+
+      dq_addlast(&node->flinkat, &g_assemblyhead_time);
     }
 
+  /* Remember I/O buffer count */
+
+  node->bufcnt += bufcnt;
+  g_bufoccupy  += bufcnt;
+
   if (curfraglink->fragoff == 0)
     {
       /* Have received the zero fragment */
 
       node->verifyflag |= IP_FRAGVERIFY_RECVDZEROFRAG;
     }
-  else if (!curfraglink->morefrags)
+
+  if (!curfraglink->morefrags)
     {
       /* Have received the tail fragment */
 
       node->verifyflag |= IP_FRAGVERIFY_RECVDTAILFRAG;
+      node->totallen    = curend;
     }
 
   /* For indexing convenience */
 
   curfraglink->fragsnode = node;
 
-  /* Check receiving status */
+  /* Check receiving status, no fragments overlap so the datagram is
+   * complete once the received length adds up to the total length.
+   */
 
-  ip_fragin_check(node);
+  node->recvdlen += curfraglink->fraglen;
+  if ((node->verifyflag & IP_FRAGVERIFY_RECVDTAILFRAG) != 0 &&
+      node->recvdlen == node->totallen)
+    {
+      node->verifyflag |= IP_FRAGVERIFY_RECVDALLFRAGS;
+    }
 
   /* Buffer is take away, clear original pointers in NIC */
 
   netdev_iob_clear(dev);
 
-  /* Perform cache cleaning when reassembly cache size exceeds the configured
-   * threshold
-   */
-
-  ip_fragin_cachemonitor(node);
+  return OK;
 
-  return empty;
+errout:
+  kmm_free(curfraglink);
+  return ret;
 }
 
 /****************************************************************************
@@ -1110,36 +1132,26 @@ int32_t ip_frag_uninit(void)
 
 void ip_frag_stop(FAR struct net_driver_s *dev)
 {
-  FAR sq_entry_t *entry = NULL;
-  FAR sq_entry_t *entrynext;
+  FAR dq_entry_t *entry = NULL;
+  FAR dq_entry_t *entrynext;
 
   ninfo("Stop frag processing for NIC:%p\n", dev);
 
   nxmutex_lock(&g_ipfrag_lock);
 
-  entry = sq_peek(&g_assemblyhead_ipid);
+  entry = dq_peek(&g_assemblyhead_time);
 
   /* Drop those unassembled incoming fragments belonging to this NIC */
 
   while (entry != NULL)
     {
-      FAR struct ip_fragsnode_s *node = (FAR struct ip_fragsnode_s *)entry;
-      entrynext = sq_next(entry);
+      FAR struct ip_fragsnode_s *node =
+        container_of(entry, struct ip_fragsnode_s, flinkat);
+      entrynext = dq_next(entry);
 
       if (dev == node->dev)
         {
-          if (node->frags != NULL)
-            {
-              FAR struct ip_fraglink_s *fraglink = node->frags;
-
-              while (fraglink != NULL)
-                {
-                  fraglink = ip_fragin_freelink(fraglink);
-                }
-            }
-
-          ip_frag_remnode(node);
-          kmm_free(entry);
+          ip_fragin_freenode(node);
         }
 
       entry = entrynext;
@@ -1166,44 +1178,27 @@ void ip_frag_stop(FAR struct net_driver_s *dev)
 
 void ip_frag_remallfrags(void)
 {
-  FAR sq_entry_t *entry = NULL;
-  FAR sq_entry_t *entrynext;
+  FAR dq_entry_t *entry = NULL;
+  FAR dq_entry_t *entrynext;
   FAR struct net_driver_s *dev;
 
   nxmutex_lock(&g_ipfrag_lock);
 
-  entry = sq_peek(&g_assemblyhead_ipid);
+  entry = dq_peek(&g_assemblyhead_time);
 
   /* Drop all unassembled incoming fragments */
 
   while (entry != NULL)
     {
-      FAR struct ip_fragsnode_s *node = (FAR struct ip_fragsnode_s *)entry;
-      entrynext = sq_next(entry);
-
-      if (node->frags != NULL)
-        {
-          FAR struct ip_fraglink_s *fraglink = node->frags;
-
-          while (fraglink != NULL)
-            {
-              fraglink = ip_fragin_freelink(fraglink);
-            }
-        }
-
-      /* Because nodes managed by the two queues are the same,
-       * and g_assemblyhead_ipid will be cleared after this loop ends,
-       * so only reset g_assemblyhead_time is needed after this loop ends
-       */
+      entrynext = dq_next(entry);
 
-      sq_rem(entry, &g_assemblyhead_ipid);
-      kmm_free(entry);
+      ip_fragin_freenode(container_of(entry, struct ip_fragsnode_s,
+                                      flinkat));
 
       entry = entrynext;
     }
 
-  sq_init(&g_assemblyhead_time);
-  g_bufoccupy = 0;
+  DEBUGASSERT(g_bufoccupy == 0);
 
   nxmutex_unlock(&g_ipfrag_lock);
 
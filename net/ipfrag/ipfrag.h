@@ -70,6 +70,26 @@ enum ip_fragverify_e
   IP_FRAGVERIFY_RECVDTAILFRAG  = 0x01 << 2,
 };
 
+/* Identifies the fragments of one datagram: RFC 791 uses source,
+ * destination, protocol and identification, RFC 8200 leaves the protocol
+ * out (it is zero for IPv6).  IPv4 addresses use the first two words.
+ * Keys are compared with memcmp(), so they must be zeroed before filling.
+ */
+
+struct ip_fragkey_s
+{
+  net_ipv6addr_t             srcipaddr;
+  net_ipv6addr_t             destipaddr;
+
+  /* The identification field is 16 bits in IPv4 header but 32 bits in IPv6
+   * fragment header
+   */
+
+  uint32_t                   ipid;
+  uint8_t                    proto;
+  uint8_t                    isipv4;
+};
+
 struct ip_fraglink_s
 {
   /* This link is used to maintain a single-linked list of ip_fraglink_s,
@@ -84,37 +104,30 @@ struct ip_fraglink_s
   uint16_t                   fragoff;   /* Fragment offset */
   uint16_t                   fraglen;   /* Payload length */
   uint16_t                   morefrags; /* The more frag flag */
-
-  /* The identification field is 16 bits in IPv4 header but 32 bits in IPv6
-   * fragment header
-   */
-
-  uint32_t                   ipid;
 };
 
 struct ip_fragsnode_s
 {
-  /* This link is used to maintain a single-linked list of ip_fragsnode_s.
-   * Must be the first field in the structure due to flink type casting.
+  /* This link chains the nodes of one reassembly hash bucket.  Must be the
+   * first field in the structure due to type casting.
    */
 
-  FAR struct ip_fragsnode_s *flink;
+  dq_entry_t                 flink;
 
   /* Another link which connects all ip_fragsnode_s in order of addition
    * time
    */
 
-  FAR sq_entry_t            *flinkat;
+  dq_entry_t                 flinkat;
 
   /* Interface understood by the network */
 
   FAR struct net_driver_s   *dev;
 
-  /* IP Identification (IP ID) field defined in ipv4 header or in ipv6
-   * fragment header.
-   */
+  /* The datagram this node reassembles and the hash of that key */
 
-  uint32_t                   ipid;
+  struct ip_fragkey_s        key;
+  uint32_t                   hash;
 
   /* Count ticks, used by ressembly timer */
 
@@ -128,9 +141,20 @@ struct ip_fragsnode_s
 
   uint32_t                   bufcnt;
 
-  /* Linked all fragments with the same IP ID. */
+  /* Bytes of payload received so far, and the total payload length once
+   * the tail fragment is known.  Fragments never overlap, so the datagram
+   * is complete when both are equal.
+   */
+
+  uint32_t                   recvdlen;
+  uint32_t                   totallen;
+
+  /* Linked all fragments of the datagram, ordered by offset, and the last
+   * one of them (in-order arrival appends without walking the list).
+   */
 
   FAR struct ip_fraglink_s  *frags;
+  FAR struct ip_fraglink_s  *lastlink;
 
   /* Points to the reassembled outgoing IP frame */
 
@@ -149,8 +173,8 @@ extern "C"
 #  define EXTERN extern
 #endif
 
-/* Only one thread can access g_assemblyhead_ipid and g_assemblyhead_time
- * at a time
+/* Only one thread can access the reassembly hash buckets and
+ * g_assemblyhead_time at a time
  */
 
 extern mutex_t g_ipfrag_lock;
@@ -182,21 +206,34 @@ uint32_t ip_frag_remnode(FAR struct ip_fragsnode_s *node);
  * Description:
  *   Enqueue one fragment.
  *   All fragments belonging to one IP frame are organized in a linked list
- *   form, that is a ip_fragsnode_s node. All ip_fragsnode_s nodes are also
- *   organized in an upper-level linked list.
+ *   form, that is a ip_fragsnode_s node. The nodes are looked up in a hash
+ *   table by their key and are also linked in order of creation for the
+ *   reassembly timer.
  *
  * Input Parameters:
  *   dev         - NIC Device instance
+ *   key         - Identifies the datagram the fragment belongs to
  *   curfraglink - node of the lower-level linked list, it maintains
  *                 information of one fragment
  *
  * Returned Value:
- *   Whether queue is empty before enqueue the new node
+ *   OK on success, curfraglink->fragsnode is then the node of the datagram
+ *   and owns the fragment and dev->d_iob has been cleared.  On failure a
+ *   negated errno value is returned, curfraglink has been freed and its
+ *   I/O buffer is left in dev->d_iob:
+ *     -EEXIST  - Duplicate of a fragment already queued
+ *     -EBADMSG - Malformed fragment, or overlapping fragments (the whole
+ *                datagram has been dropped)
+ *     -ENOMEM  - Out of memory or over the reassembly cache limit
+ *
+ * Assumptions:
+ *   g_ipfrag_lock is held.
  *
  ****************************************************************************/
 
-bool ip_fragin_enqueue(FAR struct net_driver_s *dev,
-                       FAR struct ip_fraglink_s *curfraglink);
+int ip_fragin_enqueue(FAR struct net_driver_s *dev,
+                      FAR const struct ip_fragkey_s *key,
+                      FAR struct ip_fraglink_s *curfraglink);
 
 /****************************************************************************
  * Name: ipv4_fragin
@@ -54,7 +54,8 @@
 
 static inline int32_t
 ipv4_fragin_getinfo(FAR struct iob_s *iob,
-                    FAR struct ip_fraglink_s *fraglink);
+                    FAR struct ip_fraglink_s *fraglink,
+                    FAR struct ip_fragkey_s *key);
 static uint32_t ipv4_fragin_reassemble(FAR struct ip_fragsnode_s *node);
 static inline void
 ipv4_fragout_buildipv4header(FAR struct ipv4_hdr_s *ref,
@@ -75,6 +76,7 @@ ipv4_fragout_buildipv4header(FAR struct ipv4_hdr_s *ref,
  *   iob      - An IPv4 fragment
  *   fraglink - node of the lower-level linked list, it maintains information
  *              of one fragment
+ *   key      - Returns the reassembly key of the datagram
  *
  * Returned Value:
  *   None
@@ -83,7 +85,8 @@ ipv4_fragout_buildipv4header(FAR struct ipv4_hdr_s *ref,
 
 static inline int32_t
 ipv4_fragin_getinfo(FAR struct iob_s *iob,
-                    FAR struct ip_fraglink_s *fraglink)
+                    FAR struct ip_fraglink_s *fraglink,
+                    FAR struct ip_fragkey_s *key)
 {
   FAR struct ipv4_hdr_s *ipv4 = (FAR struct ipv4_hdr_s *)
                                 (iob->io_data + iob->io_offset);
@@ -98,9 +101,15 @@ ipv4_fragin_getinfo(FAR struct iob_s *iob,
   fraglink->fragoff   = ((offset & 0x1fff) << 3);
 
   fraglink->fraglen   = (ipv4->len[0] << 8) + ipv4->len[1] - IPv4_HDRLEN;
-  fraglink->ipid      = (ipv4->ipid[0] << 8) + ipv4->ipid[1];
   fraglink->frag      = iob;
 
+  memset(key, 0, sizeof(*key));
+  net_ipv4addr_hdrcopy(key->srcipaddr, ipv4->srcipaddr);
+  net_ipv4addr_hdrcopy(key->destipaddr, ipv4->destipaddr);
+  key->ipid           = (ipv4->ipid[0] << 8) + ipv4->ipid[1];
+  key->proto          = ipv4->proto;
+  key->isipv4         = true;
+
   return OK;
 }
 
@@ -261,7 +270,8 @@ int32_t ipv4_fragin(FAR struct net_driver_s *dev)
 {
   FAR struct ip_fragsnode_s *node;
   FAR struct ip_fraglink_s *fraginfo;
-  bool restartwdog;
+  struct ip_fragkey_s key;
+  int ret;
 
   if (dev->d_len != dev->d_iob->io_pktlen)
     {
@@ -278,13 +288,16 @@ int32_t ipv4_fragin(FAR struct net_driver_s *dev)
 
   /* Polulate fragment information from input packet data */
 
-  ipv4_fragin_getinfo(dev->d_iob, fraginfo);
+  ipv4_fragin_getinfo(dev->d_iob, fraginfo, &key);
 
   nxmutex_lock(&g_ipfrag_lock);
 
-  /* Need to restart reassembly worker if the original linked list is empty */
-
-  restartwdog = ip_fragin_enqueue(dev, fraginfo);
+  ret = ip_fragin_enqueue(dev, &key, fraginfo);
+  if (ret < 0)
+    {
+      nxmutex_unlock(&g_ipfrag_lock);
+      return ret;
+    }
 
   node = fraginfo->fragsnode;
 
@@ -320,13 +333,6 @@ int32_t ipv4_fragin(FAR struct net_driver_s *dev)
 
   nxmutex_unlock(&g_ipfrag_lock);
 
-  if (restartwdog)
-    {
-      /* Restart the work queue for fragment processing */
-
-      ip_frag_startwdog();
-    }
-
   return OK;
 }
 
@@ -60,7 +60,8 @@ static uint32_t g_ipv6id;
  ****************************************************************************/
 
 static int32_t ipv6_fragin_getinfo(FAR struct iob_s *iob,
-                                   FAR struct ip_fraglink_s *fraglink);
+                                   FAR struct ip_fraglink_s *fraglink,
+                                   FAR struct ip_fragkey_s *key);
 static uint32_t ipv6_fragin_reassemble(FAR struct ip_fragsnode_s *node);
 static inline void
 ipv6_fragout_buildipv6header(FAR struct ipv6_hdr_s *ref,
@@ -97,7 +98,8 @@ static uint16_t ipv6_fragout_getunfraginfo(FAR struct iob_s *iob,
  ****************************************************************************/
 
 static int32_t ipv6_fragin_getinfo(FAR struct iob_s *iob,
-                                   FAR struct ip_fraglink_s *fraglink)
+                                   FAR struct ip_fraglink_s *fraglink,
+                                   FAR struct ip_fragkey_s *key)
 {
   FAR struct ipv6_hdr_s *ipv6 = (FAR struct ipv6_hdr_s *)
                                 (iob->io_data + iob->io_offset);
@@ -142,12 +144,15 @@ static int32_t ipv6_fragin_getinfo(FAR struct iob_s *iob,
       fraglink->morefrags = fraglink->fragoff & 0x1;
       fraglink->fragoff  &= 0xfff8;
       fraglink->fraglen   = paylen;
-      fraglink->ipid      = NTOHL(
+      fraglink->frag      = iob;
+
+      memset(key, 0, sizeof(*key));
+      net_ipv6addr_copy(key->srcipaddr, ipv6->srcipaddr);
+      net_ipv6addr_copy(key->destipaddr, ipv6->destipaddr);
+      key->ipid           = NTOHL(
         ((uint32_t)(*(FAR uint16_t *)(&fraghdr->id[0])) << 16) +
          (uint32_t)(*(FAR uint16_t *)(&fraghdr->id[2])));
 
-      fraglink->frag      = iob;
-
       return OK;
     }
   else
@@ -468,7 +473,8 @@ int32_t ipv6_fragin(FAR struct net_driver_s *dev)
 {
   FAR struct ip_fragsnode_s *node = NULL;
   FAR struct ip_fraglink_s *fraginfo = NULL;
-  bool restartwdog;
+  struct ip_fragkey_s key;
+  int ret;
 
   if (dev->d_len != dev->d_iob->io_pktlen)
     {
@@ -485,13 +491,20 @@ int32_t ipv6_fragin(FAR struct net_driver_s *dev)
 
   /* Polulate fragment information from input packet data */
 
-  ipv6_fragin_getinfo(dev->d_iob, fraginfo);
+  if (ipv6_fragin_getinfo(dev->d_iob, fraginfo, &key) < 0)
+    {
+      kmm_free(fraginfo);
+      return -EINVAL;
+    }
 
   nxmutex_lock(&g_ipfrag_lock);
 
-  /* Need to restart reassembly worker if the original linked list is empty */
-
-  restartwdog = ip_fragin_enqueue(dev, fraginfo);
+  ret = ip_fragin_enqueue(dev, &key, fraginfo);
+  if (ret < 0)
+    {
+      nxmutex_unlock(&g_ipfrag_lock);
+      return ret;
+    }
 
   node = fraginfo->fragsnode;
   if (node->verifyflag & IP_FRAGVERIFY_RECVDALLFRAGS)
@@ -526,13 +539,6 @@ int32_t ipv6_fragin(FAR struct net_driver_s *dev)
 
   nxmutex_unlock(&g_ipfrag_lock);
 
-  if (restartwdog)
-    {
-      /* Restart the work queue for fragment processing */
-
-      ip_frag_startwdog();
-    }
-
   return OK;
 }
 
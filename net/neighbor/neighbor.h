@@ -31,22 +31,88 @@
 
 #include <net/ethernet.h>
 
+#include <nuttx/mm/iob.h>
 #include <nuttx/net/ip.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/sixlowpan.h>
 #include <nuttx/net/neighbor.h>
 
+#include "devif/devif.h"
+
 #ifdef CONFIG_NET_IPv6
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_NET_IPv6_NCONF_ALLOC_ENTRIES
+#  define CONFIG_NET_IPv6_NCONF_ALLOC_ENTRIES 0
+#endif
+
+#ifndef CONFIG_NET_IPv6_NCONF_MAX_ENTRIES
+#  define CONFIG_NET_IPv6_NCONF_MAX_ENTRIES 0
+#endif
+
+#ifndef CONFIG_NET_IPv6_NCONF_HASHSIZE
+#  define CONFIG_NET_IPv6_NCONF_HASHSIZE 16
+#endif
+
+#ifndef CONFIG_NET_IPv6_NCONF_REACHABLE
+#  define CONFIG_NET_IPv6_NCONF_REACHABLE 30
+#endif
+
+#ifndef CONFIG_NET_IPv6_NCONF_MAXAGE
+#  define CONFIG_NET_IPv6_NCONF_MAXAGE 1200
+#endif
+
+#ifndef CONFIG_NET_IPv6_NCONF_QUEUELEN
+#  define CONFIG_NET_IPv6_NCONF_QUEUELEN 0
+#endif
+
+/* Neighbor Table entry states.  An entry is created INCOMPLETE when the
+ * first packet for an unknown address is sent, turns REACHABLE with the
+ * Neighbor Advertisement and STALE when it was not confirmed for
+ * CONFIG_NET_IPv6_NCONF_REACHABLE seconds.  STALE entries are still used
+ * and dropped after CONFIG_NET_IPv6_NCONF_MAXAGE seconds without a
+ * confirmation.
+ */
+
+#define NEIGHBOR_STATE_INCOMPLETE 0
+#define NEIGHBOR_STATE_REACHABLE  1
+#define NEIGHBOR_STATE_STALE      2
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One node of the Neighbor Table: the entry reported by netlink plus the
+ * table bookkeeping.  ne_time of the entry is the time of the last
+ * confirmation (or of the solicitation while INCOMPLETE).
+ */
+
+struct neighbor_node_s
+{
+  dq_entry_t              nn_node;    /* Link in the hash bucket */
+  dq_entry_t              nn_lru;     /* Link in the LRU list */
+  uint8_t                 nn_state;   /* See NEIGHBOR_STATE_* definitions */
+#if CONFIG_NET_IPv6_NCONF_QUEUELEN > 0
+  uint8_t                 nn_nqueued; /* Number of packets in nn_queue */
+  struct iob_queue_s      nn_queue;   /* Packets waiting for resolution */
+#endif
+  struct neighbor_entry_s nn_entry;   /* The address mapping */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
 
-/* This is the Neighbor table.  The network should be locked when accessing
- * this table.
+/* The nodes of the Neighbor Table in use, most recently used first.  The
+ * network should be locked when accessing this table.
  */
 
-extern struct neighbor_entry_s g_neighbors[CONFIG_NET_IPv6_NCONF_ENTRIES];
+extern dq_queue_t g_neighbor_lru;
 
 /****************************************************************************
  * Public Function Prototypes
@@ -54,6 +120,142 @@ extern struct neighbor_entry_s g_neighbors[CONFIG_NET_IPv6_NCONF_ENTRIES];
 
 struct net_driver_s; /* Forward reference */
 
+/****************************************************************************
+ * Name: neighbor_findnode
+ *
+ * Description:
+ *   Find a node in the Neighbor Table, in any state.  The node found
+ *   becomes the most recently used one; an expired node is dropped.
+ *
+ * Input Parameters:
+ *   ipaddr - The IPv6 address to use in the lookup
+ *   dev    - The device of the node, NULL matches any device
+ *
+ * Returned Value:
+ *   The node corresponding to the IPv6 address, NULL if there is none.
+ *
+ ****************************************************************************/
+
+FAR struct neighbor_node_s *
+neighbor_findnode(FAR const net_ipv6addr_t ipaddr,
+                  FAR struct net_driver_s *dev);
+
+/****************************************************************************
+ * Name: neighbor_allocnode
+ *
+ * Description:
+ *   Add a new INCOMPLETE node to the Neighbor Table.  The least recently
+ *   used node is recycled when the table is full.
+ *
+ * Input Parameters:
+ *   dev    - Driver instance the neighbor is reached through
+ *   ipaddr - The IPv6 address of the neighbor
+ *
+ * Returned Value:
+ *   The new node, NULL if none could be allocated.
+ *
+ ****************************************************************************/
+
+FAR struct neighbor_node_s *
+neighbor_allocnode(FAR struct net_driver_s *dev,
+                   FAR const net_ipv6addr_t ipaddr);
+
+/****************************************************************************
+ * Name: neighbor_freenode
+ *
+ * Description:
+ *   Remove a node from the Neighbor Table and drop its queued packets.
+ *
+ ****************************************************************************/
+
+void neighbor_freenode(FAR struct neighbor_node_s *node);
+
+/****************************************************************************
+ * Name: neighbor_setstate
+ *
+ * Description:
+ *   Move a node to a new state and restart its timer.  Queued packets
+ *   become ready to send once the node is resolved.
+ *
+ ****************************************************************************/
+
+void neighbor_setstate(FAR struct neighbor_node_s *node, uint8_t state);
+
+/****************************************************************************
+ * Name: neighbor_expired
+ *
+ * Description:
+ *   Advance the state of a node with the time passed since its last
+ *   confirmation.  Returns true if the node should be dropped.
+ *
+ ****************************************************************************/
+
+bool neighbor_expired(FAR struct neighbor_node_s *node, clock_t now);
+
+/****************************************************************************
+ * Name: neighbor_cleanup
+ *
+ * Description:
+ *   Remove all Neighbor Table entries of a network device.
+ *
+ * Input Parameters:
+ *   dev - The device driver structure
+ *
+ ****************************************************************************/
+
+void neighbor_cleanup(FAR struct net_driver_s *dev);
+
+/****************************************************************************
+ * Name: neighbor_count
+ *
+ * Description:
+ *   Return the number of entries currently in the Neighbor Table.
+ *
+ ****************************************************************************/
+
+unsigned int neighbor_count(void);
+
+/****************************************************************************
+ * Name: neighbor_queue
+ *
+ * Description:
+ *   Keep a copy of the outgoing IPv6 packet in the device buffer until the
+ *   Neighbor Solicitation for its next hop is answered.  An INCOMPLETE
+ *   node is created for the address if there is none yet.
+ *
+ * Input Parameters:
+ *   dev    - The device driver structure holding the packet
+ *   ipaddr - The next hop IPv6 address
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_IPv6_NCONF_QUEUELEN > 0
+void neighbor_queue(FAR struct net_driver_s *dev,
+                    FAR const net_ipv6addr_t ipaddr);
+#else
+#  define neighbor_queue(d,i)
+#endif
+
+/****************************************************************************
+ * Name: neighbor_queue_poll
+ *
+ * Description:
+ *   Send the packets kept by neighbor_queue() whose next hop address got
+ *   resolved.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll() with the network locked.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_IPv6_NCONF_QUEUELEN > 0
+int neighbor_queue_poll(FAR struct net_driver_s *dev,
+                        devif_poll_callback_t callback);
+#else
+#  define neighbor_queue_poll(d,c) (0)
+#endif
+
 /****************************************************************************
  * Name: neighbor_findentry
  *
@@ -65,78 +65,54 @@
 void neighbor_add(FAR struct net_driver_s *dev, FAR net_ipv6addr_t ipaddr,
                   FAR uint8_t *addr)
 {
-  uint8_t lltype;
-  clock_t oldest_time;
-  int     oldest_ndx;
-  bool    found = false;
-  bool    new_entry;
-  int     i;
+  FAR struct neighbor_entry_s *neighbor;
+  FAR struct neighbor_node_s *node;
+  bool found;
+  bool new_entry;
 
   DEBUGASSERT(dev != NULL && addr != NULL);
 
-  /* Find the matching entry, first unused entry, or the oldest used entry.
-   * The unused entry will have ne_time == 0 and should generate the oldest
-   * time.  REVISIT:  Could this fail on clock wraparound?  A more explicit
-   * check might be to compare ne_ipaddr with the IPv6 unspecified address.
+  /* Find the matching node, or add a new one (recycling the least recently
+   * used node if the table is full).
    */
 
-  oldest_time = g_neighbors[0].ne_time;
-  oldest_ndx  = 0;
-  lltype      = dev->d_lltype;
+  node  = neighbor_findnode(ipaddr, dev);
+  found = node != NULL && node->nn_state != NEIGHBOR_STATE_INCOMPLETE;
 
-  for (i = 0; i < CONFIG_NET_IPv6_NCONF_ENTRIES; ++i)
+  if (node == NULL)
     {
-      if (g_neighbors[i].ne_addr.na_lltype == lltype &&
-          net_ipv6addr_cmp(g_neighbors[i].ne_ipaddr, ipaddr))
+      node = neighbor_allocnode(dev, ipaddr);
+      if (node == NULL)
         {
-          oldest_ndx = i;
-          found = true;
-          break;
-        }
-
-      if ((int)(g_neighbors[i].ne_time - oldest_time) < 0)
-        {
-          oldest_ndx = i;
-          oldest_time = g_neighbors[i].ne_time;
+          nerr("ERROR: Neighbor Table full\n");
+          return;
         }
     }
 
-  /* When overwite old entry, need to notify RTM_DELNEIGH */
-
-  if (!found && g_neighbors[oldest_ndx].ne_time != 0)
-    {
-      netlink_neigh_notify(&g_neighbors[oldest_ndx], RTM_DELNEIGH,
-                           AF_INET6);
-    }
+  neighbor = &node->nn_entry;
 
   /* Need to notify when entry is not found or changes in table */
 
-  new_entry = !found || memcmp(&g_neighbors[oldest_ndx].ne_addr.u, addr,
-                             g_neighbors[oldest_ndx].ne_addr.na_llsize) != 0;
+  new_entry = !found || memcmp(&neighbor->ne_addr.u, addr,
+                               neighbor->ne_addr.na_llsize) != 0;
 
-  /* Use the oldest or first free entry (either pointed to by the
-   * "oldest_ndx" variable).
-   */
+  neighbor->ne_addr.na_lltype = dev->d_lltype;
+  neighbor->ne_addr.na_llsize = netdev_lladdrsize(dev);
 
-  g_neighbors[oldest_ndx].ne_dev  = dev;
-  g_neighbors[oldest_ndx].ne_time = clock_systime_ticks();
-  net_ipv6addr_copy(g_neighbors[oldest_ndx].ne_ipaddr, ipaddr);
+  memcpy(&neighbor->ne_addr.u, addr, neighbor->ne_addr.na_llsize);
 
-  g_neighbors[oldest_ndx].ne_addr.na_lltype = lltype;
-  g_neighbors[oldest_ndx].ne_addr.na_llsize = netdev_lladdrsize(dev);
+  /* The neighbor is confirmed reachable, packets waiting for it may go */
 
-  memcpy(&g_neighbors[oldest_ndx].ne_addr.u, addr,
-         g_neighbors[oldest_ndx].ne_addr.na_llsize);
+  neighbor_setstate(node, NEIGHBOR_STATE_REACHABLE);
 
   /* Notify the new entry */
 
   if (new_entry)
     {
-      netlink_neigh_notify(&g_neighbors[oldest_ndx], RTM_NEWNEIGH,
-                           AF_INET6);
+      netlink_neigh_notify(neighbor, RTM_NEWNEIGH, AF_INET6);
     }
 
   /* Dump the contents of the new entry */
 
-  neighbor_dumpentry("Added entry", &g_neighbors[oldest_ndx]);
+  neighbor_dumpentry("Added entry", neighbor);
 }
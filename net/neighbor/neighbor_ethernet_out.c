@@ -165,10 +165,12 @@ void neighbor_ethernet_out(FAR struct net_driver_s *dev)
            ninfo("IPv6 Neighbor solicitation for IPv6\n");
 
           /* The destination address was not in our Neighbor Table, so we
-           * overwrite the IPv6 packet with an ICMPv6 Neighbor Solicitation
+           * keep a copy of the IPv6 packet for when the advertisement
+           * arrives and overwrite it with an ICMPv6 Neighbor Solicitation
            * message.
            */
 
+          neighbor_queue(dev, ipaddr);
           icmpv6_solicit(dev, ipaddr);
 #else
           /* What to do here? We need the laddr, but no way to get it. */
@@ -47,23 +47,21 @@
  *
  * Returned Value:
  *   The Neighbor Table entry corresponding to the IPv6 address;  NULL is
- *   returned if there is no matching entry in the Neighbor Table.
+ *   returned if there is no resolved entry in the Neighbor Table.
  *
  ****************************************************************************/
 
 FAR struct neighbor_entry_s *neighbor_findentry(const net_ipv6addr_t ipaddr)
 {
-  int i;
+  FAR struct neighbor_node_s *node;
 
-  for (i = 0; i < CONFIG_NET_IPv6_NCONF_ENTRIES; ++i)
-    {
-      FAR struct neighbor_entry_s *neighbor = &g_neighbors[i];
+  /* Nodes still waiting for the Neighbor Advertisement have no address */
 
-      if (net_ipv6addr_cmp(neighbor->ne_ipaddr, ipaddr))
-        {
-          neighbor_dumpentry("Entry found", neighbor);
-          return neighbor;
-        }
+  node = neighbor_findnode(ipaddr, NULL);
+  if (node != NULL && node->nn_state != NEIGHBOR_STATE_INCOMPLETE)
+    {
+      neighbor_dumpentry("Entry found", &node->nn_entry);
+      return &node->nn_entry;
     }
 
   neighbor_dumpipaddr("Not found", ipaddr);
@@ -29,6 +29,8 @@
 #include <string.h>
 #include <debug.h>
 
+#include <nuttx/clock.h>
+#include <nuttx/nuttx.h>
 #include <nuttx/net/ip.h>
 
 #include "inet/inet.h"
@@ -63,25 +65,23 @@
 unsigned int neighbor_snapshot(FAR struct neighbor_entry_s *snapshot,
                                unsigned int nentries)
 {
+  FAR struct neighbor_node_s *node;
+  FAR dq_entry_t *entry;
   unsigned int ncopied;
-  int i;
+  clock_t now;
 
-  /* Copy all non-empty entries in the Neighbor table. */
+  /* Copy all resolved, non-expired entries in the Neighbor table. */
 
-  for (i = 0, ncopied = 0;
-       nentries > ncopied && i < CONFIG_NET_IPv6_NCONF_ENTRIES;
-       i++)
+  for (entry = dq_peek(&g_neighbor_lru), now = clock_systime_ticks(),
+       ncopied = 0;
+       nentries > ncopied && entry != NULL;
+       entry = dq_next(entry))
     {
-      FAR struct neighbor_entry_s *neighbor = &g_neighbors[i];
-
-      /* An unused entry table entry will be nullified.  In particularly,
-       * the Neighbor IP address will be all zero (i.e., the unspecified
-       * IPv6 address).
-       */
-
-      if (!net_ipv6addr_cmp(neighbor->ne_ipaddr, g_ipv6_unspecaddr))
+      node = container_of(entry, struct neighbor_node_s, nn_lru);
+      if (node->nn_state != NEIGHBOR_STATE_INCOMPLETE &&
+          !neighbor_expired(node, now))
         {
-          memcpy(&snapshot[ncopied], neighbor,
+          memcpy(&snapshot[ncopied], &node->nn_entry,
                  sizeof(struct neighbor_entry_s));
           ncopied++;
         }
@@ -0,0 +1,491 @@
+/****************************************************************************
+ * net/neighbor/neighbor_table.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/nuttx.h>
+#include <nuttx/net/net.h>
+
+#include "netdev/netdev.h"
+#include "netlink/netlink.h"
+#include "utils/utils.h"
+#include "neighbor/neighbor.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define NEIGHBOR_REACHABLE_TICK  SEC2TICK(CONFIG_NET_IPv6_NCONF_REACHABLE)
+#define NEIGHBOR_MAXAGE_TICK     SEC2TICK(CONFIG_NET_IPv6_NCONF_MAXAGE)
+
+/* How long an INCOMPLETE node waits for the Neighbor Advertisement */
+
+#define NEIGHBOR_INCOMPLETE_TICK SEC2TICK(3)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The pool of Neighbor Table nodes */
+
+NET_BUFPOOL_DECLARE(g_neighbor_nodes, sizeof(struct neighbor_node_s),
+                    CONFIG_NET_IPv6_NCONF_ENTRIES,
+                    CONFIG_NET_IPv6_NCONF_ALLOC_ENTRIES,
+                    CONFIG_NET_IPv6_NCONF_MAX_ENTRIES);
+
+/* The nodes in use, hashed by IPv6 address */
+
+static dq_queue_t g_neighbor_hash[CONFIG_NET_IPv6_NCONF_HASHSIZE];
+static unsigned int g_neighbor_nentries;
+
+#if CONFIG_NET_IPv6_NCONF_QUEUELEN > 0
+/* The number of resolved nodes that still hold queued packets */
+
+static unsigned int g_neighbor_nready;
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* The nodes of the Neighbor Table in use, most recently used first.  The
+ * network should be locked when accessing this table.
+ */
+
+dq_queue_t g_neighbor_lru;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: neighbor_hash
+ *
+ * Description:
+ *   Return the hash bucket of an IPv6 address.
+ *
+ ****************************************************************************/
+
+static FAR dq_queue_t *neighbor_hash(FAR const net_ipv6addr_t ipaddr)
+{
+  uint32_t hash = 0;
+  int i;
+
+  for (i = 0; i < 8; i += 2)
+    {
+      hash ^= ((uint32_t)ipaddr[i] << 16) | ipaddr[i + 1];
+    }
+
+  hash ^= hash >> 16;
+  hash ^= hash >> 8;
+  return &g_neighbor_hash[hash % CONFIG_NET_IPv6_NCONF_HASHSIZE];
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: neighbor_findnode
+ *
+ * Description:
+ *   Find a node in the Neighbor Table, in any state.  The node found
+ *   becomes the most recently used one; an expired node is dropped.
+ *
+ * Input Parameters:
+ *   ipaddr - The IPv6 address to use in the lookup
+ *   dev    - The device of the node, NULL matches any device
+ *
+ * Returned Value:
+ *   The node corresponding to the IPv6 address, NULL if there is none.
+ *
+ ****************************************************************************/
+
+FAR struct neighbor_node_s *
+neighbor_findnode(FAR const net_ipv6addr_t ipaddr,
+                  FAR struct net_driver_s *dev)
+{
+  FAR struct neighbor_node_s *node;
+  FAR dq_entry_t *entry;
+
+  for (entry = dq_peek(neighbor_hash(ipaddr)); entry != NULL;
+       entry = dq_next(entry))
+    {
+      node = container_of(entry, struct neighbor_node_s, nn_node);
+      if ((dev == NULL || node->nn_entry.ne_dev == dev) &&
+          net_ipv6addr_cmp(node->nn_entry.ne_ipaddr, ipaddr))
+        {
+          if (neighbor_expired(node, clock_systime_ticks()))
+            {
+              neighbor_freenode(node);
+              return NULL;
+            }
+
+          if (dq_peek(&g_neighbor_lru) != &node->nn_lru)
+            {
+              dq_rem(&node->nn_lru, &g_neighbor_lru);
+              dq_addfirst(&node->nn_lru, &g_neighbor_lru);
+            }
+
+          return node;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: neighbor_allocnode
+ *
+ * Description:
+ *   Add a new INCOMPLETE node to the Neighbor Table.  The least recently
+ *   used node is recycled when the table is full.
+ *
+ * Input Parameters:
+ *   dev    - Driver instance the neighbor is reached through
+ *   ipaddr - The IPv6 address of the neighbor
+ *
+ * Returned Value:
+ *   The new node, NULL if none could be allocated.
+ *
+ ****************************************************************************/
+
+FAR struct neighbor_node_s *
+neighbor_allocnode(FAR struct net_driver_s *dev,
+                   FAR const net_ipv6addr_t ipaddr)
+{
+  FAR struct neighbor_node_s *node;
+  FAR dq_entry_t *oldest;
+
+  node = NET_BUFPOOL_TRYALLOC(g_neighbor_nodes);
+  if (node == NULL)
+    {
+      oldest = dq_tail(&g_neighbor_lru);
+      if (oldest == NULL)
+        {
+          return NULL;
+        }
+
+      neighbor_freenode(container_of(oldest, struct neighbor_node_s,
+                                     nn_lru));
+      node = NET_BUFPOOL_TRYALLOC(g_neighbor_nodes);
+      if (node == NULL)
+        {
+          return NULL;
+        }
+    }
+
+  net_ipv6addr_copy(node->nn_entry.ne_ipaddr, ipaddr);
+  node->nn_entry.ne_dev  = dev;
+  node->nn_entry.ne_time = clock_systime_ticks();
+  node->nn_state         = NEIGHBOR_STATE_INCOMPLETE;
+
+  dq_addfirst(&node->nn_node, neighbor_hash(ipaddr));
+  dq_addfirst(&node->nn_lru, &g_neighbor_lru);
+  g_neighbor_nentries++;
+
+  return node;
+}
+
+/****************************************************************************
+ * Name: neighbor_freenode
+ *
+ * Description:
+ *   Remove a node from the Neighbor Table and drop its queued packets.
+ *
+ ****************************************************************************/
+
+void neighbor_freenode(FAR struct neighbor_node_s *node)
+{
+  /* Nodes that never had an address were never announced */
+
+  if (node->nn_state != NEIGHBOR_STATE_INCOMPLETE)
+    {
+      netlink_neigh_notify(&node->nn_entry, RTM_DELNEIGH, AF_INET6);
+    }
+
+#if CONFIG_NET_IPv6_NCONF_QUEUELEN > 0
+  if (node->nn_nqueued > 0)
+    {
+      if (node->nn_state != NEIGHBOR_STATE_INCOMPLETE)
+        {
+          g_neighbor_nready--;
+        }
+
+      iob_free_queue(&node->nn_queue);
+    }
+#endif
+
+  dq_rem(&node->nn_node, neighbor_hash(node->nn_entry.ne_ipaddr));
+  dq_rem(&node->nn_lru, &g_neighbor_lru);
+  g_neighbor_nentries--;
+
+  NET_BUFPOOL_FREE(g_neighbor_nodes, node);
+}
+
+/****************************************************************************
+ * Name: neighbor_setstate
+ *
+ * Description:
+ *   Move a node to a new state and restart its timer.  Queued packets
+ *   become ready to send once the node is resolved.
+ *
+ ****************************************************************************/
+
+void neighbor_setstate(FAR struct neighbor_node_s *node, uint8_t state)
+{
+#if CONFIG_NET_IPv6_NCONF_QUEUELEN > 0
+  if (node->nn_nqueued > 0 && node->nn_state == NEIGHBOR_STATE_INCOMPLETE &&
+      state != NEIGHBOR_STATE_INCOMPLETE)
+    {
+      g_neighbor_nready++;
+      netdev_txnotify_dev(node->nn_entry.ne_dev);
+    }
+#endif
+
+  node->nn_state         = state;
+  node->nn_entry.ne_time = clock_systime_ticks();
+}
+
+/****************************************************************************
+ * Name: neighbor_expired
+ *
+ * Description:
+ *   Advance the state of a node with the time passed since its last
+ *   confirmation.  Returns true if the node should be dropped.
+ *
+ ****************************************************************************/
+
+bool neighbor_expired(FAR struct neighbor_node_s *node, clock_t now)
+{
+  clock_t elapsed = now - node->nn_entry.ne_time;
+
+  switch (node->nn_state)
+    {
+      case NEIGHBOR_STATE_INCOMPLETE:
+        return elapsed > NEIGHBOR_INCOMPLETE_TICK;
+
+      case NEIGHBOR_STATE_REACHABLE:
+        if (elapsed > NEIGHBOR_REACHABLE_TICK)
+          {
+            node->nn_state = NEIGHBOR_STATE_STALE;
+          }
+
+        /* Fall through */
+
+      default:
+        return elapsed > NEIGHBOR_MAXAGE_TICK;
+    }
+}
+
+/****************************************************************************
+ * Name: neighbor_cleanup
+ *
+ * Description:
+ *   Remove all Neighbor Table entries of a network device.
+ *
+ * Input Parameters:
+ *   dev - The device driver structure
+ *
+ ****************************************************************************/
+
+void neighbor_cleanup(FAR struct net_driver_s *dev)
+{
+  FAR struct neighbor_node_s *node;
+  FAR dq_entry_t *entry;
+  FAR dq_entry_t *next;
+
+  for (entry = dq_peek(&g_neighbor_lru); entry != NULL; entry = next)
+    {
+      next = dq_next(entry);
+      node = container_of(entry, struct neighbor_node_s, nn_lru);
+      if (node->nn_entry.ne_dev == dev)
+        {
+          neighbor_freenode(node);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: neighbor_count
+ *
+ * Description:
+ *   Return the number of entries currently in the Neighbor Table.
+ *
+ ****************************************************************************/
+
+unsigned int neighbor_count(void)
+{
+  return g_neighbor_nentries;
+}
+
+/****************************************************************************
+ * Name: neighbor_queue
+ *
+ * Description:
+ *   Keep a copy of the outgoing IPv6 packet in the device buffer until the
+ *   Neighbor Solicitation for its next hop is answered.  An INCOMPLETE
+ *   node is created for the address if there is none yet.
+ *
+ * Input Parameters:
+ *   dev    - The device driver structure holding the packet
+ *   ipaddr - The next hop IPv6 address
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_IPv6_NCONF_QUEUELEN > 0
+void neighbor_queue(FAR struct net_driver_s *dev,
+                    FAR const net_ipv6addr_t ipaddr)
+{
+  FAR struct neighbor_node_s *node;
+  FAR struct iob_s *iob;
+
+  if (dev->d_iob == NULL)
+    {
+      return;
+    }
+
+  node = neighbor_findnode(ipaddr, dev);
+  if (node == NULL)
+    {
+      node = neighbor_allocnode(dev, ipaddr);
+      if (node == NULL)
+        {
+          return;
+        }
+    }
+  else if (node->nn_state != NEIGHBOR_STATE_INCOMPLETE)
+    {
+      return;
+    }
+
+  iob = netdev_iob_clone(dev, true);
+  if (iob == NULL)
+    {
+      return;
+    }
+
+  /* Make room by dropping the oldest packet */
+
+  if (node->nn_nqueued >= CONFIG_NET_IPv6_NCONF_QUEUELEN)
+    {
+      iob_free_chain(iob_remove_queue(&node->nn_queue));
+      node->nn_nqueued--;
+    }
+
+  if (iob_tryadd_queue(iob, &node->nn_queue) < 0)
+    {
+      iob_free_chain(iob);
+      return;
+    }
+
+  node->nn_nqueued++;
+}
+
+/****************************************************************************
+ * Name: neighbor_queue_poll
+ *
+ * Description:
+ *   Send the packets kept by neighbor_queue() whose next hop address got
+ *   resolved.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver indirectly through
+ *   devif_poll() with the network locked.
+ *
+ ****************************************************************************/
+
+int neighbor_queue_poll(FAR struct net_driver_s *dev,
+                        devif_poll_callback_t callback)
+{
+  FAR struct neighbor_node_s *node;
+  FAR dq_entry_t *entry;
+  FAR struct iob_s *iob;
+  bool reused = false;
+  int bstop = 0;
+
+  while (!bstop && g_neighbor_nready > 0)
+    {
+      /* Sending a packet may reorder or drop nodes, so look for the next
+       * ready node of the device from the start each time.
+       */
+
+      for (entry = dq_peek(&g_neighbor_lru); entry != NULL;
+           entry = dq_next(entry))
+        {
+          node = container_of(entry, struct neighbor_node_s, nn_lru);
+          if (node->nn_entry.ne_dev == dev && node->nn_nqueued > 0 &&
+              node->nn_state != NEIGHBOR_STATE_INCOMPLETE)
+            {
+              break;
+            }
+        }
+
+      if (entry == NULL)
+        {
+          break;
+        }
+
+      iob = iob_remove_queue(&node->nn_queue);
+      if (--node->nn_nqueued == 0)
+        {
+          g_neighbor_nready--;
+        }
+
+      /* Replace the device buffer, build the L2 header and send */
+
+      reused = true;
+      netdev_iob_replace(dev, iob);
+      devif_out(dev);
+
+      if (dev->d_len > 0)
+        {
+          bstop = callback(dev);
+        }
+    }
+
+  /* Come back for the rest if the driver is out of buffers */
+
+  if (bstop && g_neighbor_nready > 0)
+    {
+      netdev_txnotify_dev(dev);
+    }
+
+  /* Reuse iob buffer */
+
+  if (!bstop && reused)
+    {
+      iob_update_pktlen(dev->d_iob, 0, false);
+      netdev_iob_prepare(dev, true, 0);
+    }
+
+  return bstop;
+}
+#endif /* CONFIG_NET_IPv6_NCONF_QUEUELEN > 0 */
@@ -50,11 +50,11 @@
 
 void neighbor_update(const net_ipv6addr_t ipaddr)
 {
-  struct neighbor_entry_s *neighbor;
+  FAR struct neighbor_node_s *node;
 
-  neighbor = neighbor_findentry(ipaddr);
-  if (neighbor != NULL)
+  node = neighbor_findnode(ipaddr, NULL);
+  if (node != NULL && node->nn_state != NEIGHBOR_STATE_INCOMPLETE)
     {
-      neighbor->ne_time = clock_systime_ticks();
+      neighbor_setstate(node, NEIGHBOR_STATE_REACHABLE);
     }
 }
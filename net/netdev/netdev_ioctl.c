@@ -82,6 +82,7 @@
 #include "netdev/netdev.h"
 #include "devif/devif.h"
 #include "igmp/igmp.h"
+#include "ipforward/ipforward.h"
 #include "icmpv6/icmpv6.h"
 #include "route/route.h"
 #include "netlink/netlink.h"
@@ -1240,6 +1241,26 @@ static int netdev_ifr_ioctl(FAR struct socket *psock, int cmd,
         break;
     }
 
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  /* New addresses or masks may change where packets are forwarded. */
+
+  switch (cmd)
+    {
+      case SIOCSIFADDR:
+      case SIOCDIFADDR:
+      case SIOCSIFDSTADDR:
+      case SIOCSIFNETMASK:
+      case SIOCSLIFADDR:
+      case SIOCSLIFDSTADDR:
+      case SIOCSLIFNETMASK:
+        ipfwd_flow_flush();
+        break;
+
+      default:
+        break;
+    }
+#endif
+
   net_unlock();
   return ret;
 }
@@ -1961,6 +1982,9 @@ int netdev_ifup(FAR struct net_driver_s *dev)
               /* Mark the interface as up */
 
               dev->d_flags |= IFF_UP;
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+              ipfwd_flow_flush();
+#endif
 
               /* Update the driver status */
 
@@ -1995,6 +2019,9 @@ int netdev_ifdown(FAR struct net_driver_s *dev)
               /* Mark the interface as down */
 
               dev->d_flags &= ~(IFF_UP | IFF_RUNNING);
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+              ipfwd_flow_flush();
+#endif
 
               /* Update the driver status */
 
@@ -38,7 +38,11 @@
 #include <nuttx/net/netdev.h>
 
 #include "utils/utils.h"
+#include "devif/devif.h"
 #include "netdev/netdev.h"
+#include "arp/arp.h"
+#include "ipforward/ipforward.h"
+#include "neighbor/neighbor.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -150,6 +154,19 @@ int netdev_unregister(FAR struct net_driver_s *dev)
 #ifdef CONFIG_NETDEV_IFINDEX
       free_ifindex(dev->d_ifindex);
 #endif
+
+      /* Forget the connections waiting for a TX poll of the device and the
+       * neighbors reached through it.
+       */
+
+      devif_txready_flush(dev);
+      arp_cleanup(dev);
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+      ipfwd_flow_flush();
+#endif
+#ifdef CONFIG_NET_IPv6
+      neighbor_cleanup(dev);
+#endif
       net_unlock();
 
 #if CONFIG_NETDEV_STATISTICS_LOG_PERIOD > 0
@@ -47,7 +47,7 @@
  ****************************************************************************/
 
 /* Structure to store all info we need, including table data and
- * init/apply functions.
+ * init/apply/counters functions.
  */
 
 struct ip6t_table_s
@@ -55,6 +55,7 @@ struct ip6t_table_s
   FAR struct ip6t_replace *repl;
   FAR struct ip6t_replace *(*init_func)(void);
   FAR int (*apply_func)(FAR const struct ip6t_replace *);
+  FAR void (*counters_func)(FAR struct ip6t_replace *);
 };
 
 /* Following structs represent the layout of an entry with standard/error
@@ -82,9 +83,9 @@ struct ip6t_error_entry_s
 static struct ip6t_table_s g_tables[] =
 {
 #ifdef CONFIG_NET_IPFILTER
-  {NULL, ip6t_filter_init, ip6t_filter_apply},
+  {NULL, ip6t_filter_init, ip6t_filter_apply, ip6t_filter_counters},
 #else
-  {NULL, NULL, NULL}
+  {NULL, NULL, NULL, NULL}
 #endif
 };
 
@@ -199,6 +200,7 @@ static int get_info(FAR struct ip6t_getinfo *get, FAR socklen_t *len)
 
 static int get_entries(FAR struct ip6t_get_entries *get, FAR socklen_t *len)
 {
+  FAR struct ip6t_table_s *table;
   FAR struct ip6t_replace *repl;
 
   if (*len < sizeof(*get) || *len != sizeof(*get) + get->size)
@@ -206,17 +208,26 @@ static int get_entries(FAR struct ip6t_get_entries *get, FAR socklen_t *len)
       return -EINVAL;
     }
 
-  repl = ip6t_table_repl(get->name);
-  if (repl == NULL)
+  table = ip6t_table(get->name);
+  if (table == NULL || table->repl == NULL)
     {
       return -ENOENT;
     }
 
+  repl = table->repl;
+
   if (get->size != repl->size)
     {
       return -EAGAIN;
     }
 
+  /* Refresh the counters of the entries before copying them out. */
+
+  if (table->counters_func != NULL)
+    {
+      table->counters_func(repl);
+    }
+
   memcpy(get->entrytable, repl->entries, get->size);
 
   return OK;
@@ -599,3 +599,76 @@ int ip6t_filter_apply(FAR const struct ip6t_replace *repl)
   return OK;
 }
 #endif
+
+/****************************************************************************
+ * Name: ipt_filter_counters
+ *
+ * Description:
+ *   Fill the hit counters of the filter rules into the table entries.  The
+ *   rules were added in the same order as the entries of each chain by
+ *   ipt_filter_apply.
+ *
+ * Input Parameters:
+ *   repl - The filter table data to fill.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+void ipt_filter_counters(FAR struct ipt_replace *repl)
+{
+  FAR struct ipfilter_entry_s *filter;
+  FAR struct ipt_entry *entry;
+  FAR uint8_t *head;
+  enum nf_inet_hooks hook;
+  size_t size;
+
+  for (hook = NF_INET_LOCAL_IN; hook <= NF_INET_LOCAL_OUT; hook++)
+    {
+      filter = ipfilter_cfg_first(PF_INET, convert_chain(hook));
+      head = (FAR uint8_t *)repl->entries + repl->hook_entry[hook];
+      size = repl->underflow[hook] - repl->hook_entry[hook] + 1;
+
+      ipt_entry_for_every(entry, head, size)
+        {
+          if (filter == NULL)
+            {
+              break;
+            }
+
+          entry->counters.pcnt = filter->pcnt;
+          entry->counters.bcnt = filter->bcnt;
+          filter = filter->flink;
+        }
+    }
+}
+#endif
+
+#ifdef CONFIG_NET_IPv6
+void ip6t_filter_counters(FAR struct ip6t_replace *repl)
+{
+  FAR struct ipfilter_entry_s *filter;
+  FAR struct ip6t_entry *entry;
+  FAR uint8_t *head;
+  enum nf_inet_hooks hook;
+  size_t size;
+
+  for (hook = NF_INET_LOCAL_IN; hook <= NF_INET_LOCAL_OUT; hook++)
+    {
+      filter = ipfilter_cfg_first(PF_INET6, convert_chain(hook));
+      head = (FAR uint8_t *)repl->entries + repl->hook_entry[hook];
+      size = repl->underflow[hook] - repl->hook_entry[hook] + 1;
+
+      ip6t_entry_for_every(entry, head, size)
+        {
+          if (filter == NULL)
+            {
+              break;
+            }
+
+          entry->counters.pcnt = filter->pcnt;
+          entry->counters.bcnt = filter->bcnt;
+          filter = filter->flink;
+        }
+    }
+}
+#endif
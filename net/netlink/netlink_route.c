@@ -527,7 +527,8 @@ static int netlink_get_devlist(NETLINK_HANDLE handle,
 
 #if defined(CONFIG_NET_ARP) && !defined(CONFIG_NETLINK_DISABLE_GETNEIGH)
 static size_t netlink_fill_arptable(
-                              FAR struct getneigh_recvfrom_rsplist_s **entry)
+                              FAR struct getneigh_recvfrom_rsplist_s **entry,
+                              size_t tabnum)
 {
   unsigned int ncopied;
   size_t allocsize;
@@ -540,7 +541,7 @@ static size_t netlink_fill_arptable(
 
   net_lock();
   ncopied = arp_snapshot((FAR struct arpreq *)(*entry)->payload.data,
-                         CONFIG_NET_ARPTAB_SIZE);
+                         tabnum);
   net_unlock();
 
   /* Now we have the real number of valid entries in the ARP table and
@@ -580,7 +581,8 @@ static size_t netlink_fill_arptable(
 
 #if defined(CONFIG_NET_IPv6) && !defined(CONFIG_NETLINK_DISABLE_GETNEIGH)
 static size_t netlink_fill_nbtable(
-                              FAR struct getneigh_recvfrom_rsplist_s **entry)
+                              FAR struct getneigh_recvfrom_rsplist_s **entry,
+                              size_t tabnum)
 {
   unsigned int ncopied;
   size_t allocsize;
@@ -594,7 +596,7 @@ static size_t netlink_fill_nbtable(
   net_lock();
   ncopied = neighbor_snapshot(
                       (FAR struct neighbor_entry_s *)(*entry)->payload.data,
-                      CONFIG_NET_IPv6_NCONF_ENTRIES);
+                      tabnum);
   net_unlock();
 
   /* Now we have the real number of valid entries in the Neighbor table
@@ -644,16 +646,14 @@ netlink_get_neighbor(FAR const void *neigh, int domain, int type,
   size_t tabnum;
   size_t rspsize;
 
-  /* Preallocate memory to hold the maximum sized ARP table
-   * REVISIT:  This is probably excessively large and could cause false
-   * memory out conditions.  A better approach would be to actually count
-   * the number of valid entries in the ARP table.
+  /* Preallocate memory to hold the entries currently in the table, the
+   * snapshot is limited to this number.
    */
 
 #if defined(CONFIG_NET_ARP)
   if (domain == AF_INET)
     {
-      tabnum  = req ? CONFIG_NET_ARPTAB_SIZE : 1;
+      tabnum  = req ? arp_count() : 1;
       tabsize = tabnum * sizeof(struct arpreq);
     }
   else
@@ -661,7 +661,7 @@ netlink_get_neighbor(FAR const void *neigh, int domain, int type,
 #if defined(CONFIG_NET_IPv6)
   if (domain == AF_INET6)
     {
-      tabnum  = req ? CONFIG_NET_IPv6_NCONF_ENTRIES : 1;
+      tabnum  = req ? neighbor_count() : 1;
       tabsize = tabnum * sizeof(struct neighbor_entry_s);
     }
   else
@@ -710,13 +710,13 @@ netlink_get_neighbor(FAR const void *neigh, int domain, int type,
 #if defined(CONFIG_NET_ARP)
   else if (domain == AF_INET)
     {
-      tabnum = netlink_fill_arptable(&alloc);
+      tabnum = netlink_fill_arptable(&alloc, tabnum);
     }
 #endif
 #if defined(CONFIG_NET_IPv6)
   else if (domain == AF_INET6)
     {
-      tabnum = netlink_fill_nbtable(&alloc);
+      tabnum = netlink_fill_nbtable(&alloc, tabnum);
     }
 #endif
 
@@ -0,0 +1,102 @@
+/****************************************************************************
+ * net/route/lpmroute.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __NET_ROUTE_LPMROUTE_H
+#define __NET_ROUTE_LPMROUTE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include "route/route.h"
+
+#ifdef CONFIG_ROUTE_LPM
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_lpmroute_ipv4 and net_lpmroute_ipv6
+ *
+ * Description:
+ *   Find the route with the longest prefix covering the target address
+ *   using the longest prefix match trie.  The trie is rebuilt from the
+ *   routing tables on the first lookup after any change to the tables.
+ *
+ * Input Parameters:
+ *   target    - The address to look up.
+ *   prefixlen - Only match prefixes longer than prefixlen.
+ *   filter    - Optional filter; a route is only considered if the filter
+ *               returns non-zero for it.  May be NULL.
+ *   arg       - An arbitrary value that will be passed to the filter.
+ *   route     - The location to return a copy of the matching route.
+ *
+ * Returned Value:
+ *   OK if a route was found; -ENOENT if no route matches.  -ENOMEM is
+ *   returned if the trie could not be built, in which case the caller
+ *   should fall back to searching the routing tables directly.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+int net_lpmroute_ipv4(in_addr_t target, int8_t prefixlen,
+                      route_handler_ipv4_t filter, FAR void *arg,
+                      FAR struct net_route_ipv4_s *route);
+#endif
+
+#ifdef CONFIG_NET_IPv6
+int net_lpmroute_ipv6(const net_ipv6addr_t target, int16_t prefixlen,
+                      route_handler_ipv6_t filter, FAR void *arg,
+                      FAR struct net_route_ipv6_s *route);
+#endif
+
+/****************************************************************************
+ * Name: net_flushlpm_ipv4 and net_flushlpm_ipv6
+ *
+ * Description:
+ *   Invalidate the longest prefix match trie after the routing table has
+ *   been modified.  The trie will be rebuilt on the next lookup.
+ *
+ * Input Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+void net_flushlpm_ipv4(void);
+#endif
+
+#ifdef CONFIG_NET_IPv6
+void net_flushlpm_ipv6(void);
+#endif
+
+#endif /* CONFIG_ROUTE_LPM */
+#endif /* __NET_ROUTE_LPMROUTE_H */
@@ -35,8 +35,10 @@
 #include <nuttx/fs/fs.h>
 #include <nuttx/net/ip.h>
 
+#include "ipforward/ipforward.h"
 #include "netlink/netlink.h"
 #include "route/fileroute.h"
+#include "route/lpmroute.h"
 #include "route/route.h"
 
 #if defined(CONFIG_ROUTE_IPv4_FILEROUTE) || defined(CONFIG_ROUTE_IPv6_FILEROUTE)
@@ -87,6 +89,12 @@ int net_addroute_ipv4(in_addr_t target, in_addr_t netmask, in_addr_t router)
   nwritten = net_writeroute_ipv4(&fshandle, &route);
 
   net_closeroute_ipv4(&fshandle);
+#ifdef CONFIG_ROUTE_LPM
+  net_flushlpm_ipv4();
+#endif
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  ipfwd_flow_flush();
+#endif
 
   netlink_route_notify(&route, RTM_NEWROUTE, AF_INET);
   return nwritten >= 0 ? 0 : (int)nwritten;
@@ -123,6 +131,12 @@ int net_addroute_ipv6(net_ipv6addr_t target, net_ipv6addr_t netmask,
   nwritten = net_writeroute_ipv6(&fshandle, &route);
 
   net_closeroute_ipv6(&fshandle);
+#ifdef CONFIG_ROUTE_LPM
+  net_flushlpm_ipv6();
+#endif
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  ipfwd_flow_flush();
+#endif
 
   netlink_route_notify(&route, RTM_NEWROUTE, AF_INET6);
   return nwritten >= 0 ? 0 : (int)nwritten;
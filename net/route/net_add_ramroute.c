@@ -36,7 +36,9 @@
 
 #include <arch/irq.h>
 
+#include "ipforward/ipforward.h"
 #include "netlink/netlink.h"
+#include "route/lpmroute.h"
 #include "route/ramroute.h"
 #include "route/route.h"
 
@@ -88,6 +90,12 @@ int net_addroute_ipv4(in_addr_t target, in_addr_t netmask, in_addr_t router)
 
   ramroute_ipv4_addlast((FAR struct net_route_ipv4_entry_s *)route,
                         &g_ipv4_routes);
+#ifdef CONFIG_ROUTE_LPM
+  net_flushlpm_ipv4();
+#endif
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  ipfwd_flow_flush();
+#endif
   net_unlock();
 
   netlink_route_notify(route, RTM_NEWROUTE, AF_INET);
@@ -125,6 +133,12 @@ int net_addroute_ipv6(net_ipv6addr_t target, net_ipv6addr_t netmask,
 
   ramroute_ipv6_addlast((FAR struct net_route_ipv6_entry_s *)route,
                         &g_ipv6_routes);
+#ifdef CONFIG_ROUTE_LPM
+  net_flushlpm_ipv6();
+#endif
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  ipfwd_flow_flush();
+#endif
   net_unlock();
 
   netlink_route_notify(route, RTM_NEWROUTE, AF_INET6);
@@ -38,9 +38,11 @@
 #include <nuttx/fs/fs.h>
 #include <nuttx/net/ip.h>
 
+#include "ipforward/ipforward.h"
 #include "netlink/netlink.h"
 #include "route/fileroute.h"
 #include "route/cacheroute.h"
+#include "route/lpmroute.h"
 #include "route/route.h"
 
 #if defined(CONFIG_ROUTE_IPv4_FILEROUTE) || defined(CONFIG_ROUTE_IPv6_FILEROUTE)
@@ -317,6 +319,12 @@ int net_delroute_ipv4(in_addr_t target, in_addr_t netmask)
   ret = file_truncate(&fshandle, filesize);
 
   netlink_route_notify(&match, RTM_DELROUTE, AF_INET);
+#ifdef CONFIG_ROUTE_LPM
+  net_flushlpm_ipv4();
+#endif
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  ipfwd_flow_flush();
+#endif
 
 errout_with_fshandle:
   net_closeroute_ipv4(&fshandle);
@@ -470,6 +478,12 @@ int net_delroute_ipv6(net_ipv6addr_t target, net_ipv6addr_t netmask)
   ret = file_truncate(&fshandle, filesize);
 
   netlink_route_notify(&match, RTM_DELROUTE, AF_INET6);
+#ifdef CONFIG_ROUTE_LPM
+  net_flushlpm_ipv6();
+#endif
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+  ipfwd_flow_flush();
+#endif
 
 errout_with_fshandle:
   net_closeroute_ipv6(&fshandle);
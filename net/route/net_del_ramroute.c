@@ -34,7 +34,9 @@
 #include <arpa/inet.h>
 #include <nuttx/net/ip.h>
 
+#include "ipforward/ipforward.h"
 #include "netlink/netlink.h"
+#include "route/lpmroute.h"
 #include "route/ramroute.h"
 #include "route/route.h"
 
@@ -118,6 +120,12 @@ static int net_del_ipv4route(FAR struct net_route_ipv4_s *route,
       /* And free the routing table entry by adding it to the free list */
 
       net_freeroute_ipv4(route);
+#ifdef CONFIG_ROUTE_LPM
+      net_flushlpm_ipv4();
+#endif
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+      ipfwd_flow_flush();
+#endif
 
       /* Return a non-zero value to terminate the traversal */
 
@@ -176,6 +184,12 @@ static int net_del_ipv6route(FAR struct net_route_ipv6_s *route,
       /* And free the routing table entry by adding it to the free list */
 
       net_freeroute_ipv6(route);
+#ifdef CONFIG_ROUTE_LPM
+      net_flushlpm_ipv6();
+#endif
+#ifdef CONFIG_NET_IPFORWARD_FLOWCACHE
+      ipfwd_flow_flush();
+#endif
 
       /* Return a non-zero value to terminate the traversal */
 
@@ -0,0 +1,619 @@
+/****************************************************************************
+ * net/route/net_lpmroute.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+
+#include "route/lpmroute.h"
+#include "route/route.h"
+#include "utils/utils.h"
+
+#ifdef CONFIG_ROUTE_LPM
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Addresses are used as trie keys in network byte order */
+
+#ifdef CONFIG_NET_IPv6
+#  define LPM_KEYSIZE     16
+#else
+#  define LPM_KEYSIZE     4
+#endif
+
+/* Return bit 'n' of the key, counting from the most significant bit */
+
+#define LPM_BIT(key, n)   (((key)[(n) >> 3] >> (7 - ((n) & 7))) & 1)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One route held by the trie.  Routes with the same prefix are kept in
+ * routing table order so that the first one still wins, as it does in the
+ * linear search.
+ */
+
+struct lpm_leaf_s
+{
+  FAR struct lpm_leaf_s *flink;
+  union
+  {
+#ifdef CONFIG_NET_IPv4
+    struct net_route_ipv4_s ipv4;
+#endif
+#ifdef CONFIG_NET_IPv6
+    struct net_route_ipv6_s ipv6;
+#endif
+  } u;
+};
+
+/* A node of the path-compressed binary trie.  Nodes without leaves only
+ * exist where two branches fork.
+ */
+
+struct lpm_node_s
+{
+  FAR struct lpm_node_s *child[2];  /* Sub-tries by the bit after key */
+  FAR struct lpm_leaf_s *head;      /* Routes with exactly this prefix */
+  FAR struct lpm_leaf_s *tail;
+  uint8_t plen;                     /* Number of valid bits in key */
+  uint8_t key[LPM_KEYSIZE];         /* Masked prefix */
+};
+
+struct lpm_trie_s
+{
+  FAR struct lpm_node_s *root;
+  uint32_t gen;                     /* Bumped on each route change */
+  uint32_t built;                   /* Generation the trie was built for */
+  bool valid;                       /* False if the last build failed */
+};
+
+/* Accept a leaf found during the lookup */
+
+typedef CODE bool (*lpm_accept_t)(FAR struct lpm_leaf_s *leaf,
+                                  FAR void *arg);
+
+#ifdef CONFIG_NET_IPv4
+struct lpm_filter_ipv4_s
+{
+  route_handler_ipv4_t filter;
+  FAR void *arg;
+};
+#endif
+
+#ifdef CONFIG_NET_IPv6
+struct lpm_filter_ipv6_s
+{
+  route_handler_ipv6_t filter;
+  FAR void *arg;
+};
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+static struct lpm_trie_s g_lpm_ipv4 =
+{
+  NULL, 1, 0, false
+};
+#endif
+
+#ifdef CONFIG_NET_IPv6
+static struct lpm_trie_s g_lpm_ipv6 =
+{
+  NULL, 1, 0, false
+};
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lpm_common
+ *
+ * Description:
+ *   Return the number of leading bits, up to maxbits, that two keys have
+ *   in common.
+ *
+ ****************************************************************************/
+
+static int lpm_common(FAR const uint8_t *a, FAR const uint8_t *b,
+                      int maxbits)
+{
+  int bits = 0;
+  uint8_t diff;
+
+  while (bits < maxbits)
+    {
+      diff = a[bits >> 3] ^ b[bits >> 3];
+      if (diff != 0)
+        {
+          while ((diff & 0x80) == 0)
+            {
+              diff <<= 1;
+              bits++;
+            }
+
+          break;
+        }
+
+      bits += 8;
+    }
+
+  return bits < maxbits ? bits : maxbits;
+}
+
+/****************************************************************************
+ * Name: lpm_newnode
+ *
+ * Description:
+ *   Allocate a trie node for the first plen bits of key.
+ *
+ ****************************************************************************/
+
+static FAR struct lpm_node_s *lpm_newnode(FAR const uint8_t *key, int plen)
+{
+  FAR struct lpm_node_s *node;
+  int nbytes = (plen + 7) >> 3;
+
+  node = kmm_zalloc(sizeof(struct lpm_node_s));
+  if (node != NULL)
+    {
+      node->plen = plen;
+      memcpy(node->key, key, nbytes);
+      if ((plen & 7) != 0)
+        {
+          node->key[nbytes - 1] &= 0xff << (8 - (plen & 7));
+        }
+    }
+
+  return node;
+}
+
+/****************************************************************************
+ * Name: lpm_free
+ *
+ * Description:
+ *   Release a (sub-)trie and all of the routes that it holds.
+ *
+ ****************************************************************************/
+
+static void lpm_free(FAR struct lpm_node_s *node)
+{
+  FAR struct lpm_leaf_s *leaf;
+
+  if (node == NULL)
+    {
+      return;
+    }
+
+  lpm_free(node->child[0]);
+  lpm_free(node->child[1]);
+
+  while ((leaf = node->head) != NULL)
+    {
+      node->head = leaf->flink;
+      kmm_free(leaf);
+    }
+
+  kmm_free(node);
+}
+
+/****************************************************************************
+ * Name: lpm_insert
+ *
+ * Description:
+ *   Add a route for the first plen bits of key to the trie.  The leaf is
+ *   consumed on success.
+ *
+ ****************************************************************************/
+
+static int lpm_insert(FAR struct lpm_trie_s *trie, FAR const uint8_t *key,
+                      int plen, FAR struct lpm_leaf_s *leaf)
+{
+  FAR struct lpm_node_s **link = &trie->root;
+  FAR struct lpm_node_s *node;
+  FAR struct lpm_node_s *fork;
+  int common;
+
+  for (; ; )
+    {
+      node = *link;
+      if (node == NULL)
+        {
+          node = lpm_newnode(key, plen);
+          if (node == NULL)
+            {
+              return -ENOMEM;
+            }
+
+          *link = node;
+          break;
+        }
+
+      common = lpm_common(node->key, key, MIN(node->plen, plen));
+      if (common == node->plen)
+        {
+          if (common == plen)
+            {
+              /* Same prefix, append to the routes of this node */
+
+              break;
+            }
+
+          /* The node prefix covers the route, descend */
+
+          link = &node->child[LPM_BIT(key, common)];
+          continue;
+        }
+
+      /* The route diverges from the node prefix after 'common' bits.  If
+       * the route prefix ends there it becomes the parent of the node,
+       * otherwise both hang off a new fork node.
+       */
+
+      fork = lpm_newnode(key, common);
+      if (fork == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      fork->child[LPM_BIT(node->key, common)] = node;
+      *link = fork;
+
+      if (common == plen)
+        {
+          node = fork;
+          break;
+        }
+
+      node = lpm_newnode(key, plen);
+      if (node == NULL)
+        {
+          return -ENOMEM;
+        }
+
+      fork->child[LPM_BIT(key, common)] = node;
+      break;
+    }
+
+  leaf->flink = NULL;
+  if (node->tail != NULL)
+    {
+      node->tail->flink = leaf;
+    }
+  else
+    {
+      node->head = leaf;
+    }
+
+  node->tail = leaf;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: lpm_lookup
+ *
+ * Description:
+ *   Walk the trie along the key and return the accepted route with the
+ *   longest prefix that is longer than prefixlen.
+ *
+ ****************************************************************************/
+
+static FAR struct lpm_leaf_s *lpm_lookup(FAR struct lpm_trie_s *trie,
+                                         FAR const uint8_t *key, int keybits,
+                                         int prefixlen, lpm_accept_t accept,
+                                         FAR void *arg)
+{
+  FAR struct lpm_node_s *node = trie->root;
+  FAR struct lpm_leaf_s *found = NULL;
+  FAR struct lpm_leaf_s *leaf;
+
+  while (node != NULL &&
+         lpm_common(node->key, key, node->plen) == node->plen)
+    {
+      if (node->plen > prefixlen)
+        {
+          for (leaf = node->head; leaf != NULL; leaf = leaf->flink)
+            {
+              if (accept(leaf, arg))
+                {
+                  found = leaf;
+                  break;
+                }
+            }
+        }
+
+      if (node->plen >= keybits)
+        {
+          break;
+        }
+
+      node = node->child[LPM_BIT(key, node->plen)];
+    }
+
+  return found;
+}
+
+/****************************************************************************
+ * Name: lpm_rebuild
+ *
+ * Description:
+ *   Rebuild the trie from the routing table if it has changed since the
+ *   last build.  A failed build leaves the trie marked invalid until the
+ *   next change so that lookups don't retry it on every packet.
+ *
+ ****************************************************************************/
+
+static bool lpm_rebuild(FAR struct lpm_trie_s *trie,
+                        CODE int (*build)(FAR struct lpm_trie_s *trie))
+{
+  uint32_t gen = trie->gen;
+
+  if (trie->built != gen)
+    {
+      lpm_free(trie->root);
+      trie->root  = NULL;
+      trie->valid = build(trie) >= 0;
+      trie->built = gen;
+
+      if (!trie->valid)
+        {
+          nerr("ERROR: Failed to build the LPM trie\n");
+          lpm_free(trie->root);
+          trie->root = NULL;
+        }
+    }
+
+  return trie->valid;
+}
+
+/****************************************************************************
+ * Name: lpm_add_ipv4, lpm_build_ipv4 and lpm_accept_ipv4
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+static int lpm_add_ipv4(FAR struct net_route_ipv4_s *route, FAR void *arg)
+{
+  FAR struct lpm_leaf_s *leaf;
+  in_addr_t prefix;
+  int ret;
+
+  leaf = kmm_malloc(sizeof(struct lpm_leaf_s));
+  if (leaf == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  memcpy(&leaf->u.ipv4, route, sizeof(struct net_route_ipv4_s));
+  prefix = route->target & route->netmask;
+
+  ret = lpm_insert(arg, (FAR const uint8_t *)&prefix,
+                   net_ipv4_mask2pref(route->netmask), leaf);
+  if (ret < 0)
+    {
+      kmm_free(leaf);
+    }
+
+  return ret;
+}
+
+static int lpm_build_ipv4(FAR struct lpm_trie_s *trie)
+{
+  return net_foreachroute_ipv4(lpm_add_ipv4, trie);
+}
+
+static bool lpm_accept_ipv4(FAR struct lpm_leaf_s *leaf, FAR void *arg)
+{
+  FAR struct lpm_filter_ipv4_s *filter = arg;
+
+  return filter->filter == NULL ||
+         filter->filter(&leaf->u.ipv4, filter->arg) != 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: lpm_add_ipv6, lpm_build_ipv6 and lpm_accept_ipv6
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6
+static int lpm_add_ipv6(FAR struct net_route_ipv6_s *route, FAR void *arg)
+{
+  FAR struct lpm_leaf_s *leaf;
+  net_ipv6addr_t prefix;
+  int ret;
+  int i;
+
+  leaf = kmm_malloc(sizeof(struct lpm_leaf_s));
+  if (leaf == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  memcpy(&leaf->u.ipv6, route, sizeof(struct net_route_ipv6_s));
+  for (i = 0; i < 8; i++)
+    {
+      prefix[i] = route->target[i] & route->netmask[i];
+    }
+
+  ret = lpm_insert(arg, (FAR const uint8_t *)prefix,
+                   net_ipv6_mask2pref(route->netmask), leaf);
+  if (ret < 0)
+    {
+      kmm_free(leaf);
+    }
+
+  return ret;
+}
+
+static int lpm_build_ipv6(FAR struct lpm_trie_s *trie)
+{
+  return net_foreachroute_ipv6(lpm_add_ipv6, trie);
+}
+
+static bool lpm_accept_ipv6(FAR struct lpm_leaf_s *leaf, FAR void *arg)
+{
+  FAR struct lpm_filter_ipv6_s *filter = arg;
+
+  return filter->filter == NULL ||
+         filter->filter(&leaf->u.ipv6, filter->arg) != 0;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: net_lpmroute_ipv4
+ *
+ * Description:
+ *   Find the IPv4 route with the longest prefix covering the target.
+ *
+ * Input Parameters:
+ *   target    - The IPv4 address to look up.
+ *   prefixlen - Only match prefixes longer than prefixlen.
+ *   filter    - Optional route filter, may be NULL.
+ *   arg       - An arbitrary value that will be passed to the filter.
+ *   route     - The location to return a copy of the matching route.
+ *
+ * Returned Value:
+ *   OK on success; -ENOENT if there is no route; -ENOMEM if the trie is
+ *   not available.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+int net_lpmroute_ipv4(in_addr_t target, int8_t prefixlen,
+                      route_handler_ipv4_t filter, FAR void *arg,
+                      FAR struct net_route_ipv4_s *route)
+{
+  struct lpm_filter_ipv4_s match;
+  FAR struct lpm_leaf_s *leaf;
+
+  if (!lpm_rebuild(&g_lpm_ipv4, lpm_build_ipv4))
+    {
+      return -ENOMEM;
+    }
+
+  match.filter = filter;
+  match.arg    = arg;
+
+  leaf = lpm_lookup(&g_lpm_ipv4, (FAR const uint8_t *)&target, 32,
+                    prefixlen, lpm_accept_ipv4, &match);
+  if (leaf == NULL)
+    {
+      return -ENOENT;
+    }
+
+  memcpy(route, &leaf->u.ipv4, sizeof(struct net_route_ipv4_s));
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: net_lpmroute_ipv6
+ *
+ * Description:
+ *   Find the IPv6 route with the longest prefix covering the target.
+ *
+ * Input Parameters:
+ *   target    - The IPv6 address to look up.
+ *   prefixlen - Only match prefixes longer than prefixlen.
+ *   filter    - Optional route filter, may be NULL.
+ *   arg       - An arbitrary value that will be passed to the filter.
+ *   route     - The location to return a copy of the matching route.
+ *
+ * Returned Value:
+ *   OK on success; -ENOENT if there is no route; -ENOMEM if the trie is
+ *   not available.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv6
+int net_lpmroute_ipv6(const net_ipv6addr_t target, int16_t prefixlen,
+                      route_handler_ipv6_t filter, FAR void *arg,
+                      FAR struct net_route_ipv6_s *route)
+{
+  struct lpm_filter_ipv6_s match;
+  FAR struct lpm_leaf_s *leaf;
+
+  if (!lpm_rebuild(&g_lpm_ipv6, lpm_build_ipv6))
+    {
+      return -ENOMEM;
+    }
+
+  match.filter = filter;
+  match.arg    = arg;
+
+  leaf = lpm_lookup(&g_lpm_ipv6, (FAR const uint8_t *)target, 128,
+                    prefixlen, lpm_accept_ipv6, &match);
+  if (leaf == NULL)
+    {
+      return -ENOENT;
+    }
+
+  memcpy(route, &leaf->u.ipv6, sizeof(struct net_route_ipv6_s));
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: net_flushlpm_ipv4 and net_flushlpm_ipv6
+ *
+ * Description:
+ *   Invalidate the longest prefix match trie after the routing table has
+ *   been modified.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_IPv4
+void net_flushlpm_ipv4(void)
+{
+  g_lpm_ipv4.gen++;
+}
+#endif
+
+#ifdef CONFIG_NET_IPv6
+void net_flushlpm_ipv6(void)
+{
+  g_lpm_ipv6.gen++;
+}
+#endif
+
+#endif /* CONFIG_ROUTE_LPM */
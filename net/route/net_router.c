@@ -36,6 +36,7 @@
 
 #include "devif/devif.h"
 #include "route/cacheroute.h"
+#include "route/lpmroute.h"
 #include "route/route.h"
 #include "utils/utils.h"
 
@@ -248,6 +249,9 @@ int net_ipv4_router(in_addr_t target, FAR in_addr_t *router,
                     int8_t prefixlen)
 {
   struct route_ipv4_match_s match;
+#ifdef CONFIG_ROUTE_LPM
+  struct net_route_ipv4_s entry;
+#endif
   int ret;
 
   /* Just early return for long prefix, maybe already got exact match. */
@@ -264,6 +268,23 @@ int net_ipv4_router(in_addr_t target, FAR in_addr_t *router,
       return -ENOENT;
     }
 
+#ifdef CONFIG_ROUTE_LPM
+  /* Try the longest prefix match trie first, it only fails with -ENOMEM
+   * if it could not be built.
+   */
+
+  ret = net_lpmroute_ipv4(target, prefixlen, NULL, NULL, &entry);
+  if (ret != -ENOMEM)
+    {
+      if (ret >= 0)
+        {
+          net_ipv4addr_copy(*router, entry.router);
+        }
+
+      return ret;
+    }
+#endif
+
   /* Set up the comparison structure */
 
   memset(&match, 0, sizeof(struct route_ipv4_match_s));
@@ -342,6 +363,9 @@ int net_ipv6_router(const net_ipv6addr_t target, net_ipv6addr_t router,
                     int16_t prefixlen)
 {
   struct route_ipv6_match_s match;
+#ifdef CONFIG_ROUTE_LPM
+  struct net_route_ipv6_s entry;
+#endif
   int ret;
 
   /* Just early return for long prefix, maybe already got exact match. */
@@ -358,6 +382,23 @@ int net_ipv6_router(const net_ipv6addr_t target, net_ipv6addr_t router,
       return -ENOENT;
     }
 
+#ifdef CONFIG_ROUTE_LPM
+  /* Try the longest prefix match trie first, it only fails with -ENOMEM
+   * if it could not be built.
+   */
+
+  ret = net_lpmroute_ipv6(target, prefixlen, NULL, NULL, &entry);
+  if (ret != -ENOMEM)
+    {
+      if (ret >= 0)
+        {
+          net_ipv6addr_copy(router, entry.router);
+        }
+
+      return ret;
+    }
+#endif
+
   /* Set up the comparison structure */
 
   memset(&match, 0, sizeof(struct route_ipv6_match_s));
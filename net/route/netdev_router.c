@@ -35,6 +35,7 @@
 
 #include "netdev/netdev.h"
 #include "route/cacheroute.h"
+#include "route/lpmroute.h"
 #include "route/route.h"
 #include "utils/utils.h"
 
@@ -169,6 +170,25 @@ static int net_ipv4_devmatch(FAR struct net_route_ipv4_s *route,
 }
 #endif /* CONFIG_NET_IPv4 */
 
+/****************************************************************************
+ * Name: net_ipv4_lpmfilter
+ *
+ * Description:
+ *   Return 1 if the router of the IPv4 route is on the device's network.
+ *   Used to filter the longest prefix match trie lookup.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_IPv4) && defined(CONFIG_ROUTE_LPM)
+static int net_ipv4_lpmfilter(FAR struct net_route_ipv4_s *route,
+                              FAR void *arg)
+{
+  FAR struct net_driver_s *dev = arg;
+
+  return net_ipv4addr_maskcmp(route->router, dev->d_ipaddr, dev->d_netmask);
+}
+#endif
+
 /****************************************************************************
  * Name: net_ipv6_devmatch
  *
@@ -232,6 +252,25 @@ static int net_ipv6_devmatch(FAR struct net_route_ipv6_s *route,
 }
 #endif /* CONFIG_NET_IPv6 */
 
+/****************************************************************************
+ * Name: net_ipv6_lpmfilter
+ *
+ * Description:
+ *   Return 1 if the router of the IPv6 route is on the device's network.
+ *   Used to filter the longest prefix match trie lookup.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_IPv6) && defined(CONFIG_ROUTE_LPM)
+static int net_ipv6_lpmfilter(FAR struct net_route_ipv6_s *route,
+                              FAR void *arg)
+{
+  FAR struct net_driver_s *dev = arg;
+
+  return NETDEV_V6ADDR_ONLINK(dev, route->router);
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -262,8 +301,22 @@ void netdev_ipv4_router(FAR struct net_driver_s *dev, in_addr_t target,
                         FAR in_addr_t *router)
 {
   struct route_ipv4_devmatch_s match;
+#ifdef CONFIG_ROUTE_LPM
+  struct net_route_ipv4_s entry;
+#endif
   int ret;
 
+#ifdef CONFIG_ROUTE_LPM
+  /* Try the longest prefix match trie first */
+
+  ret = net_lpmroute_ipv4(target, -1, net_ipv4_lpmfilter, dev, &entry);
+  if (ret != -ENOMEM)
+    {
+      net_ipv4addr_copy(*router, ret >= 0 ? entry.router : dev->d_draddr);
+      return;
+    }
+#endif
+
   /* Set up the comparison structure */
 
   memset(&match, 0, sizeof(struct route_ipv4_devmatch_s));
@@ -349,8 +402,23 @@ void netdev_ipv6_router(FAR struct net_driver_s *dev,
                         FAR net_ipv6addr_t router)
 {
   struct route_ipv6_devmatch_s match;
+#ifdef CONFIG_ROUTE_LPM
+  struct net_route_ipv6_s entry;
+#endif
   int ret;
 
+#ifdef CONFIG_ROUTE_LPM
+  /* Try the longest prefix match trie first */
+
+  ret = net_lpmroute_ipv6(target, -1, net_ipv6_lpmfilter, dev, &entry);
+  if (ret != -ENOMEM)
+    {
+      net_ipv6addr_copy(router, ret >= 0 ? entry.router :
+                                           dev->d_ipv6draddr);
+      return;
+    }
+#endif
+
   /* Set up the comparison structure */
 
   memset(&match, 0, sizeof(struct route_ipv6_devmatch_s));
@@ -105,6 +105,8 @@
 #define TCP_WSCALE            0x01U /* Window Scale option enabled */
 #define TCP_SACK              0x02U /* Selective ACKs enabled */
 #define TCP_CLOSE_ARRANGED    0x04U /* Connection is arranged to be freed */
+#define TCP_RCVBUF_LOCK       0x20U /* SO_RCVBUF set, no autotuning */
+#define TCP_SNDBUF_LOCK       0x40U /* SO_SNDBUF set, no autotuning */
 
 #ifdef CONFIG_NET_TCP_CC_NEWRENO
 /* The TCP flags for congestion control */
@@ -267,6 +269,14 @@ struct tcp_conn_s
 #if CONFIG_NET_RECV_BUFSIZE > 0
   int32_t  rcv_bufs;      /* Maximum amount of bytes queued in recv */
 #endif
+#ifdef CONFIG_NET_TCP_RCVBUF_AUTOTUNE
+  clock_t  rcv_rtt;       /* Receiver side RTT estimate (ticks) */
+  clock_t  rcv_rtt_time;  /* Start time of the RTT measurement */
+  uint32_t rcv_rtt_seq;   /* Sequence number ending the RTT measurement */
+  clock_t  rcvq_time;     /* Start time of the drain measurement */
+  uint32_t rcvq_copied;   /* Bytes read by the user in this interval */
+  uint32_t rcvq_space;    /* Most bytes read by the user within one RTT */
+#endif
 #if CONFIG_NET_SEND_BUFSIZE > 0
   int32_t  snd_bufs;      /* Maximum amount of bytes queued in send */
   sem_t    snd_sem;       /* Semaphore signals send completion */
@@ -298,6 +308,25 @@ struct tcp_conn_s
 
   FAR struct iob_s *readahead;   /* Read-ahead buffering */
 
+#ifdef CONFIG_NET_TCP_ZEROCOPY
+  /* Zero-copy receive
+   *
+   *   zc_lent    - Read-ahead I/O buffer chains lent to the application by
+   *                TCP_ZEROCOPY_RECEIVE, one queue entry per call.
+   *   zc_lentlen - Total bytes in zc_lent, still counted against the
+   *                receive buffer.
+   */
+
+  struct iob_queue_s zc_lent;
+  uint32_t zc_lentlen;
+#endif
+
+#ifdef CONFIG_NET_TCP_KTLS
+  /* Kernel TLS record layer state, allocated by TCP_ULP "tls" */
+
+  FAR struct tcp_tls_s *tls;
+#endif
+
 #ifdef CONFIG_NET_TCP_OUT_OF_ORDER
 
   /* Number of out-of-order segments */
@@ -418,6 +447,22 @@ struct tcp_wrbuffer_s
 };
 #endif
 
+/* This structure tracks one MSG_ZEROCOPY send whose user buffer is
+ * referenced by write buffers until the peer has ACKed the data.
+ */
+
+#ifdef CONFIG_NET_TCP_ZEROCOPY_SEND
+struct tcp_zcsend_s
+{
+  FAR const uint8_t *zc_base;    /* Start of the user buffer */
+  size_t             zc_len;     /* Length of the user buffer */
+  unsigned int       zc_pending; /* Number of IOBs referring to the buffer */
+  bool               zc_orphan;  /* The sender was canceled, the last IOB
+                                  * frees the structure */
+  sem_t              zc_sem;     /* Posted when zc_pending drops to zero */
+};
+#endif
+
 /* Support for listen backlog:
  *
  *   struct tcp_blcontainer_s describes one backlogged connection
@@ -1276,6 +1321,27 @@ void tcp_appsend(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
 void tcp_rexmit(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
                 uint16_t result);
 
+/****************************************************************************
+ * Name: tcp_txready
+ *
+ * Description:
+ *   Put the connection on the TX ready list of its device so that the next
+ *   TX poll of the device visits it.
+ *
+ * Input Parameters:
+ *   conn  - The TCP connection structure
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_TXREADY
+void tcp_txready(FAR struct tcp_conn_s *conn);
+#else
+#  define tcp_txready(conn)
+#endif
+
 /****************************************************************************
  * Name: tcp_send_txnotify
  *
@@ -1742,6 +1808,272 @@ uint32_t tcp_get_recvwindow(FAR struct net_driver_s *dev,
 
 bool tcp_should_send_recvwindow(FAR struct tcp_conn_s *conn);
 
+/****************************************************************************
+ * Name: tcp_rcvrtt_measure
+ *
+ * Description:
+ *   Estimate the round trip time from the receiver side: the time it takes
+ *   the peer to fill one advertised window.  Called when in-order data is
+ *   received on an established connection.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure holding connection information.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_RCVBUF_AUTOTUNE
+void tcp_rcvrtt_measure(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: tcp_rcvspace_adjust
+ *
+ * Description:
+ *   Account for data read by the application and, once per measured round
+ *   trip, grow the receive buffer to twice the amount drained so that the
+ *   advertised window keeps up with the application.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure holding connection information.
+ *   copied - The number of bytes just read by the application.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_RCVBUF_AUTOTUNE
+void tcp_rcvspace_adjust(FAR struct tcp_conn_s *conn, size_t copied);
+#endif
+
+/****************************************************************************
+ * Name: tcp_sndbuf_expand
+ *
+ * Description:
+ *   Try to grow the send buffer of a connection whose write queue is full.
+ *   The buffer may grow to twice the amount the peer currently allows in
+ *   flight, bounded by the free IOBs in the system.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure holding connection information.
+ *
+ * Returned Value:
+ *   True if the send buffer size was increased.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_SNDBUF_AUTOTUNE
+bool tcp_sndbuf_expand(FAR struct tcp_conn_s *conn);
+#endif
+
+/****************************************************************************
+ * Name: tcp_zerocopy_receive
+ *
+ * Description:
+ *   Implement TCP_ZEROCOPY_RECEIVE: detach I/O buffers from the head of
+ *   the read-ahead chain and describe their payload in the caller's iovec
+ *   array.  The buffers stay attached to the connection until they are
+ *   returned with tcp_zerocopy_release() or the connection is freed.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure holding connection information.
+ *   zc   - The request, updated with the lent fragments.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, zero bytes lent meaning end of file.
+ *   -EAGAIN if no data is available, -ENOMEM if no IOB queue entry could
+ *   be allocated, -EINVAL for a malformed request.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_ZEROCOPY
+struct tcp_zerocopy_receive;
+
+int tcp_zerocopy_receive(FAR struct tcp_conn_s *conn,
+                         FAR struct tcp_zerocopy_receive *zc);
+#endif
+
+/****************************************************************************
+ * Name: tcp_zerocopy_release
+ *
+ * Description:
+ *   Implement TCP_ZEROCOPY_RELEASE: free the I/O buffers lent by an earlier
+ *   TCP_ZEROCOPY_RECEIVE and reopen the receive window.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure holding connection information.
+ *   cookie - The cookie returned by TCP_ZEROCOPY_RECEIVE.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, -EINVAL if the cookie is unknown.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_ZEROCOPY
+int tcp_zerocopy_release(FAR struct tcp_conn_s *conn, FAR void *cookie);
+#endif
+
+/****************************************************************************
+ * Name: tcp_zcsend_setup
+ *
+ * Description:
+ *   Start tracking a MSG_ZEROCOPY send of the user buffer 'buf'.
+ *
+ * Returned Value:
+ *   The tracking structure, NULL if there is no memory for it.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_ZEROCOPY_SEND
+FAR struct tcp_zcsend_s *tcp_zcsend_setup(FAR const void *buf, size_t len);
+
+/****************************************************************************
+ * Name: tcp_zcsend_attach
+ *
+ * Description:
+ *   Append 'len' bytes of the user buffer at 'src' to the write buffer
+ *   without copying them.
+ *
+ * Returned Value:
+ *   The number of bytes attached, or -ENOMEM if no IOB could be allocated.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+ssize_t tcp_zcsend_attach(FAR struct tcp_zcsend_s *zc,
+                          FAR struct tcp_wrbuffer_s *wrb,
+                          FAR const uint8_t *src, size_t len);
+
+/****************************************************************************
+ * Name: tcp_zcsend_wait
+ *
+ * Description:
+ *   Wait until no write buffer refers to the user buffer any longer, i.e.
+ *   until all of its data has been ACKed or dropped with the connection,
+ *   then free the tracking structure.  Does nothing if 'zc' is NULL.
+ *
+ * Assumptions:
+ *   The network is not locked.
+ *
+ ****************************************************************************/
+
+void tcp_zcsend_wait(FAR struct tcp_zcsend_s *zc);
+
+/****************************************************************************
+ * Name: tcp_zcsend_cleanup
+ *
+ * Description:
+ *   Cancellation cleanup of a MSG_ZEROCOPY send: leave the tracking
+ *   structure to the last IOB that still refers to the user buffer, or
+ *   free it if there is none.
+ *
+ ****************************************************************************/
+
+void tcp_zcsend_cleanup(FAR void *arg);
+#endif
+
+/****************************************************************************
+ * Name: tcp_tls_ulp
+ *
+ * Description:
+ *   Implement setsockopt(TCP_ULP, "tls"): attach the kernel TLS record
+ *   layer to a connected TCP socket.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, -ENOENT for an unknown protocol name, -EEXIST if
+ *   the layer is already attached, -ENOTCONN or -ENOMEM.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_KTLS
+int tcp_tls_ulp(FAR struct socket *psock, FAR const void *value,
+                socklen_t value_len);
+
+/****************************************************************************
+ * Name: tcp_tls_setsockopt
+ *
+ * Description:
+ *   Handle the SOL_TLS level options TLS_TX and TLS_RX, which install the
+ *   key material negotiated by the application's TLS handshake.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, -ENOPROTOOPT if TCP_ULP "tls" was not set,
+ *   -EINVAL for unsupported parameters, -EBUSY if the direction is already
+ *   configured, -ENOMEM.
+ *
+ ****************************************************************************/
+
+int tcp_tls_setsockopt(FAR struct socket *psock, int option,
+                       FAR const void *value, socklen_t value_len);
+
+/****************************************************************************
+ * Name: tcp_tls_txenabled/tcp_tls_rxenabled/tcp_tls_rxpending
+ *
+ * Description:
+ *   Query the TLS state: TLS_TX/TLS_RX configured, or decrypted data (or
+ *   an error) ready to be received without new TCP data.
+ *
+ ****************************************************************************/
+
+bool tcp_tls_txenabled(FAR struct socket *psock);
+bool tcp_tls_rxenabled(FAR struct socket *psock);
+bool tcp_tls_rxpending(FAR struct tcp_conn_s *conn);
+
+/****************************************************************************
+ * Name: tcp_tls_send
+ *
+ * Description:
+ *   Send 'buf' as encrypted application data records.
+ *
+ * Returned Value:
+ *   The number of plaintext bytes accepted, or a negated errno value.
+ *
+ ****************************************************************************/
+
+ssize_t tcp_tls_send(FAR struct socket *psock, FAR const void *buf,
+                     size_t len, int flags);
+
+/****************************************************************************
+ * Name: tcp_tls_recvmsg
+ *
+ * Description:
+ *   Receive and decrypt records.  Non application data records are
+ *   reported with a SOL_TLS/TLS_GET_RECORD_TYPE control message.
+ *
+ * Returned Value:
+ *   The number of plaintext bytes received, zero on end of file, or a
+ *   negated errno value.
+ *
+ ****************************************************************************/
+
+ssize_t tcp_tls_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                        int flags);
+
+/****************************************************************************
+ * Name: tcp_tls_free
+ *
+ * Description:
+ *   Release the TLS state of a connection, called from tcp_free().
+ *
+ ****************************************************************************/
+
+void tcp_tls_free(FAR struct tcp_conn_s *conn);
+#endif
+
 /****************************************************************************
  * Name: psock_tcp_cansend
  *
@@ -0,0 +1,285 @@
+/****************************************************************************
+ * net/tcp/tcp_autotune.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/netconfig.h>
+#include <nuttx/net/tcp.h>
+
+#include "tcp/tcp.h"
+
+#if defined(CONFIG_NET_TCP_RCVBUF_AUTOTUNE) || \
+    defined(CONFIG_NET_TCP_SNDBUF_AUTOTUNE)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_autotune_limit
+ *
+ * Description:
+ *   Limit a new buffer size so that one step of growth never claims more
+ *   than half of the IOBs that are currently free.
+ *
+ * Input Parameters:
+ *   cursize - The current buffer size.
+ *   newsize - The desired buffer size.
+ *
+ * Returned Value:
+ *   The buffer size to use.
+ *
+ ****************************************************************************/
+
+static uint32_t tcp_autotune_limit(uint32_t cursize, uint32_t newsize)
+{
+  uint32_t limit;
+  int navail;
+
+  navail = iob_navail(true);
+  if (navail <= 0)
+    {
+      return cursize;
+    }
+
+  limit = cursize + (uint32_t)navail * CONFIG_IOB_BUFSIZE / 2;
+  return newsize > limit ? limit : newsize;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_RCVBUF_AUTOTUNE
+
+/****************************************************************************
+ * Name: tcp_rcvrtt_measure
+ *
+ * Description:
+ *   Estimate the round trip time from the receiver side: the time it takes
+ *   the peer to fill one advertised window.  Called when in-order data is
+ *   received on an established connection.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure holding connection information.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_rcvrtt_measure(FAR struct tcp_conn_s *conn)
+{
+  uint32_t rcvseq = tcp_getsequence(conn->rcvseq);
+  clock_t now = clock_systime_ticks();
+  clock_t sample;
+
+  if (conn->rcv_rtt_time != 0)
+    {
+      /* Wait until the window advertised at the start has been used */
+
+      if (TCP_SEQ_LT(rcvseq, conn->rcv_rtt_seq))
+        {
+          return;
+        }
+
+      /* The sample is an upper bound of the RTT when the sender is not
+       * window limited, so follow decreases at once and smooth increases.
+       */
+
+      sample = now - conn->rcv_rtt_time;
+      if (sample == 0)
+        {
+          sample = 1;
+        }
+
+      if (conn->rcv_rtt == 0 || sample < conn->rcv_rtt)
+        {
+          conn->rcv_rtt = sample;
+        }
+      else
+        {
+          conn->rcv_rtt += (sample - conn->rcv_rtt) >> 3;
+        }
+    }
+
+  /* Start a new measurement over the currently advertised window */
+
+  conn->rcv_rtt_seq  = TCP_SEQ_GT(conn->rcv_adv, rcvseq) ?
+                       conn->rcv_adv : rcvseq + conn->mss;
+  conn->rcv_rtt_time = now;
+}
+
+/****************************************************************************
+ * Name: tcp_rcvspace_adjust
+ *
+ * Description:
+ *   Account for data read by the application and, once per measured round
+ *   trip, grow the receive buffer to twice the amount drained so that the
+ *   advertised window keeps up with the application.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure holding connection information.
+ *   copied - The number of bytes just read by the application.
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_rcvspace_adjust(FAR struct tcp_conn_s *conn, size_t copied)
+{
+  clock_t now = clock_systime_ticks();
+  uint32_t rcvbuf;
+
+  if ((conn->flags & TCP_RCVBUF_LOCK) != 0)
+    {
+      return;
+    }
+
+  conn->rcvq_copied += copied;
+
+  if (conn->rcv_rtt == 0 || now - conn->rcvq_time < conn->rcv_rtt)
+    {
+      return;
+    }
+
+  /* Only grow when the application drained more than ever before in one
+   * round trip: one window is in flight while the other is being read.
+   */
+
+  if (conn->rcvq_copied > conn->rcvq_space)
+    {
+      conn->rcvq_space = conn->rcvq_copied;
+
+      rcvbuf = conn->rcvq_copied << 1;
+      if (rcvbuf > CONFIG_NET_TCP_RCVBUF_AUTOTUNE_MAX)
+        {
+          rcvbuf = CONFIG_NET_TCP_RCVBUF_AUTOTUNE_MAX;
+        }
+
+#if CONFIG_NET_MAX_RECV_BUFSIZE > 0
+      if (rcvbuf > CONFIG_NET_MAX_RECV_BUFSIZE)
+        {
+          rcvbuf = CONFIG_NET_MAX_RECV_BUFSIZE;
+        }
+#endif
+
+      rcvbuf = tcp_autotune_limit(conn->rcv_bufs, rcvbuf);
+      if (rcvbuf > (uint32_t)conn->rcv_bufs)
+        {
+          ninfo("rcv_bufs %" PRId32 " -> %" PRIu32 " (rtt %lu)\n",
+                conn->rcv_bufs, rcvbuf, (unsigned long)conn->rcv_rtt);
+          conn->rcv_bufs = rcvbuf;
+        }
+    }
+
+  conn->rcvq_copied = 0;
+  conn->rcvq_time   = now;
+}
+
+#endif /* CONFIG_NET_TCP_RCVBUF_AUTOTUNE */
+
+#ifdef CONFIG_NET_TCP_SNDBUF_AUTOTUNE
+
+/****************************************************************************
+ * Name: tcp_sndbuf_expand
+ *
+ * Description:
+ *   Try to grow the send buffer of a connection whose write queue is full.
+ *   The buffer may grow to twice the amount the peer currently allows in
+ *   flight, bounded by the free IOBs in the system.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure holding connection information.
+ *
+ * Returned Value:
+ *   True if the send buffer size was increased.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+bool tcp_sndbuf_expand(FAR struct tcp_conn_s *conn)
+{
+  uint32_t inflight;
+  uint32_t sndbuf;
+
+  if ((conn->flags & TCP_SNDBUF_LOCK) != 0)
+    {
+      return false;
+    }
+
+  inflight = conn->snd_wnd;
+#ifdef CONFIG_NET_TCP_CC_NEWRENO
+  if (inflight > conn->cwnd)
+    {
+      inflight = conn->cwnd;
+    }
+#endif
+
+  /* Keep one window in flight and one queued behind it */
+
+  sndbuf = inflight << 1;
+  if (sndbuf > CONFIG_NET_TCP_SNDBUF_AUTOTUNE_MAX)
+    {
+      sndbuf = CONFIG_NET_TCP_SNDBUF_AUTOTUNE_MAX;
+    }
+
+#if CONFIG_NET_MAX_SEND_BUFSIZE > 0
+  if (sndbuf > CONFIG_NET_MAX_SEND_BUFSIZE)
+    {
+      sndbuf = CONFIG_NET_MAX_SEND_BUFSIZE;
+    }
+#endif
+
+  sndbuf = tcp_autotune_limit(conn->snd_bufs, sndbuf);
+  if (sndbuf <= (uint32_t)conn->snd_bufs)
+    {
+      return false;
+    }
+
+  ninfo("snd_bufs %" PRId32 " -> %" PRIu32 "\n", conn->snd_bufs, sndbuf);
+  conn->snd_bufs = sndbuf;
+  return true;
+}
+
+#endif /* CONFIG_NET_TCP_SNDBUF_AUTOTUNE */
+#endif /* CONFIG_NET_TCP_RCVBUF_AUTOTUNE || CONFIG_NET_TCP_SNDBUF_AUTOTUNE */
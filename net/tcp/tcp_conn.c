@@ -777,6 +777,13 @@ void tcp_free_rx_buffers(FAR struct tcp_conn_s *conn)
   iob_free_chain(conn->readahead);
   conn->readahead = NULL;
 
+#ifdef CONFIG_NET_TCP_ZEROCOPY
+  /* Release any read-ahead buffers still lent to the application */
+
+  iob_free_queue(&conn->zc_lent);
+  conn->zc_lentlen = 0;
+#endif
+
 #ifdef CONFIG_NET_TCP_OUT_OF_ORDER
   /* Release any out-of-order buffers */
 
@@ -835,6 +842,10 @@ void tcp_free(FAR struct tcp_conn_s *conn)
 
   tcp_stop_timer(conn);
 
+  /* Leave the TX ready list of the device */
+
+  devif_txready_remove(&conn->sconn);
+
   /* Make sure monitor is stopped. */
 
   tcp_stop_monitor(conn, TCP_CLOSE);
@@ -862,6 +873,12 @@ void tcp_free(FAR struct tcp_conn_s *conn)
 
   tcp_free_rx_buffers(conn);
 
+#ifdef CONFIG_NET_TCP_KTLS
+  /* Release the TLS record layer and wipe its keys */
+
+  tcp_tls_free(conn);
+#endif
+
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
   /* Release any write buffers attached to the connection */
 
@@ -1103,6 +1120,8 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct net_driver_s *dev,
 #if CONFIG_NET_SEND_BUFSIZE > 0
       conn->snd_bufs         = listener->snd_bufs;
 #endif
+      conn->flags            = listener->flags &
+                               (TCP_RCVBUF_LOCK | TCP_SNDBUF_LOCK);
       conn->mss              = listener->mss;
 
       /* Fill in the necessary fields for the new connection. */
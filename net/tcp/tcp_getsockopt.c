@@ -28,6 +28,7 @@
 
 #include <sys/time.h>
 #include <stdint.h>
+#include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
@@ -239,6 +240,46 @@ int tcp_getsockopt(FAR struct socket *psock, int option,
           }
         break;
 
+#ifdef CONFIG_NET_TCP_ZEROCOPY
+      case TCP_ZEROCOPY_RECEIVE: /* Borrow received data */
+        if (*value_len != sizeof(struct tcp_zerocopy_receive))
+          {
+            ret = -EINVAL;
+          }
+#ifdef CONFIG_NET_TCP_KTLS
+        else if (tcp_tls_rxenabled(psock))
+          {
+            /* Received data is ciphertext, it must not be lent out */
+
+            ret = -EINVAL;
+          }
+#endif
+        else
+          {
+            ret = tcp_zerocopy_receive(conn,
+                    (FAR struct tcp_zerocopy_receive *)value);
+          }
+        break;
+#endif
+
+#ifdef CONFIG_NET_TCP_KTLS
+      case TCP_ULP: /* Upper layer protocol name */
+        if (conn->tls == NULL)
+          {
+            *value_len = 0;
+          }
+        else if (*value_len < sizeof("tls"))
+          {
+            ret = -EINVAL;
+          }
+        else
+          {
+            memcpy(value, "tls", sizeof("tls"));
+            *value_len = sizeof("tls");
+          }
+        break;
+#endif
+
       default:
         nerr("ERROR: Unrecognized TCP option: %d\n", option);
         ret = -ENOPROTOOPT;
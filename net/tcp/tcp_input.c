@@ -893,6 +893,12 @@ reset:
 found:
   flags = 0;
 
+  /* A segment may open the window or acknowledge data, poll the connection
+   * again on the next TX poll.
+   */
+
+  tcp_txready(conn);
+
   /* We do a very naive form of TCP reset processing; we just accept
    * any RST and kill our connection. We should in fact check if the
    * sequence number of this reset is within our advertised window
@@ -1553,6 +1559,9 @@ found:
         if (dev->d_len > 0 && (conn->tcpstateflags & TCP_STOPPED) == 0)
           {
             flags |= TCP_NEWDATA;
+#ifdef CONFIG_NET_TCP_RCVBUF_AUTOTUNE
+            tcp_rcvrtt_measure(conn);
+#endif
           }
 
         /* If this packet constitutes an ACK for outstanding data (flagged
@@ -290,7 +290,11 @@ int tcp_pollsetup(FAR struct socket *psock, FAR struct pollfd *fds)
 
   /* Check for read data or backlogged connection availability now */
 
-  if (conn->readahead != NULL || tcp_backlogpending(conn))
+  if (conn->readahead != NULL || tcp_backlogpending(conn)
+#ifdef CONFIG_NET_TCP_KTLS
+      || tcp_tls_rxpending(conn)
+#endif
+     )
     {
       /* Normal data may be read without blocking. */
 
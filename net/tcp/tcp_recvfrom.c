@@ -804,6 +804,15 @@ ssize_t psock_tcp_recvfrom(FAR struct socket *psock, FAR struct msghdr *msg,
         }
     }
 
+#ifdef CONFIG_NET_TCP_RCVBUF_AUTOTUNE
+  /* Let the receive buffer follow the rate the application drains it */
+
+  if (ret > 0 && (flags & MSG_PEEK) == 0)
+    {
+      tcp_rcvspace_adjust(conn, ret);
+    }
+
+#endif
   /* Receive additional data from read-ahead buffer, send the ACK timely.
    *
    * Revisit: Because IOBs are system-wide resources, consuming the read
@@ -813,6 +822,7 @@ ssize_t psock_tcp_recvfrom(FAR struct socket *psock, FAR struct msghdr *msg,
 
   if (tcp_should_send_recvwindow(conn))
     {
+      tcp_txready(conn);
       netdev_txnotify_dev(conn->dev);
     }
 
@@ -66,6 +66,9 @@ static uint32_t tcp_calc_rcvsize(FAR struct tcp_conn_s *conn,
   uint32_t desire;
 
   recvsize = conn->readahead ? conn->readahead->io_pktlen : 0;
+#ifdef CONFIG_NET_TCP_ZEROCOPY
+  recvsize += conn->zc_lentlen;
+#endif
   if (conn->rcv_bufs > recvsize)
     {
       desire = conn->rcv_bufs - recvsize;
@@ -670,6 +670,31 @@ void tcp_synack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
   tcp_sendcommon(dev, conn, tcp);
 }
 
+/****************************************************************************
+ * Name: tcp_txready
+ *
+ * Description:
+ *   Put the connection on the TX ready list of its device so that the next
+ *   TX poll of the device visits it.
+ *
+ * Input Parameters:
+ *   conn  - The TCP connection structure
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NETDEV_TXREADY
+void tcp_txready(FAR struct tcp_conn_s *conn)
+{
+  if (conn->dev != NULL)
+    {
+      devif_txready(&conn->dev->d_tcpready, &conn->sconn);
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: tcp_send_txnotify
  *
@@ -689,6 +714,8 @@ void tcp_synack(FAR struct net_driver_s *dev, FAR struct tcp_conn_s *conn,
 void tcp_send_txnotify(FAR struct socket *psock,
                        FAR struct tcp_conn_s *conn)
 {
+  tcp_txready(conn);
+
 #ifdef CONFIG_NET_IPv4
 #ifdef CONFIG_NET_IPv6
   /* If both IPv4 and IPv6 support are enabled, then we will need to select
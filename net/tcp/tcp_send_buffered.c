@@ -610,6 +610,7 @@ static uint16_t psock_send_eventhandler(FAR struct net_driver_s *dev,
 
                       TCP_WBNACK(wrb) = 0;
                       conn->timeout = true;
+                      tcp_txready(conn);
                       netdev_txnotify_dev(conn->dev);
                       return flags;
                     }
@@ -1316,6 +1317,9 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
   FAR struct tcp_conn_s *conn;
   FAR struct tcp_wrbuffer_s *wrb;
   FAR const uint8_t *cp;
+#ifdef CONFIG_NET_TCP_ZEROCOPY_SEND
+  FAR struct tcp_zcsend_s *zc = NULL;
+#endif
   unsigned int timeout;
   ssize_t    result = 0;
   bool       nonblock;
@@ -1379,6 +1383,26 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
 
   BUF_DUMP("psock_tcp_send", buf, len);
 
+#ifdef CONFIG_NET_TCP_ZEROCOPY_SEND
+  /* MSG_ZEROCOPY queues the user buffer itself, so the send may only
+   * return once the peer has ACKed all of it.  That wait can't honour
+   * O_NONBLOCK, MSG_DONTWAIT or SO_SNDTIMEO, such sends copy the data.
+   */
+
+  if ((flags & MSG_ZEROCOPY) != 0 && !nonblock && timeout == UINT_MAX)
+    {
+      zc = tcp_zcsend_setup(buf, len);
+      if (zc != NULL)
+        {
+          /* Don't leave the tracking structure behind if the thread is
+           * canceled while the IOBs still refer to the buffer.
+           */
+
+          tls_cleanup_push(tls_get_info(), tcp_zcsend_cleanup, zc);
+        }
+    }
+
+#endif
   cp = buf;
   while (len > 0)
     {
@@ -1434,6 +1458,15 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
         {
           struct tcp_callback_s info;
 
+#ifdef CONFIG_NET_TCP_SNDBUF_AUTOTUNE
+          /* Try to grow the send buffer before waiting for it to drain */
+
+          if (tcp_sndbuf_expand(conn))
+            {
+              continue;
+            }
+
+#endif
           if (nonblock)
             {
               ret = -EAGAIN;
@@ -1547,7 +1580,24 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
            * remaining data.
            */
 
-          chunk_result = TCP_WBTRYCOPYIN(wrb, cp, chunk_len, off);
+#ifdef CONFIG_NET_TCP_ZEROCOPY_SEND
+          if (zc != NULL)
+            {
+              /* One IOB refers to at most UINT16_MAX bytes */
+
+              if (chunk_len > UINT16_MAX)
+                {
+                  chunk_len = UINT16_MAX;
+                }
+
+              chunk_result = tcp_zcsend_attach(zc, wrb, cp, chunk_len);
+            }
+          else
+#endif
+            {
+              chunk_result = TCP_WBTRYCOPYIN(wrb, cp, chunk_len, off);
+            }
+
           if (chunk_result == -ENOMEM)
             {
               if (TCP_WBPKTLEN(wrb) > 0)
@@ -1662,6 +1712,15 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
       result += chunk_result;
     }
 
+#ifdef CONFIG_NET_TCP_ZEROCOPY_SEND
+  if (zc != NULL)
+    {
+      tls_cleanup_pop(tls_get_info(), 0);
+      tcp_zcsend_wait(zc);
+      zc = NULL;
+    }
+#endif
+
   /* Check for errors.  Errors are signaled by negative errno values
    * for the send length
    */
@@ -1680,6 +1739,14 @@ errout_with_lock:
   net_unlock();
 
 errout:
+#ifdef CONFIG_NET_TCP_ZEROCOPY_SEND
+  if (zc != NULL)
+    {
+      tls_cleanup_pop(tls_get_info(), 0);
+      tcp_zcsend_wait(zc);
+    }
+#endif
+
   if (result > 0)
     {
       return result;
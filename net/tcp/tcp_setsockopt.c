@@ -260,6 +260,27 @@ int tcp_setsockopt(FAR struct socket *psock, int option,
           }
         break;
 
+#ifdef CONFIG_NET_TCP_ZEROCOPY
+      case TCP_ZEROCOPY_RELEASE: /* Return borrowed data */
+        if (value_len != sizeof(struct tcp_zerocopy_receive))
+          {
+            ret = -EINVAL;
+          }
+        else
+          {
+            FAR const struct tcp_zerocopy_receive *zc = value;
+
+            ret = tcp_zerocopy_release(conn, zc->cookie);
+          }
+        break;
+#endif
+
+#ifdef CONFIG_NET_TCP_KTLS
+      case TCP_ULP: /* Attach an upper layer protocol */
+        ret = tcp_tls_ulp(psock, value, value_len);
+        break;
+#endif
+
       default:
         nerr("ERROR: Unrecognized TCP option: %d\n", option);
         ret = -ENOPROTOOPT;
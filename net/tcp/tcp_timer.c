@@ -152,6 +152,7 @@ static void tcp_timer_expiry(FAR void *arg)
       if (conn == arg)
         {
           conn->timeout = true;
+          tcp_txready(conn);
           netdev_txnotify_dev(conn->dev);
           break;
         }
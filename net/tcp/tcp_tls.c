@@ -0,0 +1,1071 @@
+/****************************************************************************
+ * net/tcp/tcp_tls.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <endian.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <netinet/tcp.h>
+#include <netinet/tls.h>
+
+#include <crypto/xform.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mutex.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/tcp.h>
+
+#include "socket/socket.h"
+#include "sixlowpan/sixlowpan.h"
+#include "utils/utils.h"
+#include "tcp/tcp.h"
+
+#ifdef CONFIG_NET_TCP_KTLS
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Record layer sizes (RFC 5246 / RFC 8446) */
+
+#define TLS_HEADER_SIZE      5      /* type, legacy version, length */
+#define TLS_NONCE_SIZE       8      /* Per record part of the AEAD nonce */
+#define TLS_SALT_SIZE        4      /* Constant part of the AEAD nonce */
+#define TLS_TAG_SIZE         16     /* AEAD authentication tag */
+#define TLS_AAD12_SIZE       13     /* seq_num + type + version + length */
+#define TLS_MAX_PLAINTEXT    16384  /* 2^14 */
+#define TLS_MAX_CIPHERTEXT   (TLS_MAX_PLAINTEXT + 256)
+
+#define TLS_RECORD_APPDATA   23     /* ContentType application_data */
+
+#define TLS_TX_PAYLOAD       CONFIG_NET_TCP_KTLS_TX_RECORD
+#define TLS_TX_BUFSIZE       (TLS_HEADER_SIZE + TLS_NONCE_SIZE + \
+                              TLS_TX_PAYLOAD + 1 + TLS_TAG_SIZE)
+#define TLS_RX_BUFSIZE       (TLS_HEADER_SIZE + TLS_MAX_CIPHERTEXT)
+
+/* Largest crypto block processed at once (CHACHA20_BLOCK_LEN) */
+
+#define TLS_BLOCK_SIZE       64
+
+#define TLS_CTX_ALIGN(n)     (((n) + 7) & ~7)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Crypto state and record buffer of one direction.  'iv' is the per record
+ * part of the nonce: the explicit nonce of TLS 1.2 AES-GCM, or the
+ * implicit IV that is XORed with the sequence number otherwise.
+ */
+
+struct tcp_tls_dir_s
+{
+  mutex_t lock;                          /* Serializes senders/receivers */
+  FAR const struct enc_xform *exf;       /* Cipher, NULL if not enabled */
+  FAR const struct auth_hash *axf;       /* Authenticator */
+  FAR uint8_t *kschedule;                /* Cipher key schedule */
+  FAR uint8_t *ictx;                     /* Keyed authenticator state */
+  FAR uint8_t *actx;                     /* Authenticator of one record */
+  FAR uint8_t *buf;                      /* Record buffer */
+  uint64_t seq;                          /* Next record sequence number */
+  uint16_t version;                      /* TLS_1_2_VERSION/TLS_1_3_VERSION */
+  bool explicit_nonce;                   /* Nonce is carried in the record */
+  uint8_t iv[TLS_NONCE_SIZE];
+
+  /* TX: ciphertext not sent yet is buf[head, tail).
+   * RX: buf[0, tail) holds the partially received record, and the
+   * plaintext not consumed yet of the last opened record is
+   * buf[head, end) with content type 'type'.
+   */
+
+  uint16_t head;
+  uint16_t tail;
+  uint16_t end;
+  uint8_t type;
+  int error;                             /* Sticky error */
+};
+
+struct tcp_tls_s
+{
+  struct tcp_tls_dir_s tx;
+  struct tcp_tls_dir_s rx;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_tls_put16/put64/get16/get64
+ *
+ * Description:
+ *   Big endian accessors of the record header fields.
+ *
+ ****************************************************************************/
+
+static void tcp_tls_put16(FAR uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)(v >> 8);
+  p[1] = (uint8_t)v;
+}
+
+static void tcp_tls_put64(FAR uint8_t *p, uint64_t v)
+{
+  int i;
+
+  for (i = 7; i >= 0; i--, v >>= 8)
+    {
+      p[i] = (uint8_t)v;
+    }
+}
+
+static uint16_t tcp_tls_get16(FAR const uint8_t *p)
+{
+  return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static uint64_t tcp_tls_get64(FAR const uint8_t *p)
+{
+  uint64_t v = 0;
+  int i;
+
+  for (i = 0; i < 8; i++)
+    {
+      v = (v << 8) | p[i];
+    }
+
+  return v;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_nonce
+ *
+ * Description:
+ *   Compute the per record part of the nonce of the next record.
+ *
+ ****************************************************************************/
+
+static void tcp_tls_nonce(FAR struct tcp_tls_dir_s *dir, FAR uint8_t *nonce)
+{
+  int i;
+
+  if (dir->explicit_nonce)
+    {
+      memcpy(nonce, dir->iv, TLS_NONCE_SIZE);
+    }
+  else
+    {
+      tcp_tls_put64(nonce, dir->seq);
+      for (i = 0; i < TLS_NONCE_SIZE; i++)
+        {
+          nonce[i] ^= dir->iv[i];
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_tls_advance
+ *
+ * Description:
+ *   Step the sequence number (and the explicit nonce) past one record.
+ *
+ ****************************************************************************/
+
+static void tcp_tls_advance(FAR struct tcp_tls_dir_s *dir)
+{
+  int i;
+
+  dir->seq++;
+  if (dir->explicit_nonce)
+    {
+      for (i = TLS_NONCE_SIZE - 1; i >= 0 && ++dir->iv[i] == 0; i--);
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_tls_crypt
+ *
+ * Description:
+ *   AEAD encrypt or decrypt 'len' bytes at 'data' in place.  This is the
+ *   record level equivalent of swcr_authenc(): the cipher and the
+ *   authenticator are driven directly so that the AAD and the tag can live
+ *   outside of the data.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, -EBADMSG if the tag of a decrypted record does
+ *   not match.
+ *
+ ****************************************************************************/
+
+static int tcp_tls_crypt(FAR struct tcp_tls_dir_s *dir,
+                         FAR uint8_t *nonce, FAR const uint8_t *aad,
+                         size_t aadlen, FAR uint8_t *data, size_t len,
+                         FAR uint8_t *tag, bool encrypt)
+{
+  FAR const struct enc_xform *exf = dir->exf;
+  FAR const struct auth_hash *axf = dir->axf;
+  uint32_t blkbuf[TLS_BLOCK_SIZE / sizeof(uint32_t)];
+  FAR uint8_t *blk = (FAR uint8_t *)blkbuf;
+  uint8_t mac[TLS_TAG_SIZE];
+  size_t blksz = axf->blocksize;
+  size_t chunk;
+  size_t i;
+  int ret = OK;
+
+  memcpy(dir->actx, dir->ictx, axf->ctxsize);
+  axf->reinit(dir->actx, nonce, TLS_NONCE_SIZE);
+  axf->update(dir->actx, aad, aadlen);
+  exf->reinit((caddr_t)dir->kschedule, nonce);
+
+  for (i = 0; i < len; i += blksz)
+    {
+      chunk = MIN(len - i, blksz);
+      if (chunk < blksz)
+        {
+          memset(blk, 0, blksz);
+        }
+
+      memcpy(blk, data + i, chunk);
+      if (encrypt)
+        {
+          exf->encrypt((caddr_t)dir->kschedule, blk);
+          axf->update(dir->actx, blk, chunk);
+        }
+      else
+        {
+          axf->update(dir->actx, blk, chunk);
+          exf->decrypt((caddr_t)dir->kschedule, blk);
+        }
+
+      memcpy(data + i, blk, chunk);
+    }
+
+  /* Length block, GHASH wants bit counts, Poly1305 byte counts */
+
+  memset(blk, 0, TLS_TAG_SIZE);
+  if (exf == &enc_xform_chacha20_poly1305)
+    {
+      blkbuf[0] = htole32(aadlen);
+      blkbuf[2] = htole32(len);
+    }
+  else
+    {
+      blkbuf[1] = htobe32(aadlen * 8);
+      blkbuf[3] = htobe32(len * 8);
+    }
+
+  axf->update(dir->actx, blk, TLS_TAG_SIZE);
+  axf->final(mac, dir->actx);
+
+  if (encrypt)
+    {
+      memcpy(tag, mac, TLS_TAG_SIZE);
+    }
+  else if (timingsafe_bcmp(tag, mac, TLS_TAG_SIZE) != 0)
+    {
+      ret = -EBADMSG;
+    }
+
+  explicit_bzero(mac, sizeof(mac));
+  explicit_bzero(blkbuf, sizeof(blkbuf));
+  return ret;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_aad
+ *
+ * Description:
+ *   Build the additional authenticated data of a record whose header is at
+ *   'hdr' and whose plaintext (TLS 1.2) is 'len' bytes long.
+ *
+ * Returned Value:
+ *   The size of the AAD.
+ *
+ ****************************************************************************/
+
+static size_t tcp_tls_aad(FAR struct tcp_tls_dir_s *dir,
+                          FAR const uint8_t *hdr, size_t len,
+                          FAR uint8_t *aad)
+{
+  if (dir->version == TLS_1_3_VERSION)
+    {
+      memcpy(aad, hdr, TLS_HEADER_SIZE);
+      return TLS_HEADER_SIZE;
+    }
+
+  tcp_tls_put64(aad, dir->seq);
+  memcpy(aad + 8, hdr, 3);
+  tcp_tls_put16(aad + 11, len);
+  return TLS_AAD12_SIZE;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_seal
+ *
+ * Description:
+ *   Build and encrypt one record of content type 'type' from 'len' bytes
+ *   of 'src' in the TX buffer.
+ *
+ ****************************************************************************/
+
+static void tcp_tls_seal(FAR struct tcp_tls_dir_s *tx, uint8_t type,
+                         FAR const void *src, size_t len)
+{
+  FAR uint8_t *buf = tx->buf;
+  FAR uint8_t *data = buf + TLS_HEADER_SIZE;
+  uint8_t aad[TLS_AAD12_SIZE];
+  uint8_t nonce[TLS_NONCE_SIZE];
+  size_t aadlen;
+
+  tcp_tls_nonce(tx, nonce);
+  if (tx->explicit_nonce)
+    {
+      memcpy(data, nonce, TLS_NONCE_SIZE);
+      data += TLS_NONCE_SIZE;
+    }
+
+  memcpy(data, src, len);
+
+  /* TLS 1.3 hides the real content type inside the encrypted record */
+
+  if (tx->version == TLS_1_3_VERSION)
+    {
+      data[len++] = type;
+      type = TLS_RECORD_APPDATA;
+    }
+
+  buf[0] = type;
+  tcp_tls_put16(buf + 1, TLS_1_2_VERSION);
+  tcp_tls_put16(buf + 3, data - buf - TLS_HEADER_SIZE + len +
+                         TLS_TAG_SIZE);
+
+  aadlen = tcp_tls_aad(tx, buf, len, aad);
+  tcp_tls_crypt(tx, nonce, aad, aadlen, data, len, data + len, true);
+  tcp_tls_advance(tx);
+
+  tx->head = 0;
+  tx->tail = data - buf + len + TLS_TAG_SIZE;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_open
+ *
+ * Description:
+ *   Authenticate and decrypt the complete record in the RX buffer and
+ *   expose its plaintext as buf[head, end).
+ *
+ ****************************************************************************/
+
+static int tcp_tls_open(FAR struct tcp_tls_dir_s *rx)
+{
+  FAR uint8_t *buf = rx->buf;
+  FAR uint8_t *data = buf + TLS_HEADER_SIZE;
+  uint8_t aad[TLS_AAD12_SIZE];
+  uint8_t nonce[TLS_NONCE_SIZE];
+  size_t aadlen;
+  size_t len;
+  int ret;
+
+  len = tcp_tls_get16(buf + 3);
+  if (rx->explicit_nonce)
+    {
+      memcpy(nonce, data, TLS_NONCE_SIZE);
+      data += TLS_NONCE_SIZE;
+      len  -= TLS_NONCE_SIZE;
+    }
+  else
+    {
+      tcp_tls_nonce(rx, nonce);
+    }
+
+  len   -= TLS_TAG_SIZE;
+  aadlen = tcp_tls_aad(rx, buf, len, aad);
+  ret    = tcp_tls_crypt(rx, nonce, aad, aadlen, data, len, data + len,
+                         false);
+  if (ret < 0)
+    {
+      nerr("ERROR: TLS record authentication failed\n");
+      return ret;
+    }
+
+  tcp_tls_advance(rx);
+  rx->type = buf[0];
+
+  /* Strip the TLS 1.3 padding and recover the real content type */
+
+  if (rx->version == TLS_1_3_VERSION)
+    {
+      while (len > 0 && data[len - 1] == 0)
+        {
+          len--;
+        }
+
+      if (len == 0)
+        {
+          return -EBADMSG;
+        }
+
+      rx->type = data[--len];
+    }
+
+  rx->head = data - buf;
+  rx->end  = rx->head + len;
+  rx->tail = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_flush
+ *
+ * Description:
+ *   Send the rest of the last sealed record.
+ *
+ ****************************************************************************/
+
+static int tcp_tls_flush(FAR struct socket *psock,
+                         FAR struct tcp_tls_dir_s *tx, int flags)
+{
+  ssize_t ret;
+
+  while (tx->head < tx->tail)
+    {
+#ifdef CONFIG_NET_6LOWPAN
+      /* Try 6LoWPAN first, like inet_send() does for plain data */
+
+      ret = psock_6lowpan_tcp_send(psock, tx->buf + tx->head,
+                                   tx->tail - tx->head);
+      if (ret < 0)
+#endif
+        {
+          ret = psock_tcp_send(psock, tx->buf + tx->head,
+                               tx->tail - tx->head, flags);
+        }
+
+      if (ret <= 0)
+        {
+          return ret < 0 ? (int)ret : -EAGAIN;
+        }
+
+      tx->head += ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_fill
+ *
+ * Description:
+ *   Receive the rest of the next record into the RX buffer and open it.
+ *   A partially received record is kept across calls, so non-blocking
+ *   sockets may return -EAGAIN in the middle of a record.
+ *
+ * Returned Value:
+ *   One if a record was opened, zero on end of file at a record boundary,
+ *   or a negated errno value.
+ *
+ ****************************************************************************/
+
+static int tcp_tls_fill(FAR struct socket *psock,
+                        FAR struct tcp_tls_dir_s *rx, int flags)
+{
+  FAR uint8_t *buf = rx->buf;
+  struct msghdr msg;
+  struct iovec iov;
+  size_t need;
+  size_t len;
+  ssize_t ret;
+
+  for (; ; )
+    {
+      need = TLS_HEADER_SIZE;
+      if (rx->tail >= TLS_HEADER_SIZE)
+        {
+          /* The smallest record holds the explicit nonce (TLS 1.2
+           * AES-GCM) or the inner content type (TLS 1.3), and the tag.
+           */
+
+          len = tcp_tls_get16(buf + 3);
+          if (buf[1] != 3 || buf[2] != 3 ||
+              len < TLS_TAG_SIZE + (rx->explicit_nonce ? TLS_NONCE_SIZE :
+                                    rx->version == TLS_1_3_VERSION) ||
+              len > TLS_MAX_CIPHERTEXT ||
+              (rx->version == TLS_1_3_VERSION &&
+               buf[0] != TLS_RECORD_APPDATA))
+            {
+              nerr("ERROR: Malformed TLS record header\n");
+              return -EBADMSG;
+            }
+
+          need += len;
+          if (rx->tail == need)
+            {
+              break;
+            }
+        }
+
+      memset(&msg, 0, sizeof(msg));
+      iov.iov_base   = buf + rx->tail;
+      iov.iov_len    = need - rx->tail;
+      msg.msg_iov    = &iov;
+      msg.msg_iovlen = 1;
+
+      ret = psock_tcp_recvfrom(psock, &msg, flags);
+      if (ret < 0)
+        {
+          return ret;
+        }
+      else if (ret == 0)
+        {
+          /* End of file, fine only between two records */
+
+          return rx->tail == 0 ? 0 : -EBADMSG;
+        }
+
+      rx->tail += ret;
+    }
+
+  ret = tcp_tls_open(rx);
+  return ret < 0 ? ret : 1;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_dir_setup
+ *
+ * Description:
+ *   Install the key material of TLS_TX or TLS_RX.
+ *
+ ****************************************************************************/
+
+static int tcp_tls_dir_setup(FAR struct tcp_tls_dir_s *dir,
+                             FAR const void *value, socklen_t value_len,
+                             size_t bufsize)
+{
+  FAR const struct tls_crypto_info *info = value;
+  FAR const struct enc_xform *exf;
+  FAR const struct auth_hash *axf;
+  FAR const uint8_t *key;
+  FAR const uint8_t *salt;
+  FAR const uint8_t *iv;
+  FAR const uint8_t *seq;
+  uint8_t keysalt[32 + TLS_SALT_SIZE];
+  size_t keylen;
+  size_t ctxlen;
+  int ret = OK;
+
+  if (value_len < sizeof(*info) ||
+      (info->version != TLS_1_2_VERSION &&
+       info->version != TLS_1_3_VERSION))
+    {
+      return -EINVAL;
+    }
+
+  switch (info->cipher_type)
+    {
+      case TLS_CIPHER_AES_GCM_128:
+        {
+          FAR const struct tls12_crypto_info_aes_gcm_128 *ci = value;
+
+          if (value_len != sizeof(*ci))
+            {
+              return -EINVAL;
+            }
+
+          exf    = &enc_xform_aes_gcm;
+          axf    = &auth_hash_gmac_aes_128;
+          key    = ci->key;
+          keylen = sizeof(ci->key);
+          salt   = ci->salt;
+          iv     = ci->iv;
+          seq    = ci->rec_seq;
+        }
+        break;
+
+      case TLS_CIPHER_AES_GCM_256:
+        {
+          FAR const struct tls12_crypto_info_aes_gcm_256 *ci = value;
+
+          if (value_len != sizeof(*ci))
+            {
+              return -EINVAL;
+            }
+
+          exf    = &enc_xform_aes_gcm;
+          axf    = &auth_hash_gmac_aes_256;
+          key    = ci->key;
+          keylen = sizeof(ci->key);
+          salt   = ci->salt;
+          iv     = ci->iv;
+          seq    = ci->rec_seq;
+        }
+        break;
+
+      case TLS_CIPHER_CHACHA20_POLY1305:
+        {
+          FAR const struct tls12_crypto_info_chacha20_poly1305 *ci = value;
+
+          if (value_len != sizeof(*ci))
+            {
+              return -EINVAL;
+            }
+
+          /* The 12 byte IV splits into the same salt/nonce layout */
+
+          exf    = &enc_xform_chacha20_poly1305;
+          axf    = &auth_hash_chacha20_poly1305;
+          key    = ci->key;
+          keylen = sizeof(ci->key);
+          salt   = ci->iv;
+          iv     = ci->iv + TLS_SALT_SIZE;
+          seq    = ci->rec_seq;
+        }
+        break;
+
+      default:
+        return -EINVAL;
+    }
+
+  nxmutex_lock(&dir->lock);
+
+  if (dir->exf != NULL)
+    {
+      ret = -EBUSY;
+      goto errout;
+    }
+
+  ctxlen = TLS_CTX_ALIGN(exf->ctxsize) + 2 * TLS_CTX_ALIGN(axf->ctxsize);
+  dir->kschedule = kmm_zalloc(ctxlen);
+  dir->buf = kmm_malloc(bufsize);
+  if (dir->kschedule == NULL || dir->buf == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout_with_mem;
+    }
+
+  dir->ictx = dir->kschedule + TLS_CTX_ALIGN(exf->ctxsize);
+  dir->actx = dir->ictx + TLS_CTX_ALIGN(axf->ctxsize);
+
+  memcpy(keysalt, key, keylen);
+  memcpy(keysalt + keylen, salt, TLS_SALT_SIZE);
+
+  if (exf->setkey(dir->kschedule, keysalt, keylen + TLS_SALT_SIZE) < 0)
+    {
+      ret = -EINVAL;
+      goto errout_with_key;
+    }
+
+  axf->init(dir->ictx);
+  axf->setkey(dir->ictx, keysalt, keylen + TLS_SALT_SIZE);
+
+  memcpy(dir->iv, iv, TLS_NONCE_SIZE);
+  dir->seq            = tcp_tls_get64(seq);
+  dir->version        = info->version;
+  dir->explicit_nonce = info->version == TLS_1_2_VERSION &&
+                        exf == &enc_xform_aes_gcm;
+  dir->axf            = axf;
+  dir->exf            = exf;
+
+  explicit_bzero(keysalt, sizeof(keysalt));
+  nxmutex_unlock(&dir->lock);
+  return OK;
+
+errout_with_key:
+  explicit_bzero(keysalt, sizeof(keysalt));
+
+errout_with_mem:
+  if (dir->kschedule != NULL)
+    {
+      explicit_bzero(dir->kschedule, ctxlen);
+      kmm_free(dir->kschedule);
+      dir->kschedule = NULL;
+    }
+
+  kmm_free(dir->buf);
+  dir->buf = NULL;
+
+errout:
+  nxmutex_unlock(&dir->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_dir_free
+ ****************************************************************************/
+
+static void tcp_tls_dir_free(FAR struct tcp_tls_dir_s *dir)
+{
+  if (dir->exf != NULL)
+    {
+      explicit_bzero(dir->kschedule,
+                     TLS_CTX_ALIGN(dir->exf->ctxsize) +
+                     2 * TLS_CTX_ALIGN(dir->axf->ctxsize));
+      kmm_free(dir->kschedule);
+      kmm_free(dir->buf);
+    }
+
+  nxmutex_destroy(&dir->lock);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_tls_ulp
+ *
+ * Description:
+ *   Implement setsockopt(TCP_ULP, "tls"): attach the TLS record layer to a
+ *   connected socket.  No record is processed until TLS_TX and/or TLS_RX
+ *   are configured.
+ *
+ ****************************************************************************/
+
+int tcp_tls_ulp(FAR struct socket *psock, FAR const void *value,
+                socklen_t value_len)
+{
+  FAR struct tcp_conn_s *conn = psock->s_conn;
+  FAR const char *name = value;
+  FAR struct tcp_tls_s *tls;
+
+  if (value_len < 3 || memcmp(name, "tls", 3) != 0 ||
+      (value_len > 3 && name[3] != '\0'))
+    {
+      return -ENOENT;
+    }
+
+  if (!_SS_ISCONNECTED(conn->sconn.s_flags))
+    {
+      return -ENOTCONN;
+    }
+
+  tls = kmm_zalloc(sizeof(struct tcp_tls_s));
+  if (tls == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  nxmutex_init(&tls->tx.lock);
+  nxmutex_init(&tls->rx.lock);
+
+  net_lock();
+  if (conn->tls != NULL)
+    {
+      net_unlock();
+      nxmutex_destroy(&tls->tx.lock);
+      nxmutex_destroy(&tls->rx.lock);
+      kmm_free(tls);
+      return -EEXIST;
+    }
+
+  conn->tls = tls;
+  net_unlock();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_setsockopt
+ *
+ * Description:
+ *   Handle the SOL_TLS level socket options.
+ *
+ ****************************************************************************/
+
+int tcp_tls_setsockopt(FAR struct socket *psock, int option,
+                       FAR const void *value, socklen_t value_len)
+{
+  FAR struct tcp_conn_s *conn = psock->s_conn;
+
+  if (psock->s_type != SOCK_STREAM || conn->tls == NULL)
+    {
+      return -ENOPROTOOPT;
+    }
+
+  if (value == NULL)
+    {
+      return -EFAULT;
+    }
+
+  switch (option)
+    {
+      case TLS_TX:
+        return tcp_tls_dir_setup(&conn->tls->tx, value, value_len,
+                                 TLS_TX_BUFSIZE);
+
+      case TLS_RX:
+        return tcp_tls_dir_setup(&conn->tls->rx, value, value_len,
+                                 TLS_RX_BUFSIZE);
+
+      default:
+        return -ENOPROTOOPT;
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_tls_txenabled/tcp_tls_rxenabled
+ *
+ * Description:
+ *   Return true if the socket encrypts sent data / decrypts received data.
+ *
+ ****************************************************************************/
+
+bool tcp_tls_txenabled(FAR struct socket *psock)
+{
+  FAR struct tcp_conn_s *conn = psock->s_conn;
+
+  return conn->tls != NULL && conn->tls->tx.exf != NULL;
+}
+
+bool tcp_tls_rxenabled(FAR struct socket *psock)
+{
+  FAR struct tcp_conn_s *conn = psock->s_conn;
+
+  return conn->tls != NULL && conn->tls->rx.exf != NULL;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_rxpending
+ *
+ * Description:
+ *   Return true if decrypted data or an error is waiting to be read, i.e.
+ *   the next receive will not block even with no new TCP data.
+ *
+ ****************************************************************************/
+
+bool tcp_tls_rxpending(FAR struct tcp_conn_s *conn)
+{
+  FAR struct tcp_tls_s *tls = conn->tls;
+
+  return tls != NULL && tls->rx.exf != NULL &&
+         (tls->rx.head < tls->rx.end || tls->rx.error < 0);
+}
+
+/****************************************************************************
+ * Name: tcp_tls_send
+ *
+ * Description:
+ *   Split 'buf' into application data records, encrypt them and send them
+ *   on the TCP connection.  A record that could only be sent partially is
+ *   completed before any new data is accepted.
+ *
+ * Returned Value:
+ *   The number of plaintext bytes accepted, or a negated errno value.  The
+ *   bytes of a record are accepted once it is sent, or once it is queued
+ *   for the next call after -EAGAIN.  Any other error loses the record,
+ *   which is not counted, and fails all later sends.
+ *
+ ****************************************************************************/
+
+ssize_t tcp_tls_send(FAR struct socket *psock, FAR const void *buf,
+                     size_t len, int flags)
+{
+  FAR struct tcp_conn_s *conn = psock->s_conn;
+  FAR struct tcp_tls_dir_s *tx = &conn->tls->tx;
+  FAR const uint8_t *src = buf;
+  size_t accepted = 0;
+  size_t chunk;
+  int ret;
+
+  /* The record buffer is reused, it cannot be sent without copying */
+
+  flags &= ~MSG_ZEROCOPY;
+
+  nxmutex_lock(&tx->lock);
+
+  ret = tx->error < 0 ? tx->error : tcp_tls_flush(psock, tx, flags);
+  while (ret >= 0 && accepted < len)
+    {
+      chunk = MIN(len - accepted, TLS_TX_PAYLOAD);
+      tcp_tls_seal(tx, TLS_RECORD_APPDATA, src + accepted, chunk);
+
+      /* A record left over by -EAGAIN is completed by the next call */
+
+      ret = tcp_tls_flush(psock, tx, flags);
+      if (ret >= 0 || ret == -EAGAIN)
+        {
+          accepted += chunk;
+        }
+    }
+
+  /* The sequence number of a lost record is used up, so the peer could
+   * not open any later record.
+   */
+
+  if (ret < 0 && ret != -EAGAIN)
+    {
+      tx->error = ret;
+      tx->head  = tx->tail;
+    }
+
+  nxmutex_unlock(&tx->lock);
+  return accepted > 0 || ret >= 0 ? (ssize_t)accepted : ret;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_recvmsg
+ *
+ * Description:
+ *   Receive and decrypt records into 'msg'.  Records of another content
+ *   type than application data are returned alone and their type is
+ *   reported with a SOL_TLS/TLS_GET_RECORD_TYPE control message; without
+ *   room for it they fail with -EIO, like on Linux.
+ *
+ * Returned Value:
+ *   The number of plaintext bytes received, zero on end of file, or a
+ *   negated errno value.
+ *
+ ****************************************************************************/
+
+ssize_t tcp_tls_recvmsg(FAR struct socket *psock, FAR struct msghdr *msg,
+                        int flags)
+{
+  FAR struct tcp_conn_s *conn = psock->s_conn;
+  FAR struct tcp_tls_dir_s *rx = &conn->tls->rx;
+  FAR const struct iovec *iov = msg->msg_iov;
+  FAR const struct iovec *end = iov + msg->msg_iovlen;
+  size_t iovoff = 0;
+  size_t copied = 0;
+  size_t total = 0;
+  size_t chunk;
+  uint16_t head;
+  int tcpflags;
+  int ret = OK;
+
+  for (; iov != end; iov++)
+    {
+      total += iov->iov_len;
+    }
+
+  iov = msg->msg_iov;
+  tcpflags = flags & ~(MSG_PEEK | MSG_WAITALL);
+
+  nxmutex_lock(&rx->lock);
+
+  if (rx->error < 0)
+    {
+      ret = rx->error;
+      goto out;
+    }
+
+  head = rx->head;
+  while (copied < total)
+    {
+      if (head >= rx->end)
+        {
+          /* Once something was copied, only take records that are
+           * already there unless MSG_WAITALL was requested.
+           */
+
+          ret = tcp_tls_fill(psock, rx, copied > 0 &&
+                             (flags & MSG_WAITALL) == 0 ?
+                             tcpflags | MSG_DONTWAIT : tcpflags);
+          if (ret <= 0)
+            {
+              if (ret == -EBADMSG)
+                {
+                  rx->error = ret;
+                }
+
+              break;
+            }
+
+          head = rx->head;
+        }
+
+      if (rx->type != TLS_RECORD_APPDATA)
+        {
+          if (copied > 0)
+            {
+              break;
+            }
+
+          if (cmsg_append(msg, SOL_TLS, TLS_GET_RECORD_TYPE,
+                          &rx->type, sizeof(rx->type)) == NULL)
+            {
+              ret = -EIO;
+              break;
+            }
+        }
+
+      /* Copy the plaintext into the user I/O vector */
+
+      while (head < rx->end && iov != end)
+        {
+          chunk = MIN(rx->end - head, iov->iov_len - iovoff);
+          memcpy((FAR uint8_t *)iov->iov_base + iovoff, rx->buf + head,
+                 chunk);
+          head   += chunk;
+          iovoff += chunk;
+          copied += chunk;
+          if (iovoff == iov->iov_len)
+            {
+              iov++;
+              iovoff = 0;
+            }
+        }
+
+      if ((flags & MSG_PEEK) == 0)
+        {
+          rx->head = head;
+        }
+
+      if ((flags & MSG_PEEK) != 0 || rx->type != TLS_RECORD_APPDATA)
+        {
+          break;
+        }
+    }
+
+out:
+  nxmutex_unlock(&rx->lock);
+  return copied > 0 ? (ssize_t)copied : ret;
+}
+
+/****************************************************************************
+ * Name: tcp_tls_free
+ *
+ * Description:
+ *   Release the TLS state of a connection and wipe its keys.
+ *
+ ****************************************************************************/
+
+void tcp_tls_free(FAR struct tcp_conn_s *conn)
+{
+  if (conn->tls != NULL)
+    {
+      tcp_tls_dir_free(&conn->tls->tx);
+      tcp_tls_dir_free(&conn->tls->rx);
+      kmm_free(conn->tls);
+      conn->tls = NULL;
+    }
+}
+
+#endif /* CONFIG_NET_TCP_KTLS */
@@ -0,0 +1,409 @@
+/****************************************************************************
+ * net/tcp/tcp_zerocopy.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <netinet/tcp.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/queue.h>
+#include <nuttx/semaphore.h>
+#include <nuttx/mm/iob.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/tcp.h>
+
+#include "netdev/netdev.h"
+#include "socket/socket.h"
+#include "tcp/tcp.h"
+
+#ifdef CONFIG_NET_TCP_ZEROCOPY
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_ZEROCOPY_SEND
+/****************************************************************************
+ * Name: tcp_zcsend_free
+ *
+ * Description:
+ *   IOB free callback of a zero-copy write buffer fragment: drop the
+ *   reference to the user buffer and wake up the sender on the last one.
+ *   The tracking structure of a canceled sender is freed instead.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+static void tcp_zcsend_free(FAR void *data, FAR void *arg)
+{
+  FAR struct tcp_zcsend_s *zc = arg;
+
+  DEBUGASSERT(zc->zc_pending > 0);
+  DEBUGASSERT((FAR const uint8_t *)data >= zc->zc_base &&
+              (FAR const uint8_t *)data < zc->zc_base + zc->zc_len);
+
+  if (--zc->zc_pending == 0)
+    {
+      if (zc->zc_orphan)
+        {
+          nxsem_destroy(&zc->zc_sem);
+          kmm_free(zc);
+        }
+      else
+        {
+          nxsem_post(&zc->zc_sem);
+        }
+    }
+}
+#endif /* CONFIG_NET_TCP_ZEROCOPY_SEND */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: tcp_zerocopy_receive
+ *
+ * Description:
+ *   Implement TCP_ZEROCOPY_RECEIVE: detach I/O buffers from the head of
+ *   the read-ahead chain and describe their payload in the caller's iovec
+ *   array.  The buffers stay attached to the connection until they are
+ *   returned with tcp_zerocopy_release() or the connection is freed.
+ *
+ * Input Parameters:
+ *   conn - The TCP connection structure holding connection information.
+ *   zc   - The request, updated with the lent fragments.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, zero bytes lent meaning end of file.
+ *   -EAGAIN if no data is available, -ENOMEM if no IOB queue entry could
+ *   be allocated, -EINVAL for a malformed request.
+ *
+ ****************************************************************************/
+
+int tcp_zerocopy_receive(FAR struct tcp_conn_s *conn,
+                         FAR struct tcp_zerocopy_receive *zc)
+{
+  FAR struct iob_s *lent;
+  FAR struct iob_s *tail;
+  FAR struct iob_s *iob;
+  unsigned int pktlen;
+  size_t len = 0;
+  int niov = 0;
+  int ret;
+
+  if (zc->iov == NULL || zc->iovcnt <= 0 || zc->length == 0)
+    {
+      return -EINVAL;
+    }
+
+  net_lock();
+
+  lent = conn->readahead;
+  if (lent == NULL)
+    {
+      zc->iovcnt = 0;
+      zc->length = 0;
+      zc->cookie = NULL;
+
+      /* No data: end of file once the peer has closed the connection */
+
+      ret = _SS_ISCONNECTED(conn->sconn.s_flags) ? -EAGAIN : OK;
+      goto out;
+    }
+
+  /* Collect whole I/O buffers from the head of the read-ahead chain */
+
+  tail = NULL;
+  for (iob = lent; iob != NULL; iob = iob->io_flink)
+    {
+      if (iob->io_len > 0)
+        {
+          if (niov >= zc->iovcnt ||
+              (niov > 0 && len + iob->io_len > zc->length))
+            {
+              break;
+            }
+
+          zc->iov[niov].iov_base = IOB_DATA(iob);
+          zc->iov[niov].iov_len  = iob->io_len;
+          len += iob->io_len;
+          niov++;
+        }
+
+      tail = iob;
+    }
+
+  /* Split the chain behind the last lent I/O buffer */
+
+  pktlen = lent->io_pktlen;
+  conn->readahead = tail->io_flink;
+  tail->io_flink  = NULL;
+  lent->io_pktlen = len;
+
+  if (conn->readahead != NULL)
+    {
+      conn->readahead->io_pktlen = pktlen - len;
+    }
+
+  ret = iob_tryadd_queue(lent, &conn->zc_lent);
+  if (ret < 0)
+    {
+      /* Out of queue entries, put the data back */
+
+      tail->io_flink  = conn->readahead;
+      lent->io_pktlen = pktlen;
+      conn->readahead = lent;
+      goto out;
+    }
+
+  conn->zc_lentlen += len;
+
+  zc->iovcnt = niov;
+  zc->length = len;
+  zc->cookie = lent;
+
+#ifdef CONFIG_NET_TCP_RCVBUF_AUTOTUNE
+  tcp_rcvspace_adjust(conn, len);
+#endif
+
+out:
+  net_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: tcp_zerocopy_release
+ *
+ * Description:
+ *   Implement TCP_ZEROCOPY_RELEASE: free the I/O buffers lent by an earlier
+ *   TCP_ZEROCOPY_RECEIVE and reopen the receive window.
+ *
+ * Input Parameters:
+ *   conn   - The TCP connection structure holding connection information.
+ *   cookie - The cookie returned by TCP_ZEROCOPY_RECEIVE.
+ *
+ * Returned Value:
+ *   Zero (OK) on success, -EINVAL if the cookie is unknown.
+ *
+ ****************************************************************************/
+
+int tcp_zerocopy_release(FAR struct tcp_conn_s *conn, FAR void *cookie)
+{
+  FAR struct iob_qentry_s *qentry;
+  FAR struct iob_s *lent = cookie;
+
+  net_lock();
+
+  /* Only accept chains that were really lent on this connection */
+
+  for (qentry = conn->zc_lent.qh_head; qentry != NULL;
+       qentry = qentry->qe_flink)
+    {
+      if (qentry->qe_head == lent)
+        {
+          break;
+        }
+    }
+
+  if (qentry == NULL)
+    {
+      net_unlock();
+      return -EINVAL;
+    }
+
+  DEBUGASSERT(conn->zc_lentlen >= lent->io_pktlen);
+  conn->zc_lentlen -= lent->io_pktlen;
+  iob_free_queue_qentry(lent, &conn->zc_lent);
+
+  /* The freed buffers may open the receive window, announce it timely */
+
+  if (conn->dev != NULL && tcp_should_send_recvwindow(conn))
+    {
+      tcp_txready(conn);
+      netdev_txnotify_dev(conn->dev);
+    }
+
+  net_unlock();
+  return OK;
+}
+
+#ifdef CONFIG_NET_TCP_ZEROCOPY_SEND
+/****************************************************************************
+ * Name: tcp_zcsend_setup
+ *
+ * Description:
+ *   Start tracking a MSG_ZEROCOPY send of the user buffer 'buf'.
+ *
+ * Returned Value:
+ *   The tracking structure, NULL if there is no memory for it.
+ *
+ ****************************************************************************/
+
+FAR struct tcp_zcsend_s *tcp_zcsend_setup(FAR const void *buf, size_t len)
+{
+  FAR struct tcp_zcsend_s *zc;
+
+  /* The IOBs may outlive a canceled sender, so the tracking structure
+   * can't be on its stack.
+   */
+
+  zc = kmm_zalloc(sizeof(struct tcp_zcsend_s));
+  if (zc != NULL)
+    {
+      zc->zc_base = buf;
+      zc->zc_len  = len;
+      nxsem_init(&zc->zc_sem, 0, 0);
+    }
+
+  return zc;
+}
+
+/****************************************************************************
+ * Name: tcp_zcsend_attach
+ *
+ * Description:
+ *   Append 'len' bytes of the user buffer at 'src' to the write buffer
+ *   without copying them.
+ *
+ * Returned Value:
+ *   The number of bytes attached, or -ENOMEM if no IOB could be allocated.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+ssize_t tcp_zcsend_attach(FAR struct tcp_zcsend_s *zc,
+                          FAR struct tcp_wrbuffer_s *wrb,
+                          FAR const uint8_t *src, size_t len)
+{
+  FAR struct iob_s *iob;
+
+  DEBUGASSERT(len <= UINT16_MAX);
+  DEBUGASSERT(src >= zc->zc_base && src + len <= zc->zc_base + zc->zc_len);
+
+  iob = iob_alloc_with_data((FAR void *)src, len, tcp_zcsend_free, zc);
+  if (iob == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  /* The user data is both the payload and the whole buffer, so later
+   * copies into this write buffer always start a new IOB.
+   */
+
+  iob->io_len    = len;
+  iob->io_pktlen = len;
+  iob_concat(TCP_WBIOB(wrb), iob);
+
+  zc->zc_pending++;
+  return len;
+}
+
+/****************************************************************************
+ * Name: tcp_zcsend_wait
+ *
+ * Description:
+ *   Wait until no write buffer refers to the user buffer any longer, i.e.
+ *   until all of its data has been ACKed or dropped with the connection,
+ *   then free the tracking structure.  Does nothing if 'zc' is NULL.
+ *
+ * Assumptions:
+ *   The network is not locked.
+ *
+ ****************************************************************************/
+
+void tcp_zcsend_wait(FAR struct tcp_zcsend_s *zc)
+{
+  if (zc == NULL)
+    {
+      return;
+    }
+
+  net_lock();
+
+  /* The user buffer must not be reused while it may be retransmitted, so
+   * this wait can neither time out nor be interrupted.  psock_tcp_send()
+   * only sends without copying when it may block without a timeout.
+   */
+
+  while (zc->zc_pending > 0)
+    {
+      net_sem_wait_uninterruptible(&zc->zc_sem);
+    }
+
+  net_unlock();
+
+  nxsem_destroy(&zc->zc_sem);
+  kmm_free(zc);
+}
+
+/****************************************************************************
+ * Name: tcp_zcsend_cleanup
+ *
+ * Description:
+ *   Cancellation cleanup of a MSG_ZEROCOPY send: leave the tracking
+ *   structure to the last IOB that still refers to the user buffer, or
+ *   free it if there is none.
+ *
+ * Input Parameters:
+ *   arg - The tracking structure returned by tcp_zcsend_setup().
+ *
+ ****************************************************************************/
+
+void tcp_zcsend_cleanup(FAR void *arg)
+{
+  FAR struct tcp_zcsend_s *zc = arg;
+
+  net_lock();
+  if (zc->zc_pending > 0)
+    {
+      zc->zc_orphan = true;
+      zc = NULL;
+    }
+
+  net_unlock();
+
+  if (zc != NULL)
+    {
+      nxsem_destroy(&zc->zc_sem);
+      kmm_free(zc);
+    }
+}
+#endif /* CONFIG_NET_TCP_ZEROCOPY_SEND */
+
+#endif /* CONFIG_NET_TCP_ZEROCOPY */
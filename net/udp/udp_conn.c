@@ -628,6 +628,7 @@ void udp_free(FAR struct udp_conn_s *conn)
   /* Remove the connection from the active list */
 
   dq_rem(&conn->sconn.node, &g_active_udp_connections);
+  devif_txready_remove(&conn->sconn);
 
   /* Release any read-ahead buffers attached to the connection, NULL is ok */
 
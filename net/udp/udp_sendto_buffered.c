@@ -340,6 +340,7 @@ static int sendto_next_transfer(FAR struct udp_conn_s *conn)
 
   /* Notify the device driver of the availability of TX data */
 
+  devif_txready(&dev->d_udpready, &conn->sconn);
   netdev_txnotify_dev(dev);
   return OK;
 }
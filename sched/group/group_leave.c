@@ -35,6 +35,7 @@
 #include <nuttx/irq.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
+#include <nuttx/mm/arena.h>
 #include <nuttx/sched.h>
 #include <nuttx/spinlock.h>
 
@@ -123,6 +124,12 @@ group_release(FAR struct task_group_s *group, uint8_t ttype)
     }
 #endif
 
+#ifdef CONFIG_MM_TASK_ARENA
+  /* Give the heap arena back last, the steps above free into it */
+
+  mm_arena_release(group);
+#endif
+
   /* Then drop the group freeing the allocated memory */
 
 #ifndef CONFIG_DISABLE_PTHREAD
@@ -0,0 +1,140 @@
+/****************************************************************************
+ * sched/init/nx_boottime.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/init.h>
+#include <nuttx/sched_note.h>
+#include <nuttx/spinlock.h>
+
+#ifdef CONFIG_SCHED_BOOT_TIMELINE
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct boot_mark_s g_boot_marks[CONFIG_SCHED_BOOT_TIMELINE_NMARKS];
+static size_t g_boot_nmarks;
+static spinlock_t g_boot_lock = SP_UNLOCKED;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nx_boot_begin
+ *
+ * Description:
+ *   Record the start of a boot phase in the boot timeline and, once the
+ *   task lists are ready, in the note driver.
+ *
+ * Input Parameters:
+ *   name - The name of the phase, must be a string constant
+ *
+ ****************************************************************************/
+
+void nx_boot_begin(FAR const char *name)
+{
+  irqstate_t flags;
+
+  flags = spin_lock_irqsave(&g_boot_lock);
+  if (g_boot_nmarks < CONFIG_SCHED_BOOT_TIMELINE_NMARKS)
+    {
+      g_boot_marks[g_boot_nmarks].name  = name;
+      g_boot_marks[g_boot_nmarks].begin = perf_gettime();
+      g_boot_marks[g_boot_nmarks].end   = 0;
+      g_boot_nmarks++;
+    }
+
+  spin_unlock_irqrestore(&g_boot_lock, flags);
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_DUMP
+  /* The note logic needs the running task */
+
+  if (OSINIT_TASK_READY())
+    {
+      sched_note_mark(NOTE_TAG_SCHED, name);
+    }
+#endif
+}
+
+/****************************************************************************
+ * Name: nx_boot_end
+ *
+ * Description:
+ *   Record the end of the latest running boot phase with this name.
+ *
+ * Input Parameters:
+ *   name - The name of the phase
+ *
+ ****************************************************************************/
+
+void nx_boot_end(FAR const char *name)
+{
+  clock_t now = perf_gettime();
+  irqstate_t flags;
+  size_t i;
+
+  flags = spin_lock_irqsave(&g_boot_lock);
+  for (i = g_boot_nmarks; i-- > 0; )
+    {
+      if (g_boot_marks[i].end == 0 &&
+          strcmp(g_boot_marks[i].name, name) == 0)
+        {
+          /* 0 is kept for the phases that are still running */
+
+          g_boot_marks[i].end = now != 0 ? now : 1;
+          break;
+        }
+    }
+
+  spin_unlock_irqrestore(&g_boot_lock, flags);
+}
+
+/****************************************************************************
+ * Name: nx_boot_timeline
+ *
+ * Description:
+ *   Return the boot timeline recorded so far.
+ *
+ * Input Parameters:
+ *   marks - Location to return the array of marks
+ *
+ * Returned Value:
+ *   The number of marks in the array.
+ *
+ ****************************************************************************/
+
+size_t nx_boot_timeline(FAR const struct boot_mark_s **marks)
+{
+  *marks = g_boot_marks;
+  return g_boot_nmarks;
+}
+
+#endif /* CONFIG_SCHED_BOOT_TIMELINE */
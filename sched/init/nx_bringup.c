@@ -43,6 +43,7 @@
 #include <nuttx/kthread.h>
 #include <nuttx/userspace.h>
 #include <nuttx/binfmt/binfmt.h>
+#include <nuttx/mm/heapguard.h>
 
 #ifdef CONFIG_LEGACY_PAGING
 #  include "paging/paging.h"
@@ -319,13 +320,16 @@ static inline void nx_start_application(void)
    * configured.
    */
 
+  nx_boot_begin("board_late_initialize");
   board_late_initialize();
+  nx_boot_end("board_late_initialize");
 #endif
 
 #ifndef CONFIG_BOARD_CRASHDUMP_NONE
   coredump_initialize();
 #endif
 
+  nx_boot_begin("init_spawn");
   posix_spawnattr_init(&attr);
   attr.priority  = CONFIG_INIT_PRIORITY;
   attr.stacksize = CONFIG_INIT_STACKSIZE;
@@ -378,6 +382,7 @@ static inline void nx_start_application(void)
 #endif
   posix_spawnattr_destroy(&attr);
   DEBUGASSERT(ret > 0);
+  nx_boot_end("init_spawn");
 }
 
 /****************************************************************************
@@ -486,6 +491,7 @@ static inline void nx_create_initthread(void)
 int nx_bringup(void)
 {
   sched_trace_begin();
+  nx_boot_begin("nx_bringup");
 
 #ifndef CONFIG_DISABLE_ENVIRON
   /* Setup up the initial environment for the idle task.  At present, this
@@ -508,6 +514,15 @@ int nx_bringup(void)
 #endif
 #endif
 
+#ifdef CONFIG_MM_HEAPGUARD_SELFTEST
+  /* Check the sampled allocations before any other thread runs */
+
+  if (heapguard_selftest() < 0)
+    {
+      serr("ERROR: Heap guard self test failed\n");
+    }
+#endif
+
   /* Start the page fill worker kernel thread that will resolve page faults.
    * This should always be the first thread started because it may have to
    * resolve page faults in other threads
@@ -537,6 +552,7 @@ int nx_bringup(void)
 
 #endif
 
+  nx_boot_end("nx_bringup");
   sched_trace_end();
   return OK;
 }
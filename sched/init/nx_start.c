@@ -526,6 +526,7 @@ void nx_start(void)
   /* Boot up is complete */
 
   g_nx_initstate = OSINIT_BOOT;
+  nx_boot_begin("boot");
 
   /* Initialize task list table *********************************************/
 
@@ -538,6 +539,8 @@ void nx_start(void)
   /* Task lists are initialized */
 
   g_nx_initstate = OSINIT_TASKLISTS;
+  nx_boot_end("boot");
+  nx_boot_begin("tasklists");
 
   /* Initialize RTOS Data ***************************************************/
 
@@ -631,6 +634,8 @@ void nx_start(void)
   /* The memory manager is available */
 
   g_nx_initstate = OSINIT_MEMORY;
+  nx_boot_end("tasklists");
+  nx_boot_begin("memory");
 
   /* Initialize tasking data structures */
 
@@ -686,7 +691,10 @@ void nx_start(void)
    * that are different for each  processor and hardware platform.
    */
 
+  nx_boot_end("memory");
+  nx_boot_begin("up_initialize");
   up_initialize();
+  nx_boot_end("up_initialize");
 
   /* Initialize common drivers */
 
@@ -698,12 +706,15 @@ void nx_start(void)
    * that cannot wait until board_late_initialize.
    */
 
+  nx_boot_begin("board_early_initialize");
   board_early_initialize();
+  nx_boot_end("board_early_initialize");
 #endif
 
   /* Hardware resources are now available */
 
   g_nx_initstate = OSINIT_HARDWARE;
+  nx_boot_begin("hardware");
 
   /* Setup for Multi-Tasking ************************************************/
 
@@ -751,6 +762,7 @@ void nx_start(void)
   /* The OS is fully initialized and we are beginning multi-tasking */
 
   g_nx_initstate = OSINIT_OSREADY;
+  nx_boot_end("hardware");
 
   /* Create initial tasks and bring-up the system */
 
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+# tools/boottime.py
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed to the Apache Software Foundation (ASF) under one or more
+# contributor license agreements.  See the NOTICE file distributed with
+# this work for additional information regarding copyright ownership.  The
+# ASF licenses this file to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance with the
+# License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+# License for the specific language governing permissions and limitations
+# under the License.
+#
+import argparse
+import json
+import statistics
+import subprocess
+import sys
+
+program_description = """
+Boot a simulator build several times, collect /proc/boot from each run and
+compare the median duration of every boot phase against a baseline.
+
+The build needs CONFIG_SCHED_BOOT_TIMELINE, CONFIG_FS_PROCFS (mounted at
+/proc) and an nsh console with cat and poweroff.  Typical use:
+
+  tools/boottime.py --save baseline.json ./nuttx
+  ... change something, rebuild ...
+  tools/boottime.py --baseline baseline.json ./nuttx
+
+The exit status is 1 if any phase regressed beyond the threshold or is
+missing from the current boot.
+"""
+
+
+def boot_once(binary, timeout):
+    """Boot the simulator once and return {phase: usec}"""
+
+    cmds = "cat /proc/boot\npoweroff\n"
+    try:
+        proc = subprocess.run(
+            [binary],
+            input=cmds,
+            capture_output=True,
+            text=True,
+            timeout=timeout,
+        )
+        output = proc.stdout
+    except subprocess.TimeoutExpired as e:
+        output = e.stdout or ""
+        if isinstance(output, bytes):
+            output = output.decode(errors="replace")
+
+    phases = {}
+    inside = False
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[0] == "PHASE":
+            inside = True
+            phases = {}
+        elif inside and len(fields) == 3 and fields[2].isdigit():
+            phases[fields[0]] = int(fields[2])
+        elif inside and len(fields) == 3 and fields[2] == "-":
+            # A phase that has not ended has no duration, leave it out so
+            # that compare() reports it as missing
+
+            continue
+        elif inside:
+            inside = False
+
+    return phases
+
+
+def collect(binary, runs, timeout):
+    samples = {}
+    for i in range(runs):
+        phases = boot_once(binary, timeout)
+        if not phases:
+            sys.exit("run %d: no boot timeline in the output" % i)
+
+        for name, usec in phases.items():
+            samples.setdefault(name, []).append(usec)
+
+    return {name: statistics.median(v) for name, v in samples.items()}
+
+
+def compare(current, baseline, threshold, slack):
+    regressed = False
+    print("%-24s %12s %12s %8s" % ("PHASE", "BASE(us)", "NOW(us)", "DIFF"))
+    for name, base in baseline.items():
+        if name not in current:
+            print("%-24s %12d %12s  REGRESSED" % (name, base, "missing"))
+            regressed = True
+            continue
+
+        now = current[name]
+        diff = (now - base) * 100.0 / base if base else 0.0
+        bad = now > base * (1 + threshold / 100.0) + slack
+        regressed |= bad
+        print(
+            "%-24s %12d %12d %+7.1f%%%s"
+            % (name, base, now, diff, "  REGRESSED" if bad else "")
+        )
+
+    return regressed
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description=program_description,
+        formatter_class=argparse.RawTextHelpFormatter,
+    )
+    parser.add_argument("binary", help="simulator binary, e.g. ./nuttx")
+    parser.add_argument("-n", "--runs", type=int, default=5, help="boot count")
+    parser.add_argument(
+        "-t", "--threshold", type=float, default=20.0, help="allowed percent"
+    )
+    parser.add_argument(
+        "-s",
+        "--slack",
+        type=int,
+        default=500,
+        help="allowed absolute increase in us, hides jitter of short phases",
+    )
+    parser.add_argument("--timeout", type=int, default=30, help="seconds/run")
+    parser.add_argument("--baseline", help="baseline to compare against")
+    parser.add_argument("--save", help="write the result as a new baseline")
+    args = parser.parse_args()
+
+    current = collect(args.binary, args.runs, args.timeout)
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(current, f, indent=2)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+        if compare(current, baseline, args.threshold, args.slack):
+            sys.exit(1)
+    else:
+        for name, usec in current.items():
+            print("%-24s %12d" % (name, usec))
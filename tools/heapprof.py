@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+# tools/heapprof.py
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Licensed to the Apache Software Foundation (ASF) under one or more
+# contributor license agreements.  See the NOTICE file distributed with
+# this work for additional information regarding copyright ownership.  The
+# ASF licenses this file to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance with the
+# License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+# License for the specific language governing permissions and limitations
+# under the License.
+#
+import argparse
+import gzip
+import math
+import re
+import subprocess
+import sys
+
+program_description = """
+Convert a /proc/heapprof dump of the sampling heap profiler
+(CONFIG_MM_HEAPPROF) to a symbolized pprof profile, or print the top
+allocation sites.  Typical use:
+
+  nsh> cat /proc/heapprof > /tmp/heap.txt
+  tools/heapprof.py -e nuttx -o heap.pb.gz heap.txt
+  pprof -http=: heap.pb.gz
+
+Write to /proc/heapprof first to restrict the allocation profile to a
+time window, the duration is used to report allocation rates.
+"""
+
+HEADER_RE = re.compile(
+    r"heap profile: *(\d+): *(\d+) *\[ *(\d+): *(\d+) *\] *@ *heap_v2/(\d+)"
+)
+SAMPLE_RE = re.compile(r"(\d+): *(\d+) *\[ *(\d+): *(\d+) *\] *@(.*)")
+
+
+def parse(lines):
+    """Return (rate, duration_ms, dropped, [(values, addrs)])"""
+
+    rate = None
+    duration = 0
+    dropped = 0
+    samples = []
+    for line in lines:
+        line = line.strip()
+        m = HEADER_RE.match(line)
+        if m:
+            rate = int(m.group(5))
+            continue
+
+        if line.startswith("# duration_ms:"):
+            duration = int(line.split(":")[1])
+        elif line.startswith("# dropped:"):
+            dropped = int(line.split(":")[1])
+        elif rate is not None:
+            m = SAMPLE_RE.match(line)
+            if m:
+                values = [int(m.group(i)) for i in range(1, 5)]
+                addrs = [int(a, 16) for a in m.group(5).split()]
+                samples.append((values, addrs))
+
+    if rate is None:
+        sys.exit("no heap profile header found")
+
+    return rate, duration, dropped, samples
+
+
+def unsample(count, size, rate):
+    """Scale sampled counts back, an allocation of n bytes is sampled
+    with probability 1 - exp(-n / rate)"""
+
+    if count == 0 or size == 0:
+        return 0, 0
+
+    scale = 1 / (1 - math.exp(-size / count / rate))
+    return int(count * scale), int(size * scale)
+
+
+def symbolize(elf, addrs):
+    """Return {addr: (function, file, line)} using addr2line"""
+
+    if not elf or not addrs:
+        return {}
+
+    # Frames are return addresses, look up the call instruction
+
+    addrs = sorted(addrs)
+    proc = subprocess.run(
+        ["addr2line", "-a", "-f", "-C", "-e", elf]
+        + ["0x%x" % max(a - 1, 0) for a in addrs],
+        capture_output=True,
+        text=True,
+        check=True,
+    )
+
+    out = proc.stdout.splitlines()
+    result = {}
+    for i, addr in enumerate(addrs):
+        func, location = out[i * 3 + 1 : i * 3 + 3]
+        filename, _, line = location.rpartition(":")
+        line = line.split()[0] if line else "0"
+        result[addr] = (
+            func if func != "??" else "0x%x" % addr,
+            filename if filename != "??" else "",
+            int(line) if line.isdigit() else 0,
+        )
+
+    return result
+
+
+class Proto:
+    """Just enough of the protobuf wire format for profile.proto"""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def varint(self, value):
+        value &= (1 << 64) - 1
+        while value >= 0x80:
+            self.buf.append((value & 0x7F) | 0x80)
+            value >>= 7
+        self.buf.append(value)
+
+    def int(self, field, value):
+        if value:
+            self.varint(field << 3)
+            self.varint(value)
+
+    def bytes(self, field, data):
+        self.varint(field << 3 | 2)
+        self.varint(len(data))
+        self.buf += data
+
+    def packed(self, field, values):
+        sub = Proto()
+        for v in values:
+            sub.varint(v)
+        self.bytes(field, sub.buf)
+
+    def message(self, field, sub):
+        self.bytes(field, sub.buf)
+
+
+def to_pprof(rate, duration, samples, symbols):
+    strings = [""]
+    index = {"": 0}
+
+    def string(s):
+        if s not in index:
+            index[s] = len(strings)
+            strings.append(s)
+        return index[s]
+
+    def value_type(kind, unit):
+        vt = Proto()
+        vt.int(1, string(kind))
+        vt.int(2, string(unit))
+        return vt
+
+    profile = Proto()
+    for kind, unit in (
+        ("alloc_objects", "count"),
+        ("alloc_space", "bytes"),
+        ("inuse_objects", "count"),
+        ("inuse_space", "bytes"),
+    ):
+        profile.message(1, value_type(kind, unit))
+
+    locations = {}
+    functions = {}
+    function_messages = []
+    for values, addrs in samples:
+        inuse = unsample(values[0], values[1], rate)
+        alloc = unsample(values[2], values[3], rate)
+        for addr in addrs:
+            locations.setdefault(addr, len(locations) + 1)
+
+        sample = Proto()
+        sample.packed(1, [locations[a] for a in addrs])
+        sample.packed(2, [alloc[0], alloc[1], inuse[0], inuse[1]])
+        profile.message(2, sample)
+
+    for addr, lid in locations.items():
+        func, filename, line = symbols.get(addr, ("0x%x" % addr, "", 0))
+        fid = functions.get((func, filename))
+        if fid is None:
+            fid = len(functions) + 1
+            functions[(func, filename)] = fid
+            f = Proto()
+            f.int(1, fid)
+            f.int(2, string(func))
+            f.int(3, string(func))
+            f.int(4, string(filename))
+            function_messages.append(f)
+
+        ln = Proto()
+        ln.int(1, fid)
+        ln.int(2, line)
+        loc = Proto()
+        loc.int(1, lid)
+        loc.int(3, addr)
+        loc.message(4, ln)
+        profile.message(4, loc)
+
+    for f in function_messages:
+        profile.message(5, f)
+
+    profile.int(10, duration * 1000000)
+    profile.message(11, value_type("space", "bytes"))
+    profile.int(12, rate)
+    profile.int(14, string("inuse_space"))
+
+    # The string table is written last, all strings are known by now
+
+    for s in strings:
+        profile.bytes(6, s.encode())
+
+    return bytes(profile.buf)
+
+
+def print_top(rate, duration, dropped, samples, symbols, count):
+    rows = []
+    for values, addrs in samples:
+        inuse = unsample(values[0], values[1], rate)
+        alloc = unsample(values[2], values[3], rate)
+        site = " <- ".join(symbols.get(a, ("0x%x" % a,))[0] for a in addrs[:4])
+        rows.append((inuse[1], alloc[1], site))
+
+    seconds = duration / 1000.0
+    print("%12s %14s  %s" % ("INUSE(B)", "ALLOC(B/s)", "SITE"))
+    for inuse, alloc, site in sorted(rows, reverse=True)[:count]:
+        print(
+            "%12d %14d  %s" % (inuse, alloc / seconds if seconds else alloc, site)
+        )
+
+    if dropped:
+        print("%d samples dropped, enlarge the profiler tables" % dropped)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description=program_description,
+        formatter_class=argparse.RawTextHelpFormatter,
+    )
+    parser.add_argument("dump", help="the content of /proc/heapprof, - for stdin")
+    parser.add_argument("-e", "--elf", help="the nuttx ELF to symbolize with")
+    parser.add_argument("-o", "--output", help="write a gzipped pprof profile")
+    parser.add_argument(
+        "-n", "--top", type=int, default=20, help="sites printed without -o"
+    )
+    args = parser.parse_args()
+
+    if args.dump == "-":
+        rate, duration, dropped, samples = parse(sys.stdin)
+    else:
+        with open(args.dump) as f:
+            rate, duration, dropped, samples = parse(f)
+
+    symbols = symbolize(args.elf, {a for _, addrs in samples for a in addrs})
+
+    if args.output:
+        with gzip.open(args.output, "wb") as f:
+            f.write(to_pprof(rate, duration, samples, symbols))
+    else:
+        print_top(rate, duration, dropped, samples, symbols, args.top)